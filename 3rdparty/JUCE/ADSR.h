@@ -10,9 +10,7 @@
 // - Added various functions as used by SFM::Envelope (synth-envelope.h)
 // - Removed buffer processing function
 // - Curves added by Paul
-// 
-// FIXME:
-//   - Uses 'jassert' (which happens to be available since FM. BISON uses it too
+// - Uses SFM_ASSERT instead of 'jassert'
 //
 // ----------------------------------------------------------------------------------------------------
 
@@ -104,7 +102,7 @@ namespace SFM // So that it will not collide with juce::ADSR
         void setParameters (const Parameters& newParameters)
         {
             // need to call setSampleRate() first!
-            jassert (sampleRate > 0.0);
+            SFM_ASSERT(sampleRate > 0.0);
 
             parameters = newParameters;
             recalculateRates();
@@ -126,7 +124,7 @@ namespace SFM // So that it will not collide with juce::ADSR
         */
         void setSampleRate (double newSampleRate) noexcept
         {
-            jassert (newSampleRate > 0.0);
+            SFM_ASSERT(newSampleRate > 0.0);
             sampleRate = newSampleRate;
         }
 
@@ -193,7 +191,7 @@ namespace SFM // So that it will not collide with juce::ADSR
 
         void pianoSustain(float falloff) noexcept
         {
-            jassert(falloff >= 0.f);
+            SFM_ASSERT(falloff >= 0.f);
 
             parameters.sustain = envelopeVal; // Adapt last/current output
 
@@ -214,7 +212,7 @@ namespace SFM // So that it will not collide with juce::ADSR
 
         void scaleReleaseRate(float scale) noexcept
         {
-            jassert(scale >= 0.f);
+            SFM_ASSERT(scale >= 0.f);
             parameters.release *= scale;
         }
 
@@ -15,10 +15,20 @@
 #include "synth-global.h"
 #include "patch/synth-patch-global.h"
 #include "synth-DX7-LFO-table.h"
+#include "helper/synth-profile.h"
 
 namespace SFM
 {
-	static bool s_performStaticInit = true;
+	// Static initialization (LUTs, random generator) is done once, by whichever instance comes first; instances can be
+	// constructed concurrently (see synth-rack.h), so the global random generator needs guarding too
+	static std::once_flag s_staticInit;
+	static std::mutex s_randomMutex;
+
+	// Voice jobs (see SetJobPool()): no more than this many voices per job
+	constexpr unsigned kMaxVoicesPerJob = 8;
+
+	// ResetPostPass(): crossfade time
+	constexpr float kPostPassFadeTime = 0.05f; // 50MS
 
 	/* ----------------------------------------------------------------------------------------------------
 
@@ -28,15 +38,22 @@ namespace SFM
 	
 	Bison::Bison()
 	{
-		if (true == s_performStaticInit)
+		// Writes what SFM_LOG() queues (see helper/synth-log.h)
+		StartLogThread();
+
+		std::call_once(s_staticInit, []()
 		{
 			// Calculate LUTs & initialize random generator
 			InitializeRandomGenerator();
 			CalculateMIDIToFrequencyLUT();
-			InitializeFastCosine();
 			Supersaw::CalculateDetuneTable();
+			Oscillator::CalculateWavetables();
+		});
 
-			s_performStaticInit = false;
+		// Seed random streams (see SeedVoice())
+		{
+			std::lock_guard<std::mutex> lock(s_randomMutex);
+			m_randomSeed = uint64_t(mt_randu32()) | (uint64_t(mt_randu32()) << 32);
 		}
 		
 		// Reset entire patch
@@ -46,8 +63,17 @@ namespace SFM
 		const bool monophonic = Patch::VoiceMode::kMono == m_patch.voiceMode;
 		m_curPolyphony = (false == monophonic) ? m_patch.maxPolyVoices : 1;
 
-		Log("Instance of FM. BISON engine initalized");
-		Log("Suzie, call DR. BISON, tell him it's for me...");
+		// Reserve request & scratch lists (see FM_BISON.h)
+		m_polyVoiceReq.reserve(kMaxPolyVoices);
+		m_polyVoiceReleaseReq.reserve(kMaxPolyVoices);
+		m_monoSequence.reserve(kMaxPolyVoices);
+		m_voicesToRender.reserve(kMaxPolyVoices);
+		m_voicesToSteal.reserve(kMaxPolyVoices);
+
+		// Worker (see ResetPostPass() & UpdateNoteTable()) is attached to by OnSetSamplingProperties(), see SetWorker()
+
+		SFM_LOG("Instance of FM. BISON engine initalized");
+		SFM_LOG("Suzie, call DR. BISON, tell him it's for me...");
 
 		/*
 			IMPORTANT: call SetSamplingProperties() before Render()
@@ -56,9 +82,14 @@ namespace SFM
 
 	Bison::~Bison() 
 	{
+		DetachWorker();
+
 		DeleteRateDependentObjects();
+		ReleaseVoicePool();
+
+		SFM_LOG("Instance of FM. BISON engine released");
 
-		Log("Instance of FM. BISON engine released");
+		StopLogThread();
 	}
 
 	/* ----------------------------------------------------------------------------------------------------
@@ -69,39 +100,56 @@ namespace SFM
 	 ------------------------------------------------------------------------------------------------------ */
 
 	// Called by JUCE's prepareToPlay()
-	void Bison::OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock)
+	void Bison::OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock, unsigned internalRate /* = 0 */, bool internalRateFX /* = false */)
 	{
-		Log("BISON::OnSetSamplingProperties(" + std::to_string(sampleRate) + ", " + std::to_string(samplesPerBlock) + ")");
+		SFM_LOG("BISON::OnSetSamplingProperties({}, {}, {})", sampleRate, samplesPerBlock, internalRate);
 
-		m_sampleRate       = sampleRate;
-		m_samplesPerBlock  = samplesPerBlock;
+		// Before taking the lock below, since the worker takes it whilst holding it's own (see BackgroundWorker)
+		AttachWorker();
 
-		m_Nyquist = sampleRate>>1;
+		// Keep worker out of the way
+		std::lock_guard<std::mutex> lock(m_workerMutex);
 
-		/* 
-			Reset sample rate dependent global objects
-		*/
+		m_hostSampleRate      = sampleRate;
+		m_hostSamplesPerBlock = samplesPerBlock;
 
-		DeleteRateDependentObjects();
+		// Find largest ratio (up to 4) that keeps the engine at or above the requested internal rate
+		m_internalRatio = 1;
+		if (0 != internalRate)
+		{
+			while (m_internalRatio < 4 && sampleRate/(m_internalRatio*2) >= internalRate)
+				m_internalRatio *= 2;
+		}
 
-		// Stop & reset all voices, clear slots & wipe requests
-		for (unsigned iVoice = 0; iVoice < kMaxPolyVoices; ++iVoice)		
-			m_voices[iVoice].Reset(m_sampleRate);
+		m_internalRateFX = m_internalRatio > 1 && true == internalRateFX;
 
-		for (unsigned iSlot = 0; iSlot < 128; ++iSlot)
-			m_keyToVoice[iSlot] = -1;
+		m_sampleRate       = sampleRate/m_internalRatio;
+		m_samplesPerBlock  = (1 == m_internalRatio) ? samplesPerBlock : samplesPerBlock/m_internalRatio + 1; // Rounded up
 
-		m_polyVoiceReq.clear();
-		m_polyVoiceReleaseReq.clear();
+		m_Nyquist = m_sampleRate>>1;
 
-		m_resetVoices = false;
+		m_maxOpFreq = (m_internalRatio > 1) ? kInternalMaxOpPitch*m_sampleRate : 0.f;
+
+		if (m_internalRatio > 1)
+			SFM_LOG("Voice engine runs at internal rate: {}", m_sampleRate);
+
+		/* 
+			Reset sample rate dependent global objects
+		*/
+
+		ReleaseRateDependentObjects();
+
+		// Size voice pool to patch & reset all of them
+		GrowVoicePool(m_patch.maxPolyVoices);
+		ClearVoices();
 		 
 		// Reset BPM
 		m_BPM = 0.0;
 		m_resetPhaseBPM = true;
 
-		// Voice mode
+		// Voice mode (and matching polyphony, or NoteOn() trips over it before the first Render())
 		m_curVoiceMode = m_patch.voiceMode;
+		m_curPolyphony = (Patch::VoiceMode::kMono == m_curVoiceMode) ? 1 : std::min(m_patch.maxPolyVoices, m_voiceCapacity);
 
 		// Reset monophonic state
 		m_monoSequence.clear();
@@ -111,19 +159,122 @@ namespace SFM
 		// Reset filter type
 		m_curFilterType = SvfLinearTrapOptimised2::NO_FLT_TYPE;
 
+		// Size arena (only reallocates if it must grow); order of allocation below must match
+		size_t arenaSize = 4*Arena::GetFloatsSize(m_samplesPerBlock);
+
+		if (nullptr != m_pJobPool)
+			arenaSize += (kMaxVoiceJobs-2)*2*Arena::GetFloatsSize(m_samplesPerBlock);
+
+		arenaSize += ((nullptr != m_pJobPool) ? kMaxVoiceJobs : 2)*Arena::GetFloatsSize(3*m_samplesPerBlock);
+
+		if (m_internalRatio > 1)
+		{
+			arenaSize += Arena::Align(sizeof(PolyphaseUpsampler)) + PolyphaseUpsampler::GetArenaSize(m_internalRatio);
+			arenaSize += 2*Arena::GetFloatsSize(m_hostSamplesPerBlock+m_internalRatio);
+		}
+
+		arenaSize += Arena::Align(sizeof(FreeRunningPhase));
+		arenaSize += 2*Arena::Align(sizeof(NoteTable));
+
+		const size_t postPassArenaSize = Arena::Align(sizeof(PostPass)) + PostPass::GetArenaSize(GetPostPassSampleRate(), GetPostPassSamplesPerBlock());
+		arenaSize += 2*Arena::GetFloatsSize(GetPostPassSamplesPerBlock()) + 2*postPassArenaSize;
+
+		// Pipelined mode needs the engine & PostPass at host rate
+		const bool pipelined = true == m_pipelined && 1 == m_internalRatio;
+
+		if (true == pipelined)
+			arenaSize += kPipelineSlots*4*Arena::GetFloatsSize(m_samplesPerBlock) + 2*Arena::GetFloatsSize(m_hostSamplesPerBlock);
+
+		m_arena.Reserve(arenaSize, 0 != SFM_LOCK_ARENA);
+
+		SFM_LOG("Arena size: {} bytes", arenaSize);
+
 		// Allocate intermediate buffers (a pair for each thread)
-		m_pBufL[0] = reinterpret_cast<float *>(mallocAligned(m_samplesPerBlock*sizeof(float), 16));
-		m_pBufL[1] = reinterpret_cast<float *>(mallocAligned(m_samplesPerBlock*sizeof(float), 16));
-		m_pBufR[0] = reinterpret_cast<float *>(mallocAligned(m_samplesPerBlock*sizeof(float), 16));
-		m_pBufR[1] = reinterpret_cast<float *>(mallocAligned(m_samplesPerBlock*sizeof(float), 16));
+		m_pBufL[0] = m_arena.AllocateFloats(m_samplesPerBlock);
+		m_pBufL[1] = m_arena.AllocateFloats(m_samplesPerBlock);
+		m_pBufR[0] = m_arena.AllocateFloats(m_samplesPerBlock);
+		m_pBufR[1] = m_arena.AllocateFloats(m_samplesPerBlock);
+
+		// Voice jobs use these as well, plus a pair for each extra job (see RenderVoiceJobs())
+		for (unsigned iJob = 0; iJob < kMaxVoiceJobs; ++iJob)
+		{
+			if (iJob < 2)
+			{
+				m_pJobBufL[iJob] = m_pBufL[iJob];
+				m_pJobBufR[iJob] = m_pBufR[iJob];
+			}
+			else if (nullptr != m_pJobPool)
+			{
+				m_pJobBufL[iJob] = m_arena.AllocateFloats(m_samplesPerBlock);
+				m_pJobBufR[iJob] = m_arena.AllocateFloats(m_samplesPerBlock);
+			}
+			else
+				m_pJobBufL[iJob] = m_pJobBufR[iJob] = nullptr;
+
+			m_pJobLFOs[iJob] = (iJob < 2 || nullptr != m_pJobPool) ? m_arena.AllocateFloats(3*m_samplesPerBlock) : nullptr;
+		}
 
-		// Create effects
-		m_postPass = new PostPass(m_sampleRate, m_samplesPerBlock, m_Nyquist);
+		// Create upsampler (and it's output buffers, which can hold a host block plus what's left from the last)
+		if (m_internalRatio > 1)
+		{
+			m_upsampler = new (m_arena.Allocate(sizeof(PolyphaseUpsampler))) PolyphaseUpsampler(m_arena, m_internalRatio);
+			m_pUpBufL = m_arena.AllocateFloats(m_hostSamplesPerBlock+m_internalRatio);
+			m_pUpBufR = m_arena.AllocateFloats(m_hostSamplesPerBlock+m_internalRatio);
+		}
+
+		m_upBufCount = 0;
 
 		// Start global LFO phase
-		m_globalLFO = new Phase(m_sampleRate);
+		m_globalLFO = new (m_arena.Allocate(sizeof(FreeRunningPhase))) FreeRunningPhase(m_sampleRate);
 		const float freqLFO = MIDI_To_DX7_LFO_Hz(m_patch.LFORate);
-		m_globalLFO->Initialize(freqLFO, m_sampleRate);
+		m_globalLFO->Initialize(freqLFO, m_sampleRate, m_sampleClock);
+
+		// Create note tables & build the first one right away (see UpdateNoteTable())
+		m_noteTables[0] = new (m_arena.Allocate(sizeof(NoteTable))) NoteTable(m_sampleRate);
+		m_noteTables[1] = new (m_arena.Allocate(sizeof(NoteTable))) NoteTable(m_sampleRate);
+
+		m_activeNoteTable = 0;
+		if (true == m_noteTablesEnabled)
+		{
+			m_noteTables[m_activeNoteTable]->Build(m_patch.operators);
+			m_noteTable = m_noteTables[m_activeNoteTable];
+		}
+		else
+			m_noteTable = nullptr;
+
+		m_noteTableState.store(kNoteTableFree);
+
+		// Create effects (standby slot is built by worker when ResetPostPass() is called)
+		m_pPostFadeBufL = m_arena.AllocateFloats(GetPostPassSamplesPerBlock());
+		m_pPostFadeBufR = m_arena.AllocateFloats(GetPostPassSamplesPerBlock());
+		m_postPassArenas[0].Carve(m_arena, postPassArenaSize);
+		m_postPassArenas[1].Carve(m_arena, postPassArenaSize);
+
+		m_activePostPass = 0;
+		CreatePostPass(m_activePostPass);
+		m_postPass = m_postPasses[m_activePostPass];
+		m_fadingPostPass = nullptr;
+		m_postPassFadeSize = unsigned(GetPostPassSampleRate()*kPostPassFadeTime);
+
+		m_resetPostPass.store(false);
+		m_standbyState.store(kStandbyFree);
+
+		// Allocate pipeline slots & output buffers, then start thread
+		if (true == pipelined)
+		{
+			for (PipelineSlot &slot : m_pipelineSlots)
+			{
+				slot.pInL  = m_arena.AllocateFloats(m_samplesPerBlock);
+				slot.pInR  = m_arena.AllocateFloats(m_samplesPerBlock);
+				slot.pOutL = m_arena.AllocateFloats(m_samplesPerBlock);
+				slot.pOutR = m_arena.AllocateFloats(m_samplesPerBlock);
+			}
+
+			m_pPipelineOutL = m_arena.AllocateFloats(m_hostSamplesPerBlock);
+			m_pPipelineOutR = m_arena.AllocateFloats(m_hostSamplesPerBlock);
+
+			StartPipeline();
+		}
 
 		// Reset global interpolated parameters
 		m_curLFOBlend    = { m_patch.LFOBlend, m_sampleRate, kDefParameterLatency };
@@ -135,32 +286,136 @@ namespace SFM
 		m_curModulation  = { 0.f, m_sampleRate, kDefParameterLatency * 1.5f /* Longer */ };
 		m_curAftertouch  = { 0.f, m_sampleRate, kDefParameterLatency * 3.f  /* Longer */ };
 
-		// Reset operator peaks (visualization)
-		for (float &peak : m_opPeaks)
-			peak = 0.f;
+		// Restart visualization windows
+		m_visualization.Reset(m_hostSampleRate);
+
+		PublishLatency();
+
+		// A ResetPostPass() call might've been waiting for m_postPass
+		SignalWorker();
+	}
+
+	void Bison::ReserveVoices(unsigned numVoices)
+	{
+		if (true == GrowVoicePool(numVoices) && 0 != m_sampleRate)
+			ClearVoices();
+	}
+
+	bool Bison::GrowVoicePool(unsigned numVoices)
+	{
+		// Monophonic mode needs 2 voices (see UpdateVoicesPreRender())
+		numVoices = std::clamp<unsigned>(numVoices, 2, kMaxPolyVoices);
+
+		if (numVoices <= m_voiceCapacity)
+			return false;
+
+		ReleaseVoicePool();
+
+		m_voices = reinterpret_cast<Voice *>(mallocAligned(numVoices*sizeof(Voice), kArenaAlignment));
+		m_supersaws = reinterpret_cast<Supersaw *>(mallocAligned(numVoices*kNumOperators*sizeof(Supersaw), kArenaAlignment));
+
+		for (unsigned iVoice = 0; iVoice < numVoices; ++iVoice)
+		{
+			Voice *pVoice = new (m_voices+iVoice) Voice();
+
+			// Supersaw state only takes up space (and cache) in these slots, and only if an operator is one
+			pVoice->m_pSupersaws = m_supersaws + iVoice*kNumOperators;
+			for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+				new (pVoice->m_pSupersaws+iOp) Supersaw();
+		}
+
+		m_voiceCapacity = numVoices;
+
+		SFM_LOG("Voice pool: {} voices, {} bytes", numVoices, numVoices*(sizeof(Voice) + kNumOperators*sizeof(Supersaw)));
+
+		return true;
+	}
+
+	void Bison::ReleaseVoicePool()
+	{
+		for (unsigned iVoice = 0; iVoice < m_voiceCapacity; ++iVoice)
+			m_voices[iVoice].~Voice();
+
+		for (unsigned iSlot = 0; iSlot < m_voiceCapacity*kNumOperators; ++iSlot)
+			m_supersaws[iSlot].~Supersaw();
+
+		freeAligned(m_voices);
+		freeAligned(m_supersaws);
+
+		m_voices = nullptr;
+		m_supersaws = nullptr;
+		m_voiceCapacity = 0;
+	}
+
+	void Bison::ClearVoices()
+	{
+		for (unsigned iVoice = 0; iVoice < m_voiceCapacity; ++iVoice)		
+			m_voices[iVoice].Reset(m_sampleRate);
+
+		for (unsigned iSlot = 0; iSlot < 128; ++iSlot)
+			m_keyToVoice[iSlot] = -1;
+
+		m_polyVoiceReq.clear();
+		m_polyVoiceReleaseReq.clear();
+
+		m_voiceCount = 0;
+		m_resetVoices = false;
 	}
 
 	// Cleans up after OnSetSamplingProperties()
 	void Bison::DeleteRateDependentObjects()
 	{
-		// Allocate intermediate sample buffers
-		if (nullptr != m_pBufL[0]) // Good enough to assume
+		std::lock_guard<std::mutex> lock(m_workerMutex);
+		ReleaseRateDependentObjects();
+	}
+
+	void Bison::ReleaseRateDependentObjects()
+	{
+		// Uses PostPass & buffers below
+		StopPipeline();
+
+		for (PipelineSlot &slot : m_pipelineSlots)
+			slot.pInL = slot.pInR = slot.pOutL = slot.pOutR = nullptr;
+
+		m_pPipelineOutL = m_pPipelineOutR = nullptr;
+
+		// Intermediate sample buffers live in the arena
+		m_pBufL[0] = m_pBufL[1] = m_pBufR[0] = m_pBufR[1] = nullptr;
+		m_pUpBufL = m_pUpBufR = nullptr;
+		m_pPostFadeBufL = m_pPostFadeBufR = nullptr;
+
+		// Destroy objects constructed in the arena
+		m_postPass = m_fadingPostPass = nullptr;
+		m_latency.store(0, std::memory_order_relaxed);
+		DestroyPostPass(0);
+		DestroyPostPass(1);
+
+		if (nullptr != m_upsampler)
 		{
-			freeAligned(m_pBufL[0]);
-			freeAligned(m_pBufL[1]);
-			freeAligned(m_pBufR[0]);
-			freeAligned(m_pBufR[1]);
+			m_upsampler->~PolyphaseUpsampler();
+			m_upsampler = nullptr;
 		}
 
-		m_pBufL[0] = m_pBufL[1] = m_pBufR[0] = m_pBufR[1] = nullptr;
+		if (nullptr != m_globalLFO)
+		{
+			m_globalLFO->~FreeRunningPhase();
+			m_globalLFO = nullptr;
+		}
+
+		m_noteTable = nullptr;
+		m_noteTableState.store(kNoteTableFree);
 
-		// Release post-pass
-		delete m_postPass;
-		m_postPass = nullptr;
+		for (NoteTable *&pTable : m_noteTables)
+		{
+			if (nullptr != pTable)
+			{
+				pTable->~NoteTable();
+				pTable = nullptr;
+			}
+		}
 
-		// Delete global LFO
-		delete m_globalLFO;
-		m_globalLFO = nullptr;
+		// Keep memory, just start over (freed by destructor)
+		m_arena.Reset();
 	}
 
 	/* ----------------------------------------------------------------------------------------------------
@@ -180,7 +435,7 @@ namespace SFM
 	// Release voice, but retain key slot
 	void Bison::ReleaseVoice(int index)
 	{
-		SFM_ASSERT(index >= 0 && index < kMaxPolyVoices);
+		SFM_ASSERT(index >= 0 && index < int(m_voiceCapacity));
 
 		Voice &voice = m_voices[index];
 		SFM_ASSERT(true == voice.IsPlaying());
@@ -189,14 +444,13 @@ namespace SFM
 		voice.m_sustained = false;
 		voice.OnRelease();
 
-		const int key = voice.m_key;
-		Log("Voice released: " + std::to_string(index) + " for key: " + std::to_string(key));
+		SFM_LOG("Voice released: {} for key: {}", index, voice.m_key);
 	}
 	
 	// Free voice & key slot immediately
 	void Bison::FreeVoice(int index)
 	{
-		SFM_ASSERT(index >= 0 && index < kMaxPolyVoices);
+		SFM_ASSERT(index >= 0 && index < int(m_voiceCapacity));
 
 		Voice &voice = m_voices[index];
 
@@ -217,16 +471,16 @@ namespace SFM
 			FreeKey(voice.m_key);
 			voice.m_key = -1;
 
-			Log("Voice freed: " + std::to_string(index) + " for key: " + std::to_string(key));
+			SFM_LOG("Voice freed: {} for key: {}", index, key);
 		}
 		else
-			Log("Voice freed: " + std::to_string(index));
+			SFM_LOG("Voice freed: {}", index);
 	}
 
 	// Steal voice (quick fade)
 	void Bison::StealVoice(int index)
 	{
-		SFM_ASSERT(index >= 0 && index < kMaxPolyVoices);
+		SFM_ASSERT(index >= 0 && index < int(m_voiceCapacity));
 
 		Voice &voice = m_voices[index];
 		SFM_ASSERT(false == voice.IsIdle());
@@ -240,6 +494,7 @@ namespace SFM
 
 		// Flag as stolen
 		voice.m_state = Voice::kStolen;
+		++m_telemetryBlock.steals;
 		
 		// Initiate fade out
 		const float curGlobalAmp = voice.m_globalAmp.Get();
@@ -254,12 +509,14 @@ namespace SFM
 			FreeKey(key);
 			voice.m_key = -1;
 
-			Log("Voice stolen: " + std::to_string(index) + " for key: " + std::to_string(key));
+			SFM_LOG("Voice stolen: {} for key: {}", index, key);
 		}
 		else
-			Log("Voice stolen (not bound to key): " + std::to_string(index));
+			SFM_LOG("Voice stolen (not bound to key): {}", index);
 	}
 
+	// NoteOn() & NoteOff() follow the patch's voice mode, which might not be in effect yet: the switch is made by
+	// the next Render() (see UpdateVoicesPreRender()), which keeps the requests issued for the new mode
 	void Bison::NoteOn(unsigned key, float frequency, float velocity, unsigned timeStamp)
 	{
 		const bool monophonic = Patch::VoiceMode::kMono == m_patch.voiceMode;
@@ -271,7 +528,8 @@ namespace SFM
 		for (const auto &request : m_polyVoiceReq)
 			if (request.key == key)
 			{
-				Log("Duplicate NoteOn() for key: " + std::to_string(key));
+				SFM_LOG("Duplicate NoteOn() for key: {}", key);
+				++m_telemetryBlock.duplicateNoteOns;
 				return;
 			}
 
@@ -279,7 +537,7 @@ namespace SFM
 		request.key            = key;
 		request.frequency      = frequency;
 		request.velocity       = velocity;
-		request.timeStamp      = timeStamp;
+		request.timeStamp      = ToInternalTimeStamp(timeStamp);
 		
 		const int index = GetVoice(key);
 
@@ -300,12 +558,17 @@ namespace SFM
 					if (false == voice.IsStolen())
 						StealVoice(index);
 
-					Log("NoteOn() retrigger: " + std::to_string(key) + ", voice: " + std::to_string(index));
+					SFM_LOG("NoteOn() retrigger: {}, voice: {}", key, index);
 				}
 			}
 
+			// Switch from monophonic pending? Then it's the polyphony it's going to be
+			const unsigned polyphony = (Patch::VoiceMode::kMono == m_curVoiceMode)
+				? std::min(m_patch.maxPolyVoices, m_voiceCapacity)
+				: m_curPolyphony;
+
 			// Issue request
-			if (m_polyVoiceReq.size() < m_curPolyphony)
+			if (m_polyVoiceReq.size() < polyphony)
 			{
 				m_polyVoiceReq.push_back(request);
 			}
@@ -314,25 +577,27 @@ namespace SFM
 				// Replace last request (FIXME: honour time stamp?)
 				m_polyVoiceReq.pop_back();
 				m_polyVoiceReq.push_back(request);
+
+				++m_telemetryBlock.droppedRequests;
 			}
 		}
 		else
 		{
 			/* Monophonic */
 
-			SFM_ASSERT(1 == m_curPolyphony);
+			SFM_ASSERT(1 == m_curPolyphony || Patch::VoiceMode::kMono != m_curVoiceMode);
 
-			Log("NoteOn() monophonic, key: " + std::to_string(key));
+			SFM_LOG("NoteOn() monophonic, key: {}", key);
 
 			if (false == m_monoVoiceReq.MonoIsValid() || request.timeStamp <= m_monoVoiceReq.timeStamp)
 			{
 				m_monoVoiceReq = request;
 
-				Log("Monophonic: is audible request");
+				SFM_LOG("Monophonic: is audible request");
 			}
 
 			// Always add requests to sequence
-			m_monoSequence.emplace_front(request);
+			m_monoSequence.insert(m_monoSequence.begin(), request);
 		}
 	}
 
@@ -346,7 +611,7 @@ namespace SFM
 		for (auto request : m_polyVoiceReleaseReq)
 			if (request == key)
 			{
-				Log("Duplicate NoteOff() for key: " + std::to_string(key));
+				SFM_LOG("Duplicate NoteOff() for key: {}", key);
 				return;
 			}
 
@@ -369,7 +634,7 @@ namespace SFM
 					// Erase and break since NoteOn() ensures there are no duplicates in the deque
 					m_polyVoiceReq.erase(iReq);
 
-					Log("Deferred NoteOn() removed due to matching NOTE_OFF for key: " + std::to_string(key));
+					SFM_LOG("Deferred NoteOn() removed due to matching NOTE_OFF for key: {}", key);
 
 					break;
 				}
@@ -379,9 +644,10 @@ namespace SFM
 		{
 			/* Monophonic */
 
-			Log("NoteOff() monophonic, key: " + std::to_string(key));
+			SFM_LOG("NoteOff() monophonic, key: {}", key);
 
-			const int index = GetVoice(key);
+			// Switch from polyphonic pending? Then the key's voice is going to be stolen anyway
+			const int index = (Patch::VoiceMode::kMono == m_curVoiceMode) ? GetVoice(key) : -1;
 			if (index >= 0)
 			{
 				SFM_ASSERT(0 == index);
@@ -390,9 +656,9 @@ namespace SFM
 				if (m_voices[index].IsPlaying())
 				{
 					m_monoVoiceReleaseReq.key = key;
-					m_monoVoiceReleaseReq.timeStamp = timeStamp;
+					m_monoVoiceReleaseReq.timeStamp = ToInternalTimeStamp(timeStamp);
 
-					Log("Monophonic: is release request of playing note");
+					SFM_LOG("Monophonic: is release request of playing note");
 				}
 			}
 			
@@ -403,7 +669,7 @@ namespace SFM
 				{
 					m_monoSequence.erase(iReq);
 
-					Log("Monophonic: key removed from sequence");
+					SFM_LOG("Monophonic: key removed from sequence");
 
 					break;
 				}
@@ -417,126 +683,35 @@ namespace SFM
 
 	 ------------------------------------------------------------------------------------------------------ */
 
-	// Calc. operator frequency
-	static float CalcOpFreq(float fundamentalFreq, float detuneOffs, const PatchOperators::Operator &patchOp)
+	// Operator frequency, level, filters & envelope key tracking come from the note table if it's current (see
+	// UpdateNoteTable()), otherwise they're calculated on the spot; the result is the same
+	SFM_INLINE static float GetOpFreq(const NoteTable *pTable, unsigned iOp, float fundamentalFreq, float detuneOffs, const PatchOperators::Operator &patchOp)
 	{
-		float frequency;
-		if (true == patchOp.fixed)
-		{
-			frequency = (float) patchOp.coarse;
-			SFM_ASSERT(frequency >= 0.f && frequency <= kMaxFixedHz);
-
-			// Fixed requency does not necessarily have to be below Nyquist
-			// Ratio, fine and detune controls are disabled in VST UI
-		}
-		else
-		{
-			frequency = fundamentalFreq;
-
-			const int   coarse = patchOp.coarse;              // Ratio
-			const int     fine = patchOp.fine;                // Semitones
-			const float detune = patchOp.detune + detuneOffs; // Cents
-
-			SFM_ASSERT(coarse >= kCoarseMin && coarse <= kCoarseMax);
-			SFM_ASSERT(abs(fine) <= kFineRange);
-			SFM_ASSERT(abs(detune) <= kDetuneRange);
-			
-			frequency *= powf(2.f, (detune*0.01f)/12.f);
-
-			if (coarse < 0)
-				frequency /= abs(coarse-1);
-			else if (coarse > 1)
-				frequency *= coarse;
-			
-			frequency *= powf(2.f, fine/12.f);
-		}
-
-		return frequency;
+		return (nullptr != pTable)
+			? pTable->GetOpFreq(iOp, fundamentalFreq, detuneOffs)
+			: NoteTable::CalcOpFreq(fundamentalFreq, detuneOffs, patchOp);
 	}
 
-	// Calc. multiplier for operator amplitude or modulation index
-	static float CalcOpLevel(unsigned key, float velocity, const PatchOperators::Operator &patchOp)
+	SFM_INLINE static float GetOpLevel(const NoteTable *pTable, unsigned iOp, unsigned key, float velocity, const PatchOperators::Operator &patchOp)
 	{
-		float multiplier = 1.f;
-
-		// Factor in velocity
-		const float velPow = velocity*velocity;
-		multiplier = lerpf<float>(multiplier, multiplier*velPow, patchOp.velSens);
-		
-		// Apply L/R breakpoint cut & level scaling (subtractive/additive & linear/exponential, like the DX7)
-		const unsigned breakpoint = patchOp.levelScaleBP;
-
-		if (true == patchOp.cutLeftOfLSBP && true == patchOp.cutRightOfLSBP)
-		{
-			// Range cut
-			const unsigned sides = 127-breakpoint;
-
-			unsigned left = sides/2;
-			const unsigned remainder = left % 12;
-			left += 12-remainder; // Align right to high C note
-
-			const unsigned right = left+breakpoint;
-			
-			if (key < left || key > right)
-				multiplier = 0.f;
-		}
-		else if (true == patchOp.cutLeftOfLSBP && key < breakpoint)
-			// Cut left
-			multiplier = 0.f;
-		else if (true == patchOp.cutRightOfLSBP && key > breakpoint)
-			// Cut right
-			multiplier = 0.f;
-		
-		// We didn't cut, so apply level scaling as usual
-		if (0.f != multiplier)
-		{
-			// Apply level scaling
-			const unsigned numSemis = patchOp.levelScaleRange;
-			if (0 != numSemis)
-			{
-				const bool keyIsLeftOfBP  = key < breakpoint;
-				const bool keyIsRightOfBP = key > breakpoint;
-
-				const float levelStep = 1.f/numSemis;
-
-				int distance = 0;
-				float amount = 0.f;
-				bool isExponential = false;
-
-				if (true == keyIsLeftOfBP)
-				{
-					distance = breakpoint-key;
-					amount = patchOp.levelScaleL;
-					isExponential = patchOp.levelScaleExpL;
-				}
-				else if (true == keyIsRightOfBP)
-				{
-					distance = key-breakpoint;
-					amount = patchOp.levelScaleR;
-					isExponential = patchOp.levelScaleExpR;
-				}
-
-				// Calculate normalized distance from BP
-				distance = std::min<int>(numSemis, abs(distance));
-				const float linear = smoothstepf(distance*levelStep); // This (smoothstep) takes the edges off, results in a smoother glide
-				const float factor = false == isExponential ? linear : powf(linear, 1.f-linear) /* -EXP/+EXP */;
-
-				if (amount < 0.f)
-					// Fade out by gradually interpolating towards lower level
-					multiplier = lerpf<float>(multiplier, multiplier*(1.f-fabsf(amount)), factor);
-				else if (amount > 0.f)
-					// Fade in by adding to set level
-					multiplier = lerpf<float>(multiplier, std::min<float>(1.f, multiplier+fabsf(amount)), factor);
+		return (nullptr != pTable)
+			? pTable->GetOpLevel(iOp, key, velocity, patchOp.velSens)
+			: NoteTable::CalcOpLevel(key, velocity, patchOp);
+	}
 
-				// Subtractive as well as additive scaling leave the multiplier (output) on the other side
-				// of the breakpoint intact; this makes it intuitive to use this feature (I think)
-			}
-		}
+	SFM_INLINE static void SetOperatorFilters(const NoteTable *pTable, unsigned iOp, unsigned key, unsigned sampleRate, Biquad &filter, SvfLinearTrapOptimised2 &modFilter, const PatchOperators::Operator &patchOp)
+	{
+		if (nullptr != pTable)
+			pTable->SetOperatorFilters(iOp, key, filter, modFilter);
+		else
+			NoteTable::SetOperatorFilters(key, sampleRate, filter, modFilter, patchOp);
+	}
 
-		SFM_ASSERT(multiplier >= 0.f && multiplier <= 1.f);
-		
-		// Return level multiplier!
-		return multiplier;
+	SFM_INLINE static float GetKeyTracking(const NoteTable *pTable, unsigned iOp, unsigned key, const PatchOperators::Operator &patchOp)
+	{
+		return (nullptr != pTable)
+			? pTable->GetKeyTracking(iOp, key)
+			: NoteTable::CalcKeyTracking(key, patchOp);
 	}
 
 	// Simply scales [-1..1] to [0.5..0.5]
@@ -547,124 +722,23 @@ namespace SFM
 	}
 
 
-	SFM_INLINE static float CalcPhaseJitter(float jitter)
+	SFM_INLINE static float CalcPhaseJitter(float jitter, RandomStream &random)
 	{
 		SFM_ASSERT(jitter >= 0.f && jitter <= 1.f);
-		return jitter*mt_randf()*0.25f; // [0..90] deg.
+		return jitter*random.NextFloat()*0.25f; // [0..90] deg.
 	}
 
-	SFM_INLINE static float CalcPhaseShift(const Voice::Operator &voiceOp, const PatchOperators::Operator &patchOp)
+	SFM_INLINE static float CalcPhaseShift(Voice::Operator &voiceOp, const PatchOperators::Operator &patchOp, RandomStream &random)
 	{
 		float shift = 0.f;
 		if (false == patchOp.keySync)
 		{
-			shift = voiceOp.oscillator.GetPhase() * mt_randf(); // FIXME: keep phase running or at least have global ones for each operator
+			shift = voiceOp.oscillator.GetPhase() * random.NextFloat(); // FIXME: keep phase running or at least have global ones for each operator
 		}
 
 		return shift;
 	}
 
-	// Returns [-1..1]
-	SFM_INLINE static float CalcOpCutoffKeyTracking(unsigned key, float cutoffKeyTrack)
-	{
-		SFM_ASSERT(key >= 0 && key <= 127);
-		const float normalizedKey = key/127.f;
-
-		/* const */ float tracking = cutoffKeyTrack;
-		SFM_ASSERT_BINORM(tracking);
-
-		return tracking*normalizedKey;
-	}
-
-	// Set up (static) operator filter
-	static void SetOperatorFilters(unsigned key, unsigned sampleRate, Biquad &filter, SvfLinearTrapOptimised2 &modFilter, const PatchOperators::Operator &patchOp)
-	{
-		SFM_ASSERT(sampleRate > 0);
-
-		const unsigned Nyquist = sampleRate/2;
-
-//		filter.resetState();    //
-//		filter.reset();         // <- Shouldn't be necessary, as we always initialize it or set it to 'bq_type_none'
-		modFilter.resetState(); //
-		
-		const float normQ = patchOp.resonance;
-		
-		// Calculate keytracking (only for LPF & HPF)
-		float tracking = -1.f, cutoffNormFrom = -1.f, cutoffNormTo = -1.f;
-		
-		if (PatchOperators::Operator::kLowpassFilter == patchOp.filterType || PatchOperators::Operator::kHighpassFilter == patchOp.filterType)
-		{
-			const float cutoffKeyTrack = patchOp.cutoffKeyTrack;
-			tracking = CalcOpCutoffKeyTracking(key, cutoffKeyTrack);
-
-			cutoffNormFrom = patchOp.cutoff;
-			cutoffNormTo = (tracking >= 0.f) ? 1.f : 0.f;
-		
-			tracking = fabsf(tracking);
-		}
-		
-		float cutoffNorm = -1.f; // Causes assertion if not set for kLowpassFilter/kHighpassFilter
-		const float biQ = 0.01f + 9.99f*normQ; // See Biquad.h
-		switch (patchOp.filterType)
-		{
-		default:
-			SFM_ASSERT(false);
-
-		case PatchOperators::Operator::kNoFilter:
-			filter.setBiquad(bq_type_none, 0.f, 0.f, 0.f);
-			break;
-
-		case PatchOperators::Operator::kLowpassFilter:
-			cutoffNorm = lerpf<float>(cutoffNormFrom, cutoffNormTo, tracking); // Keytrack
-			filter.setBiquad(bq_type_lowpass, BQ_CutoffToHz(cutoffNorm, Nyquist)/sampleRate, biQ, 0.f);
-			break;
-
-		case PatchOperators::Operator::kHighpassFilter:
-			cutoffNorm = lerpf<float>(cutoffNormFrom, 1.f-cutoffNormTo, tracking); // Keytrack
-			filter.setBiquad(bq_type_highpass, BQ_CutoffToHz(cutoffNorm, Nyquist)/sampleRate, biQ, 0.f);
-			break;
-
-		// FIXME: why not track the next ones too?
-		case PatchOperators::Operator::kBandpassFilter:
-			filter.setBiquad(bq_type_bandpass, BQ_CutoffToHz(patchOp.cutoff, Nyquist)/sampleRate, biQ, 0.f);
-			break;
-
-		case PatchOperators::Operator::kPeakFilter:
-			SFM_ASSERT(patchOp.peakdB >= kMinOpFilterPeakdB && patchOp.peakdB <= kMaxOpFilterPeakdB);
-			filter.setBiquad(bq_type_peak, BQ_CutoffToHz(patchOp.cutoff, Nyquist)/sampleRate, biQ, patchOp.peakdB);
-			break;
-		}
-		
-		switch (patchOp.waveform)
-		{
-			// These waveforms shall remain unaltered
-			case Oscillator::kSine:
-			case Oscillator::kCosine:
-			case Oscillator::kPolyTriangle:
-			case Oscillator::kSupersaw: // Checked and it's not necessary (though at first I assumed it would be)
-				modFilter.updateNone();
-				break;
-			
-			// Filter the remaining waveforms a little to "take the top off"
-			default:
-				modFilter.updateLowpassCoeff(SVF_CutoffToHz(kModulatorLP, Nyquist), kSVFLowestFilterQ, sampleRate);
-				break;
-		}
-	}
-	
-	// Calc. tracking (linear or 'acoustically curved')
-	SFM_INLINE static float CalcKeyTracking(unsigned key, const PatchOperators::Operator &patchOp)
-	{
-		SFM_ASSERT(key >= 0 && key <= 127);
-		const float normalizedKey = key/127.f;
-
-		SFM_ASSERT(patchOp.envKeyTrack >= 0.f && patchOp.envKeyTrack <= 1.f);
-		
-		return (false == patchOp.acousticEnvKeyTrack)
-			? 1.f - 0.9f*patchOp.envKeyTrack*normalizedKey
-			: AcousticTrackingCurve(normalizedKey, patchOp.envKeyTrack); // See impl. for details
-	}
-
 	// Calc. LFO frequencies
 	SFM_INLINE static void CalcLFOFreq(float &frequency /* Set to base freq. */, float &modFrequency, int speedAdj)
 	{
@@ -675,16 +749,23 @@ namespace SFM
 		modFrequency = frequency*freqSpeedAdj;
 	}
 
+	// Gives voice a fresh random stream (reproducible, one per note) and hands it to it's oscillators
+	void Bison::SeedVoice(Voice &voice)
+	{
+		voice.m_random.Seed(m_randomSeed, m_nextVoiceStream++);
+		voice.BindOscillatorState();
+	}
+
 	// Initializes LFOs (used on top of Voice::Sample())
 	void Bison::InitializeLFOs(Voice &voice, float jitter)
 	{
 		// Calc. shift
 		float phaseShift = (true == m_patch.LFOKeySync)
 			? 0.f // Synchronized 
-			: m_globalLFO->Get(); // Free running
+			: m_globalLFO->Get(m_sampleClock); // Free running
 
 		// Add jitter
-		phaseShift += CalcPhaseJitter(jitter);
+		phaseShift += CalcPhaseJitter(jitter, voice.m_random);
 		
 		// Frequencies
 		float frequency = m_globalLFO->GetFrequency(), modFrequency;
@@ -721,17 +802,20 @@ namespace SFM
 		const float jitter = m_patch.jitter;     // Jitter
 		const float velocity = request.velocity; // Velocity
 
-		// Store key & velocity immediately (used by CalcOpLevel())
+		// Store key & velocity immediately
 		voice.m_key = key;
 		voice.m_velocity = velocity;
 
+		// Seed before anything random happens
+		SeedVoice(voice);
+
 		// Get fundamental freq. (using JUCE-supplied freq. for now)
 		float fundamentalFreq = (-1.f == request.frequency)
 			? float(g_MIDIToFreqLUT[key])
 			: request.frequency;
 
 		// Note frequency jitter
-		const float noteJitter = jitter*mt_randfc()*kMaxNoteJitter;
+		const float noteJitter = jitter*voice.m_random.NextFloatBipolar()*kMaxNoteJitter;
 		fundamentalFreq *= powf(2.f, (noteJitter*0.01f)/12.f);
 
 		voice.m_fundamentalFreq = fundamentalFreq;
@@ -750,11 +834,16 @@ namespace SFM
 		// harder and the decay phase will be longer
 		const float envAcousticScaling = 1.f + (velocity*velocity)*m_patch.acousticScaling;
 
+		// No current note table means the operators below are calculated on the spot (see UpdateNoteTable())
+		if (nullptr == m_noteTable)
+			++m_telemetryBlock.noteTableFallbacks;
+
 		// Set up voice operators
 		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
 		{
 			const PatchOperators::Operator &patchOp = patchOps.operators[iOp];
 			Voice::Operator &voiceOp = voice.m_operators[iOp];
+			Voice::OperatorSetup &opSetup = voice.m_operatorSetup[iOp];
 
 			voiceOp.enabled   = patchOp.enabled;
 			voiceOp.isCarrier = patchOp.isCarrier;
@@ -767,19 +856,20 @@ namespace SFM
 				const float opVelocity = (false == patchOp.velocityInvert) ? velocity : 1.f-velocity;
 
 				// (Re)set constant/static filters
-				SetOperatorFilters(key, m_sampleRate, voiceOp.filter, voiceOp.modFilter, patchOp);
+				SetOperatorFilters(m_noteTable, iOp, key, m_sampleRate, voiceOp.filter, voiceOp.modFilter, patchOp);
 				
 				// Store detune jitter
-				voiceOp.detuneOffs = jitter*mt_randfc()*patchOp.detune*kMaxDetuneJitter;
+				opSetup.detuneOffs = jitter*voice.m_random.NextFloatBipolar()*patchOp.detune*kMaxDetuneJitter;
 	
-				const float frequency = CalcOpFreq(fundamentalFreq, voiceOp.detuneOffs, patchOp);
+				const float frequency = GetOpFreq(m_noteTable, iOp, fundamentalFreq, opSetup.detuneOffs, patchOp);
 				
 				// Get amplitude & index
-				const float level = CalcOpLevel(key, opVelocity, patchOp);
+				const float level = GetOpLevel(m_noteTable, iOp, key, opVelocity, patchOp);
 				const float amplitude = patchOp.output*level, index = patchOp.index*level;
 
+				voiceOp.oscillator.SetRenderMode(m_patch.oscRenderMode);
 				voiceOp.oscillator.Initialize(
-					patchOp.waveform, frequency, m_sampleRate, CalcPhaseShift(voiceOp, patchOp), patchOp.supersawDetune, patchOp.supersawMix);
+					patchOp.waveform, frequency, m_sampleRate, CalcPhaseShift(voiceOp, patchOp, voice.m_random), patchOp.supersawDetune, patchOp.supersawMix, m_sampleClock);
 
 				// Set supersaw parameters for interpolation
 				voiceOp.supersawDetune.SetRate(m_sampleRate, kDefParameterLatency);
@@ -799,21 +889,21 @@ namespace SFM
 				// No interpolation
 				voiceOp.curFreq.SetRate(m_sampleRate, kDefPolyFreqGlide);
 				voiceOp.curFreq.Set(frequency);
-				voiceOp.setFrequency = frequency;
+				opSetup.setFrequency = frequency;
 
 				// Envelope key tracking
-				const float envKeyTracking = CalcKeyTracking(key, patchOp);
+				const float envKeyTracking = GetKeyTracking(m_noteTable, iOp, key, patchOp);
 				
 				// Start envelope
 				voiceOp.envelope.Start(patchOp.envParams, m_sampleRate, patchOp.isCarrier, envKeyTracking, envAcousticScaling); 
 
 				// Modulation sources
-				voiceOp.modulators[0] = patchOp.modulators[0];
-				voiceOp.modulators[1] = patchOp.modulators[1];
-				voiceOp.modulators[2] = patchOp.modulators[2];
+				voiceOp.modulators[0] = int8_t(patchOp.modulators[0]);
+				voiceOp.modulators[1] = int8_t(patchOp.modulators[1]);
+				voiceOp.modulators[2] = int8_t(patchOp.modulators[2]);
 
 				// Feedback
-				voiceOp.iFeedback   = patchOp.feedback;
+				voiceOp.iFeedback   = int8_t(patchOp.feedback);
 				voiceOp.feedbackAmt = { patchOp.feedbackAmt, m_sampleRate, kDefParameterLatency };
 				voiceOp.feedback    = 0.f;
 				
@@ -841,6 +931,9 @@ namespace SFM
 		voice.m_pitchBendRange = m_patch.pitchBendRange;
 		voice.m_pitchEnvelope.Start(m_patch.pitchEnvParams, m_sampleRate);
 
+		// Limit operator frequency (internal rate only)
+		voice.m_maxOpFreq = m_maxOpFreq;
+
 		// Voice is now playing
 		voice.m_state = Voice::kPlaying;
 		++m_voiceCount;
@@ -873,17 +966,21 @@ namespace SFM
 
 		const float velocity = request.velocity;
 
-		// Store key & velocity immediately (used by CalcOpLevel())
+		// Store key & velocity immediately
 		voice.m_key = key;
 		voice.m_velocity = velocity;
 
+		// New stream if (re)triggered, otherwise keep drawing from the current one
+		if (true == reset)
+			SeedVoice(voice);
+
 		// Get fundamental freq. (using JUCE-supplied freq. for now)
 		float fundamentalFreq = (-1.f == request.frequency)
 			? float(g_MIDIToFreqLUT[key])
 			: request.frequency;
 
 		// Note frequency jitter
-		const float noteJitter = jitter * (-1.f + mt_randf()*2.f);
+		const float noteJitter = jitter * voice.m_random.NextFloatBipolar();
 		fundamentalFreq *= powf(2.f, (noteJitter*kMaxNoteJitter*0.01f)/12.f);
 
 		voice.m_fundamentalFreq = fundamentalFreq;
@@ -905,11 +1002,16 @@ namespace SFM
 		float glideAtt = 1.f - m_patch.monoAtt*request.velocity;
 		voice.m_freqGlide = monoGlide*glideAtt;
 
+		// No current note table means the operators below are calculated on the spot (see UpdateNoteTable())
+		if (nullptr == m_noteTable)
+			++m_telemetryBlock.noteTableFallbacks;
+
 		// Set up voice operators
 		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
 		{
 			const PatchOperators::Operator &patchOp = patchOps.operators[iOp];
 			Voice::Operator &voiceOp = voice.m_operators[iOp];
+			Voice::OperatorSetup &opSetup = voice.m_operatorSetup[iOp];
 
 			voiceOp.enabled   = patchOp.enabled;
 			voiceOp.isCarrier = patchOp.isCarrier;
@@ -924,22 +1026,23 @@ namespace SFM
 				if (true == reset)
 				{
 					// (Re)set constant/static filters
-					SetOperatorFilters(key, m_sampleRate, voiceOp.filter, voiceOp.modFilter, patchOp);
+					SetOperatorFilters(m_noteTable, iOp, key, m_sampleRate, voiceOp.filter, voiceOp.modFilter, patchOp);
 				}
 
 				// Store detune jitter
-				voiceOp.detuneOffs = jitter*mt_randfc()*patchOp.detune*kMaxDetuneJitter;
+				opSetup.detuneOffs = jitter*voice.m_random.NextFloatBipolar()*patchOp.detune*kMaxDetuneJitter;
 				
-				const float frequency = CalcOpFreq(fundamentalFreq, voiceOp.detuneOffs, patchOp);
+				const float frequency = GetOpFreq(m_noteTable, iOp, fundamentalFreq, opSetup.detuneOffs, patchOp);
 
 				// Get amplitude & index
-				const float level = CalcOpLevel(key, opVelocity, patchOp);
+				const float level = GetOpLevel(m_noteTable, iOp, key, opVelocity, patchOp);
 				const float amplitude = patchOp.output*level, index = patchOp.index*level;
 
 				if (true == reset)
 				{
+					voiceOp.oscillator.SetRenderMode(m_patch.oscRenderMode);
 					voiceOp.oscillator.Initialize(
-						patchOp.waveform, frequency, m_sampleRate, CalcPhaseShift(voiceOp, patchOp), patchOp.supersawDetune, patchOp.supersawMix);
+						patchOp.waveform, frequency, m_sampleRate, CalcPhaseShift(voiceOp, patchOp, voice.m_random), patchOp.supersawDetune, patchOp.supersawMix, m_sampleClock);
 
 					// Set supersaw parameters for interpolation
 					voiceOp.supersawDetune.SetRate(m_sampleRate, kDefParameterLatency);
@@ -960,7 +1063,7 @@ namespace SFM
 					voiceOp.curFreq.SetRate(m_sampleRate, voice.m_freqGlide);
 					voiceOp.curFreq.Set(frequency);
 
-					const float envKeyTracking = CalcKeyTracking(key, patchOp);
+					const float envKeyTracking = GetKeyTracking(m_noteTable, iOp, key, patchOp);
 					voiceOp.envelope.Start(patchOp.envParams, m_sampleRate, patchOp.isCarrier, envKeyTracking, envAcousticScaling); 
 				}
 				else
@@ -979,15 +1082,15 @@ namespace SFM
 					voiceOp.curFreq.SetTarget(frequency);
 				}
 
-				voiceOp.setFrequency = frequency;
+				opSetup.setFrequency = frequency;
 
 				// Modulation sources
-				voiceOp.modulators[0] = patchOp.modulators[0];
-				voiceOp.modulators[1] = patchOp.modulators[1];
-				voiceOp.modulators[2] = patchOp.modulators[2];
+				voiceOp.modulators[0] = int8_t(patchOp.modulators[0]);
+				voiceOp.modulators[1] = int8_t(patchOp.modulators[1]);
+				voiceOp.modulators[2] = int8_t(patchOp.modulators[2]);
 
 				// Feedback
-				voiceOp.iFeedback   = patchOp.feedback;
+				voiceOp.iFeedback   = int8_t(patchOp.feedback);
 				voiceOp.feedbackAmt = { patchOp.feedbackAmt, m_sampleRate, kDefParameterLatency };
 				voiceOp.feedback    = 0.f;
 				
@@ -1018,6 +1121,9 @@ namespace SFM
 			voice.m_pitchEnvelope.Start(m_patch.pitchEnvParams, m_sampleRate);
 		}
 
+		// Limit operator frequency (internal rate only)
+		voice.m_maxOpFreq = m_maxOpFreq;
+
 		// Voice is now playing
 		voice.m_state = Voice::kPlaying;
 		++m_voiceCount;
@@ -1039,6 +1145,8 @@ namespace SFM
 	// Prepare voices for Render() pass
 	void Bison::UpdateVoicesPreRender()
 	{
+		SFM_PROFILE_SCOPE(kProfileVoicesPreRender);
+
 		m_modeSwitch = m_curVoiceMode != m_patch.voiceMode;
 		const bool monophonic = Patch::VoiceMode::kMono == m_curVoiceMode;
 
@@ -1049,13 +1157,13 @@ namespace SFM
 		if (true == m_modeSwitch || true == m_resetVoices)
 		{
 			if (true == m_modeSwitch)
-				Log("Voice mode switch (stealing voices)");
+				SFM_LOG("Voice mode switch (stealing voices)");
 
 			if (true == m_resetVoices)
-				Log("Asked to reset all voices");
+				SFM_LOG("Asked to reset all voices");
 
 			// Steal *all* active voices
-			for (unsigned iVoice = 0; iVoice < kMaxPolyVoices; ++iVoice)
+			for (unsigned iVoice = 0; iVoice < m_voiceCapacity; ++iVoice)
 			{
 				Voice &voice = m_voices[iVoice];
 				
@@ -1063,22 +1171,29 @@ namespace SFM
 				{
 					StealVoice(iVoice);
 
-					Log("Voice mode switch / Voice reset, stealing voice: " + std::to_string(iVoice));
+					SFM_LOG("Voice mode switch / Voice reset, stealing voice: {}", iVoice);
 				}
 			}
 
-			m_polyVoiceReq.clear();
+			m_telemetryBlock.voiceReset = true;
+
+			// Requests issued for polyphonic mode after switching to it are kept (see NoteOn()), unless asked to reset
+			const bool toPolyphonic = true == m_modeSwitch && Patch::VoiceMode::kPoly == m_patch.voiceMode;
+			if (false == toPolyphonic || true == m_resetVoices)
+			{
+				m_telemetryBlock.droppedRequests += unsigned(m_polyVoiceReq.size());
+				m_polyVoiceReq.clear();
+			}
+
 			m_polyVoiceReleaseReq.clear();
 
-			// Set voice mode state
+			// Set voice mode state & polyphony (see RenderEngine())
 			m_curVoiceMode = m_patch.voiceMode;
+			m_curPolyphony = (Patch::VoiceMode::kMono == m_curVoiceMode) ? 1 : std::min(m_patch.maxPolyVoices, m_voiceCapacity);
 
-			// Monophonic?
+			// Was monophonic?
 			if (true == monophonic)
 			{
-				// Set polyphony
-				m_curPolyphony = 1;
-
 				// Clear state
 				m_monoSequence.clear();
 				m_monoVoiceReq.key = VoiceRequest::kInvalid;
@@ -1097,7 +1212,8 @@ namespace SFM
 		{
 			/* Polyphonic */
 
-			std::deque<VoiceReleaseRequest> remainder;
+			// Requests for sustained voices are kept (compacted in place)
+			size_t numRemaining = 0;
 		
 			for (auto key : m_polyVoiceReleaseReq)
 			{
@@ -1120,12 +1236,12 @@ namespace SFM
 					else
 					{
 						// Voice is sustained, defer request
-						remainder.emplace_back(key);
+						m_polyVoiceReleaseReq[numRemaining++] = key;
 					}
 				}
 			}
 
-			m_polyVoiceReleaseReq = remainder;
+			m_polyVoiceReleaseReq.resize(numRemaining);
 		}
 
 		/*
@@ -1164,13 +1280,8 @@ namespace SFM
 
 			if (remainingRequests > 0)
 			{
-				struct VoiceRef
-				{
-					unsigned iVoice;
-					float summedOutput;
-				};
-
-				std::vector<VoiceRef> voiceRefs;
+				auto &voiceRefs = m_voicesToSteal;
+				voiceRefs.clear();
 
 				for (unsigned iVoice = 0; iVoice < m_curPolyphony; ++iVoice)
 				{
@@ -1201,7 +1312,7 @@ namespace SFM
 					// Steal voice
 					const unsigned iVoice = voiceRef.iVoice;
 					StealVoice(iVoice);
-					Log("Voice stolen (index): " + std::to_string(iVoice));
+					SFM_LOG("Voice stolen (index): {}", iVoice);
 					
 					if (--remainingRequests == 0)
 						break;
@@ -1210,13 +1321,15 @@ namespace SFM
 				if (remainingRequests != 0)
 				{
 					// FIXME: I think it's a viable strategy to drop the remaining requests?
-					Log("Could not steal enough voices: " + std::to_string(remainingRequests) + " remaining.");
+					SFM_LOG("Could not steal enough voices: {} remaining.", remainingRequests);
 				}
 			}
 
 			// Now first in line to be allocated next frame
 			for (auto &request : m_polyVoiceReq)
 				request.timeStamp = 0;
+
+			m_telemetryBlock.deferredRequests = unsigned(m_polyVoiceReq.size());
 		}
 
 		/*
@@ -1249,7 +1362,7 @@ namespace SFM
 
 						fromSequence = true;
 
-						Log("Monophonic: trigger previous note in sequence: " + std::to_string(m_monoVoiceReq.key));
+						SFM_LOG("Monophonic: trigger previous note in sequence: {}", m_monoVoiceReq.key);
 					}
 				}
 				else
@@ -1257,7 +1370,7 @@ namespace SFM
 					// Sequence fell silent
 					m_monoSequence.clear();
 
-					Log("Monophonic: sequence fell silent, erased request(s)");
+					SFM_LOG("Monophonic: sequence fell silent, erased request(s)");
 				}
 			}
 
@@ -1285,9 +1398,9 @@ namespace SFM
 				// Copy and quickly fade if it's releasing
 				if (false == voice.IsIdle() && true == voice.IsReleasing())
 				{
-					m_voices[1] = m_voices[0]; // Copy
-					m_voices[1].m_key = -1;    // Unbind
-					StealVoice(1);             // Steal
+					m_voices[1].CopyFrom(m_voices[0]); // Copy (voice 0 is reseeded below)
+					m_voices[1].m_key = -1;            // Unbind
+					StealVoice(1);                     // Steal
 				}
 				
 				// Free up slot immediately
@@ -1349,9 +1462,13 @@ namespace SFM
 							// - Most of these are updated in this loop
 							// - The set of parameters (also outside of this object) isn't conclusive and may vary depending on the use of FM. BISON (currently: VST plug-in)
 
+							if (nullptr == m_noteTable)
+								++m_telemetryBlock.noteTableFallbacks;
+
 							for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
 							{
 								auto &voiceOp = voice.m_operators[iOp];
+								auto &opSetup = voice.m_operatorSetup[iOp];
 
 								// Update per-sample interpolated parameters
 								if (true == voiceOp.enabled)
@@ -1361,17 +1478,17 @@ namespace SFM
 
 									// Get velocity & frequency
 									const float opVelocity = (false == patchOp.velocityInvert) ? voice.m_velocity : 1.f-voice.m_velocity;
-									const float frequency = CalcOpFreq(fundamentalFreq, voiceOp.detuneOffs, patchOp);
+									const float frequency = GetOpFreq(m_noteTable, iOp, fundamentalFreq, opSetup.detuneOffs, patchOp);
 
 									// Get amplitude & index
-									const float level = CalcOpLevel(voice.m_key, opVelocity, patchOp);
+									const float level = GetOpLevel(m_noteTable, iOp, voice.m_key, opVelocity, patchOp);
 									const float amplitude = patchOp.output*level, index = patchOp.index*level;
 								
 									// Interpolate freq. if necessary
-									if (frequency != voiceOp.setFrequency)
+									if (frequency != opSetup.setFrequency)
 									{
 										voiceOp.curFreq.SetTarget(frequency);
-										voiceOp.setFrequency = frequency;
+										opSetup.setFrequency = frequency;
 									}
 
 									// Set amplitude & index
@@ -1408,8 +1525,10 @@ namespace SFM
 	// Update voices after Render() pass
 	void Bison::UpdateVoicesPostRender()
 	{
+		SFM_PROFILE_SCOPE(kProfileVoicesPostRender);
+
 		// Free (stolen) voices
-		for (unsigned iVoice = 0; iVoice < kMaxPolyVoices /* Evaluate all! */; ++iVoice)
+		for (unsigned iVoice = 0; iVoice < m_voiceCapacity /* Evaluate all! */; ++iVoice)
 		{
 			Voice &voice = m_voices[iVoice];
 
@@ -1461,7 +1580,7 @@ namespace SFM
 					if (true == voice.IsPlaying() && false == voice.IsSustained())
 					{
 						voice.m_sustained = true;
-						Log("Voice sustained (synth.): " + std::to_string(iVoice));
+						SFM_LOG("Voice sustained (synth.): {}", iVoice);
 					}
 				}
 			}
@@ -1474,7 +1593,7 @@ namespace SFM
 					if (true == voice.IsPlaying() && true == voice.IsSustained())
 					{
 						voice.m_sustained = false;
-						Log("Voice no longer sustained (synth.): " + std::to_string(iVoice));
+						SFM_LOG("Voice no longer sustained (synth.): {}", iVoice);
 					}
 				}
 			}
@@ -1507,7 +1626,7 @@ namespace SFM
 								voiceOp.envelope.OnPianoSustain(pedalFalloff, pedalReleaseMul);
 							}
 
-						Log("Voice sustained (CP): " + std::to_string(iVoice));
+						SFM_LOG("Voice sustained (CP): {}", iVoice);
 					}
 				}
 			}
@@ -1520,7 +1639,7 @@ namespace SFM
 					if (false == voice.IsIdle() && true == voice.IsSustained())
 					{
 						voice.m_sustained = false;
-						Log("Voice no longer sustained (CP): " + std::to_string(iVoice));
+						SFM_LOG("Voice no longer sustained (CP): {}", iVoice);
 					}
 				}
 			}
@@ -1543,18 +1662,91 @@ namespace SFM
 	{
 		SFM_ASSERT(nullptr != pInst);
 		SFM_ASSERT(nullptr != pContext);
-		pInst->RenderVoices(pContext->parameters, pContext->voiceIndices, pContext->numSamples, pContext->pDestL, pContext->pDestR);
+		pInst->RenderVoices(pContext->parameters, pContext->pVoiceIndices, pContext->numVoices, pContext->numSamples, pContext->pDestL, pContext->pDestR, pContext->pLFOs);
+	}
+
+	/* static */ void Bison::VoiceRenderJob(void *pInst, void *pContext)
+	{
+		VoiceRenderThread(reinterpret_cast<Bison *>(pInst), reinterpret_cast<VoiceThreadContext *>(pContext));
+	}
+
+	// Splits voices (m_voicesToRender) up into jobs for m_pJobPool, the first of which is done right here; each job renders
+	// to it's own buffers, these are mixed in a fixed order, so the result doesn't depend on who did what
+	void Bison::RenderVoiceJobs(const VoiceRenderParameters &parameters, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != m_pJobPool);
+
+		const unsigned numVoices = unsigned(m_voicesToRender.size());
+		const unsigned numJobs = std::min(kMaxVoiceJobs, (numVoices+kMaxVoicesPerJob-1)/kMaxVoicesPerJob);
+		SFM_ASSERT(numJobs > 1);
+
+		static_assert(4 == kMaxVoiceJobs);
+		VoiceThreadContext contexts[kMaxVoiceJobs] = { parameters, parameters, parameters, parameters };
+		Job jobs[kMaxVoiceJobs];
+		JobGroup group;
+
+		unsigned iVoice = 0;
+		for (unsigned iJob = 0; iJob < numJobs; ++iJob)
+		{
+			// Spread evenly
+			const unsigned numJobVoices = (numVoices-iVoice)/(numJobs-iJob);
+
+			VoiceThreadContext &context = contexts[iJob];
+			context.pVoiceIndices = m_voicesToRender.data() + iVoice;
+			context.numVoices = numJobVoices;
+			context.numSamples = numSamples;
+			context.pDestL = m_pJobBufL[iJob];
+			context.pDestR = m_pJobBufR[iJob];
+			context.pLFOs = m_pJobLFOs[iJob];
+
+			iVoice += numJobVoices;
+
+			if (iJob > 0)
+			{
+				memset(context.pDestL, 0, numSamples*sizeof(float));
+				memset(context.pDestR, 0, numSamples*sizeof(float));
+
+				Job &job = jobs[iJob];
+				job.function = VoiceRenderJob;
+				job.pInstance = this;
+				job.pData = &context;
+
+				m_pJobPool->Push(job, group);
+			}
+		}
+
+		SFM_ASSERT(iVoice == numVoices);
+
+		VoiceRenderThread(this, &contexts[0]); // Process our part (m_pBufL[0] & m_pBufR[0])
+		m_pJobPool->Wait(group);               // Help out until the rest is done
+
+		for (unsigned iJob = 1; iJob < numJobs; ++iJob)
+		{
+			const float *pJobL = m_pJobBufL[iJob];
+			const float *pJobR = m_pJobBufR[iJob];
+
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				m_pBufL[0][iSample] += pJobL[iSample];
+				m_pBufR[0][iSample] += pJobR[iSample];
+			}
+		}
 	}
 
 	// Renders a set of voices
 	// - Stick to variables supplied through a context *or* make very sure you read only!
 	// - Assumes that each voice is active
-	void Bison::RenderVoices(const VoiceRenderParameters &context, const std::vector<unsigned> &voiceIndices, unsigned numSamples, float *pDestL, float *pDestR) const
+	void Bison::RenderVoices(const VoiceRenderParameters &context, const unsigned *pVoiceIndices, unsigned numVoices, unsigned numSamples, float *pDestL, float *pDestR, float *pLFOs) const
 	{
 		SFM_ASSERT(nullptr != pDestL && nullptr != pDestR);
+		SFM_ASSERT(nullptr != pLFOs);
 
-		for (auto iVoice : voiceIndices)
+		for (unsigned iIndex = 0; iIndex < numVoices; ++iIndex)
 		{
+			const unsigned iVoice = pVoiceIndices[iIndex];
+
+			SFM_PROFILE_SCOPE(kProfileVoice);
+
 			Voice &voice = const_cast<Voice&>(m_voices[iVoice]);
 			SFM_ASSERT(false == voice.IsIdle());
 
@@ -1579,6 +1771,9 @@ namespace SFM
 				voice.m_globalAmp.Set(0.f);
 				voice.m_globalAmp.SetTarget(kVoiceGain);
 			}
+
+			// Render (most) LFOs ahead, at the frequencies above
+			voice.RenderLFOs(pLFOs, numSamples);
 	
 			if (true == context.resetFilter)
 			{
@@ -1678,7 +1873,7 @@ namespace SFM
 		SFM_ASSERT(nullptr != m_pBufL[0] && nullptr != m_pBufR[0]);
 		SFM_ASSERT(nullptr != m_pBufL[1] && nullptr != m_pBufR[1]);
 
-		if (numSamples > m_samplesPerBlock)
+		if (numSamples > m_hostSamplesPerBlock)
 		{
 			// According to JUCE's documentation this *can* occur, but I don't think it ever does (nor should)
 			SFM_ASSERT(false);
@@ -1690,14 +1885,201 @@ namespace SFM
 		DisableDenormals disableDEN;
 #endif
 
+		SFM_PROFILE_SCOPE(kProfileRender);
+
+		const auto start = std::chrono::steady_clock::now();
+
+		m_visualization.BeginBlock();
+
+		if (1 == m_internalRatio)
+		{
+			// Everything at host rate
+			RenderEngine(numSamples, bendWheel, modulation, aftertouch);
+
+			if (false == IsPipelined())
+			{
+				PostPassParameters parameters;
+				GetPostPassParameters(aftertouch, parameters);
+				ApplyPostPass(numSamples, parameters, m_pBufL[0], m_pBufR[0], pLeft, pRight);
+			}
+			else
+				RenderPipelined(numSamples, aftertouch, pLeft, pRight);
+
+			PublishVisualization(numSamples, pLeft, pRight);
+			PublishTelemetry(numSamples, start);
+			PublishLatency();
+
+			return;
+		}
+
+		SFM_ASSERT(nullptr != m_upsampler);
+		SFM_ASSERT(m_upBufCount < m_internalRatio);
+
+		// Render just enough (internal) samples to fill this block, the remainder is kept for the next call
+		const unsigned ratio = m_internalRatio;
+		const unsigned numInternal = (numSamples > m_upBufCount) ? (numSamples-m_upBufCount + ratio-1)/ratio : 0;
+		SFM_ASSERT(numInternal <= m_samplesPerBlock);
+
+		if (0 != numInternal)
+		{
+			RenderEngine(numInternal, bendWheel, modulation, aftertouch);
+
+			if (true == m_internalRateFX)
+			{
+				PostPassParameters parameters;
+				GetPostPassParameters(aftertouch, parameters);
+				ApplyPostPass(numInternal, parameters, m_pBufL[0], m_pBufR[0], m_pBufL[0], m_pBufR[0]);
+			}
+
+			m_upsampler->Apply(m_pBufL[0], m_pBufR[0], numInternal, m_pUpBufL+m_upBufCount, m_pUpBufR+m_upBufCount);
+		}
+
+		const unsigned numAvailable = m_upBufCount + numInternal*ratio;
+		SFM_ASSERT(numAvailable >= numSamples);
+
+		if (false == m_internalRateFX)
+		{
+			PostPassParameters parameters;
+			GetPostPassParameters(aftertouch, parameters);
+			ApplyPostPass(numSamples, parameters, m_pUpBufL, m_pUpBufR, pLeft, pRight);
+		}
+		else
+		{
+			memcpy(pLeft,  m_pUpBufL, numSamples*sizeof(float));
+			memcpy(pRight, m_pUpBufR, numSamples*sizeof(float));
+		}
+
+		// Move remainder to front
+		m_upBufCount = numAvailable-numSamples;
+		memmove(m_pUpBufL, m_pUpBufL+numSamples, m_upBufCount*sizeof(float));
+		memmove(m_pUpBufR, m_pUpBufR+numSamples, m_upBufCount*sizeof(float));
+
+		PublishVisualization(numSamples, pLeft, pRight);
+		PublishTelemetry(numSamples, start);
+		PublishLatency();
+	}
+
+	void Bison::PublishVisualization(unsigned numSamples, const float *pLeft, const float *pRight)
+	{
+		if (false == m_visualization.IsActive())
+			return;
+
+		m_visualization.Meter(kVisOutput, pLeft, pRight, numSamples);
+		m_visualization.Capture(pLeft, pRight, numSamples);
+
+		// PostPass belongs to the pipeline thread if it runs
+		if (true == IsPipelined())
+			m_visualization.GetFrame().compressorBite = m_pipelineCompressorBite;
+		else if (nullptr != m_postPass)
+			m_visualization.GetFrame().compressorBite = m_postPass->GetCompressorBite();
+
+		m_visualization.EndBlock();
+	}
+
+	void Bison::PublishTelemetry(unsigned numSamples, std::chrono::steady_clock::time_point start)
+	{
+		Telemetry &telemetry = m_telemetryBlock;
+
+		++telemetry.block;
+
+		// Count voices by state
+		telemetry.activeVoices = telemetry.releasingVoices = telemetry.stolenVoices = 0;
+		for (unsigned iVoice = 0; iVoice < m_voiceCapacity; ++iVoice)
+		{
+			const Voice &voice = m_voices[iVoice];
+
+			if (true == voice.IsIdle())
+				continue;
+
+			if (true == voice.IsStolen())
+				++telemetry.stolenVoices;
+			else if (true == voice.IsReleasing())
+				++telemetry.releasingVoices;
+			else
+				++telemetry.activeVoices;
+		}
+
+		telemetry.polyphony = m_curPolyphony;
+		telemetry.reqPolyphony = (Patch::VoiceMode::kMono == m_curVoiceMode) ? 1 : m_patch.maxPolyVoices;
+
+		// Load
+		const auto end = std::chrono::steady_clock::now();
+		telemetry.renderTimeUs = std::chrono::duration<float, std::micro>(end-start).count();
+		telemetry.budgetUs = 1e6f*numSamples/m_hostSampleRate;
+		telemetry.load = telemetry.renderTimeUs/telemetry.budgetUs;
+
+		if (telemetry.load > 1.f)
+			++telemetry.overruns;
+		else if (telemetry.load >= kTelemetryNearMissLoad)
+			++telemetry.nearMisses;
+
+		telemetry.peakLoad = std::max(telemetry.peakLoad, telemetry.load);
+
+		// Totals
+		telemetry.totalSteals += telemetry.steals;
+		telemetry.totalDeferred += telemetry.deferredRequests;
+		telemetry.totalDropped += telemetry.droppedRequests;
+		telemetry.totalDuplicateNoteOns += telemetry.duplicateNoteOns;
+		telemetry.totalNoteTableFallbacks += telemetry.noteTableFallbacks;
+
+		m_telemetry.Publish(telemetry);
+
+		// Start counting next block
+		telemetry.steals = 0;
+		telemetry.deferredRequests = 0;
+		telemetry.droppedRequests = 0;
+		telemetry.duplicateNoteOns = 0;
+		telemetry.noteTableFallbacks = 0;
+		telemetry.voiceReset = false;
+	}
+
+	void Bison::PublishLatency()
+	{
+		float latency = 0.f;
+
+		if (nullptr != m_postPass)
+		{
+			// PostPass belongs to the pipeline thread if it runs
+			const float postPassLatency = (true == IsPipelined()) ? m_pipelinePostPassLatency : m_postPass->GetLatency();
+
+			// Runs at internal rate?
+			const float ratio = (true == m_internalRateFX) ? float(m_internalRatio) : 1.f;
+			latency += postPassLatency*ratio;
+		}
+
+		if (nullptr != m_upsampler)
+		{
+			latency += m_upsampler->GetLatency();
+		}
+
+		if (true == IsPipelined())
+		{
+			latency += float(m_hostSamplesPerBlock);
+		}
+
+		// FIXME: more?
+
+		m_latency.store(int(latency), std::memory_order_relaxed);
+	}
+
+	void Bison::RenderEngine(unsigned numSamples, float bendWheel, float modulation, float aftertouch)
+	{
+		SFM_ASSERT(numSamples <= m_samplesPerBlock);
+
 		const bool monophonic = Patch::VoiceMode::kMono == m_curVoiceMode;
 
-		// Reset voices if polyphony changes
-		const unsigned maxVoices = (false == monophonic) ? m_patch.maxPolyVoices : 1;
+		// Voices are initialized & updated using it
+		UpdateNoteTable();
+
+		// Reset voices if polyphony changes (clamped to pool, see ReserveVoices())
+		const unsigned maxVoices = (false == monophonic) ? std::min(m_patch.maxPolyVoices, m_voiceCapacity) : 1;
 		if (m_curPolyphony != maxVoices)
 		{
 			m_resetVoices = true;
 			m_curPolyphony = maxVoices;
+
+			if (false == monophonic && maxVoices < m_patch.maxPolyVoices)
+				SFM_LOG("Polyphony clamped to voice pool: {} (patch asks for {})", maxVoices, m_patch.maxPolyVoices);
 		}
 
 		// Modulation override?
@@ -1708,7 +2090,7 @@ namespace SFM
 		}
 
 		// Calculate current BPM freq.
-		unsigned overrideDelayBit = 0;
+		m_overrideDelayBit = 0;
 		if (true == m_patch.beatSync && 0.f != m_BPM)
 		{
 			const float ratio = m_patch.beatSyncRatio; // Note ratio
@@ -1720,7 +2102,7 @@ namespace SFM
 			
 			// If can't fit delay within it's line, revert to manual setting
 			if (1.f/m_freqBPM >= kMainDelayInSec)
-				overrideDelayBit = kFlagOverrideDelay;
+				m_overrideDelayBit = kFlagOverrideDelay;
 		}
 		else
 			// None: interpret this as a cue to use user controlled rate(s)
@@ -1734,7 +2116,7 @@ namespace SFM
 		{
 			// Set LFO speed in (DX7) range
 			freqLFO = MIDI_To_DX7_LFO_Hz(m_patch.LFORate);
-			m_globalLFO->SetFrequency(freqLFO); // FIXME: LPF?
+			m_globalLFO->SetFrequency(freqLFO, m_sampleClock); // FIXME: LPF?
 		}
 		else
 		{
@@ -1743,13 +2125,13 @@ namespace SFM
 
 			if (false == m_resetPhaseBPM)
 			{
-				m_globalLFO->SetFrequency(freqLFO); // FIXME: LPF?
+				m_globalLFO->SetFrequency(freqLFO, m_sampleClock); // FIXME: LPF?
 			}
 			else
 			{
 				// Full reset; likely to be used when (re)starting a track
 				// This *must* be done prior to UpdateVoicesPreRender()
-				m_globalLFO->Initialize(freqLFO, m_sampleRate);
+				m_globalLFO->Initialize(freqLFO, m_sampleRate, m_sampleClock);
 
 				// FIXME: this is where one would reinitialize possible interpolation of LFO rate (removed along with ParameterSlew @ 1/11/2021)
 			}
@@ -1852,6 +2234,8 @@ namespace SFM
 
 		if (0 != numVoices)
 		{
+			SFM_PROFILE_SCOPE(kProfileRenderVoices);
+
 			// Swap 2 branches for multiplications later on
 			const float mainFilterAftertouch = (Patch::kMainFilter == m_patch.aftertouchMod) ? 1.f : 0.f;
 			const float modulationAftertouch = (Patch::kModulation == m_patch.aftertouchMod) ? 1.f : 0.f;
@@ -1865,13 +2249,21 @@ namespace SFM
 			parameters.mainFilterAftertouch = mainFilterAftertouch;
 
 			// Build array of voices to render
-			std::vector<unsigned> voiceIndices;
-			for (int iVoice = 0; iVoice < kMaxPolyVoices /* Actual voice count can be > m_curPolyphony */; ++iVoice)
+			auto &voiceIndices = m_voicesToRender;
+			voiceIndices.clear();
+
+			for (unsigned iVoice = 0; iVoice < m_voiceCapacity /* Actual voice count can be > m_curPolyphony */; ++iVoice)
 			{
 				if (false == m_voices[iVoice].IsIdle())
 					voiceIndices.push_back(iVoice);
 			}
 
+			if (nullptr != m_pJobPool && voiceIndices.size() > kMaxVoicesPerJob)
+			{
+				// Split them up into jobs for the (shared) pool
+				RenderVoiceJobs(parameters, numSamples);
+			}
+			else
 #if defined(SFM_DISABLE_VOICE_THREAD)
 			if (true)
 #else
@@ -1880,10 +2272,12 @@ namespace SFM
 			{
 				// Render all voices on current thread
 				VoiceThreadContext context(parameters);
-				context.voiceIndices = std::move(voiceIndices);
+				context.pVoiceIndices = voiceIndices.data();
+				context.numVoices = unsigned(voiceIndices.size());
 				context.numSamples = numSamples;
 				context.pDestL = m_pBufL[0];
 				context.pDestR = m_pBufR[0];
+				context.pLFOs = m_pJobLFOs[0];
 			
 				VoiceRenderThread(this, &context);
 			}
@@ -1897,9 +2291,11 @@ namespace SFM
 				VoiceThreadContext contexts[2] = { parameters, parameters };
 				
 				// Split voices up 50/50
-				const size_t half = voiceIndices.size() / 2;
-				contexts[0].voiceIndices = std::vector<unsigned>(voiceIndices.begin(), voiceIndices.begin() + half);
-				contexts[1].voiceIndices = std::vector<unsigned>(voiceIndices.begin() + half, voiceIndices.end());
+				const unsigned half = unsigned(voiceIndices.size()) / 2;
+				contexts[0].pVoiceIndices = voiceIndices.data();
+				contexts[0].numVoices = half;
+				contexts[1].pVoiceIndices = voiceIndices.data() + half;
+				contexts[1].numVoices = unsigned(voiceIndices.size()) - half;
 
 				contexts[0].numSamples = contexts[1].numSamples = numSamples;
 
@@ -1907,6 +2303,8 @@ namespace SFM
 				contexts[0].pDestR = m_pBufR[0];
 				contexts[1].pDestL = m_pBufL[1];
 				contexts[1].pDestR = m_pBufR[1];
+				contexts[0].pLFOs = m_pJobLFOs[0];
+				contexts[1].pLFOs = m_pJobLFOs[1];
 
 				std::thread thread(VoiceRenderThread, this, &contexts[1]);
 
@@ -1922,28 +2320,8 @@ namespace SFM
 			}
 		}
 
-		// Keep *all* supersaw oscillators running; I could move this loop to RenderVoices(), but that would clutter up the function a bit,
-		// and here it's easy to follow and easy to extend
-		// FIXME: review this (see Github issue: https://github.com/bipolaraudio/FM-BISON/issues/235)
-
-//		const bool monophonic = Patch::VoiceMode::kMono == m_patch.voiceMode;
-		for (auto &voice : m_voices)
-		{	
-			const bool isIdle = voice.IsIdle() && !monophonic;
-
-			for (auto &voiceOp : voice.m_operators)
-			{
-				// Only update if *not* in use
-				if (true == isIdle || false == voiceOp.enabled)
-				{
-					auto &saw = voiceOp.oscillator.GetSupersaw();
-					saw.Skip(numSamples);
-				}
-			}
-		}
-
-		// Advance global LFO phase (free running)
-		m_globalLFO->Skip(numSamples);
+		// Advance sample clock: free running phases (global LFO, supersaws) catch up with it when they're used
+		m_sampleClock += numSamples;
 				
 		// Update voice logic (post)
 		UpdateVoicesPostRender();
@@ -1951,77 +2329,6 @@ namespace SFM
 		// Update sustain state
 		UpdateSustain();
 
-		// Calc. post filter wetness
-		float postWet = m_patch.postWet;
-		if (Patch::kPostFilter == m_patch.aftertouchMod)
-			postWet = std::min<float>(1.f, postWet+aftertouchFiltered); // More pressure -> more wetness
-
-		// Apply post-processing (FIXME: pass structure?)
-		m_postPass->Apply(numSamples,
-			/* BPM sync. */
-			m_freqBPM, m_patch.syncOverride | overrideDelayBit,
-			/* Auto-wah (FIXME: use more ParameterSlew if necessary) */
-			m_patch.wahResonance,
-			m_patch.wahAttack,
-			m_patch.wahHold,
-			m_patch.wahRate,
-			m_patch.wahDrivedB,
-			m_patch.wahSpeak,
-			m_patch.wahSpeakVowel,
-			m_patch.wahSpeakVowelMod,
-			m_patch.wahSpeakGhost,
-			m_patch.wahSpeakCut,
-			m_patch.wahSpeakResonance,
-			m_patch.wahCut,
-			m_patch.wahWet * ( (Patch::kWahPedal == m_patch.sustainType) ? m_sustain : 1.f ), // FIXME: this ain't great, will probably be noisy without some sort of LPF
-			/* Chorus/Phaser */
-			m_patch.cpRate,
-			m_patch.cpWet,
-			false == m_patch.cpIsPhaser,
-			/* Delay */
-			m_patch.delayInSec,
-			m_patch.delayWet,
-			m_patch.delayDrivedB,
-			m_patch.delayFeedback,
-			m_patch.delayFeedbackCutoff,
-			m_patch.delayTapeWow,
-			/* MOOG-style 24dB filter + Tube distort */
-			m_patch.postCutoff,
-			m_patch.postResonance,
-			m_patch.postDrivedB,
-			postWet,
-			m_patch.tubeDistort,
-			m_patch.tubeDrive,
-			m_patch.tubeOffset,
-			m_patch.tubeTone,
-			m_patch.tubeToneReso,
-			/* Reverb */
-			m_patch.reverbWet,
-			m_patch.reverbRoomSize,
-			m_patch.reverbDampening,
-			m_patch.reverbWidth,
-			m_patch.reverbBassTuningdB,
-			m_patch.reverbTrebleTuningdB,
-			m_patch.reverbPreDelay,
-			/* Compressor */
-			m_patch.compThresholddB,
-			m_patch.compKneedB,
-			m_patch.compRatio,
-			m_patch.compGaindB,
-			m_patch.compAttack,
-			m_patch.compRelease,
-			m_patch.compLookahead,
-			m_patch.compAutoGain,
-			m_patch.compRMSToPeak,
-			/* Tuning (post-EQ) */
-			m_patch.bassTuningdB,
-			m_patch.trebleTuningdB,
-			m_patch.midTuningdB,
-			/* Master volume */
-			m_patch.masterVoldB,
-			/* Buffers */
-			m_pBufL[0], m_pBufR[0], pLeft, pRight);
-
 		// Of all these, copies were used per voice, so skip numSamples to keep up	
 		m_curLFOBlend.Skip(numSamples);
 		m_curLFOModDepth.Skip(numSamples);
@@ -2037,12 +2344,16 @@ namespace SFM
 		m_resetPhaseBPM = false;
 
 		//
-		// Primitive visualization aid(s)
+		// Visualization (if anyone's watching)
 		//
 
+		if (false == m_visualization.IsActive())
+			return;
+
+		m_visualization.Meter(kVisVoices, m_pBufL[0], m_pBufR[0], numSamples);
+
 		// Calculate peak ([0..1]) for each operator
-		for (float &peak : m_opPeaks)
-			peak = 0.f;
+		float *opPeaks = m_visualization.GetFrame().opPeaks;
 
 		if (numVoices > 0)
 		{
@@ -2061,8 +2372,8 @@ namespace SFM
 							const float curGain = voiceOp.envGain.Get();
 							
 							// New maximum?
-							if (curGain > m_opPeaks[iOp])
-								m_opPeaks[iOp] = curGain;
+							if (curGain > opPeaks[iOp])
+								opPeaks[iOp] = curGain;
 						}
 					}
 				}
@@ -2070,4 +2381,462 @@ namespace SFM
 		}
 	}
 
+	/* ----------------------------------------------------------------------------------------------------
+
+		PostPass & it's standby instance
+
+		ResetPostPass() only raises a flag; the worker thread picks it up, (re)builds the standby instance
+		in it's slot and marks it ready, after which ApplyPostPass() swaps it in (just a pointer) and runs
+		both for kPostPassFadeTime to crossfade, so the old one's tails won't just be cut off
+
+		The audio thread never takes the mutex, ownership of the standby slot is handed back and forth
+		using m_standbyState (see StandbyState)
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void Bison::WorkerTask(void *pInstance)
+	{
+		Bison *pInst = static_cast<Bison *>(pInstance);
+
+		std::lock_guard<std::mutex> lock(pInst->m_workerMutex);
+
+		if (kStandbyFree == pInst->m_standbyState.load(std::memory_order_acquire) && nullptr != pInst->m_postPass)
+		{
+			if (true == pInst->m_resetPostPass.exchange(false, std::memory_order_acq_rel))
+			{
+				const unsigned iStandby = pInst->m_activePostPass^1;
+				pInst->DestroyPostPass(iStandby);
+				pInst->CreatePostPass(iStandby);
+
+				pInst->m_standbyState.store(kStandbyReady, std::memory_order_release);
+			}
+		}
+
+		// See UpdateNoteTable()
+		if (kNoteTableRequested == pInst->m_noteTableState.load(std::memory_order_acquire))
+		{
+			pInst->m_noteTables[pInst->m_activeNoteTable^1]->Build(pInst->m_noteTableRequest);
+			pInst->m_noteTableState.store(kNoteTableReady, std::memory_order_release);
+		}
+	}
+
+	void Bison::SetWorker(BackgroundWorker *pWorker)
+	{
+		if (pWorker == m_pSharedWorker)
+			return;
+
+		// Attached to again by OnSetSamplingProperties()
+		DetachWorker();
+		m_pSharedWorker = pWorker;
+	}
+
+	void Bison::AttachWorker()
+	{
+		if (nullptr != m_pWorker.load(std::memory_order_acquire))
+			return;
+
+		BackgroundWorker *pWorker = m_pSharedWorker;
+		if (nullptr == pWorker)
+		{
+			m_ownWorker = std::make_unique<BackgroundWorker>();
+			pWorker = m_ownWorker.get();
+		}
+
+		pWorker->Add(WorkerTask, this);
+		m_pWorker.store(pWorker, std::memory_order_release);
+	}
+
+	void Bison::DetachWorker()
+	{
+		// Once Remove() returns the worker is done with this instance
+		BackgroundWorker *pWorker = m_pWorker.exchange(nullptr, std::memory_order_acq_rel);
+		if (nullptr != pWorker)
+			pWorker->Remove(this);
+
+		m_ownWorker.reset();
+	}
+
+	void Bison::SignalWorker()
+	{
+		BackgroundWorker *pWorker = m_pWorker.load(std::memory_order_acquire);
+		if (nullptr != pWorker)
+			pWorker->Signal();
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Note tables (see synth-note-table.h)
+
+		Same idea as PostPass' standby instance: the worker builds the standby table from a copy of the patch's
+		operators (m_noteTableRequest) and RenderEngine() swaps it in once it's ready and still current; in
+		between voices are initialized (and updated) the old-fashioned way, so nothing's ever late or wrong
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void Bison::UpdateNoteTable()
+	{
+		// See SetNoteTables()
+		if (false == m_noteTablesEnabled)
+			return;
+
+		const PatchOperators &patchOps = m_patch.operators;
+
+		if (nullptr != m_noteTable && true == m_noteTable->IsCurrent(patchOps))
+			return;
+
+		// Patch has moved on
+		m_noteTable = nullptr;
+
+		const unsigned state = m_noteTableState.load(std::memory_order_acquire);
+
+		if (kNoteTableReady == state && true == m_noteTables[m_activeNoteTable^1]->IsCurrent(patchOps))
+		{
+			// Swap in
+			m_activeNoteTable ^= 1;
+			m_noteTable = m_noteTables[m_activeNoteTable];
+
+			m_noteTableState.store(kNoteTableFree, std::memory_order_release);
+
+			return;
+		}
+
+		if (kNoteTableRequested != state)
+		{
+			// Free or built from parameters that have since changed: (re)request
+			m_noteTableRequest = patchOps;
+			m_noteTableState.store(kNoteTableRequested, std::memory_order_release);
+			SignalWorker();
+		}
+	}
+
+	void Bison::GetPostPassParameters(float aftertouch, PostPassParameters &parameters) const
+	{
+		// BPM sync.
+		parameters.rateBPM = m_freqBPM;
+		parameters.overrideFlagsRateBPM = m_patch.syncOverride | m_overrideDelayBit;
+
+		// Auto-wah (FIXME: use more ParameterSlew if necessary)
+		parameters.wahResonance = m_patch.wahResonance;
+		parameters.wahAttack = m_patch.wahAttack;
+		parameters.wahHold = m_patch.wahHold;
+		parameters.wahRate = m_patch.wahRate;
+		parameters.wahDrivedB = m_patch.wahDrivedB;
+		parameters.wahSpeak = m_patch.wahSpeak;
+		parameters.wahSpeakVowel = m_patch.wahSpeakVowel;
+		parameters.wahSpeakVowelMod = m_patch.wahSpeakVowelMod;
+		parameters.wahSpeakGhost = m_patch.wahSpeakGhost;
+		parameters.wahSpeakCut = m_patch.wahSpeakCut;
+		parameters.wahSpeakResonance = m_patch.wahSpeakResonance;
+		parameters.wahCut = m_patch.wahCut;
+		parameters.wahWet = m_patch.wahWet * ( (Patch::kWahPedal == m_patch.sustainType) ? m_sustain : 1.f ); // FIXME: this ain't great, will probably be noisy without some sort of LPF
+
+		// Chorus/Phaser
+		parameters.cpRate = m_patch.cpRate;
+		parameters.cpWet = m_patch.cpWet;
+		parameters.isChorus = false == m_patch.cpIsPhaser;
+
+		// Delay
+		parameters.delayInSec = m_patch.delayInSec;
+		parameters.delayWet = m_patch.delayWet;
+		parameters.delayDrivedB = m_patch.delayDrivedB;
+		parameters.delayFeedback = m_patch.delayFeedback;
+		parameters.delayFeedbackCutoff = m_patch.delayFeedbackCutoff;
+		parameters.delayTapeWow = m_patch.delayTapeWow;
+
+		// Calc. post filter wetness
+		float postWet = m_patch.postWet;
+		if (Patch::kPostFilter == m_patch.aftertouchMod)
+			postWet = std::min<float>(1.f, postWet+aftertouch); // More pressure -> more wetness
+
+		// MOOG-style 24dB filter + Tube distort
+		parameters.postCutoff = m_patch.postCutoff;
+		parameters.postResonance = m_patch.postResonance;
+		parameters.postDrivedB = m_patch.postDrivedB;
+		parameters.postWet = postWet;
+		parameters.postZDF = Patch::kZDFPostFilter == m_patch.postFilterType;
+		parameters.tubeDistort = m_patch.tubeDistort;
+		parameters.tubeDrive = m_patch.tubeDrive;
+		parameters.tubeOffset = m_patch.tubeOffset;
+		parameters.tubeTone = m_patch.tubeTone;
+		parameters.tubeToneReso = m_patch.tubeToneReso;
+
+		// Reverb
+		parameters.reverbWet = m_patch.reverbWet;
+		parameters.reverbRoomSize = m_patch.reverbRoomSize;
+		parameters.reverbDampening = m_patch.reverbDampening;
+		parameters.reverbWidth = m_patch.reverbWidth;
+		parameters.reverbBassTuningdB = m_patch.reverbBassTuningdB;
+		parameters.reverbTrebleTuningdB = m_patch.reverbTrebleTuningdB;
+		parameters.reverbPreDelay = m_patch.reverbPreDelay;
+
+		// Compressor
+		parameters.compThresholddB = m_patch.compThresholddB;
+		parameters.compKneedB = m_patch.compKneedB;
+		parameters.compRatio = m_patch.compRatio;
+		parameters.compGaindB = m_patch.compGaindB;
+		parameters.compAttack = m_patch.compAttack;
+		parameters.compRelease = m_patch.compRelease;
+		parameters.compLookahead = m_patch.compLookahead;
+		parameters.compAutoGain = m_patch.compAutoGain;
+		parameters.compRMSToPeak = m_patch.compRMSToPeak;
+
+		// Tuning (post-EQ) & master volume
+		parameters.bassTuningdB = m_patch.bassTuningdB;
+		parameters.trebleTuningdB = m_patch.trebleTuningdB;
+		parameters.midTuningdB = m_patch.midTuningdB;
+		parameters.masterVoldB = m_patch.masterVoldB;
+	}
+
+	void Bison::ApplyPostPass(unsigned numSamples, const PostPassParameters &parameters, const float *pLeftIn, const float *pRightIn, float *pLeftOut, float *pRightOut)
+	{
+		// Swap in standby instance?
+		if (nullptr == m_fadingPostPass && kStandbyReady == m_standbyState.load(std::memory_order_acquire))
+		{
+			m_fadingPostPass = m_postPass;
+			m_activePostPass ^= 1;
+			m_postPass = m_postPasses[m_activePostPass];
+			m_postPassFadePos = 0;
+
+			m_standbyState.store(kStandbyInUse, std::memory_order_release);
+		}
+
+		if (nullptr == m_fadingPostPass)
+		{
+			RunPostPass(*m_postPass, numSamples, parameters, pLeftIn, pRightIn, pLeftOut, pRightOut);
+			return;
+		}
+
+		// Outgoing instance first, input and output may be the same buffers
+		RunPostPass(*m_fadingPostPass, numSamples, parameters, pLeftIn, pRightIn, m_pPostFadeBufL, m_pPostFadeBufR);
+		RunPostPass(*m_postPass, numSamples, parameters, pLeftIn, pRightIn, pLeftOut, pRightOut);
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			const float fade = std::min<float>(1.f, float(m_postPassFadePos++)/m_postPassFadeSize);
+			pLeftOut[iSample]  = lerpf<float>(m_pPostFadeBufL[iSample], pLeftOut[iSample],  fade);
+			pRightOut[iSample] = lerpf<float>(m_pPostFadeBufR[iSample], pRightOut[iSample], fade);
+		}
+
+		if (m_postPassFadePos >= m_postPassFadeSize)
+		{
+			// Done: hand slot back to worker (which may have a reset waiting)
+			m_fadingPostPass = nullptr;
+			m_standbyState.store(kStandbyFree, std::memory_order_release);
+			SignalWorker();
+		}
+	}
+
+	void Bison::RunPostPass(PostPass &postPass, unsigned numSamples, const PostPassParameters &parameters, const float *pLeftIn, const float *pRightIn, float *pLeftOut, float *pRightOut)
+	{
+		// Visualization isn't ours to touch on the pipeline thread
+		postPass.SetVisualization((false == IsPipelined() && true == m_visualization.IsActive()) ? &m_visualization : nullptr);
+
+		// Apply post-processing
+		postPass.Apply(numSamples,
+			/* BPM sync. */
+			parameters.rateBPM, parameters.overrideFlagsRateBPM,
+			/* Auto-wah */
+			parameters.wahResonance,
+			parameters.wahAttack,
+			parameters.wahHold,
+			parameters.wahRate,
+			parameters.wahDrivedB,
+			parameters.wahSpeak,
+			parameters.wahSpeakVowel,
+			parameters.wahSpeakVowelMod,
+			parameters.wahSpeakGhost,
+			parameters.wahSpeakCut,
+			parameters.wahSpeakResonance,
+			parameters.wahCut,
+			parameters.wahWet,
+			/* Chorus/Phaser */
+			parameters.cpRate,
+			parameters.cpWet,
+			parameters.isChorus,
+			/* Delay */
+			parameters.delayInSec,
+			parameters.delayWet,
+			parameters.delayDrivedB,
+			parameters.delayFeedback,
+			parameters.delayFeedbackCutoff,
+			parameters.delayTapeWow,
+			/* MOOG-style 24dB filter + Tube distort */
+			parameters.postCutoff,
+			parameters.postResonance,
+			parameters.postDrivedB,
+			parameters.postWet,
+			parameters.postZDF,
+			parameters.tubeDistort,
+			parameters.tubeDrive,
+			parameters.tubeOffset,
+			parameters.tubeTone,
+			parameters.tubeToneReso,
+			/* Reverb */
+			parameters.reverbWet,
+			parameters.reverbRoomSize,
+			parameters.reverbDampening,
+			parameters.reverbWidth,
+			parameters.reverbBassTuningdB,
+			parameters.reverbTrebleTuningdB,
+			parameters.reverbPreDelay,
+			/* Compressor */
+			parameters.compThresholddB,
+			parameters.compKneedB,
+			parameters.compRatio,
+			parameters.compGaindB,
+			parameters.compAttack,
+			parameters.compRelease,
+			parameters.compLookahead,
+			parameters.compAutoGain,
+			parameters.compRMSToPeak,
+			/* Tuning (post-EQ) */
+			parameters.bassTuningdB,
+			parameters.trebleTuningdB,
+			parameters.midTuningdB,
+			/* Master volume */
+			parameters.masterVoldB,
+			/* Buffers */
+			pLeftIn, pRightIn, pLeftOut, pRightOut);
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Pipelined mode (see SetPipelined())
+
+		Render() renders block N's voices, copies them into a slot along with the PostPass parameters and
+		bumps m_pipelineSubmitted; the pipeline thread runs PostPass on it and bumps m_pipelineProcessed,
+		by which time Render() is (likely) busy with block N+1's voices
+
+		Output is delayed by exactly m_hostSamplesPerBlock samples: that's what it takes for Render() to
+		never have to wait for the block it just handed over, whatever the size of each block is (up to
+		m_hostSamplesPerBlock), so processed output of at most one block is kept around
+
+		Blocks aren't resized nor merged, so PostPass sees the exact same input as it would otherwise
+
+		Waiting (on either side) is done with std::atomic::wait() (a futex on Linux), which beats spinning
+		when either side takes a lot longer than the other
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void Bison::StartPipeline()
+	{
+		SFM_ASSERT(false == m_pipelineThread.joinable());
+
+		m_pipelineSubmitted.store(0);
+		m_pipelineProcessed.store(0);
+		m_pipelineCollected = 0;
+		m_pipelineOutCount = 0;
+		m_pipelineDelay = m_hostSamplesPerBlock;
+		m_pipelineCompressorBite = 0.f;
+		m_pipelinePostPassLatency = m_postPass->GetLatency();
+
+		m_stopPipeline.store(false);
+		m_pipelineThread = std::thread(PipelineThread, this);
+
+		SFM_LOG("Pipelined mode, latency: {} samples", m_hostSamplesPerBlock);
+	}
+
+	void Bison::StopPipeline()
+	{
+		if (false == m_pipelineThread.joinable())
+			return;
+
+		// Wake it up without a block to process
+		m_stopPipeline.store(true);
+		m_pipelineSubmitted.fetch_add(1, std::memory_order_release);
+		m_pipelineSubmitted.notify_one();
+
+		m_pipelineThread.join();
+	}
+
+	void Bison::PipelineThread(Bison *pInst)
+	{
+#if SFM_KILL_DENORMALS
+		// Per thread, and PostPass must see what it would on the audio thread
+		DisableDenormals disableDEN;
+#endif
+
+		unsigned iBlock = 0;
+
+		for (;;)
+		{
+			pInst->m_pipelineSubmitted.wait(iBlock, std::memory_order_acquire);
+
+			if (true == pInst->m_stopPipeline.load())
+				break;
+
+			PipelineSlot &slot = pInst->m_pipelineSlots[iBlock & (kPipelineSlots-1)];
+
+			pInst->ApplyPostPass(slot.numSamples, slot.parameters, slot.pInL, slot.pInR, slot.pOutL, slot.pOutR);
+			slot.compressorBite = pInst->m_postPass->GetCompressorBite();
+			slot.postPassLatency = pInst->m_postPass->GetLatency();
+
+			pInst->m_pipelineProcessed.store(++iBlock, std::memory_order_release);
+			pInst->m_pipelineProcessed.notify_one();
+		}
+	}
+
+	// Waits for the oldest block not collected yet and appends it's output to m_pPipelineOutL & m_pPipelineOutR
+	void Bison::CollectPipelineBlock()
+	{
+		const unsigned iBlock = m_pipelineCollected;
+		SFM_ASSERT(iBlock != m_pipelineSubmitted.load(std::memory_order_relaxed));
+
+		m_pipelineProcessed.wait(iBlock, std::memory_order_acquire);
+
+		const PipelineSlot &slot = m_pipelineSlots[iBlock & (kPipelineSlots-1)];
+		SFM_ASSERT(m_pipelineOutCount+slot.numSamples <= m_hostSamplesPerBlock);
+
+		memcpy(m_pPipelineOutL+m_pipelineOutCount, slot.pOutL, slot.numSamples*sizeof(float));
+		memcpy(m_pPipelineOutR+m_pipelineOutCount, slot.pOutR, slot.numSamples*sizeof(float));
+		m_pipelineOutCount += slot.numSamples;
+
+		m_pipelineCompressorBite = slot.compressorBite;
+		m_pipelinePostPassLatency = slot.postPassLatency;
+
+		++m_pipelineCollected;
+	}
+
+	void Bison::RenderPipelined(unsigned numSamples, float aftertouch, float *pLeft, float *pRight)
+	{
+		SFM_ASSERT(true == IsPipelined());
+
+		// Slot still in use?
+		const unsigned iBlock = m_pipelineSubmitted.load(std::memory_order_relaxed);
+		while (iBlock-m_pipelineCollected >= kPipelineSlots)
+			CollectPipelineBlock();
+
+		// Hand block over
+		PipelineSlot &slot = m_pipelineSlots[iBlock & (kPipelineSlots-1)];
+		memcpy(slot.pInL, m_pBufL[0], numSamples*sizeof(float));
+		memcpy(slot.pInR, m_pBufR[0], numSamples*sizeof(float));
+		slot.numSamples = numSamples;
+		GetPostPassParameters(aftertouch, slot.parameters);
+
+		m_pipelineSubmitted.store(iBlock+1, std::memory_order_release);
+		m_pipelineSubmitted.notify_one();
+
+		// Silence until the first block is through
+		const unsigned numSilent = std::min(numSamples, m_pipelineDelay);
+		if (0 != numSilent)
+		{
+			memset(pLeft,  0, numSilent*sizeof(float));
+			memset(pRight, 0, numSilent*sizeof(float));
+			m_pipelineDelay -= numSilent;
+		}
+
+		// Rest comes from earlier blocks only (see above)
+		const unsigned numOutput = numSamples-numSilent;
+		while (m_pipelineOutCount < numOutput)
+			CollectPipelineBlock();
+
+		memcpy(pLeft+numSilent,  m_pPipelineOutL, numOutput*sizeof(float));
+		memcpy(pRight+numSilent, m_pPipelineOutR, numOutput*sizeof(float));
+
+		// Move remainder to front
+		m_pipelineOutCount -= numOutput;
+		memmove(m_pPipelineOutL, m_pPipelineOutL+numOutput, m_pipelineOutCount*sizeof(float));
+		memmove(m_pPipelineOutR, m_pPipelineOutR+numOutput, m_pipelineOutCount*sizeof(float));
+	}
+
 }; // namespace SFM
@@ -29,7 +29,7 @@
 
 	- https://github.com/bipolaraudio/FM-BISON/issues
 	- Code is quite verbose and has not been optimized "to the bone" yet (we're still in R&D stage)
-	- Currently fitted to play nice with the JUCE framework, needs significant work to work with other platforms (especially embedded)
+	- Currently fitted to play nice with the JUCE framework (interface), but builds without it (see CMakeLists.txt)
 	- Synthesizer is stereo output *only*
 	- Parameters are, give or take a few, all interpolated per sample or accounted for in a fitting way
 	- 'SFM' is a legacy prefix & namespace name
@@ -42,7 +42,7 @@
 	- TinyMT Mersenne-Twister random generator by Makoto Matsumoto and Mutsuo Saito 
 	- Yamaha DX7 LFO rates (synth-DX7-LFO-table.h) taken from Sean Bolton's Hexter
 	- Fast cosine approximation supplied by Erik 'Kusma' Faye-Lund
-	- There are 2 dependencies on JUCE (currently these have little priority as we use JUCE for our product line)
+	- The envelope (3rdparty/JUCE/ADSR.h) is a modified version of JUCE's ADSR
 	- 'PolyBLEP'-based oscillators were lifted from https://github.com/martinfinke/PolyBLEP; by various authors (I keep a ref. copy in /3rdparty)
 	- I've ported a lot of interpolation functions from http://easings.net to single prec.
 	- *Big* thank you Adam Szabo for his thesis on the JP-8000 supersaw: https://pdfs.semanticscholar.org/1852/250068e864215dd7f12755cf00636868a251.pdf 
@@ -50,21 +50,24 @@
 
 	Most of these were modified and optimized by us
 
-	** Depends on JUCE 6.01 or later! **
+	Builds standalone (fmbison_core, see CMakeLists.txt); JUCE is only used for assertions & logging if SFM_JUCE_INTEROP is set
 	
 	Core goals:
 		- Yamaha DX7 style core FM tone generator with a plethora of extra features
 		- Subtractive synthesis (filters & effects) on top
 		- Goal: low CPU footprint in DAWs, possibly embedded targets in the future
 
-	This library is *not* thread-safe!
+	This library is *not* thread-safe! (Exceptions: GetTelemetry() and the consumer side of GetVisualization())
+	Separate instances can be constructed & used on different threads though; BisonRack (synth-rack.h) runs a few of
+	them as parts of one multi-timbral instrument on a shared job pool
  
 	Issues:
 		- I've spotted some potentially overzealous and inconsistent use of SFM_INLINE (29/05/2020)
 		- Class (object) design is somewhere between C and C++; this is because the project started out
 		  as a simple (C) experiment; I've also started to use more modern C++ features here and there, but 
 		  I'm not religious about it
-		- Performance needs to be analyzed closer, especially on OSX
+		- Performance needs to be analyzed closer, especially on OSX (bench_render, see bench/, is a start; for
+		  where Render() spends it's time build with SFM_PROFILE, see helper/synth-profile.h)
 
 	Optimal compiler parameters for Visual Studio (MSVC):
 		- /Ob2 /Oi /O2 /Ot
@@ -76,13 +79,25 @@
 #pragma once
 
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
 
 #include "synth-global.h"
 
 #include "patch/synth-patch-global.h"
 #include "synth-post-pass.h"
+#include "synth-resampler.h"
+#include "helper/synth-arena.h"
+#include "helper/synth-snapshot-buffer.h"
+#include "helper/synth-job-pool.h"
+#include "helper/synth-background-worker.h"
 #include "synth-phase.h"
 #include "synth-voice.h"
+#include "synth-note-table.h"
+#include "synth-telemetry.h"
+#include "synth-visualization.h"
 
 namespace SFM
 {
@@ -108,7 +123,11 @@ namespace SFM
 
 		// Called by JUCE's prepareToPlay()
 		// Will stop all voices, reinitialize necessary objects and (re)set globals (see synth-globals.h)
-		void OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock);
+		// 'internalRate'   - if non-zero the voice engine runs at the lowest integer fraction (1/2 or 1/4) of 'sampleRate'
+		//                    that is still at least this rate (say 44100 for 88.2/96/176.4/192KHz hosts) and is upsampled;
+		//                    operators (bent or not) are then kept just below it's Nyquist (see kInternalMaxOpPitch)
+		// 'internalRateFX' - run PostPass at the internal rate as well (cheaper, but it leans more on it's own oversampling)
+		void OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock, unsigned internalRate = 0, bool internalRateFX = false);
 
 		// Releases everything set by OnSetSamplingProperties()
 		void DeleteRateDependentObjects();
@@ -125,18 +144,69 @@ namespace SFM
 			m_resetVoices = true;
 		}
 
-		// This function can be called at any point whilst rendering
+		// This function can be called at any point whilst rendering (from any thread)
+		// A fresh instance is constructed by a worker thread, Render() then swaps it in and crossfades to it
 		void ResetPostPass()
 		{
-			if (nullptr != m_postPass)
-			{
-				// Create a new instance, that way we won't have to fiddle with details
-				// However, do *not* call this often while rendering
-				delete m_postPass;
-				m_postPass = new PostPass(m_sampleRate, m_samplesPerBlock, m_Nyquist);
-			}
+			m_resetPostPass.store(true, std::memory_order_release);
+			SignalWorker();
 		}
 		
+		// Deterministic mode: seeds all random streams (noise, S&H, supersaw phases, jitter, Vox) and restarts the
+		// sample clock, so the same patch & note events render the same output on every run
+		// Call before OnSetSamplingProperties() (which creates PostPass & resets voices), not whilst rendering
+		void SetSeed(uint64_t seed)
+		{
+			m_randomSeed = seed;
+			m_nextVoiceStream = kVoiceRandomStream;
+			m_sampleClock = 0;
+		}
+
+		uint64_t GetSeed() const { return m_randomSeed; }
+
+		// Pipelined mode (offline/freewheel rendering): PostPass processes a block on a thread of it's own whilst Render()
+		// renders the voices of the next one, which adds a block (GetSamplesPerBlock()) of latency (see GetLatency());
+		// output is that of normal rendering delayed by exactly that many samples
+		// - Only takes effect if the voice engine runs at host rate (no 'internalRate', see OnSetSamplingProperties())
+		// - PostPass stages aren't metered (see GetVisualization())
+		// Call before OnSetSamplingProperties() (which starts or stops the thread), not whilst rendering
+		void SetPipelined(bool pipelined)
+		{
+			m_pipelined = pipelined;
+		}
+
+		// Set *and* in effect
+		bool IsPipelined() const { return true == m_pipelineThread.joinable(); }
+
+		// Note tables (see synth-note-table.h) only speed up voice initialization & updates, output is identical without
+		// them, which 'fmbison-golden --check-note-tables' verifies; when off everything's calculated on the spot
+		// Call before OnSetSamplingProperties() (which builds the first one), not whilst rendering
+		void SetNoteTables(bool enabled)
+		{
+			m_noteTablesEnabled = enabled;
+		}
+
+		// Render voices as jobs on a pool (shared with other instances, see synth-rack.h) instead of on Render()'s thread
+		// only; nullptr to stop; call before OnSetSamplingProperties() (which allocates buffers for it), not whilst rendering
+		void SetJobPool(JobPool *pPool)
+		{
+			m_pJobPool = pPool;
+		}
+
+		// Have standby PostPass & note tables built by a worker shared with other instances (see synth-rack.h) instead
+		// of a thread of this instance's own; nullptr to go back to that; must outlive this instance (or be unset),
+		// call before OnSetSamplingProperties() (which attaches to it), not whilst rendering
+		void SetWorker(BackgroundWorker *pWorker);
+
+		// Leave delay and/or reverb ('sends' are PostPassSends) to send buses shared with other instances (see synth-rack.h):
+		// PostPass skips them and their wet parameters are the send levels; call before OnSetSamplingProperties()
+		void SetSends(unsigned sends)
+		{
+			m_sends = sends;
+		}
+
+		unsigned GetSends() const { return m_sends; }
+
 		// Render number of samples to 2 channels (stereo)
 		// 'bendWheel'  - amount of pitch bend (wheel) [-1..1]
 		// 'modulation' - amount of modulation (wheel)  [0..1]
@@ -150,7 +220,7 @@ namespace SFM
 
 			if (m_BPM != BPM)
 			{
-				Log("Host has set new BPM: " + std::to_string(BPM));
+				SFM_LOG("Host has set new BPM: {}", BPM);
 				m_BPM = BPM;
 			}
 		}
@@ -170,41 +240,42 @@ namespace SFM
 			m_sustain = state;
 		}
 
-		unsigned GetSampleRate() const      { return m_sampleRate;      }
-		unsigned GetSamplesPerBlock() const { return m_samplesPerBlock; }
-		unsigned GetNyquist() const         { return m_Nyquist;         }
+		unsigned GetSampleRate() const      { return m_hostSampleRate;      }
+		unsigned GetSamplesPerBlock() const { return m_hostSamplesPerBlock; }
+		unsigned GetNyquist() const         { return m_hostSampleRate>>1;   }
 
-		// Get synth. latency in samples
-		int GetLatency() const
-		{
-			float latency = 0.f;
+		// Rate the voice engine runs at (equal to GetSampleRate() unless an internal rate is used)
+		unsigned GetInternalSampleRate() const { return m_sampleRate; }
 
-			if (nullptr != m_postPass)
-			{
-				latency += m_postPass->GetLatency();
-			}
+		// Grows voice pool to hold at least 'numVoices' (only stops & resets all voices if it has to grow)
+		// OnSetSamplingProperties() reserves the patch's 'maxPolyVoices'; if you raise that later, call this first or
+		// polyphony is clamped to what's available (reported by GetTelemetry(), see 'reqPolyphony'); do *not* call
+		// this whilst Render() runs
+		// A voice takes sizeof(Voice) plus kNumOperators supersaw slots: 3992 + 6*272 bytes (g++ 12, x86-64)
+		void ReserveVoices(unsigned numVoices);
 
-			// FIXME: more?
+		unsigned GetVoiceCapacity() const { return m_voiceCapacity; }
 
-			return int(latency);
-		}
-		
-		// Value ([0..1]) can be used to visually represent compressor "bite" (when RMS falls below threshold dB)
-		// WARNING: not thread-safe!
-		float GetCompressorBite() const
+		// Voices in use (playing or releasing) as of the last Render()
+		unsigned GetVoiceCount() const { return m_voiceCount; }
+
+		// Voice pressure, steals, dropped requests & load as of the last Render(); can be called from any thread
+		void GetTelemetry(Telemetry &telemetry) const
 		{
-			if (nullptr != m_postPass)
-				return m_postPass->GetCompressorBite();
-			else
-				return 0.f;
+			m_telemetry.Read(telemetry);
 		}
 
-		// Value follows approx. peak (modulator-only will be normalized, which makes for a nicer view as 'index' values tend to be low!)
-		// WARNING: not thread-safe!
-		float GetOperatorPeak(unsigned iOp) const
+		// Get synth. latency in samples, as of the last Render() or OnSetSamplingProperties(); can be called from any thread
+		int GetLatency() const
+		{
+			return m_latency.load(std::memory_order_relaxed);
+		}
+		
+		// Operator peaks, compressor "bite", stage levels, scope & spectrum; use the consumer side of it
+		// (Attach(), Pop(), Detach()) from one thread, the UI for example (see synth-visualization.h)
+		Visualization &GetVisualization()
 		{
-			SFM_ASSERT(iOp < kNumOperators);
-			return m_opPeaks[iOp];
+			return m_visualization;
 		}
 		
 		//
@@ -259,7 +330,7 @@ namespace SFM
 		SFM_INLINE void SetKey(unsigned key, int index)
 		{
 			SFM_ASSERT(key <= 127);
-			SFM_ASSERT(index >= 0 && index < kMaxPolyVoices);
+			SFM_ASSERT(index >= 0 && index < int(m_voiceCapacity));
 
 			m_keyToVoice[key] = index;
 		}
@@ -269,6 +340,7 @@ namespace SFM
 		void StealVoice(int index);   // Steal voice
 		
 		// Used by Initialize(Mono)Voice()
+		void SeedVoice(Voice &voice);
 		void InitializeLFOs(Voice &voice, float jitter);
 
 		// Voice initalization
@@ -286,7 +358,7 @@ namespace SFM
 				InitializeVoice(request, iVoice);
 
 				// Done: pop it!
-				m_polyVoiceReq.pop_front();
+				m_polyVoiceReq.erase(m_polyVoiceReq.begin());
 			}
 			else
 			{
@@ -296,7 +368,7 @@ namespace SFM
 				InitializeMonoVoice(m_monoVoiceReq);
 			}
 			
-			Log("Voice triggered: " + std::to_string(iVoice) + ", key: " + std::to_string(m_voices[iVoice].m_key));
+			SFM_LOG("Voice triggered: {}, key: {}", iVoice, m_voices[iVoice].m_key);
 		}
 
 		// Called by Render()
@@ -327,25 +399,176 @@ namespace SFM
 
 			const VoiceRenderParameters &parameters;
 			
-			std::vector<unsigned> voiceIndices;
+			const unsigned *pVoiceIndices = nullptr;
+			unsigned numVoices = 0;
 
 			unsigned numSamples = 0;
 			float *pDestL = nullptr;
 			float *pDestR = nullptr;
+
+			// Scratch for Voice::RenderLFOs()
+			float *pLFOs = nullptr;
 		};
 
 		static void VoiceRenderThread(Bison *pInst, VoiceThreadContext *pContext);
-		void RenderVoices(const VoiceRenderParameters &context, const std::vector<unsigned> &voiceIndices, unsigned numSamples, float *pDestL, float *pDestR) const;
+		static void VoiceRenderJob(void *pInst, void *pContext);
+		void RenderVoiceJobs(const VoiceRenderParameters &parameters, unsigned numSamples);
+		void RenderVoices(const VoiceRenderParameters &context, const unsigned *pVoiceIndices, unsigned numVoices, unsigned numSamples, float *pDestL, float *pDestR, float *pLFOs) const;
+
+		// Does the actual work for DeleteRateDependentObjects() (expects m_workerMutex to be held)
+		void ReleaseRateDependentObjects();
+
+		// Voice pool: returns true if it had to grow (voices are default constructed, call ClearVoices())
+		bool GrowVoicePool(unsigned numVoices);
+		void ReleaseVoicePool();
+
+		// Stop & reset all voices, clear slots & wipe requests
+		void ClearVoices();
+
+		// Called by RenderEngine(): swaps in a freshly built note table, or asks the worker for one if the patch has moved on
+		void UpdateNoteTable();
+
+		// Called by Render(): renders voices (at internal rate) to m_pBufL[0] & m_pBufR[0]
+		void RenderEngine(unsigned numSamples, float bendWheel, float modulation, float aftertouch);
+
+		// What PostPass::Apply() takes besides buffers, taken from the patch (and RenderEngine()) after each block, so
+		// it can travel along with that block to the pipeline thread (see SetPipelined())
+		struct PostPassParameters
+		{
+			// BPM sync.
+			float rateBPM;
+			unsigned overrideFlagsRateBPM;
+
+			// Auto-wah
+			float wahResonance, wahAttack, wahHold, wahRate, wahDrivedB;
+			float wahSpeak, wahSpeakVowel, wahSpeakVowelMod, wahSpeakGhost, wahSpeakCut, wahSpeakResonance;
+			float wahCut, wahWet;
+
+			// Chorus/Phaser
+			float cpRate, cpWet;
+			bool isChorus;
+
+			// Delay
+			float delayInSec, delayWet, delayDrivedB, delayFeedback, delayFeedbackCutoff, delayTapeWow;
+
+			// MOOG-style 24dB filter + Tube distort
+			float postCutoff, postResonance, postDrivedB, postWet;
+			bool postZDF;
+			float tubeDistort, tubeDrive, tubeOffset, tubeTone;
+			bool tubeToneReso;
+
+			// Reverb
+			float reverbWet, reverbRoomSize, reverbDampening, reverbWidth, reverbBassTuningdB, reverbTrebleTuningdB, reverbPreDelay;
+
+			// Compressor
+			float compThresholddB, compKneedB, compRatio, compGaindB, compAttack, compRelease, compLookahead;
+			bool compAutoGain;
+			float compRMSToPeak;
+
+			// Tuning (post-EQ) & master volume
+			float bassTuningdB, trebleTuningdB, midTuningdB;
+			float masterVoldB;
+		};
+
+		void GetPostPassParameters(float aftertouch, PostPassParameters &parameters) const;
+
+		// Called by Render() (or the pipeline thread): applies PostPass (can be done in place), swaps in & crossfades to standby instance if one is ready
+		void ApplyPostPass(unsigned numSamples, const PostPassParameters &parameters, const float *pLeftIn, const float *pRightIn, float *pLeftOut, float *pRightOut);
+		void RunPostPass(PostPass &postPass, unsigned numSamples, const PostPassParameters &parameters, const float *pLeftIn, const float *pRightIn, float *pLeftOut, float *pRightOut);
+
+		// Pipelined mode (see SetPipelined()): RenderPipelined() hands the block in m_pBufL[0] & m_pBufR[0] to the pipeline
+		// thread and returns processed output from earlier blocks
+		void StartPipeline();
+		void StopPipeline();
+		void RenderPipelined(unsigned numSamples, float aftertouch, float *pLeft, float *pRight);
+		void CollectPipelineBlock();
+		static void PipelineThread(Bison *pInst);
+
+		// Builds standby PostPass (see ResetPostPass()) & note table (see UpdateNoteTable()) on request, on the worker's thread
+		static void WorkerTask(void *pInst);
+
+		// Worker (see SetWorker()): attach to the shared one or start one of our own, detach (and stop our own)
+		void AttachWorker();
+		void DetachWorker();
+
+		// Wakes up the worker (never blocks, so fine on the audio thread)
+		void SignalWorker();
+
+		// PostPass runs at internal rate if so requested, otherwise at host rate
+		unsigned GetPostPassSampleRate() const
+		{
+			return (1 == m_internalRatio || true == m_internalRateFX) ? m_sampleRate : m_hostSampleRate;
+		}
+
+		unsigned GetPostPassSamplesPerBlock() const
+		{
+			return (1 == m_internalRatio || true == m_internalRateFX) ? m_samplesPerBlock : m_hostSamplesPerBlock;
+		}
+
+		// Each PostPass slot has it's own part of the arena so it can be rewound and constructed again
+		void CreatePostPass(unsigned iSlot)
+		{
+			SFM_ASSERT(iSlot < 2 && nullptr == m_postPasses[iSlot]);
+
+			const unsigned sampleRate = GetPostPassSampleRate();
+
+			Arena &arena = m_postPassArenas[iSlot];
+			arena.Reset();
+
+			m_postPasses[iSlot] = new (arena.Allocate(sizeof(PostPass))) PostPass(arena, sampleRate, GetPostPassSamplesPerBlock(), sampleRate>>1, m_randomSeed);
+			m_postPasses[iSlot]->SetSends(m_sends);
+		}
+
+		void DestroyPostPass(unsigned iSlot)
+		{
+			SFM_ASSERT(iSlot < 2);
+
+			if (nullptr != m_postPasses[iSlot])
+			{
+				m_postPasses[iSlot]->~PostPass();
+				m_postPasses[iSlot] = nullptr;
+			}
+		}
+
+		// Translates host (Render()) timestamp to internal one
+		SFM_INLINE unsigned ToInternalTimeStamp(unsigned timeStamp) const
+		{
+			if (1 == m_internalRatio)
+				return timeStamp;
+
+			// Upsampled samples left over from last Render() call come first
+			return (timeStamp > m_upBufCount) ? (timeStamp-m_upBufCount)/m_internalRatio : 0;
+		}
 
 		/*
 			Variables.
 		*/
 
-		// Sample rate related (driven by JUCE)
-		unsigned m_sampleRate;
+		// Sample rate related (driven by JUCE); these are at internal rate, which equals host rate unless m_internalRatio > 1
+		unsigned m_sampleRate = 0;
 		unsigned m_Nyquist;
 		unsigned m_samplesPerBlock;
 
+		// Host rate & internal rate ratio (1, 2 or 4)
+		unsigned m_hostSampleRate = 0;
+		unsigned m_hostSamplesPerBlock = 0;
+		unsigned m_internalRatio = 1;
+		bool m_internalRateFX = false;
+
+		// Operator frequency limit (see Voice::m_maxOpFreq), only at internal rate: at host rate what's above Nyquist
+		// has always been left alone, at internal rate it would alias into what used to be ultrasonic
+		constexpr static float kInternalMaxOpPitch = 0.49f; // Fraction of internal rate
+		float m_maxOpFreq = 0.f;
+
+		// Upsampler (only if m_internalRatio > 1) & it's output, which may hold a few samples for the next Render() call
+		PolyphaseUpsampler *m_upsampler = nullptr;
+		float *m_pUpBufL = nullptr;
+		float *m_pUpBufR = nullptr;
+		unsigned m_upBufCount = 0;
+
+		// Set by RenderEngine(), used by ApplyPostPass()
+		unsigned m_overrideDelayBit = 0;
+
 		// Parameters (patch)
 		Patch m_patch;
 
@@ -357,20 +580,23 @@ namespace SFM
 		unsigned m_curPolyphony;
 
 		// Cur. voice mode
-		bool m_modeSwitch;
+		bool m_modeSwitch = false;
 		Patch::VoiceMode m_curVoiceMode;
 
+		// Request lists are vectors (front is oldest) with kMaxPolyVoices reserved, so Render() never (de)allocates;
+		// they're that short that erasing from the front doesn't matter
+
 		// Polyphonic requests
-		std::deque<VoiceRequest> m_polyVoiceReq;
-		std::deque<VoiceReleaseRequest> m_polyVoiceReleaseReq;
+		std::vector<VoiceRequest> m_polyVoiceReq;
+		std::vector<VoiceReleaseRequest> m_polyVoiceReleaseReq;
 
 		// Monophonic requests
-		std::deque<VoiceRequest> m_monoSequence;       // All pressed keys (including ones not triggered) are tracked
+		std::vector<VoiceRequest> m_monoSequence;      // All pressed keys (including ones not triggered) are tracked, latest first
 		VoiceRequest m_monoVoiceReq;                   // This frame's request; if 'key' is kInvalid, there is none
 		MonoVoiceReleaseRequest m_monoVoiceReleaseReq; // Same, but for, you guessed it, release
 
 		// Sustain?
-		bool m_sustain;
+		bool m_sustain = false;
 
 		// Per-sample interpolated global parameters
 		InterpolatedParameter<kLinInterpolate, true> m_curLFOBlend;
@@ -384,11 +610,88 @@ namespace SFM
 		InterpolatedParameter<kLinInterpolate, true> m_curModulation;           // [-1..1]
 		InterpolatedParameter<kLinInterpolate, true> m_curAftertouch;           //
 	
-		// Effects
-		PostPass *m_postPass = nullptr;
+		// Holds all rate-dependent buffers & objects (sized & laid out in OnSetSamplingProperties())
+		Arena m_arena;
+
+		// Effects: 2 slots (carved from m_arena), one active and one standby; the latter is (re)built by the worker thread
+		enum StandbyState
+		{
+			kStandbyFree,  // Not in use, can be (re)built
+			kStandbyReady, // Built, waiting for Render() to swap it in
+			kStandbyInUse  // Swapped in, old instance is being faded out
+		};
+
+		Arena m_postPassArenas[2];
+		PostPass *m_postPasses[2] = { nullptr, nullptr };
+		unsigned m_activePostPass = 0;
+		PostPass *m_postPass = nullptr;       // Active
+		PostPass *m_fadingPostPass = nullptr; // Outgoing (during crossfade)
+		unsigned m_postPassFadePos = 0;
+		unsigned m_postPassFadeSize = 0;
+		float *m_pPostFadeBufL = nullptr;
+		float *m_pPostFadeBufR = nullptr;
+
+		std::atomic<bool> m_resetPostPass = false;
+		std::atomic<unsigned> m_standbyState = kStandbyFree;
+
+		BackgroundWorker *m_pSharedWorker = nullptr;    // See SetWorker()
+		std::unique_ptr<BackgroundWorker> m_ownWorker;  // Only if there's no shared one
+		std::atomic<BackgroundWorker *> m_pWorker = nullptr; // The one attached to, if any (see AttachWorker())
+		std::mutex m_workerMutex; // Held by worker while building, and by OnSetSamplingProperties() & DeleteRateDependentObjects()
+
+		// Note tables: 2 slots (carved from m_arena) like PostPass; m_noteTable is the active one as long as it's current,
+		// nullptr otherwise (voices are then initialized without it), the worker builds the other from m_noteTableRequest
+		enum NoteTableState
+		{
+			kNoteTableFree,      // Not in use, can be requested
+			kNoteTableRequested, // Being built by the worker thread
+			kNoteTableReady      // Built, waiting for RenderEngine() to swap it in
+		};
+
+		NoteTable *m_noteTables[2] = { nullptr, nullptr };
+		unsigned m_activeNoteTable = 0;
+		const NoteTable *m_noteTable = nullptr;
+		bool m_noteTablesEnabled = true; // See SetNoteTables()
+		PatchOperators m_noteTableRequest;
+		std::atomic<unsigned> m_noteTableState = kNoteTableFree;
+
+		// Pipelined mode: blocks go round a ring of slots (buffers carved from m_arena); two counters hand them to the
+		// pipeline thread and back, the thread owns all PostPass state whilst it runs, neither side ever takes a lock
+		constexpr static unsigned kPipelineSlots = 4; // Power of 2 (counters wrap)
+
+		struct PipelineSlot
+		{
+			float *pInL = nullptr, *pInR = nullptr;
+			float *pOutL = nullptr, *pOutR = nullptr;
+			unsigned numSamples = 0;
+			PostPassParameters parameters;
+			float compressorBite = 0.f;
+			float postPassLatency = 0.f;
+		};
+
+		bool m_pipelined = false;
+		PipelineSlot m_pipelineSlots[kPipelineSlots];
+		std::atomic<unsigned> m_pipelineSubmitted = 0; // Blocks handed to the thread (Render())
+		std::atomic<unsigned> m_pipelineProcessed = 0; // Blocks processed (thread)
+		unsigned m_pipelineCollected = 0;              // Blocks copied to m_pPipelineOutL & m_pPipelineOutR (Render())
+		float *m_pPipelineOutL = nullptr;              // Processed output not yet returned (at most a block)
+		float *m_pPipelineOutR = nullptr;              //
+		unsigned m_pipelineOutCount = 0;
+		unsigned m_pipelineDelay = 0;                  // Samples of silence left to return (latency)
+		float m_pipelineCompressorBite = 0.f;          // Of the last collected block
+		float m_pipelinePostPassLatency = 0.f;         //
+		std::thread m_pipelineThread;
+		std::atomic<bool> m_stopPipeline = false;
 
 		// Running LFO (used for no key sync.)
-		Phase *m_globalLFO = nullptr;
+		FreeRunningPhase *m_globalLFO = nullptr;
+
+		// Samples rendered (at internal rate), free running phases are stamped with it
+		uint64_t m_sampleClock = 0;
+
+		// Instance seed for all random streams; each voice gets a new stream when triggered (see SeedVoice())
+		uint64_t m_randomSeed = 0;
+		uint64_t m_nextVoiceStream = kVoiceRandomStream;
 
 		// Necessary to reset filter on type switch
 		SvfLinearTrapOptimised2::FLT_TYPE m_curFilterType; 
@@ -397,8 +700,31 @@ namespace SFM
 		float *m_pBufL[2] = { nullptr, nullptr };
 		float *m_pBufR[2] = { nullptr, nullptr };
 
-		alignas(16) Voice m_voices[kMaxPolyVoices];       // Array of voices to use
-		alignas(16) bool  m_voicesStolen[kMaxPolyVoices]; // Simple way to flag voices as stolen; contain related logic in FM_BISON.cpp
+		// Voice jobs (see SetJobPool()), each renders to a pair of buffers (the first 2 are the ones above)
+		constexpr static unsigned kMaxVoiceJobs = 4;
+
+		JobPool *m_pJobPool = nullptr;
+		float *m_pJobBufL[kMaxVoiceJobs] = { nullptr };
+		float *m_pJobBufR[kMaxVoiceJobs] = { nullptr };
+		float *m_pJobLFOs[kMaxVoiceJobs] = { nullptr }; // 3 LFOs (see Voice::RenderLFOs())
+
+		// See SetSends()
+		unsigned m_sends = 0;
+
+		// Voice pool (see ReserveVoices()), each voice starts on a cache line
+		Voice *m_voices = nullptr;
+		Supersaw *m_supersaws = nullptr; // kNumOperators per voice
+		unsigned m_voiceCapacity = 0;
+
+		// Scratch lists for Render(), kMaxPolyVoices reserved
+		struct VoiceRef
+		{
+			unsigned iVoice;
+			float summedOutput;
+		};
+
+		std::vector<unsigned> m_voicesToRender;
+		std::vector<VoiceRef> m_voicesToSteal;
 
 		// Global voice count
 		unsigned m_voiceCount = 0;
@@ -406,8 +732,21 @@ namespace SFM
 		// Key-to-voice mapping table
 		int m_keyToVoice[128];
 
-		// Per operator peaks (FIXME: move into 'Visualization' object; Github issue created)
-		float m_opPeaks[kNumOperators];
+		// Fed at the end of Render(), only if there's a consumer
+		Visualization m_visualization;
+
+		void PublishVisualization(unsigned numSamples, const float *pLeft, const float *pRight);
+
+		// Telemetry: counted during the block (plus NoteOn() & NoteOff() calls before it) and published at the end of Render()
+		Telemetry m_telemetryBlock;
+		SnapshotBuffer<Telemetry> m_telemetry;
+
+		void PublishTelemetry(unsigned numSamples, std::chrono::steady_clock::time_point start);
+
+		// Latency: the compressor's lookahead is a parameter, so it's published at the end of Render() (see GetLatency())
+		std::atomic<int> m_latency = 0;
+
+		void PublishLatency();
 	};
 
 	#pragma warning (pop)
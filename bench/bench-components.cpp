@@ -0,0 +1,874 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Per-component DSP microbenchmarks.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Runs each DSP building block on it's own and reports what it costs in cycles per sample, with warm and cold caches,
+	so an optimization can be checked against a baseline in the same harness (see bench-render.cpp for the whole engine)
+
+	Usage:
+		bench_components [--filter <substring>] [--block <samples>] [--output <file.json>]
+		bench_components --check
+
+	- Warm: median (and minimum) of kWarmRuns blocks, after kWarmUpRuns blocks that aren't counted
+	- Cold: median of kColdRuns blocks, each one right after streaming through a buffer larger than the last level
+	  cache (kEvictSize), so the component's state and tables have to come from memory again
+	- Input (for filters & effects) is copied to the work buffers before the clock starts, generators write to them
+	- Cycles are TSC ticks (__rdtsc()), which on current x86 run at a fixed (nominal) rate, not the actual core
+	  clock; fine for comparing builds on one machine, don't compare across machines
+	- JSON goes to stdout (or '--output'), a readable table to stderr
+	- '--check' doesn't measure anything, it checks that block rendering is identical to sample by sample
+	  rendering (see CheckOscillators()) and exits with 1 if it isn't (registered with CTest)
+
+	FIXME:
+		- Cold only evicts data & unified caches, L1I likely still holds the code
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <x86intrin.h>
+
+#include "../synth-global.h"
+#include "../synth-oscillator.h"
+#include "../synth-supersaw.h"
+#include "../synth-oversampler.h"
+#include "../synth-ladder-filter.h"
+#include "../synth-envelope.h"
+#include "../synth-pitch-envelope.h"
+#include "../synth-delay-line.h"
+#include "../synth-reverb.h"
+#include "../synth-compressor.h"
+#include "../synth-auto-wah-vox.h"
+#include "../synth-mini-EQ.h"
+#include "../quarantined/synth-vowelizer-V1.h"
+#include "../3rdparty/filters/Biquad.h"
+#include "../3rdparty/filters/SvfLinearTrapOptimised2.hpp"
+#include "../3rdparty/filters/MusicDSPModel.h"
+#include "../helper/synth-arena.h"
+#include "../helper/synth-fast-cosine.h"
+#include "../helper/synth-helper.h"
+#include "../helper/synth-random.h"
+
+using namespace SFM;
+
+constexpr unsigned kSampleRate = 48000;
+constexpr unsigned kNyquist = kSampleRate/2;
+
+constexpr unsigned kDefBlockSize = 256;
+constexpr unsigned kMaxBlockSize = 8192;
+
+constexpr unsigned kWarmUpRuns = 64;
+constexpr unsigned kWarmRuns   = 512;
+constexpr unsigned kColdRuns   = 32;
+
+constexpr size_t kEvictSize = 64*1024*1024;
+
+constexpr uint64_t kBenchSeed = 0xB150Bull;
+
+// Keeps the compiler from throwing away results
+static volatile float s_sink = 0.f;
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Components
+
+	Each one is set up by a factory that returns the processing function (which owns the component's state);
+	the function processes (or generates) 'numSamples' in place
+
+ ------------------------------------------------------------------------------------------------------ */
+
+typedef std::function<void(float *pLeft, float *pRight, unsigned numSamples)> ProcessFunc;
+
+struct Component
+{
+	std::string name;
+	std::function<ProcessFunc()> create;
+};
+
+static std::vector<Component> s_components;
+
+static void Add(const std::string &name, std::function<ProcessFunc()> create)
+{
+	s_components.push_back({ name, create });
+}
+
+// Arena-backed components keep their arena alive with them
+template<typename T> struct ArenaOwned
+{
+	Arena arena;
+	std::unique_ptr<T> pComponent;
+};
+
+struct OscillatorForm
+{
+	Oscillator::Waveform form;
+	const char *name;
+};
+
+static const OscillatorForm kOscillatorForms[] =
+{
+	{ Oscillator::kSine,              "sine"               },
+	{ Oscillator::kCosine,            "cosine"             },
+	{ Oscillator::kPolyTriangle,      "poly-triangle"      },
+	{ Oscillator::kPolySquare,        "poly-square"        },
+	{ Oscillator::kPolySaw,           "poly-saw"           },
+	{ Oscillator::kPolyRamp,          "poly-ramp"          },
+	{ Oscillator::kPolyRectifiedSine, "poly-rectified-sine" },
+	{ Oscillator::kPolyRectangle,     "poly-rectangle"     },
+	{ Oscillator::kBump,              "bump"               },
+	{ Oscillator::kSoftRamp,          "soft-ramp"          },
+	{ Oscillator::kSoftSaw,           "soft-saw"           },
+	{ Oscillator::kSupersaw,          "supersaw"           },
+	{ Oscillator::kUniRamp,           "uni-ramp"           },
+	{ Oscillator::kRamp,              "ramp"               },
+	{ Oscillator::kSaw,               "saw"                },
+	{ Oscillator::kSquare,            "square"             },
+	{ Oscillator::kTriangle,          "triangle"           },
+	{ Oscillator::kPulse,             "pulse"              },
+	{ Oscillator::kWhiteNoise,        "white-noise"        },
+	{ Oscillator::kPinkNoise,         "pink-noise"         },
+	{ Oscillator::kSampleAndHold,     "sample-and-hold"    }
+};
+
+// Only band-limited (PolyBLEP) forms have a wavetable
+static bool HasWavetable(Oscillator::Waveform form)
+{
+	return form >= Oscillator::kPolyTriangle && form <= Oscillator::kBump;
+}
+
+// Oscillator with everything it might need (random stream & supersaw slot)
+struct OscillatorState
+{
+	OscillatorState(Oscillator::Waveform form, Oscillator::RenderMode mode, float frequency)
+	{
+		random.Seed(kBenchSeed, 0);
+		oscillator.SetRandomStream(&random);
+		oscillator.SetSupersawState(&supersaw);
+		oscillator.SetRenderMode(mode);
+		oscillator.Initialize(form, frequency, kSampleRate, 0.f, 0.5f, 0.5f);
+	}
+
+	RandomStream random;
+	Supersaw supersaw;
+	Oscillator oscillator;
+};
+
+static void AddOscillators()
+{
+	for (const OscillatorForm &form : kOscillatorForms)
+	{
+		for (Oscillator::RenderMode mode : { Oscillator::kPolyBLEP, Oscillator::kWavetable })
+		{
+			if (Oscillator::kWavetable == mode && false == HasWavetable(form.form))
+				continue;
+
+			const std::string prefix = (Oscillator::kWavetable == mode) ? "osc-wt" : "osc";
+			const Oscillator::Waveform waveform = form.form;
+
+			// Sample by sample (like operators) & block (like LFOs, see Voice::RenderLFOs())
+			Add(prefix + "/" + form.name, [waveform, mode]()
+			{
+				auto pState = std::make_shared<OscillatorState>(waveform, mode, 440.f);
+
+				return [pState](float *pLeft, float *, unsigned numSamples)
+				{
+					for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+						pLeft[iSample] = pState->oscillator.Sample(0.f);
+				};
+			});
+
+			Add(prefix + "-block/" + form.name, [waveform, mode]()
+			{
+				auto pState = std::make_shared<OscillatorState>(waveform, mode, 440.f);
+
+				return [pState](float *pLeft, float *, unsigned numSamples)
+				{
+					pState->oscillator.Sample(pLeft, numSamples);
+				};
+			});
+		}
+	}
+}
+
+template<typename T> static void AddPostFilter(const std::string &name, unsigned factor)
+{
+	Add(name, [factor]()
+	{
+		auto pState = std::make_shared<ArenaOwned<Oversampler>>();
+		pState->arena.Reserve(Oversampler::GetArenaSize(factor, kMaxBlockSize), false);
+		pState->pComponent = std::make_unique<Oversampler>(pState->arena, factor, kMaxBlockSize);
+
+		auto pFilter = std::make_shared<T>(kSampleRate*factor);
+
+		return [pState, pFilter, factor](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			Oversampler &oversampler = *pState->pComponent;
+			oversampler.Upsample(pLeft, pRight, numSamples);
+
+			float *pOverL = oversampler.GetBufferL();
+			float *pOverR = oversampler.GetBufferR();
+
+			for (unsigned iSample = 0; iSample < numSamples*factor; ++iSample)
+			{
+				pFilter->SetParameters(1000.f, 0.5f, 1.f);
+				pFilter->Apply(pOverL[iSample], pOverR[iSample]);
+			}
+
+			oversampler.Downsample(pLeft, pRight, numSamples);
+		};
+	});
+}
+
+static void AddComponents()
+{
+	AddOscillators();
+
+	Add("supersaw", []()
+	{
+		struct State
+		{
+			RandomStream random;
+			Supersaw supersaw;
+
+			State() : random(kBenchSeed, 0), supersaw(0, random) {}
+		};
+
+		auto pState = std::make_shared<State>();
+		pState->supersaw.Initialize(110.f, kSampleRate, 0.5f, 0.5f);
+
+		return [pState](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = pState->supersaw.Sample();
+		};
+	});
+
+	// Cycles through attack, decay, sustain & release
+	Add("envelope", []()
+	{
+		struct State
+		{
+			Envelope envelope;
+			Envelope::Parameters parameters;
+			unsigned counter = 0;
+		};
+
+		auto pState = std::make_shared<State>();
+
+		Envelope::Parameters &parameters = pState->parameters;
+		parameters.preAttack = 0.f;
+		parameters.attack = 0.1f;
+		parameters.decay = 0.1f;
+		parameters.sustain = 0.5f;
+		parameters.release = 0.1f;
+		parameters.globalMul = 1.f;
+		parameters.attackCurve = parameters.decayCurve = parameters.releaseCurve = 0.5f;
+
+		pState->envelope.Start(parameters, kSampleRate, true, 1.f, 1.f);
+
+		return [pState](float *pLeft, float *, unsigned numSamples)
+		{
+			constexpr unsigned kCycle = kSampleRate/2;
+
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				if (kCycle/2 == pState->counter)
+					pState->envelope.Stop();
+				else if (kCycle == pState->counter)
+				{
+					pState->envelope.Start(pState->parameters, kSampleRate, true, 1.f, 1.f);
+					pState->counter = 0;
+				}
+
+				++pState->counter;
+				pLeft[iSample] = pState->envelope.Sample();
+			}
+		};
+	});
+
+	Add("pitch-envelope", []()
+	{
+		auto pEnvelope = std::make_shared<PitchEnvelope>();
+
+		PitchEnvelope::Parameters parameters;
+		parameters.P1 = 1.f;
+		parameters.P2 = 0.f;
+		parameters.P3 = -1.f;
+		parameters.P4 = 0.f;
+		parameters.R1 = parameters.R2 = parameters.R3 = 0.5f;
+		parameters.L4 = 0.f;
+		parameters.globalMul = 1.f;
+
+		pEnvelope->Start(parameters, kSampleRate);
+
+		return [pEnvelope](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = pEnvelope->Sample(true);
+		};
+	});
+
+	// Coefficients every sample (cutoff sweeps, as it would when modulated)
+	Add("biquad/update", []()
+	{
+		auto pFilter = std::make_shared<Biquad>();
+		auto pCutoff = std::make_shared<float>(0.f);
+
+		return [pFilter, pCutoff](float *pLeft, float *, unsigned numSamples)
+		{
+			float cutoff = *pCutoff;
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				pFilter->setBiquad(bq_type_lowpass, 0.01f + 0.2f*cutoff, 0.707f, 0.f);
+				cutoff = fmodf(cutoff + 1e-4f, 1.f);
+				pLeft[iSample] = cutoff;
+			}
+
+			*pCutoff = cutoff;
+		};
+	});
+
+	Add("biquad/tick", []()
+	{
+		auto pFilter = std::make_shared<Biquad>();
+		pFilter->setBiquad(bq_type_lowpass, 0.1f, 0.707f, 0.f);
+
+		return [pFilter](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pFilter->process(pLeft[iSample], pRight[iSample]);
+		};
+	});
+
+	Add("svf/update", []()
+	{
+		auto pFilter = std::make_shared<SvfLinearTrapOptimised2>();
+		auto pCutoff = std::make_shared<float>(0.f);
+
+		return [pFilter, pCutoff](float *pLeft, float *, unsigned numSamples)
+		{
+			float cutoff = *pCutoff;
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				pFilter->updateCoefficients(100.f + 8000.f*cutoff, 0.707f, SvfLinearTrapOptimised2::LOW_PASS_FILTER, kSampleRate);
+				cutoff = fmodf(cutoff + 1e-4f, 1.f);
+				pLeft[iSample] = cutoff;
+			}
+
+			*pCutoff = cutoff;
+		};
+	});
+
+	Add("svf/tick", []()
+	{
+		auto pFilter = std::make_shared<SvfLinearTrapOptimised2>();
+		pFilter->updateCoefficients(1000.f, 0.707f, SvfLinearTrapOptimised2::LOW_PASS_FILTER, kSampleRate);
+		pFilter->resetState();
+
+		return [pFilter](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pFilter->tick(pLeft[iSample], pRight[iSample]);
+		};
+	});
+
+	Add("moog", []()
+	{
+		auto pFilter = std::make_shared<MusicDSPMoog>(kSampleRate);
+		pFilter->SetParameters(0.25f, 0.5f, 1.f);
+
+		return [pFilter](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pFilter->Apply(pLeft[iSample], pRight[iSample]);
+		};
+	});
+
+	Add("zdf-ladder", []()
+	{
+		auto pFilter = std::make_shared<LadderFilter>(kSampleRate);
+		pFilter->SetParameters(1000.f, 0.5f, 1.f);
+
+		return [pFilter](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pFilter->Apply(pLeft[iSample], pRight[iSample]);
+		};
+	});
+
+	// Both post filter models like OversampledPass runs them, so at equal audible result: MOOG at 4X, ZDF at 2X,
+	// including up- & downsampling and setting the parameters every (oversampled) sample
+	AddPostFilter<MusicDSPMoog>("moog/4x", 4);
+	AddPostFilter<LadderFilter>("zdf-ladder/2x", 2);
+
+	// Write plus one read per sample, per read mode
+	struct DelayMode
+	{
+		const char *name;
+		std::function<float(const DelayLine &, unsigned)> read;
+	};
+
+	static const DelayMode kDelayModes[] =
+	{
+		{ "read",            [](const DelayLine &delay, unsigned iSample) { return delay.Read(1000.5f + 0.25f*(iSample & 7)); }           },
+		{ "read-nearest",    [](const DelayLine &delay, unsigned iSample) { return delay.ReadNearest(1000 + (iSample & 7)); }           },
+		{ "read-normalized", [](const DelayLine &delay, unsigned iSample) { return delay.ReadNormalized(0.5f + 0.01f*(iSample & 7)); } }
+	};
+
+	for (const DelayMode &mode : kDelayModes)
+	{
+		const auto read = mode.read;
+
+		Add(std::string("delay/") + mode.name, [read]()
+		{
+			auto pState = std::make_shared<ArenaOwned<DelayLine>>();
+			pState->arena.Reserve(DelayLine::GetArenaSize(kSampleRate, 0.1f), false);
+			pState->pComponent = std::make_unique<DelayLine>(pState->arena, kSampleRate, 0.1f);
+
+			return [pState, read](float *pLeft, float *, unsigned numSamples)
+			{
+				DelayLine &delay = *pState->pComponent;
+				for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				{
+					delay.Write(pLeft[iSample]);
+					pLeft[iSample] = read(delay, iSample);
+				}
+			};
+		});
+	}
+
+	Add("reverb", []()
+	{
+		auto pState = std::make_shared<ArenaOwned<Reverb>>();
+		pState->arena.Reserve(Reverb::GetArenaSize(kSampleRate), false);
+		pState->pComponent = std::make_unique<Reverb>(pState->arena, kSampleRate, kNyquist);
+
+		Reverb &reverb = *pState->pComponent;
+		reverb.SetRoomSize(0.7f);
+		reverb.SetDampening(kDefReverbDampening);
+		reverb.SetWidth(kDefReverbWidth);
+		reverb.SetPreDelay(0.f);
+
+		return [pState](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			pState->pComponent->Apply(pLeft, pRight, numSamples, kMaxReverbWet, 0.f, 0.f);
+		};
+	});
+
+	Add("compressor", []()
+	{
+		auto pState = std::make_shared<ArenaOwned<Compressor>>();
+		pState->arena.Reserve(Compressor::GetArenaSize(kSampleRate), false);
+		pState->pComponent = std::make_unique<Compressor>(pState->arena, kSampleRate);
+		pState->pComponent->SetParameters(-18.f, 6.f, 4.f, 0.f, 0.01f, 0.1f, 1.f);
+
+		return [pState](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			s_sink = s_sink + pState->pComponent->Apply(pLeft, pRight, numSamples, true, 0.5f);
+		};
+	});
+
+	Add("auto-wah", []()
+	{
+		auto pWah = std::make_shared<AutoWah>(kSampleRate, kNyquist, kBenchSeed);
+		pWah->SetParameters(kDefWahResonance, kDefWahAttack, kDefWahHold, kDefWahRate, kDefWahDrivedB, 0.5f, 1.f, 0.5f, 0.5f, 1.f, 0.f, 0.f, 1.f);
+
+		return [pWah](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			pWah->Apply(pLeft, pRight, numSamples, true);
+		};
+	});
+
+	Add("mini-eq", []()
+	{
+		auto pEQ = std::make_shared<MiniEQ>(kSampleRate, true);
+		pEQ->SetTargetdBs(3.f, -3.f, 2.f);
+
+		return [pEQ](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pEQ->Apply(pLeft[iSample], pRight[iSample]);
+		};
+	});
+
+	// Vowel sweeps (interpolation is part of the cost)
+	Add("vowelizer-v1", []()
+	{
+		auto pVowelizer = std::make_shared<VowelizerV1>();
+		auto pVowel = std::make_shared<float>(0.f);
+
+		return [pVowelizer, pVowel](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			float vowel = *pVowel;
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				pVowelizer->Apply(pLeft[iSample], pRight[iSample], vowel);
+				vowel = fmodf(vowel + 1e-4f, float(VowelizerV1::kNumVowels-1));
+			}
+
+			*pVowel = vowel;
+		};
+	});
+
+	Add("fast_cosf", []()
+	{
+		return [](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = fast_cosf(pLeft[iSample]);
+		};
+	});
+
+	// Array version (SIMD)
+	Add("fast_cosf/block", []()
+	{
+		return [](float *pLeft, float *pRight, unsigned numSamples)
+		{
+			fast_cosf(pLeft, pRight, numSamples);
+		};
+	});
+
+	Add("dB2Lin", []()
+	{
+		return [](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = dB2Lin(-60.f*fabsf(pLeft[iSample]));
+		};
+	});
+
+	Add("Lin2dB", []()
+	{
+		return [](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = Lin2dB(1e-3f + fabsf(pLeft[iSample]));
+		};
+	});
+
+	Add("mt_randf", []()
+	{
+		return [](float *pLeft, float *, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pLeft[iSample] = mt_randf();
+		};
+	});
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Measurement
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Result
+{
+	std::string name;
+	double warmMedian, warmMin;
+	double coldMedian;
+};
+
+SFM_INLINE static uint64_t ReadTSC()
+{
+	_mm_lfence();
+	const uint64_t ticks = __rdtsc();
+	_mm_lfence();
+	return ticks;
+}
+
+static std::vector<float> s_evictBuf;
+
+static void EvictCaches()
+{
+	// One read per cache line
+	float sum = 0.f;
+	for (size_t iLine = 0; iLine < s_evictBuf.size(); iLine += 64/sizeof(float))
+		sum += s_evictBuf[iLine];
+
+	s_sink = s_sink + sum;
+}
+
+static double Median(std::vector<double> &values)
+{
+	std::nth_element(values.begin(), values.begin() + values.size()/2, values.end());
+	return values[values.size()/2];
+}
+
+class Runner
+{
+public:
+	Runner(unsigned blockSize) :
+		m_blockSize(blockSize)
+,		m_inputL(blockSize), m_inputR(blockSize)
+,		m_workL(blockSize), m_workR(blockSize)
+	{
+		// Bipolar noise, like an audio signal
+		RandomStream random(kBenchSeed, 1);
+		random.FillBipolar(m_inputL.data(), blockSize);
+		random.FillBipolar(m_inputR.data(), blockSize);
+	}
+
+	Result Measure(const Component &component)
+	{
+		Result result;
+		result.name = component.name;
+
+		// Warm
+		{
+			ProcessFunc process = component.create();
+
+			for (unsigned iRun = 0; iRun < kWarmUpRuns; ++iRun)
+				Time(process);
+
+			std::vector<double> cycles(kWarmRuns);
+			for (double &perSample : cycles)
+				perSample = Time(process);
+
+			result.warmMin = *std::min_element(cycles.begin(), cycles.end());
+			result.warmMedian = Median(cycles);
+		}
+
+		// Cold (same instance: a component that sat idle for a while, not one that was just constructed)
+		{
+			ProcessFunc process = component.create();
+			Time(process);
+
+			std::vector<double> cycles(kColdRuns);
+			for (double &perSample : cycles)
+			{
+				EvictCaches();
+				perSample = Time(process);
+			}
+
+			result.coldMedian = Median(cycles);
+		}
+
+		return result;
+	}
+
+private:
+	const unsigned m_blockSize;
+
+	std::vector<float> m_inputL, m_inputR;
+	std::vector<float> m_workL, m_workR;
+
+	// Returns cycles per sample
+	double Time(ProcessFunc &process)
+	{
+		memcpy(m_workL.data(), m_inputL.data(), m_blockSize*sizeof(float));
+		memcpy(m_workR.data(), m_inputR.data(), m_blockSize*sizeof(float));
+
+		const uint64_t start = ReadTSC();
+		process(m_workL.data(), m_workR.data(), m_blockSize);
+		const uint64_t end = ReadTSC();
+
+		s_sink = s_sink + m_workL[0] + m_workL[m_blockSize-1] + m_workR[m_blockSize-1];
+
+		return double(end-start)/m_blockSize;
+	}
+};
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Output
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static void WriteJSON(FILE *pFile, const std::vector<Result> &results, unsigned blockSize)
+{
+	fprintf(pFile, "{\n");
+	fprintf(pFile, "  \"benchmark\": \"bench_components\",\n");
+#if defined(__VERSION__)
+	fprintf(pFile, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+	fprintf(pFile, "  \"unit\": \"tsc_cycles_per_sample\",\n");
+	fprintf(pFile, "  \"sample_rate\": %u,\n", kSampleRate);
+	fprintf(pFile, "  \"block_size\": %u,\n", blockSize);
+	fprintf(pFile, "  \"results\": [\n");
+
+	for (size_t iResult = 0; iResult < results.size(); ++iResult)
+	{
+		const Result &result = results[iResult];
+		fprintf(pFile, "    { \"name\": \"%s\", \"warm\": %.3f, \"warm_min\": %.3f, \"cold\": %.3f }%s\n",
+			result.name.c_str(), result.warmMedian, result.warmMin, result.coldMedian,
+			(iResult+1 < results.size()) ? "," : "");
+	}
+
+	fprintf(pFile, "  ]\n}\n");
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Check (--check)
+
+	Oscillator::Sample(float *, unsigned) must be identical to calling Sample(0.f) for each sample (see
+	synth-stateless-oscillators.h), for each waveform & render mode, at LFO and audio rates, with block sizes
+	that do and don't fit the SIMD width and the frequency changing in between blocks (like Bison::RenderVoices())
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static bool CheckOscillators()
+{
+	constexpr unsigned kCheckSamples = 8192;
+
+	static const float kFrequencies[] = { 0.1f, 5.f, 55.f, 440.f, 3520.f, 12000.f, 23000.f };
+	static const unsigned kBlockSizes[] = { 1, 3, 4, 61, 256 };
+
+	std::vector<float> scalar(kCheckSamples), block(kCheckSamples);
+
+	unsigned numChecks = 0, numFailed = 0;
+
+	for (const OscillatorForm &form : kOscillatorForms)
+	{
+		for (Oscillator::RenderMode mode : { Oscillator::kPolyBLEP, Oscillator::kWavetable })
+		{
+			if (Oscillator::kWavetable == mode && false == HasWavetable(form.form))
+				continue;
+
+			for (float frequency : kFrequencies)
+			{
+				for (unsigned blockSize : kBlockSizes)
+				{
+					OscillatorState scalarState(form.form, mode, frequency);
+					OscillatorState blockState(form.form, mode, frequency);
+
+					unsigned iBlock = 0;
+					for (unsigned iSample = 0; iSample < kCheckSamples; iSample += blockSize, ++iBlock)
+					{
+						const unsigned numSamples = std::min(blockSize, kCheckSamples-iSample);
+
+						// Supersaw has it's own way (see Voice::Sample())
+						if (Oscillator::kSupersaw != form.form)
+						{
+							const float blockFreq = frequency*(1.f + 0.01f*(iBlock%5));
+							scalarState.oscillator.SetFrequency(blockFreq);
+							blockState.oscillator.SetFrequency(blockFreq);
+						}
+
+						for (unsigned iBlockSample = 0; iBlockSample < numSamples; ++iBlockSample)
+							scalar[iSample+iBlockSample] = scalarState.oscillator.Sample(0.f);
+
+						blockState.oscillator.Sample(block.data()+iSample, numSamples);
+					}
+
+					++numChecks;
+
+					if (0 != memcmp(scalar.data(), block.data(), kCheckSamples*sizeof(float)))
+					{
+						unsigned iMismatch = 0;
+						while (0 == memcmp(&scalar[iMismatch], &block[iMismatch], sizeof(float)))
+							++iMismatch;
+
+						fprintf(stderr, "%s%s/%s at %.1fHz, block %u: sample %u is %.9g (scalar %.9g)\n",
+							"osc", (Oscillator::kWavetable == mode) ? "-wt" : "", form.name, frequency, blockSize,
+							iMismatch, block[iMismatch], scalar[iMismatch]);
+
+						++numFailed;
+					}
+				}
+			}
+		}
+	}
+
+	fprintf(stderr, "Oscillator blocks: %u of %u checks identical to scalar\n", numChecks-numFailed, numChecks);
+
+	return 0 == numFailed;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Entry point
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static int PrintUsage()
+{
+	fprintf(stderr, "Usage: bench_components [--filter <substring>] [--block <samples>] [--output <file.json>] | --check\n");
+	return 2;
+}
+
+int main(int argc, char **argv)
+{
+	const char *filter = nullptr;
+	const char *outputPath = nullptr;
+	unsigned blockSize = kDefBlockSize;
+	bool check = false;
+
+	for (int iArg = 1; iArg < argc; ++iArg)
+	{
+		const bool hasValue = iArg+1 < argc;
+
+		if (0 == strcmp(argv[iArg], "--filter") && true == hasValue)
+			filter = argv[++iArg];
+		else if (0 == strcmp(argv[iArg], "--block") && true == hasValue)
+			blockSize = unsigned(atoi(argv[++iArg]));
+		else if (0 == strcmp(argv[iArg], "--output") && true == hasValue)
+			outputPath = argv[++iArg];
+		else if (0 == strcmp(argv[iArg], "--check"))
+			check = true;
+		else
+			return PrintUsage();
+	}
+
+	if (0 == blockSize || blockSize > kMaxBlockSize)
+		return PrintUsage();
+
+	// Same static initialization as Bison::Bison()
+	InitializeRandomGenerator();
+	Supersaw::CalculateDetuneTable();
+	Oscillator::CalculateWavetables();
+
+	if (true == check)
+		return (true == CheckOscillators()) ? 0 : 1;
+
+	AddComponents();
+
+	s_evictBuf.resize(kEvictSize/sizeof(float), 1.f);
+
+	Runner runner(blockSize);
+
+	std::vector<Result> results;
+	for (const Component &component : s_components)
+	{
+		if (nullptr != filter && std::string::npos == component.name.find(filter))
+			continue;
+
+		results.push_back(runner.Measure(component));
+
+		const Result &result = results.back();
+		fprintf(stderr, "%-26s warm %9.2f (min %9.2f)  cold %9.2f cycles/sample\n", result.name.c_str(), result.warmMedian, result.warmMin, result.coldMedian);
+	}
+
+	if (true == results.empty())
+	{
+		fprintf(stderr, "No component matches '%s'\n", filter);
+		return 1;
+	}
+
+	FILE *pFile = stdout;
+	if (nullptr != outputPath)
+	{
+		pFile = fopen(outputPath, "w");
+		if (nullptr == pFile)
+		{
+			fprintf(stderr, "Can't open %s\n", outputPath);
+			return 1;
+		}
+	}
+
+	WriteJSON(pFile, results, blockSize);
+
+	if (stdout != pFile)
+		fclose(pFile);
+
+	return 0;
+}
@@ -0,0 +1,634 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- End-to-end render benchmark.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Drives Bison headlessly (deterministic mode, see Bison::SetSeed()) through MIDI scenarios and patch archetypes
+	and reports, as JSON, what each configuration costs
+
+	Usage:
+		bench_render [--full] [--pipelined] [--seconds <s>] [--archetype <name>] [--scenario <name>] [--output <file.json>]
+
+	- Default run: every archetype & scenario at the baseline (32 voices, 256 samples, 48KHz), then sweeps of
+	  polyphony (1-128), block size (16-2048) and sample rate (44.1-192KHz) one axis at a time (arpeggio scenario)
+	- '--full' runs the entire grid instead (takes a while)
+	- '--pipelined' runs everything in pipelined mode (see Bison::SetPipelined()), compare to a normal run to see what
+	  it buys; block times are then those of Render() as a whole, waiting on the pipeline thread included
+	- Per run: ns/sample, ns/voice-sample (voices actually in use per block), p50/p99/max block time, the block's
+	  real-time budget and the real-time factor (audio duration over render time; > 1 keeps up)
+	- 'polyphony' is what the engine actually ran with, which is less than 'voices' if it was clamped (see
+	  Bison::ReserveVoices())
+	- Blocks that trigger notes are also timed on their own (mean & max), that's where note-on spikes show up; the
+	  'burst' scenario and 'key-scaled' archetype are there to provoke them (see synth-note-table.h)
+	- JSON goes to stdout (or '--output'), a readable summary to stderr
+	- Built with SFM_PROFILE (see helper/synth-profile.h) each run also reports it's per-stage timings
+
+	FIXME:
+		- Only measures the calling thread (SFM_DISABLE_VOICE_THREAD is set by default anyway)
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../FM_BISON.h"
+#include "../helper/synth-profile.h"
+
+using namespace SFM;
+
+constexpr uint64_t kBenchSeed = 0xB150Bull;
+
+constexpr unsigned kBaseVoices     = 32;
+constexpr unsigned kBaseBlockSize  = 256;
+constexpr unsigned kBaseSampleRate = 48000;
+
+constexpr float kDefSeconds    = 3.f;
+constexpr float kWarmUpSeconds = 0.25f;
+
+const unsigned kVoiceCounts[] = { 1, 8, 32, 64, 128 };
+const unsigned kBlockSizes[]  = { 16, 64, 256, 1024, 2048 };
+const unsigned kSampleRates[] = { 44100, 48000, 96000, 192000 };
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Patch archetypes
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Archetype
+{
+	const char *name;
+	std::function<void(Patch &)> setup;
+};
+
+// Short attack, a bit of release so voices overlap
+static void SetEnvelope(PatchOperators::Operator &patchOp, float attack, float release)
+{
+	patchOp.envParams.attack = attack;
+	patchOp.envParams.decay = 0.3f;
+	patchOp.envParams.sustain = 0.7f;
+	patchOp.envParams.release = release;
+}
+
+static void SetupSineFM(Patch &patch)
+{
+	// 3 carrier/modulator pairs
+	auto &ops = patch.operators.operators;
+	for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+	{
+		auto &patchOp = ops[iOp];
+		patchOp.enabled = true;
+		patchOp.isCarrier = 0 == (iOp & 1);
+		patchOp.coarse = 1 + (iOp >> 1);
+		patchOp.index = 0.35f;
+		if (true == patchOp.isCarrier) patchOp.modulators[0] = iOp+1;
+		SetEnvelope(patchOp, 0.f, 0.2f);
+	}
+}
+
+static const Archetype kArchetypes[] =
+{
+	{ "sine-fm", SetupSineFM },
+
+	// Six operators in series, top one feeding back into itself
+	{ "feedback-stack", [](Patch &patch)
+	{
+		auto &ops = patch.operators.operators;
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+		{
+			auto &patchOp = ops[iOp];
+			patchOp.enabled = true;
+			patchOp.isCarrier = 0 == iOp;
+			patchOp.coarse = 1 + iOp;
+			patchOp.index = 0.25f;
+			if (iOp+1 < kNumOperators) patchOp.modulators[0] = iOp+1;
+			SetEnvelope(patchOp, 0.f, 0.2f);
+		}
+
+		ops[kNumOperators-1].feedback = kNumOperators-1;
+		ops[kNumOperators-1].feedbackAmt = 0.5f;
+	} },
+
+	// Detuned supersaws through the main (resonant) filter
+	{ "supersaw-pad", [](Patch &patch)
+	{
+		auto &ops = patch.operators.operators;
+		for (unsigned iOp = 0; iOp < 2; ++iOp)
+		{
+			auto &patchOp = ops[iOp];
+			patchOp.enabled = true;
+			patchOp.isCarrier = true;
+			patchOp.waveform = Oscillator::Waveform::kSupersaw;
+			patchOp.supersawDetune = 0.5f;
+			patchOp.supersawMix = 0.7f;
+			patchOp.detune = (0 == iOp) ? -7.f : 7.f;
+			SetEnvelope(patchOp, 0.1f, 0.4f);
+		}
+
+		patch.cutoff = 0.6f;
+		patch.resonance = 0.3f;
+	} },
+
+	// Everything that depends on the key: keytracked operator filters, (exponential) level scaling, envelope
+	// key tracking, fine & detune
+	{ "key-scaled", [](Patch &patch)
+	{
+		SetupSineFM(patch);
+
+		auto &ops = patch.operators.operators;
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+		{
+			auto &patchOp = ops[iOp];
+			patchOp.fine = int(iOp)-2;
+			patchOp.detune = 2.f*iOp;
+			patchOp.filterType = (0 == (iOp & 1)) ? PatchOperators::Operator::kLowpassFilter : PatchOperators::Operator::kHighpassFilter;
+			patchOp.cutoff = 0.6f;
+			patchOp.cutoffKeyTrack = (0 == (iOp & 1)) ? 0.5f : -0.5f;
+			patchOp.levelScaleBP = 60;
+			patchOp.levelScaleRange = 36;
+			patchOp.levelScaleL = -0.5f;
+			patchOp.levelScaleR = 0.3f;
+			patchOp.levelScaleExpL = patchOp.levelScaleExpR = true;
+			patchOp.envKeyTrack = 0.5f;
+			patchOp.acousticEnvKeyTrack = true;
+		}
+	} },
+
+	// Sine FM through every PostPass effect
+	{ "all-fx", [](Patch &patch)
+	{
+		SetupSineFM(patch);
+
+		patch.wahWet = 0.5f;
+		patch.wahSpeak = 0.5f;
+		patch.cpWet = 0.5f;
+		patch.cpRate = 0.3f;
+		patch.delayInSec = 0.25f;
+		patch.delayWet = 0.3f;
+		patch.delayFeedback = 0.4f;
+		patch.postWet = 0.5f;
+		patch.postCutoff = 0.6f;
+		patch.postResonance = 0.3f;
+		patch.tubeDistort = 0.3f;
+		patch.reverbWet = 0.3f;
+		patch.reverbRoomSize = 0.7f;
+		patch.compThresholddB = -18.f;
+	} }
+};
+
+/* ----------------------------------------------------------------------------------------------------
+
+	MIDI scenarios (sized to the polyphony, so that all voices get used)
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Event
+{
+	enum Type { kNoteOn, kNoteOff, kSustainOn, kSustainOff } type;
+	unsigned sample;
+	unsigned key;
+	float velocity;
+};
+
+// Spreads 'count' keys over the keyboard, starting at C2 as long as they fit
+static unsigned GetKey(unsigned index, unsigned count)
+{
+	const unsigned lowest = (count <= 92) ? 36 : 128-count;
+	return lowest + index%count;
+}
+
+typedef std::function<std::vector<Event>(unsigned numVoices, unsigned sampleRate, unsigned numSamples)> ScenarioFunc;
+
+struct Scenario
+{
+	const char *name;
+	ScenarioFunc generate;
+};
+
+static const Scenario kScenarios[] =
+{
+	// All voices at once, held for 3/4 of a second, every second
+	{ "chord", [](unsigned numVoices, unsigned sampleRate, unsigned numSamples)
+	{
+		std::vector<Event> events;
+		for (unsigned onset = 0; onset < numSamples; onset += sampleRate)
+		{
+			for (unsigned iVoice = 0; iVoice < numVoices; ++iVoice)
+			{
+				const unsigned key = GetKey(iVoice, numVoices);
+				events.push_back({ Event::kNoteOn,  onset, key, 0.8f });
+				events.push_back({ Event::kNoteOff, onset + sampleRate*3/4, key, 0.f });
+			}
+		}
+
+		return events;
+	} },
+
+	// Notes held for (almost) a second, 'numVoices' of them per second, so they all overlap
+	{ "arpeggio", [](unsigned numVoices, unsigned sampleRate, unsigned numSamples)
+	{
+		std::vector<Event> events;
+		const unsigned step = sampleRate/numVoices;
+		const unsigned length = sampleRate - step/2;
+
+		unsigned iNote = 0;
+		for (unsigned onset = 0; onset < numSamples; onset += step, ++iNote)
+		{
+			const unsigned key = GetKey(iNote, numVoices);
+			events.push_back({ Event::kNoteOn,  onset, key, 0.5f + 0.1f*(iNote % 5) });
+			events.push_back({ Event::kNoteOff, onset + length, key, 0.f });
+		}
+
+		return events;
+	} },
+
+	// All voices landing in the same block, 4 times per second, short enough not to overlap
+	{ "burst", [](unsigned numVoices, unsigned sampleRate, unsigned numSamples)
+	{
+		std::vector<Event> events;
+		for (unsigned onset = 0; onset < numSamples; onset += sampleRate/4)
+		{
+			for (unsigned iVoice = 0; iVoice < numVoices; ++iVoice)
+			{
+				const unsigned key = GetKey(iVoice, numVoices);
+				events.push_back({ Event::kNoteOn,  onset, key, 0.4f + 0.5f*iVoice/numVoices });
+				events.push_back({ Event::kNoteOff, onset + sampleRate/8, key, 0.f });
+			}
+		}
+
+		return events;
+	} },
+
+	// Pedal down, short staccato notes (sustained), pedal up; every 2 seconds
+	{ "sustain", [](unsigned numVoices, unsigned sampleRate, unsigned numSamples)
+	{
+		std::vector<Event> events;
+		for (unsigned onset = 0; onset < numSamples; onset += sampleRate*2)
+		{
+			events.push_back({ Event::kSustainOn, onset, 0, 0.f });
+
+			const unsigned spacing = (sampleRate/2)/numVoices;
+			for (unsigned iVoice = 0; iVoice < numVoices; ++iVoice)
+			{
+				const unsigned key = GetKey(iVoice, numVoices);
+				const unsigned noteOn = onset + iVoice*spacing;
+				events.push_back({ Event::kNoteOn,  noteOn, key, 0.7f });
+				events.push_back({ Event::kNoteOff, noteOn + sampleRate/20, key, 0.f });
+			}
+
+			events.push_back({ Event::kSustainOff, onset + sampleRate*3/2, 0, 0.f });
+		}
+
+		return events;
+	} }
+};
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Run
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Config
+{
+	const Archetype *pArchetype;
+	const Scenario *pScenario;
+	unsigned numVoices;
+	unsigned blockSize;
+	unsigned sampleRate;
+	bool pipelined = false;
+};
+
+struct Result
+{
+	Config config;
+	double seconds;
+	double nsPerSample;
+	double nsPerVoiceSample;
+	double avgVoices;
+	double p50us, p99us, maxUs, budgetUs;
+	double realtimeFactor;
+
+	// Blocks that trigger notes
+	unsigned noteOnBlocks;
+	double noteOnMeanUs, noteOnMaxUs;
+
+	// Engine's own telemetry (see synth-telemetry.h), totals at the end of the run
+	Telemetry telemetry;
+
+	// Only if SFM_PROFILE > 0
+	std::vector<std::pair<ProfileStage, ProfileSnapshot>> profile;
+};
+
+static double Percentile(std::vector<double> &values, double percentile)
+{
+	SFM_ASSERT(false == values.empty());
+
+	const size_t index = std::min(values.size()-1, size_t(percentile*values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+static Result Run(const Config &config, float seconds)
+{
+	Bison bison;
+
+	Patch &patch = bison.GetPatch();
+	config.pArchetype->setup(patch);
+	patch.maxPolyVoices = config.numVoices;
+
+	bison.SetSeed(kBenchSeed);
+	bison.SetPipelined(config.pipelined);
+	bison.OnSetSamplingProperties(config.sampleRate, config.blockSize);
+
+	const unsigned blockSize = config.blockSize;
+	const unsigned numSamples = unsigned(seconds*config.sampleRate);
+	std::vector<Event> events = config.pScenario->generate(config.numVoices, config.sampleRate, numSamples);
+	std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.sample < b.sample; });
+
+	std::vector<float> left(blockSize), right(blockSize);
+
+	// Warm up (caches, page faults, PostPass worker) on silence
+	const unsigned warmUpBlocks = unsigned(kWarmUpSeconds*config.sampleRate)/blockSize + 1;
+	for (unsigned iBlock = 0; iBlock < warmUpBlocks; ++iBlock)
+		bison.Render(blockSize, 0.f, 0.f, 0.f, left.data(), right.data());
+
+	ResetProfile();
+
+	std::vector<double> blockTimes;
+	blockTimes.reserve(numSamples/blockSize + 1);
+
+	double totalNs = 0.0;
+	double voiceSamples = 0.0;
+
+	unsigned noteOnBlocks = 0;
+	double noteOnNs = 0.0, noteOnMaxNs = 0.0;
+
+	size_t iEvent = 0;
+	for (unsigned iOffset = 0; iOffset < numSamples; iOffset += blockSize)
+	{
+		const unsigned curBlockSize = std::min(blockSize, numSamples-iOffset);
+
+		const auto start = std::chrono::steady_clock::now();
+
+		bool hasNoteOn = false;
+
+		// Events for this block (dispatch is part of the cost)
+		for (; iEvent < events.size() && events[iEvent].sample < iOffset+curBlockSize; ++iEvent)
+		{
+			const Event &event = events[iEvent];
+			const unsigned timeStamp = event.sample-iOffset;
+
+			hasNoteOn |= Event::kNoteOn == event.type;
+
+			switch (event.type)
+			{
+			case Event::kNoteOn:     bison.NoteOn(event.key, -1.f, event.velocity, timeStamp); break;
+			case Event::kNoteOff:    bison.NoteOff(event.key, timeStamp); break;
+			case Event::kSustainOn:  bison.Sustain(true); break;
+			case Event::kSustainOff: bison.Sustain(false); break;
+			}
+		}
+
+		bison.Render(curBlockSize, 0.f, 0.f, 0.f, left.data(), right.data());
+
+		const auto end = std::chrono::steady_clock::now();
+
+		const double ns = std::chrono::duration<double, std::nano>(end-start).count();
+		blockTimes.push_back(ns);
+		totalNs += ns;
+
+		if (true == hasNoteOn)
+		{
+			++noteOnBlocks;
+			noteOnNs += ns;
+			noteOnMaxNs = std::max(noteOnMaxNs, ns);
+		}
+
+		voiceSamples += double(bison.GetVoiceCount())*curBlockSize;
+	}
+
+	Result result;
+	result.config = config;
+	result.seconds = double(numSamples)/config.sampleRate;
+	result.nsPerSample = totalNs/numSamples;
+	result.nsPerVoiceSample = (voiceSamples > 0.0) ? totalNs/voiceSamples : 0.0;
+	result.avgVoices = voiceSamples/numSamples;
+	result.budgetUs = 1e6*blockSize/config.sampleRate;
+	result.realtimeFactor = (result.seconds*1e9)/totalNs;
+
+	const double maxNs = *std::max_element(blockTimes.begin(), blockTimes.end());
+	result.p50us = Percentile(blockTimes, 0.5)*1e-3;
+	result.p99us = Percentile(blockTimes, 0.99)*1e-3;
+	result.maxUs = maxNs*1e-3;
+
+	result.noteOnBlocks = noteOnBlocks;
+	result.noteOnMeanUs = (0 != noteOnBlocks) ? noteOnNs*1e-3/noteOnBlocks : 0.0;
+	result.noteOnMaxUs = noteOnMaxNs*1e-3;
+
+	bison.GetTelemetry(result.telemetry);
+
+#if SFM_PROFILE
+	for (unsigned iStage = 0; iStage < kNumProfileStages; ++iStage)
+	{
+		ProfileSnapshot snapshot;
+		snapshot.Take(ProfileStage(iStage));
+
+		if (0 != snapshot.count)
+			result.profile.emplace_back(ProfileStage(iStage), snapshot);
+	}
+#endif
+
+	return result;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Output
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static void WriteJSON(FILE *pFile, const std::vector<Result> &results, float seconds)
+{
+	fprintf(pFile, "{\n");
+	fprintf(pFile, "  \"benchmark\": \"bench_render\",\n");
+#if defined(__VERSION__)
+	fprintf(pFile, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+	fprintf(pFile, "  \"seconds_per_run\": %.3f,\n", seconds);
+	fprintf(pFile, "  \"results\": [\n");
+
+	const double ticksToUs = 1e6/GetProfileTicksPerSecond();
+
+	for (size_t iResult = 0; iResult < results.size(); ++iResult)
+	{
+		const Result &result = results[iResult];
+		const Config &config = result.config;
+
+		// Per-stage timings (mean, p99 (bucket bound) & max. per call, total per second of audio)
+		std::string profile;
+		for (const auto &[stage, snapshot] : result.profile)
+		{
+			char stageJSON[256];
+			snprintf(stageJSON, sizeof(stageJSON), "%s\"%s\": { \"calls\": %llu, \"mean_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"us_per_sec\": %.1f }",
+				profile.empty() ? "" : ", ", GetProfileStageName(stage), (unsigned long long) snapshot.count,
+				snapshot.GetMeanTicks()*ticksToUs, snapshot.GetPercentileTicks(0.99)*ticksToUs, snapshot.maxTicks*ticksToUs,
+				snapshot.totalTicks*ticksToUs/result.seconds);
+
+			profile += stageJSON;
+		}
+
+		fprintf(pFile,
+			"    { \"archetype\": \"%s\", \"scenario\": \"%s\", \"voices\": %u, \"polyphony\": %u, \"block_size\": %u, \"sample_rate\": %u, \"pipelined\": %s, "
+			"\"ns_per_sample\": %.2f, \"ns_per_voice_sample\": %.2f, \"avg_voices\": %.2f, "
+			"\"block_us\": { \"p50\": %.2f, \"p99\": %.2f, \"max\": %.2f, \"budget\": %.2f }, \"realtime_factor\": %.2f, "
+			"\"note_on_block_us\": { \"blocks\": %u, \"mean\": %.2f, \"max\": %.2f }, "
+			"\"steals\": %llu, \"deferred\": %llu, \"dropped\": %llu, \"note_table_fallbacks\": %llu%s%s%s }%s\n",
+			config.pArchetype->name, config.pScenario->name, config.numVoices, result.telemetry.polyphony, config.blockSize, config.sampleRate,
+			(true == config.pipelined) ? "true" : "false",
+			result.nsPerSample, result.nsPerVoiceSample, result.avgVoices,
+			result.p50us, result.p99us, result.maxUs, result.budgetUs, result.realtimeFactor,
+			result.noteOnBlocks, result.noteOnMeanUs, result.noteOnMaxUs,
+			(unsigned long long) result.telemetry.totalSteals, (unsigned long long) result.telemetry.totalDeferred,
+			(unsigned long long) result.telemetry.totalDropped, (unsigned long long) result.telemetry.totalNoteTableFallbacks,
+			profile.empty() ? "" : ", \"profile\": { ", profile.c_str(), profile.empty() ? "" : " }",
+			(iResult+1 < results.size()) ? "," : "");
+	}
+
+	fprintf(pFile, "  ]\n}\n");
+}
+
+static void PrintSummary(const Result &result)
+{
+	const Config &config = result.config;
+	fprintf(stderr, "%-15s %-9s %3u voices %4u smp %6u Hz: %8.1f ns/smp %6.1f ns/voice-smp  p50 %8.1f p99 %8.1f max %8.1f us (budget %8.1f)  note-on max %8.1f us  %6.1fx RT%s\n",
+		config.pArchetype->name, config.pScenario->name, config.numVoices, config.blockSize, config.sampleRate,
+		result.nsPerSample, result.nsPerVoiceSample, result.p50us, result.p99us, result.maxUs, result.budgetUs, result.noteOnMaxUs, result.realtimeFactor,
+		(true == config.pipelined) ? " (pipelined)" : "");
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Entry point
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static int PrintUsage()
+{
+	fprintf(stderr, "Usage: bench_render [--full] [--pipelined] [--seconds <s>] [--archetype <name>] [--scenario <name>] [--output <file.json>]\n");
+	return 2;
+}
+
+int main(int argc, char **argv)
+{
+	bool full = false;
+	bool pipelined = false;
+	float seconds = kDefSeconds;
+	const char *archetypeFilter = nullptr;
+	const char *scenarioFilter = nullptr;
+	const char *outputPath = nullptr;
+
+	for (int iArg = 1; iArg < argc; ++iArg)
+	{
+		const bool hasValue = iArg+1 < argc;
+
+		if (0 == strcmp(argv[iArg], "--full"))
+			full = true;
+		else if (0 == strcmp(argv[iArg], "--pipelined"))
+			pipelined = true;
+		else if (0 == strcmp(argv[iArg], "--seconds") && true == hasValue)
+			seconds = float(atof(argv[++iArg]));
+		else if (0 == strcmp(argv[iArg], "--archetype") && true == hasValue)
+			archetypeFilter = argv[++iArg];
+		else if (0 == strcmp(argv[iArg], "--scenario") && true == hasValue)
+			scenarioFilter = argv[++iArg];
+		else if (0 == strcmp(argv[iArg], "--output") && true == hasValue)
+			outputPath = argv[++iArg];
+		else
+			return PrintUsage();
+	}
+
+	if (seconds <= 0.f)
+		return PrintUsage();
+
+	// Build list of configurations
+	std::vector<Config> configs;
+
+	for (const Archetype &archetype : kArchetypes)
+	{
+		if (nullptr != archetypeFilter && 0 != strcmp(archetypeFilter, archetype.name))
+			continue;
+
+		for (const Scenario &scenario : kScenarios)
+		{
+			if (nullptr != scenarioFilter && 0 != strcmp(scenarioFilter, scenario.name))
+				continue;
+
+			if (true == full)
+			{
+				for (unsigned numVoices : kVoiceCounts)
+					for (unsigned blockSize : kBlockSizes)
+						for (unsigned sampleRate : kSampleRates)
+							configs.push_back({ &archetype, &scenario, numVoices, blockSize, sampleRate });
+
+				continue;
+			}
+
+			// Baseline
+			configs.push_back({ &archetype, &scenario, kBaseVoices, kBaseBlockSize, kBaseSampleRate });
+
+			// Sweep one axis at a time (arpeggio only, or whatever scenario was asked for)
+			if (nullptr == scenarioFilter && 0 != strcmp("arpeggio", scenario.name))
+				continue;
+
+			for (unsigned numVoices : kVoiceCounts)
+				if (kBaseVoices != numVoices) configs.push_back({ &archetype, &scenario, numVoices, kBaseBlockSize, kBaseSampleRate });
+
+			for (unsigned blockSize : kBlockSizes)
+				if (kBaseBlockSize != blockSize) configs.push_back({ &archetype, &scenario, kBaseVoices, blockSize, kBaseSampleRate });
+
+			for (unsigned sampleRate : kSampleRates)
+				if (kBaseSampleRate != sampleRate) configs.push_back({ &archetype, &scenario, kBaseVoices, kBaseBlockSize, sampleRate });
+		}
+	}
+
+	for (Config &config : configs)
+		config.pipelined = pipelined;
+
+	if (true == configs.empty())
+	{
+		fprintf(stderr, "No archetype and/or scenario by that name\n");
+		return 1;
+	}
+
+	std::vector<Result> results;
+	for (const Config &config : configs)
+	{
+		results.push_back(Run(config, seconds));
+		PrintSummary(results.back());
+	}
+
+	FILE *pFile = stdout;
+	if (nullptr != outputPath)
+	{
+		pFile = fopen(outputPath, "w");
+		if (nullptr == pFile)
+		{
+			fprintf(stderr, "Can't open %s\n", outputPath);
+			return 1;
+		}
+	}
+
+	WriteJSON(pFile, results, seconds);
+
+	if (stdout != pFile)
+		fclose(pFile);
+
+	return 0;
+}
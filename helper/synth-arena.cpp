@@ -0,0 +1,79 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Memory arena (linear allocator) for rate-dependent buffers.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#ifdef _WIN32
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+#include "synth-arena.h"
+
+namespace SFM
+{
+	static bool LockPages(void *pAddress, size_t size)
+	{
+#ifdef _WIN32
+		return FALSE != VirtualLock(pAddress, size);
+#else
+		return 0 == mlock(pAddress, size);
+#endif
+	}
+
+	static void UnlockPages(void *pAddress, size_t size)
+	{
+#ifdef _WIN32
+		VirtualUnlock(pAddress, size);
+#else
+		munlock(pAddress, size);
+#endif
+	}
+
+	void Arena::Reserve(size_t size, bool lockPages)
+	{
+		size = Align(size);
+
+		if (size > m_capacity || lockPages != m_locked)
+		{
+			Release();
+
+			m_capacity = size;
+			m_pBase = reinterpret_cast<uint8_t *>(mallocAligned(std::max<size_t>(m_capacity, kArenaAlignment), kArenaAlignment));
+			SFM_ASSERT(nullptr != m_pBase);
+
+			if (true == lockPages)
+			{
+				m_locked = LockPages(m_pBase, m_capacity);
+
+				if (false == m_locked)
+					SFM_LOG("Arena: could not lock {} bytes", m_capacity);
+			}
+		}
+
+		// Touch every page so the first Render() calls won't fault
+		memset(m_pBase, 0, m_capacity);
+
+		m_offset = 0;
+	}
+
+	void Arena::Release()
+	{
+		if (nullptr != m_pBase && true == m_owner)
+		{
+			if (true == m_locked)
+				UnlockPages(m_pBase, m_capacity);
+
+			freeAligned(m_pBase);
+		}
+
+		m_pBase = nullptr;
+		m_capacity = m_offset = 0;
+		m_locked = false;
+		m_owner = true;
+	}
+}
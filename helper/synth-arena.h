@@ -0,0 +1,114 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Memory arena (linear allocator) for rate-dependent buffers.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	One block of memory, sized up front, that objects carve their buffers from in a fixed order; this makes the
+	layout deterministic and keeps related buffers (delay lines, reverb, intermediate buffers) close together
+
+	- All allocations are aligned to kArenaAlignment (cache line)
+	- Objects using an arena supply a static GetArenaSize() that must match what their constructor allocates
+	- Nothing is freed individually: Rewind() or Reset() and construct again
+	- Reserve() only reallocates if the arena must grow, and prefaults (and optionally locks) the pages
+	- Carve() turns an arena into a view on a block of another one, so that part can be rewound independently
+
+	FIXME:
+		- VirtualLock() may fail if the process working set is too small (SetProcessWorkingSetSize())
+*/
+
+#pragma once
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	constexpr size_t kArenaAlignment = 64;
+
+	class Arena
+	{
+	public:
+		Arena() {}
+
+		~Arena()
+		{
+			Release();
+		}
+
+		// Round up to alignment
+		static constexpr size_t Align(size_t size)
+		{
+			return (size + kArenaAlignment-1) & ~(kArenaAlignment-1);
+		}
+
+		// Size of 'count' floats, aligned
+		static constexpr size_t GetFloatsSize(size_t count)
+		{
+			return Align(count*sizeof(float));
+		}
+
+		// Allocates (only if it needs to grow), prefaults & optionally locks; resets offset (not on audio thread!)
+		void Reserve(size_t size, bool lockPages);
+
+		// Use block of 'parent' (does not own memory, Reserve() can't be used)
+		void Carve(Arena &parent, size_t size)
+		{
+			Release();
+
+			m_capacity = Align(size);
+			m_pBase = reinterpret_cast<uint8_t *>(parent.Allocate(m_capacity));
+			m_offset = 0;
+			m_owner = false;
+		}
+
+		// Returns aligned memory (only zeroed right after Reserve(), so clear what you need cleared)
+		void *Allocate(size_t size)
+		{
+			size = Align(size);
+
+			SFM_ASSERT(nullptr != m_pBase);
+			SFM_ASSERT(m_offset+size <= m_capacity); // GetArenaSize() out of sync?
+
+			void *pMemory = m_pBase+m_offset;
+			m_offset += size;
+
+			return pMemory;
+		}
+
+		float *AllocateFloats(size_t count)
+		{
+			return reinterpret_cast<float *>(Allocate(count*sizeof(float)));
+		}
+
+		// Current offset can be used as a mark to Rewind() to
+		size_t GetOffset() const
+		{
+			return m_offset;
+		}
+
+		void Rewind(size_t offset)
+		{
+			SFM_ASSERT(offset <= m_offset);
+			m_offset = offset;
+		}
+
+		void Reset()
+		{
+			Rewind(0);
+		}
+
+		size_t GetCapacity() const
+		{
+			return m_capacity;
+		}
+
+	private:
+		void Release();
+
+		uint8_t *m_pBase = nullptr;
+		size_t m_capacity = 0;
+		size_t m_offset = 0;
+		bool m_locked = false;
+		bool m_owner = true;
+	};
+}
@@ -0,0 +1,67 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Background worker.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include <algorithm>
+
+#include "synth-background-worker.h"
+
+namespace SFM
+{
+	BackgroundWorker::BackgroundWorker()
+	{
+		m_thread = std::thread(Thread, this);
+	}
+
+	BackgroundWorker::~BackgroundWorker()
+	{
+		m_stop.store(true);
+		Signal();
+		m_thread.join();
+	}
+
+	void BackgroundWorker::Add(void (*function)(void *pInstance), void *pInstance)
+	{
+		SFM_ASSERT(nullptr != function && nullptr != pInstance);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_clients.push_back({ function, pInstance });
+		}
+
+		// Might have work pending already
+		Signal();
+	}
+
+	void BackgroundWorker::Remove(void *pInstance)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(), [pInstance](const Client &client) { return client.pInstance == pInstance; }), m_clients.end());
+	}
+
+	void BackgroundWorker::Thread(BackgroundWorker *pWorker)
+	{
+		for (;;)
+		{
+			// Anything signalled from here on wakes us up right away (see below)
+			const unsigned signal = pWorker->m_signal.load(std::memory_order_acquire);
+
+			if (true == pWorker->m_stop.load())
+				break;
+
+			{
+				std::lock_guard<std::mutex> lock(pWorker->m_mutex);
+
+				for (const Client &client : pWorker->m_clients)
+					client.function(client.pInstance);
+			}
+
+			// Sleep until there's (new) work
+			pWorker->m_signal.wait(signal, std::memory_order_acquire);
+		}
+	}
+}
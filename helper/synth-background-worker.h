@@ -0,0 +1,62 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Background worker.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	One thread that does slow, non real-time work (building a standby PostPass or a note table, see FM_BISON.cpp)
+	on behalf of any number of clients; a Bison instance starts one of it's own unless it's handed a shared one
+	(see Bison::SetWorker()), which is what BisonRack (see synth-rack.h) does for all of it's parts
+
+	- Signal() never blocks nor allocates, so it's fine to call from the audio thread
+	- On each signal every client's function is called (in the order they were added), clients check themselves
+	  if there's anything to do
+	- Add() & Remove() take a mutex that's held whilst clients are served, so once Remove() returns the client's
+	  function won't be called anymore; not real-time safe, nor is construction (starts thread) or destruction
+*/
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <atomic>
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	class BackgroundWorker
+	{
+	public:
+		BackgroundWorker();
+		~BackgroundWorker();
+
+		// Calls function(pInstance) on the worker's thread after each Signal()
+		void Add(void (*function)(void *pInstance), void *pInstance);
+		void Remove(void *pInstance);
+
+		// Wakes up the worker
+		void Signal()
+		{
+			m_signal.fetch_add(1, std::memory_order_release);
+			m_signal.notify_one();
+		}
+
+	private:
+		struct Client
+		{
+			void (*function)(void *pInstance);
+			void *pInstance;
+		};
+
+		static void Thread(BackgroundWorker *pWorker);
+
+		std::vector<Client> m_clients;
+		std::mutex m_mutex; // Guards m_clients, held whilst serving them
+
+		std::thread m_thread;
+		std::atomic<bool> m_stop = false;
+		std::atomic<unsigned> m_signal = 0; // Bumped when there's work, the thread waits on it
+	};
+}
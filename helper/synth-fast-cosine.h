@@ -4,68 +4,180 @@
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 
-	- Period is [0..1], values outside of [0..1] work fine
+	- Period is [0..1], values outside of [0..1] work fine (up to +/- 2^22)
 	- Includes sinus and tangens
+	- Minimax polynomial (odd, 9th degree) on a quarter period, max. error is around float precision; no table
+	- 4 (SSE), 8 (AVX) & 16 (AVX-512) wide versions, the latter 2 only if the compiler targets them
+	- Folding to [-0.5..0.5] rounds to nearest (even) by an explicit conversion or rounding instruction, never by
+	  adding & subtracting a large constant, which -ffast-math, /fp:fast or x87 extended precision would break
+	- Block versions use the widest available; all versions fold the same way and are bit-identical as long as the
+	  compiler leaves the polynomial alone (FMA contraction or fast-math reassociation break that)
 */
 
 #pragma once
 
-#include "../synth-global.h"
+#include <immintrin.h>
 
-#define FAST_COSF_INLINE
+#include "../synth-global.h"
 
 namespace SFM
 {
-	constexpr unsigned kFastCosTabLog2Size = 10; // Equals size of 1024
-	constexpr unsigned kFastCosTabSize = 1 << kFastCosTabLog2Size;
+	// Minimax coefficients for sin(2*PI*x) on [-0.25..0.25] (odd powers, 1 to 9)
+	constexpr float kFastSinC1 =   6.2831851600894835f;
+	constexpr float kFastSinC3 = -41.341655031417666f;
+	constexpr float kFastSinC5 =  81.601004073345050f;
+	constexpr float kFastSinC7 = -76.549782295442630f;
+	constexpr float kFastSinC9 =  39.536706079216470f;
+
+	SFM_INLINE static __m128 fast_cosf4(__m128 x)
+	{
+		// Fold to [-0.5..0.5] by subtracting the nearest integer (conversion rounds to nearest, see MXCSR)
+		x = _mm_sub_ps(x, _mm_cvtepi32_ps(_mm_cvtps_epi32(x)));
 
-	extern double g_fastCosTab[kFastCosTabSize+1];
+		// cos(2*PI*x) = sin(2*PI*(0.25-|x|)), which lands us in [-0.25..0.25]
+		const __m128 absX = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+		const __m128 quarter = _mm_sub_ps(_mm_set1_ps(0.25f), absX);
+		const __m128 squared = _mm_mul_ps(quarter, quarter);
 
-	void InitializeFastCosine();
+		__m128 poly = _mm_set1_ps(kFastSinC9);
+		poly = _mm_add_ps(_mm_mul_ps(poly, squared), _mm_set1_ps(kFastSinC7));
+		poly = _mm_add_ps(_mm_mul_ps(poly, squared), _mm_set1_ps(kFastSinC5));
+		poly = _mm_add_ps(_mm_mul_ps(poly, squared), _mm_set1_ps(kFastSinC3));
+		poly = _mm_add_ps(_mm_mul_ps(poly, squared), _mm_set1_ps(kFastSinC1));
 
-#if defined(FAST_COSF_INLINE)
+		return _mm_mul_ps(poly, quarter);
+	}
 
-	SFM_INLINE static float fast_cosf(float x)
+	SFM_INLINE static __m128 fast_sinf4(__m128 x)
 	{
-		// Cosine is symmetrical around 0, let's get rid of negative values
-		x = fabs(x);
+		return fast_cosf4(_mm_sub_ps(x, _mm_set1_ps(0.25f)));
+	}
 
-		auto phase = 1.0 + x;
+#if defined(__AVX__)
 
-		const auto phaseAsInt = *reinterpret_cast<unsigned long long *>(&phase);
+	SFM_INLINE static __m256 fast_cosf8(__m256 x)
+	{
+		x = _mm256_sub_ps(x, _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC));
 
-		const int exponent = (phaseAsInt >> 52) - 1023;
+		const __m256 absX = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+		const __m256 quarter = _mm256_sub_ps(_mm256_set1_ps(0.25f), absX);
+		const __m256 squared = _mm256_mul_ps(quarter, quarter);
 
-		const auto fractBits  = 32-kFastCosTabLog2Size;
-		const auto fractScale = 1 << fractBits;
-		const auto fractMask  = fractScale-1;
+		__m256 poly = _mm256_set1_ps(kFastSinC9);
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, squared), _mm256_set1_ps(kFastSinC7));
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, squared), _mm256_set1_ps(kFastSinC5));
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, squared), _mm256_set1_ps(kFastSinC3));
+		poly = _mm256_add_ps(_mm256_mul_ps(poly, squared), _mm256_set1_ps(kFastSinC1));
 
-		const unsigned significand = unsigned(((phaseAsInt<<exponent) >> (52-32)));
+		return _mm256_mul_ps(poly, quarter);
+	}
 
-		const auto index    = significand >> fractBits;
-		const int  fraction = significand &  fractMask;
+	SFM_INLINE static __m256 fast_sinf8(__m256 x)
+	{
+		return fast_cosf8(_mm256_sub_ps(x, _mm256_set1_ps(0.25f)));
+	}
 
-		const auto left  = g_fastCosTab[index];
-		const auto right = g_fastCosTab[index+1];
+#endif
 
-		const auto fractMix = fraction * (1.0/fractScale);
-		return float(left + (right-left)*fractMix);
-	}
+#if defined(__AVX512F__)
 
-#else
+	SFM_INLINE static __m512 fast_cosf16(__m512 x)
+	{
+		x = _mm512_sub_ps(x, _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC));
 
-	float fast_cosf(float x);
+		const __m512 absX = _mm512_abs_ps(x);
+		const __m512 quarter = _mm512_sub_ps(_mm512_set1_ps(0.25f), absX);
+		const __m512 squared = _mm512_mul_ps(quarter, quarter);
+
+		__m512 poly = _mm512_set1_ps(kFastSinC9);
+		poly = _mm512_add_ps(_mm512_mul_ps(poly, squared), _mm512_set1_ps(kFastSinC7));
+		poly = _mm512_add_ps(_mm512_mul_ps(poly, squared), _mm512_set1_ps(kFastSinC5));
+		poly = _mm512_add_ps(_mm512_mul_ps(poly, squared), _mm512_set1_ps(kFastSinC3));
+		poly = _mm512_add_ps(_mm512_mul_ps(poly, squared), _mm512_set1_ps(kFastSinC1));
+
+		return _mm512_mul_ps(poly, quarter);
+	}
+
+	SFM_INLINE static __m512 fast_sinf16(__m512 x)
+	{
+		return fast_cosf16(_mm512_sub_ps(x, _mm512_set1_ps(0.25f)));
+	}
 
 #endif
 
+	// Plain scalar code so the compiler is free to vectorize loops
+	SFM_INLINE static float fast_cosf(float x)
+	{
+		x -= float(lrintf(x));
+
+		const float quarter = 0.25f - fabsf(x);
+		const float squared = quarter*quarter;
+
+		float poly = kFastSinC9;
+		poly = poly*squared + kFastSinC7;
+		poly = poly*squared + kFastSinC5;
+		poly = poly*squared + kFastSinC3;
+		poly = poly*squared + kFastSinC1;
+
+		return poly*quarter;
+	}
+
 	SFM_INLINE static float fast_sinf(float x)
-	{ 
-		return fast_cosf(x-0.25f); 
+	{
+		return fast_cosf(x-0.25f);
 	}
 
 	// FIXME: move to synth-fast-tan.h?
-	SFM_INLINE static float fast_tanf(float x) 
-	{ 
-		return fast_sinf(x)/fast_cosf(x); 
+	SFM_INLINE static float fast_tanf(float x)
+	{
+		return fast_sinf(x)/fast_cosf(x);
+	}
+
+	/* Block versions (source & destination may be the same) */
+
+	SFM_INLINE static void fast_cosf(const float *pSrc, float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pSrc && nullptr != pDest);
+
+		unsigned iSample = 0;
+
+#if defined(__AVX512F__)
+		for (; iSample+16 <= numSamples; iSample += 16)
+			_mm512_storeu_ps(pDest+iSample, fast_cosf16(_mm512_loadu_ps(pSrc+iSample)));
+#endif
+
+#if defined(__AVX__)
+		for (; iSample+8 <= numSamples; iSample += 8)
+			_mm256_storeu_ps(pDest+iSample, fast_cosf8(_mm256_loadu_ps(pSrc+iSample)));
+#endif
+
+		for (; iSample+4 <= numSamples; iSample += 4)
+			_mm_storeu_ps(pDest+iSample, fast_cosf4(_mm_loadu_ps(pSrc+iSample)));
+
+		for (; iSample < numSamples; ++iSample)
+			pDest[iSample] = fast_cosf(pSrc[iSample]);
+	}
+
+	SFM_INLINE static void fast_sinf(const float *pSrc, float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pSrc && nullptr != pDest);
+
+		unsigned iSample = 0;
+
+#if defined(__AVX512F__)
+		for (; iSample+16 <= numSamples; iSample += 16)
+			_mm512_storeu_ps(pDest+iSample, fast_sinf16(_mm512_loadu_ps(pSrc+iSample)));
+#endif
+
+#if defined(__AVX__)
+		for (; iSample+8 <= numSamples; iSample += 8)
+			_mm256_storeu_ps(pDest+iSample, fast_sinf8(_mm256_loadu_ps(pSrc+iSample)));
+#endif
+
+		for (; iSample+4 <= numSamples; iSample += 4)
+			_mm_storeu_ps(pDest+iSample, fast_sinf4(_mm_loadu_ps(pSrc+iSample)));
+
+		for (; iSample < numSamples; ++iSample)
+			pDest[iSample] = fast_sinf(pSrc[iSample]);
 	}
 };
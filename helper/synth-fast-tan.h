@@ -1,6 +1,6 @@
 
 /*
-	FM. BISON hybrid FM synthesis -- Hyperbolic tangent & arctangent approximationd (use with care!)
+	FM. BISON hybrid FM synthesis -- Tangent, hyperbolic tangent & arctangent approximations (use with care!)
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 	
@@ -20,6 +20,15 @@
 
 namespace SFM
 {
+	// Pade [5/4] approximation of tan(), good to approx. 1e-7 (relative) up to PI/4 and still 2e-5 near 1.41 (0.45*PI),
+	// intended for ZDF filter prewarping, where the argument is (PI*cutoff)/sampleRate
+	// Domain is [0..PI/2) in radians (unlike fast_tanf(), see synth-fast-cosine.h), the closer to PI/2 the less precise
+	SFM_INLINE static float pade_tanf(float x)
+	{
+		const float x2 = x*x;
+		return x*(945.f - 105.f*x2 + x2*x2) / (945.f - 420.f*x2 + 15.f*x2*x2);
+	}
+
 	// Source: http://www-labs.iro.umontreal.ca/~mignotte/IFT2425/Documents/EfficientApproximationArctgFunction.pdf
 	// Domain is strictly [-1..1], outside of that all bets are off
 	SFM_INLINE static float fast_atanf(float x)
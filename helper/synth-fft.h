@@ -0,0 +1,61 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Radix-2 FFT (complex, double precision).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Plain in-place iterative Cooley-Tukey, meant for calculating tables up front, *not* for real-time use
+
+	- Size must be a power of 2
+	- Inverse is not scaled, so divide by size yourself (or scale the spectrum before)
+*/
+
+#pragma once
+
+#include <complex>
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	static void FFT(std::complex<double> *pData, unsigned size, bool inverse)
+	{
+		SFM_ASSERT(nullptr != pData);
+		SFM_ASSERT(0 != size && 0 == (size & (size-1)));
+
+		// Bit reversal permutation
+		for (unsigned iIndex = 1, iReversed = 0; iIndex < size; ++iIndex)
+		{
+			unsigned bit = size >> 1;
+			for (; 0 != (iReversed & bit); bit >>= 1)
+				iReversed ^= bit;
+
+			iReversed ^= bit;
+
+			if (iIndex < iReversed)
+				std::swap(pData[iIndex], pData[iReversed]);
+		}
+
+		// Butterflies
+		for (unsigned length = 2; length <= size; length <<= 1)
+		{
+			const unsigned halfLength = length >> 1;
+			const double angle = ((true == inverse) ? 2.0 : -2.0)*3.1415926535897932384626433832795/length;
+
+			for (unsigned iBin = 0; iBin < halfLength; ++iBin)
+			{
+				// Twiddle factor calculated directly (not by recurrence), precision matters more than speed here
+				const std::complex<double> twiddle = std::polar(1.0, angle*iBin);
+
+				for (unsigned iOffset = iBin; iOffset < size; iOffset += length)
+				{
+					const std::complex<double> even = pData[iOffset];
+					const std::complex<double> odd  = pData[iOffset+halfLength]*twiddle;
+
+					pData[iOffset]            = even+odd;
+					pData[iOffset+halfLength] = even-odd;
+				}
+			}
+		}
+	}
+}
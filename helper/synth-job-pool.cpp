@@ -0,0 +1,268 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Work-stealing job pool.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	The deque is the fixed size version of Chase-Lev; the one race that matters is the owner popping the last job
+	whilst a thief goes for it too, both then settle it by bumping 'top' (CAS), the seq. cst. fences make sure each
+	side sees the other's claim
+*/
+
+#include <emmintrin.h>
+
+#include "synth-job-pool.h"
+#include "synth-helper.h"
+
+namespace SFM
+{
+	// Idle threads: spin (pause), then yield, then sleep
+	constexpr unsigned kJobSpinCount  = 2048;
+	constexpr unsigned kJobYieldCount = 64;
+
+	// Set for the pool's own threads
+	static thread_local const JobPool *t_pPool = nullptr;
+	static thread_local unsigned t_iWorker = 0;
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Deque
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	bool JobPool::Deque::Push(Job *pJob)
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		const int64_t top = m_top.load(std::memory_order_acquire);
+
+		if (bottom-top >= int64_t(kJobDequeSize))
+			return false;
+
+		m_jobs[bottom & (kJobDequeSize-1)].store(pJob, std::memory_order_relaxed);
+		m_bottom.store(bottom+1, std::memory_order_release);
+
+		return true;
+	}
+
+	Job *JobPool::Deque::Pop()
+	{
+		const int64_t bottom = m_bottom.load(std::memory_order_relaxed)-1;
+		m_bottom.store(bottom, std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		int64_t top = m_top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty
+			m_bottom.store(bottom+1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job *pJob = m_jobs[bottom & (kJobDequeSize-1)].load(std::memory_order_relaxed);
+
+		if (top == bottom)
+		{
+			// Last one, a thief might be after it too
+			if (false == m_top.compare_exchange_strong(top, top+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				pJob = nullptr;
+
+			m_bottom.store(bottom+1, std::memory_order_relaxed);
+		}
+
+		return pJob;
+	}
+
+	Job *JobPool::Deque::Steal()
+	{
+		int64_t top = m_top.load(std::memory_order_acquire);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		Job *pJob = m_jobs[top & (kJobDequeSize-1)].load(std::memory_order_relaxed);
+
+		// Lost it to the owner or another thief?
+		if (false == m_top.compare_exchange_strong(top, top+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+
+		return pJob;
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Pool
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	JobPool::JobPool(unsigned numThreads) :
+		m_workers(numThreads+1)
+	{
+		for (unsigned iWorker = 1; iWorker <= numThreads; ++iWorker)
+			m_workers[iWorker].thread = std::thread(WorkerThread, this, iWorker);
+
+		SFM_LOG("Job pool: {} thread(s)", numThreads);
+	}
+
+	JobPool::~JobPool()
+	{
+		m_stop.store(true);
+
+		m_signal.fetch_add(1);
+		m_signal.notify_all();
+
+		for (Worker &worker : m_workers)
+		{
+			if (true == worker.thread.joinable())
+				worker.thread.join();
+		}
+	}
+
+	/* static */ unsigned JobPool::GetDefaultNumThreads()
+	{
+		const unsigned numHardwareThreads = std::thread::hardware_concurrency();
+		return (numHardwareThreads > 1) ? numHardwareThreads-1 : 0;
+	}
+
+	unsigned JobPool::GetWorkerIndex() const
+	{
+		return (this == t_pPool) ? t_iWorker : 0;
+	}
+
+	void JobPool::Push(Job &job, JobGroup &group)
+	{
+		SFM_ASSERT(nullptr != job.function);
+
+		job.pGroup = &group;
+		group.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+		if (false == m_workers[GetWorkerIndex()].deque.Push(&job))
+		{
+			// Full, so do it now
+			Run(job);
+			return;
+		}
+
+		// Wake a thread if need be (see WorkerThread())
+		m_signal.fetch_add(1);
+
+		if (0 != m_sleeping.load())
+			m_signal.notify_one();
+	}
+
+	void JobPool::Wait(JobGroup &group)
+	{
+		const unsigned iWorker = GetWorkerIndex();
+
+		unsigned idle = 0;
+		while (false == group.IsDone())
+		{
+			Job *pJob = FindJob(iWorker);
+
+			if (nullptr != pJob)
+			{
+				Run(*pJob);
+				idle = 0;
+			}
+			else if (++idle < kJobSpinCount)
+			{
+				// Someone's on it
+				_mm_pause();
+			}
+			else
+			{
+				// Give that someone a chance if we're sharing a core
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	Job *JobPool::FindJob(unsigned iWorker)
+	{
+		Job *pJob = m_workers[iWorker].deque.Pop();
+		if (nullptr != pJob)
+			return pJob;
+
+		const unsigned numWorkers = GetNumWorkers();
+
+		for (unsigned iOffset = 1; iOffset < numWorkers; ++iOffset)
+		{
+			pJob = m_workers[(iWorker+iOffset) % numWorkers].deque.Steal();
+			if (nullptr != pJob)
+				return pJob;
+		}
+
+		return nullptr;
+	}
+
+	bool JobPool::HasJobs() const
+	{
+		for (const Worker &worker : m_workers)
+		{
+			if (false == worker.deque.IsEmpty())
+				return true;
+		}
+
+		return false;
+	}
+
+	/* static */ void JobPool::Run(Job &job)
+	{
+		// Job may be gone as soon as the group's count drops
+		JobGroup *pGroup = job.pGroup;
+
+		job.function(job.pInstance, job.pData);
+
+		pGroup->m_pending.fetch_sub(1, std::memory_order_release);
+	}
+
+	/* static */ void JobPool::WorkerThread(JobPool *pPool, unsigned iWorker)
+	{
+		t_pPool = pPool;
+		t_iWorker = iWorker;
+
+#if SFM_KILL_DENORMALS
+		// Per thread, and jobs must see what they would on the audio thread
+		DisableDenormals disableDEN;
+#endif
+
+		unsigned idle = 0;
+		while (false == pPool->m_stop.load(std::memory_order_relaxed))
+		{
+			Job *pJob = pPool->FindJob(iWorker);
+
+			if (nullptr != pJob)
+			{
+				Run(*pJob);
+				idle = 0;
+			}
+			else if (++idle < kJobSpinCount)
+			{
+				_mm_pause();
+			}
+			else if (idle < kJobSpinCount+kJobYieldCount)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				// Sleep: whoever pushes after I've read the signal either bumps it before I wait (so I don't) or
+				// sees that I'm sleeping and wakes me
+				pPool->m_sleeping.fetch_add(1);
+
+				const unsigned signal = pPool->m_signal.load();
+				if (false == pPool->HasJobs() && false == pPool->m_stop.load())
+					pPool->m_signal.wait(signal);
+
+				pPool->m_sleeping.fetch_sub(1);
+
+				idle = 0;
+			}
+		}
+	}
+}
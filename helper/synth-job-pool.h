@@ -0,0 +1,121 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Work-stealing job pool.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	A fixed set of threads that run short jobs on behalf of one thread driving the pool (the audio thread, say);
+	BisonRack (see synth-rack.h) runs all it's parts and their voices on one so they share threads
+
+	- Each worker (every thread plus the one driving it, which is worker 0) has a deque of it's own: it pushes and
+	  pops jobs at the bottom whilst idle workers steal from the top (Chase-Lev, after Lê et al., "Correct and
+	  Efficient Work-Stealing for Weak Memory Models", 2013)
+	- Jobs are pushed as part of a JobGroup; Wait() doesn't sleep but runs jobs (it's own first, then anyone's) until
+	  that group is done, so a job can push & wait for jobs of it's own (fork/join) without tying up a thread
+	- Push() & Wait() never allocate nor take a lock; if a deque is full the job is simply run on the spot
+	- Idle threads spin for a bit, then yield, then sleep until something is pushed (std::atomic::wait())
+	- Only one thread besides the pool's own may call Push() & Wait(), threads are started & joined by the
+	  constructor & destructor (not real-time safe!)
+*/
+
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	// Jobs pushed but not run yet
+	class JobGroup
+	{
+	public:
+		bool IsDone() const
+		{
+			return 0 == m_pending.load(std::memory_order_acquire);
+		}
+
+	private:
+		friend class JobPool;
+
+		std::atomic<unsigned> m_pending = 0;
+	};
+
+	// Runs function(pInstance, pData); must stay put until it's group is done
+	struct Job
+	{
+		void (*function)(void *pInstance, void *pData) = nullptr;
+		void *pInstance = nullptr;
+		void *pData = nullptr;
+		JobGroup *pGroup = nullptr;
+	};
+
+	constexpr unsigned kJobDequeSize = 256; // Power of 2
+
+	class JobPool
+	{
+	public:
+		// 'numThreads' can be zero, in which case the thread driving the pool simply runs everything
+		JobPool(unsigned numThreads);
+		~JobPool();
+
+		// Hardware threads minus the one driving the pool
+		static unsigned GetDefaultNumThreads();
+
+		// Threads plus the one driving the pool
+		unsigned GetNumWorkers() const
+		{
+			return unsigned(m_workers.size());
+		}
+
+		// Pushes job onto the calling worker's deque, as part of 'group'
+		void Push(Job &job, JobGroup &group);
+
+		// Runs jobs until 'group' is done
+		void Wait(JobGroup &group);
+
+	private:
+		// Owner pushes & pops at the bottom, anyone can steal from the top
+		class Deque
+		{
+		public:
+			bool Push(Job *pJob);
+			Job *Pop();
+			Job *Steal();
+
+			bool IsEmpty() const
+			{
+				return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> m_top = 0;
+			alignas(64) std::atomic<int64_t> m_bottom = 0;
+			std::atomic<Job *> m_jobs[kJobDequeSize] = { };
+		};
+
+		struct alignas(64) Worker
+		{
+			Deque deque;
+			std::thread thread;
+		};
+
+		// Index of calling thread's worker (the thread driving the pool is 0)
+		unsigned GetWorkerIndex() const;
+
+		// Own deque first, then steal from others (round robin)
+		Job *FindJob(unsigned iWorker);
+		bool HasJobs() const;
+
+		static void Run(Job &job);
+		static void WorkerThread(JobPool *pPool, unsigned iWorker);
+
+		std::vector<Worker> m_workers;
+
+		// Bumped on each Push(), sleeping threads wait on it
+		alignas(64) std::atomic<unsigned> m_signal = 0;
+		std::atomic<unsigned> m_sleeping = 0;
+		std::atomic<bool> m_stop = false;
+	};
+}
@@ -1,10 +1,18 @@
 
 /*
-	FM. BISON hybrid FM synthesis -- Debug logging.
+	FM. BISON hybrid FM synthesis -- Debug logging (deferred, real-time safe).
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	The queue is a bounded multi-producer queue (after Dmitry Vyukov's): each cell carries a sequence number that
+	tells producers whether it's free and the (single) consumer whether it's been written
 */
 
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
 #include "synth-log.h"
 
 namespace SFM
@@ -12,14 +20,219 @@ namespace SFM
 
 #if SFM_NO_LOGGING // Set in synth-global.h
 
-	void Log(const std::string &message) {}
+	void PushLog([[maybe_unused]] const char *format, [[maybe_unused]] const LogArg *pArgs, [[maybe_unused]] unsigned numArgs) {}
+	void StartLogThread() {}
+	void StopLogThread() {}
 
 #else
 
-	void Log(const std::string &message)
+	constexpr size_t kLogQueueSize = 1024; // Power of 2
+	constexpr unsigned kLogThreadSleepMS = 10;
+
+	struct LogRecord
+	{
+		const char *format;
+		unsigned numArgs;
+		LogArg args[kMaxLogArgs];
+	};
+
+	class LogQueue
+	{
+	public:
+		LogQueue()
+		{
+			for (size_t iCell = 0; iCell < kLogQueueSize; ++iCell)
+				m_cells[iCell].sequence.store(iCell, std::memory_order_relaxed);
+		}
+
+		// Any thread
+		bool Push(const LogRecord &record)
+		{
+			size_t position = m_pushPos.load(std::memory_order_relaxed);
+			Cell *pCell;
+
+			for (;;)
+			{
+				pCell = &m_cells[position & (kLogQueueSize-1)];
+
+				const size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+				const intptr_t difference = intptr_t(sequence) - intptr_t(position);
+
+				if (0 == difference)
+				{
+					// Free, claim it
+					if (true == m_pushPos.compare_exchange_weak(position, position+1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+				{
+					// Full
+					return false;
+				}
+				else
+				{
+					// Claimed by another thread
+					position = m_pushPos.load(std::memory_order_relaxed);
+				}
+			}
+
+			pCell->record = record;
+			pCell->sequence.store(position+1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Log thread only
+		bool Pop(LogRecord &record)
+		{
+			Cell &cell = m_cells[m_popPos & (kLogQueueSize-1)];
+
+			if (cell.sequence.load(std::memory_order_acquire) != m_popPos+1)
+				return false;
+
+			record = cell.record;
+			cell.sequence.store(m_popPos+kLogQueueSize, std::memory_order_release);
+			++m_popPos;
+
+			return true;
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			LogRecord record;
+		};
+
+		Cell m_cells[kLogQueueSize];
+
+		alignas(64) std::atomic<size_t> m_pushPos = 0;
+		alignas(64) size_t m_popPos = 0;
+	};
+
+	static LogQueue s_logQueue;
+	static std::atomic<uint64_t> s_droppedRecords = 0;
+
+	static std::mutex s_logThreadMutex;
+	static std::thread s_logThread;
+	static std::atomic<bool> s_stopLogThread = false;
+	static unsigned s_logThreadRefs = 0;
+
+	void PushLog(const char *format, const LogArg *pArgs, unsigned numArgs)
+	{
+		SFM_ASSERT(nullptr != format);
+		SFM_ASSERT(numArgs <= kMaxLogArgs);
+
+		LogRecord record;
+		record.format = format;
+		record.numArgs = numArgs;
+
+		for (unsigned iArg = 0; iArg < numArgs; ++iArg)
+			record.args[iArg] = pArgs[iArg];
+
+		if (false == s_logQueue.Push(record))
+			s_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void AppendLogArg(std::string &message, const LogArg &arg)
 	{
+		switch (arg.type)
+		{
+		case LogArg::kSigned:
+			message += std::to_string(arg.signedValue);
+			break;
+
+		case LogArg::kUnsigned:
+			message += std::to_string(arg.unsignedValue);
+			break;
+
+		case LogArg::kFloat:
+			message += std::to_string(arg.floatValue);
+			break;
+
+		case LogArg::kString:
+			message += (nullptr != arg.string) ? arg.string : "(null)";
+			break;
+		}
+	}
+
+	static void WriteLog(const std::string &message)
+	{
+#if SFM_JUCE_INTEROP
 		// JUCE output
 		DBG(message.c_str());
+#else
+		fprintf(stderr, "%s\n", message.c_str());
+#endif
+	}
+
+	static void WriteLogRecords()
+	{
+		static uint64_t s_reportedDrops = 0;
+
+		const uint64_t numDropped = s_droppedRecords.load(std::memory_order_relaxed);
+		if (numDropped != s_reportedDrops)
+		{
+			WriteLog("Log: " + std::to_string(numDropped-s_reportedDrops) + " record(s) dropped (queue full)");
+			s_reportedDrops = numDropped;
+		}
+
+		LogRecord record;
+		std::string message;
+
+		while (true == s_logQueue.Pop(record))
+		{
+			message.clear();
+
+			unsigned iArg = 0;
+			for (const char *pChar = record.format; 0 != *pChar; ++pChar)
+			{
+				if ('{' == pChar[0] && '}' == pChar[1] && iArg < record.numArgs)
+				{
+					AppendLogArg(message, record.args[iArg++]);
+					++pChar;
+				}
+				else
+					message += *pChar;
+			}
+
+			WriteLog(message);
+		}
+	}
+
+	static void LogThread()
+	{
+		while (false == s_stopLogThread.load())
+		{
+			WriteLogRecords();
+			std::this_thread::sleep_for(std::chrono::milliseconds(kLogThreadSleepMS));
+		}
+	}
+
+	void StartLogThread()
+	{
+		std::lock_guard<std::mutex> lock(s_logThreadMutex);
+
+		if (1 == ++s_logThreadRefs)
+		{
+			s_stopLogThread.store(false);
+			s_logThread = std::thread(LogThread);
+		}
+	}
+
+	void StopLogThread()
+	{
+		std::lock_guard<std::mutex> lock(s_logThreadMutex);
+
+		SFM_ASSERT(s_logThreadRefs > 0);
+		if (0 == --s_logThreadRefs)
+		{
+			s_stopLogThread.store(true);
+			s_logThread.join();
+
+			// Thread's gone, so I'm the consumer now
+			WriteLogRecords();
+		}
 	}
 
 #endif // SFM_NO_LOGGING
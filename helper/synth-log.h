@@ -1,17 +1,96 @@
-
 /*
-	FM. BISON hybrid FM synthesis -- Debug logging.
+	FM. BISON hybrid FM synthesis -- Debug logging (deferred, real-time safe).
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	SFM_LOG("Voice stolen: {} for key: {}", index, key);
+
+	- The call site only pushes a record (format pointer plus up to kMaxLogArgs arguments) onto a lock-free queue,
+	  which never blocks nor allocates; a background thread (see StartLogThread()) formats & writes it
+	- Format must be a string literal, each '{}' is replaced by the next argument; arguments can be integers,
+	  floating point values or string literals (anything else must outlive the record)
+	- If the queue is full records are dropped (and counted), so the audio thread never waits on output
+	- With SFM_NO_LOGGING (see synth-global.h) SFM_LOG() compiles to nothing, arguments aren't even evaluated
+	- The queue is process wide and takes multiple producers, so any thread (or instance) can log
 */
 
 #pragma once
 
-#include <string>
+#include <type_traits>
 
 #include "../synth-global.h"
 
 namespace SFM
 {
-	void Log(const std::string &message);
+	constexpr unsigned kMaxLogArgs = 4;
+
+	struct LogArg
+	{
+		enum Type : uint8_t
+		{
+			kSigned,
+			kUnsigned,
+			kFloat,
+			kString
+		} type = kSigned;
+
+		union
+		{
+			int64_t signedValue = 0;
+			uint64_t unsignedValue;
+			double floatValue;
+			const char *string;
+		};
+	};
+
+	template<typename T> SFM_INLINE LogArg MakeLogArg(T value)
+	{
+		LogArg arg;
+
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			arg.type = LogArg::kFloat;
+			arg.floatValue = double(value);
+		}
+		else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>)
+		{
+			arg.type = LogArg::kString;
+			arg.string = value;
+		}
+		else if constexpr (std::is_signed_v<T> || std::is_enum_v<T>)
+		{
+			arg.type = LogArg::kSigned;
+			arg.signedValue = int64_t(value);
+		}
+		else
+		{
+			static_assert(std::is_integral_v<T>, "SFM_LOG() takes integers, floating point values & string literals only");
+			arg.type = LogArg::kUnsigned;
+			arg.unsignedValue = uint64_t(value);
+		}
+
+		return arg;
+	}
+
+	// Use SFM_LOG() instead
+	void PushLog(const char *format, const LogArg *pArgs, unsigned numArgs);
+
+	template<typename... Args> SFM_INLINE void LogDeferred(const char *format, Args... args)
+	{
+		static_assert(sizeof...(Args) <= kMaxLogArgs, "Too many SFM_LOG() arguments");
+
+		const LogArg logArgs[] = { MakeLogArg(args)..., LogArg() /* Never empty */ };
+		PushLog(format, logArgs, unsigned(sizeof...(Args)));
+	}
+
+	// Start & stop the thread that writes records, reference counted (each Bison instance does it); not real-time safe!
+	// Records pushed while it's not running are kept until it is (or dropped, if the queue fills up)
+	void StartLogThread();
+	void StopLogThread(); // Writes what's left when the last one stops
 }
+
+#if SFM_NO_LOGGING
+	#define SFM_LOG(format, ...) ((void) 0)
+#else
+	#define SFM_LOG(format, ...) SFM::LogDeferred("" format, ##__VA_ARGS__)
+#endif
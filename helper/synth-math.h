@@ -132,6 +132,20 @@ namespace SFM
 
 		return result;
 	}
+
+	// Zeroth order modified Bessel function of the first kind (for Kaiser windows, not meant for real-time use)
+	SFM_INLINE static double BesselI0(double x)
+	{
+		double sum = 1.0, term = 1.0;
+		for (unsigned iTerm = 1; iTerm < 32; ++iTerm)
+		{
+			const double half = x/(2.0*iTerm);
+			term *= half*half;
+			sum += term;
+		}
+
+		return sum;
+	}
 }
 
 #include "synth-fast-cosine.h"
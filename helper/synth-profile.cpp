@@ -0,0 +1,120 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Render path instrumentation (scoped timers & per-stage histograms).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include <chrono>
+
+#include "synth-profile.h"
+
+namespace SFM
+{
+	ProfileStats g_profileStats[kNumProfileStages];
+
+	static const char *s_stageNames[kNumProfileStages] =
+	{
+		"render",
+		"voices-pre-render",
+		"render-voices",
+		"voice",
+		"supersaw-catch-up",
+		"voices-post-render",
+		"post-pass",
+		"wah",
+		"chorus-delay",
+		"oversampled",
+		"reverb",
+		"compressor",
+		"final",
+		"chorus-phaser",
+		"kernel-sine",
+		"kernel-polyblep",
+		"kernel-wavetable",
+		"kernel-supersaw",
+		"kernel-noise",
+		"kernel-raw"
+	};
+
+	const char *GetProfileStageName(ProfileStage stage)
+	{
+		SFM_ASSERT(stage < kNumProfileStages);
+		return s_stageNames[stage];
+	}
+
+	void ProfileSnapshot::Take(ProfileStage stage)
+	{
+		SFM_ASSERT(stage < kNumProfileStages);
+		const ProfileStats &stats = g_profileStats[stage];
+
+		count = stats.m_count.load(std::memory_order_relaxed);
+		totalTicks = stats.m_total.load(std::memory_order_relaxed);
+		maxTicks = stats.m_max.load(std::memory_order_relaxed);
+
+		for (unsigned iBucket = 0; iBucket < kProfileBuckets; ++iBucket)
+			buckets[iBucket] = stats.m_buckets[iBucket].load(std::memory_order_relaxed);
+	}
+
+	uint64_t ProfileSnapshot::GetPercentileTicks(double percentile) const
+	{
+		SFM_ASSERT(percentile >= 0.0 && percentile <= 1.0);
+
+		// Count buckets rather than use 'count', which may be slightly off
+		uint64_t numEntries = 0;
+		for (uint64_t bucket : buckets)
+			numEntries += bucket;
+
+		if (0 == numEntries)
+			return 0;
+
+		const uint64_t rank = std::max<uint64_t>(1, uint64_t(ceil(percentile*numEntries)));
+
+		uint64_t sum = 0;
+		for (unsigned iBucket = 0; iBucket < kProfileBuckets-1; ++iBucket)
+		{
+			sum += buckets[iBucket];
+			if (sum >= rank)
+				return std::min<uint64_t>(maxTicks, (uint64_t(2) << iBucket) - 1);
+		}
+
+		return maxTicks;
+	}
+
+	void ResetProfile()
+	{
+		for (ProfileStats &stats : g_profileStats)
+		{
+			stats.m_count.store(0, std::memory_order_relaxed);
+			stats.m_total.store(0, std::memory_order_relaxed);
+			stats.m_max.store(0, std::memory_order_relaxed);
+
+			for (auto &bucket : stats.m_buckets)
+				bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	double GetProfileTicksPerSecond()
+	{
+#if SFM_PROFILE_TSC
+		// Measure TSC against the steady clock once
+		static const double s_ticksPerSecond = []()
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const uint64_t startTicks = ReadProfileClock();
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+			const auto end = std::chrono::steady_clock::now();
+			const uint64_t endTicks = ReadProfileClock();
+
+			return double(endTicks-startTicks)/std::chrono::duration<double>(end-start).count();
+		}();
+
+		return s_ticksPerSecond;
+#else
+		// Nanoseconds
+		return 1e9;
+#endif
+	}
+}
@@ -0,0 +1,193 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Render path instrumentation (scoped timers & per-stage histograms).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Compile time: SFM_PROFILE (see synth-global.h) sets the level
+		0 - Off, the macros below compile to nothing (default)
+		1 - Render() stages, per voice & each PostPass stage (a few timers per block, cheap enough to leave on)
+		2 - Also per operator kernel (oscillator type) & chorus/phaser, timed *per sample*, which costs a lot and
+		    inflates what it's nested in; use it to compare kernels, not to read absolute numbers
+
+	- Timers read the TSC (rdtsc) on x86, clock_gettime() elsewhere; see GetProfileTicksPerSecond()
+	- Each stage has a histogram (power of 2 buckets of ticks) plus count, total & max, all relaxed atomics, so
+	  any thread may add to them (the voice thread does) and a monitoring thread can read them whenever it wants
+	  without taking a lock or stalling the audio thread; the price is that a snapshot isn't taken atomically as a
+	  whole (count and total may be one sample apart)
+	- Statistics are process wide, so multiple instances add up
+*/
+
+#pragma once
+
+#include <bit>
+
+#if defined(_M_X64)
+	#include <intrin.h>
+	#define SFM_PROFILE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define SFM_PROFILE_TSC 1
+#else
+	#include <time.h>
+	#define SFM_PROFILE_TSC 0
+#endif
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	enum ProfileStage
+	{
+		// Bison (FM_BISON.cpp)
+		kProfileRender,
+		kProfileVoicesPreRender,
+		kProfileRenderVoices,
+		kProfileVoice,            // Per voice, per block
+		kProfileSupersawCatchUp,  // Supersaw::CatchUp()
+		kProfileVoicesPostRender,
+
+		// PostPass (synth-post-pass.cpp)
+		kProfilePostPass,
+		kProfileWah,
+		kProfileChorusDelay,      // Shares one loop
+		kProfileOversampled,
+		kProfileReverb,
+		kProfileCompressor,
+		kProfileFinal,
+
+		// Level 2 (per sample)
+		kProfileChorusPhaser,
+		kProfileKernelSine,       // kSine & kCosine
+		kProfileKernelPolyBLEP,
+		kProfileKernelWavetable,
+		kProfileKernelSupersaw,
+		kProfileKernelNoise,      // Noise & S&H
+		kProfileKernelRaw,        // Everything else (LFO forms)
+
+		kNumProfileStages
+	};
+
+	// Bucket N holds [2^N, 2^(N+1)) ticks, last one holds everything above
+	constexpr unsigned kProfileBuckets = 32;
+
+	const char *GetProfileStageName(ProfileStage stage);
+
+	SFM_INLINE static uint64_t ReadProfileClock()
+	{
+#if SFM_PROFILE_TSC
+		return __rdtsc();
+#else
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		return uint64_t(time.tv_sec)*1000000000ull + time.tv_nsec;
+#endif
+	}
+
+	class ProfileStats
+	{
+	public:
+		SFM_INLINE void Add(uint64_t ticks)
+		{
+			m_count.fetch_add(1, std::memory_order_relaxed);
+			m_total.fetch_add(ticks, std::memory_order_relaxed);
+			m_buckets[GetBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+
+			uint64_t max = m_max.load(std::memory_order_relaxed);
+			while (ticks > max && false == m_max.compare_exchange_weak(max, ticks, std::memory_order_relaxed))
+				;
+		}
+
+		SFM_INLINE static unsigned GetBucket(uint64_t ticks)
+		{
+			const unsigned log2 = unsigned(std::bit_width(ticks | 1))-1;
+			return std::min(log2, kProfileBuckets-1);
+		}
+
+	private:
+		friend struct ProfileSnapshot;
+		friend void ResetProfile();
+
+		std::atomic<uint64_t> m_count = 0;
+		std::atomic<uint64_t> m_total = 0;
+		std::atomic<uint64_t> m_max = 0;
+		std::atomic<uint64_t> m_buckets[kProfileBuckets] = {};
+	};
+
+	extern ProfileStats g_profileStats[kNumProfileStages];
+
+	// Copy of a stage's statistics, can be taken at any time from any thread
+	struct ProfileSnapshot
+	{
+		uint64_t count = 0;
+		uint64_t totalTicks = 0;
+		uint64_t maxTicks = 0;
+		uint64_t buckets[kProfileBuckets] = { 0 };
+
+		void Take(ProfileStage stage);
+
+		double GetMeanTicks() const
+		{
+			return (0 != count) ? double(totalTicks)/count : 0.0;
+		}
+
+		// Upper bound of the bucket holding the percentile ([0..1]), so at most 2X too high
+		uint64_t GetPercentileTicks(double percentile) const;
+	};
+
+	// Lossy if stages are running concurrently, which is fine for a monitor
+	void ResetProfile();
+
+	// Calibrated once (takes ~20MS, so don't call it from the audio thread the first time)
+	double GetProfileTicksPerSecond();
+
+	// Times from construction to destruction, or to Next(), which starts timing the next stage right away
+	class ProfileTimer
+	{
+	public:
+		SFM_INLINE ProfileTimer(ProfileStage stage) :
+			m_stage(stage), m_start(ReadProfileClock())
+		{
+		}
+
+		SFM_INLINE ~ProfileTimer()
+		{
+			g_profileStats[m_stage].Add(ReadProfileClock()-m_start);
+		}
+
+		SFM_INLINE void Next(ProfileStage stage)
+		{
+			const uint64_t now = ReadProfileClock();
+			g_profileStats[m_stage].Add(now-m_start);
+
+			m_stage = stage;
+			m_start = now;
+		}
+
+	private:
+		ProfileStage m_stage;
+		uint64_t m_start;
+	};
+}
+
+#define SFM_PROFILE_CONCAT_(a, b) a ## b
+#define SFM_PROFILE_CONCAT(a, b) SFM_PROFILE_CONCAT_(a, b)
+
+#if SFM_PROFILE >= 1
+	// Times the rest of the enclosing scope
+	#define SFM_PROFILE_SCOPE(stage) SFM::ProfileTimer SFM_PROFILE_CONCAT(profileTimer, __LINE__)(stage)
+
+	// Consecutive stages without nesting them in scopes: SECTION starts the first, NEXT ends the current one and starts another
+	#define SFM_PROFILE_SECTION(timer, stage) SFM::ProfileTimer timer(stage)
+	#define SFM_PROFILE_NEXT(timer, stage) timer.Next(stage)
+#else
+	#define SFM_PROFILE_SCOPE(stage)
+	#define SFM_PROFILE_SECTION(timer, stage)
+	#define SFM_PROFILE_NEXT(timer, stage)
+#endif
+
+#if SFM_PROFILE >= 2
+	#define SFM_PROFILE_DETAIL_SCOPE(stage) SFM_PROFILE_SCOPE(stage)
+#else
+	#define SFM_PROFILE_DETAIL_SCOPE(stage)
+#endif
@@ -5,6 +5,8 @@
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 */
 
+#include <emmintrin.h>
+
 /* Include 'Tiny Mersenne-Twister' 32-bit & 64-bit in-place */
 #include "../3rdparty/tinymt/tinymt32.c"
 #include "../3rdparty/tinymt/tinymt64.c"
@@ -41,4 +43,80 @@ namespace SFM
 	{ 
 		return (int32_t) mt_randu32();
 	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		RandomStream
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	// 32x32 bit multiply for 4 lanes: high & low halves of the 64-bit products
+	SFM_INLINE static void MulHiLo4(__m128i A, __m128i M, __m128i &high, __m128i &low)
+	{
+		const __m128i even = _mm_mul_epu32(A, M);                     // Lanes 0 & 2
+		const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(A, 32), M); // Lanes 1 & 3
+		const __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+
+		low  = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+		high = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+	}
+
+	void RandomStream::FillBipolar(float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pDest);
+
+		unsigned iSample = 0;
+
+		// Finish current block first
+		while (m_index < 4 && iSample < numSamples)
+			pDest[iSample++] = NextFloatBipolar();
+
+		// 4 blocks (counters) at a time, 1 per lane
+		const __m128i M0 = _mm_set1_epi32(int(kPhiloxM0));
+		const __m128i M1 = _mm_set1_epi32(int(kPhiloxM1));
+		const __m128 scale = _mm_set1_ps(1.f/2147483648.f);
+
+		for (; iSample+16 <= numSamples; iSample += 16)
+		{
+			const uint64_t C0 = m_counter, C1 = m_counter+1, C2 = m_counter+2, C3 = m_counter+3;
+			m_counter += 4;
+
+			__m128i X0 = _mm_setr_epi32(int(C0), int(C1), int(C2), int(C3));
+			__m128i X1 = _mm_setr_epi32(int(C0 >> 32), int(C1 >> 32), int(C2 >> 32), int(C3 >> 32));
+			__m128i X2 = _mm_set1_epi32(int(m_stream));
+			__m128i X3 = _mm_set1_epi32(int(m_stream >> 32));
+
+			uint32_t K0 = m_key[0], K1 = m_key[1];
+
+			for (unsigned iRound = 0; iRound < kPhiloxRounds; ++iRound)
+			{
+				__m128i high0, low0, high1, low1;
+				MulHiLo4(X0, M0, high0, low0);
+				MulHiLo4(X2, M1, high1, low1);
+
+				X0 = _mm_xor_si128(_mm_xor_si128(high1, X1), _mm_set1_epi32(int(K0)));
+				X1 = low1;
+				X2 = _mm_xor_si128(_mm_xor_si128(high0, X3), _mm_set1_epi32(int(K1)));
+				X3 = low0;
+
+				K0 += kPhiloxW0;
+				K1 += kPhiloxW1;
+			}
+
+			// Lanes hold blocks, so transpose to get them in sequence
+			__m128 R0 = _mm_mul_ps(_mm_cvtepi32_ps(X0), scale);
+			__m128 R1 = _mm_mul_ps(_mm_cvtepi32_ps(X1), scale);
+			__m128 R2 = _mm_mul_ps(_mm_cvtepi32_ps(X2), scale);
+			__m128 R3 = _mm_mul_ps(_mm_cvtepi32_ps(X3), scale);
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+
+			_mm_storeu_ps(pDest+iSample,    R0);
+			_mm_storeu_ps(pDest+iSample+4,  R1);
+			_mm_storeu_ps(pDest+iSample+8,  R2);
+			_mm_storeu_ps(pDest+iSample+12, R3);
+		}
+
+		for (; iSample < numSamples; ++iSample)
+			pDest[iSample] = NextFloatBipolar();
+	}
 }
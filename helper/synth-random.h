@@ -3,6 +3,9 @@
 	FM. BISON hybrid FM synthesis -- Random generator.
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	- The global (Mersenne-Twister) generator is not thread-safe, use it to generate seeds and the like, not per sample
+	- RandomStream is what voices & effects draw from while rendering (see below)
 */
 
 #pragma once
@@ -30,4 +33,108 @@ namespace SFM
 	{
 		return -1.f + 2.f*mt_randf();
 	}
+
+	/*
+		RandomStream -- Counter-based generator (Philox4x32-10)
+
+		Source: Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (2011)
+
+		- Output is a pure function of seed (key), stream & counter: streams are independent, cheap to (re)seed and
+		  reproducible no matter which thread draws from them, so give each voice & effect one of it's own
+		- Generates 4 values (a block) at a time; FillBipolar() does 4 blocks at once (SSE2) and continues the same sequence
+	*/
+
+	// Stream IDs in use (see RandomStream::Seed()); voices count up from kVoiceRandomStream (one per note)
+	constexpr uint64_t kAutoWahRandomStream = 0;
+	constexpr uint64_t kVoiceRandomStream   = 1;
+
+	class RandomStream
+	{
+	public:
+		RandomStream(uint64_t seed = 0, uint64_t stream = 0)
+		{
+			Seed(seed, stream);
+		}
+
+		void Seed(uint64_t seed, uint64_t stream)
+		{
+			m_key[0] = uint32_t(seed);
+			m_key[1] = uint32_t(seed >> 32);
+			m_stream = stream;
+			m_counter = 0;
+			m_index = 4; // Empty
+		}
+
+		SFM_INLINE uint32_t NextU32()
+		{
+			if (4 == m_index)
+			{
+				Generate(m_counter++, m_block);
+				m_index = 0;
+			}
+
+			return m_block[m_index++];
+		}
+
+		SFM_INLINE uint64_t NextU64()
+		{
+			const uint64_t low = NextU32();
+			return low | (uint64_t(NextU32()) << 32);
+		}
+
+		// [0..1)
+		SFM_INLINE float NextFloat()
+		{
+			return (NextU32() >> 8)*(1.f/16777216.f);
+		}
+
+		// [-1..1]
+		SFM_INLINE float NextFloatBipolar()
+		{
+			return float(int32_t(NextU32()))*(1.f/2147483648.f);
+		}
+
+		// Same sequence as calling NextFloatBipolar() 'numSamples' times
+		void FillBipolar(float *pDest, unsigned numSamples);
+
+	private:
+		static constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+		static constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+		static constexpr uint32_t kPhiloxW0 = 0x9E3779B9; // Golden ratio
+		static constexpr uint32_t kPhiloxW1 = 0xBB67AE85; // sqrt(3)-1
+		static constexpr unsigned kPhiloxRounds = 10;
+
+		SFM_INLINE void Generate(uint64_t counter, uint32_t *pDest) const
+		{
+			uint32_t X0 = uint32_t(counter), X1 = uint32_t(counter >> 32);
+			uint32_t X2 = uint32_t(m_stream), X3 = uint32_t(m_stream >> 32);
+			uint32_t K0 = m_key[0], K1 = m_key[1];
+
+			for (unsigned iRound = 0; iRound < kPhiloxRounds; ++iRound)
+			{
+				const uint64_t product0 = uint64_t(kPhiloxM0)*X0;
+				const uint64_t product1 = uint64_t(kPhiloxM1)*X2;
+
+				X0 = uint32_t(product1 >> 32) ^ X1 ^ K0;
+				X1 = uint32_t(product1);
+				X2 = uint32_t(product0 >> 32) ^ X3 ^ K1;
+				X3 = uint32_t(product0);
+
+				K0 += kPhiloxW0;
+				K1 += kPhiloxW1;
+			}
+
+			pDest[0] = X0;
+			pDest[1] = X1;
+			pDest[2] = X2;
+			pDest[3] = X3;
+		}
+
+		uint32_t m_key[2];
+		uint64_t m_stream;
+		uint64_t m_counter;
+
+		uint32_t m_block[4];
+		unsigned m_index;
+	};
 };
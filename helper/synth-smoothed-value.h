@@ -0,0 +1,132 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Smoothed value (linear or multiplicative ramp towards a target).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Drop-in replacement for juce::SmoothedValue (JUCE 6), which is what InterpolatedParameter was built on; it
+	behaves exactly the same, including the quirks (see synth-interpolated-parameter.h), so patches sound the same
+
+	- SetRate() (JUCE: reset()) snaps current value to target
+	- Setting a target equal to the current target does *not* restart the ramp
+	- Multiplicative: neither current nor target value may be zero
+*/
+
+#pragma once
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	// Smoothing types (tags)
+	struct LinearSmoothing {};
+	struct MultiplicativeSmoothing {};
+
+	template <typename T>
+	class SmoothedValue
+	{
+	public:
+		SmoothedValue(float value = 0.f) :
+			m_current(value), m_target(value)
+		{
+		}
+
+		// Ramp length in seconds
+		void SetRate(double sampleRate, double rampLengthInSec)
+		{
+			SFM_ASSERT(sampleRate > 0.0 && rampLengthInSec >= 0.0);
+			SetRate(int(floor(rampLengthInSec*sampleRate)));
+		}
+
+		// Ramp length in samples
+		void SetRate(int numSteps)
+		{
+			m_numSteps = numSteps;
+			SetCurrentAndTarget(m_target);
+		}
+
+		SFM_INLINE void SetCurrentAndTarget(float value)
+		{
+			m_current = m_target = value;
+			m_countdown = 0;
+		}
+
+		SFM_INLINE void SetTarget(float value)
+		{
+			if (value == m_target)
+				return;
+
+			if (m_numSteps <= 0)
+			{
+				SetCurrentAndTarget(value);
+				return;
+			}
+
+			m_target = value;
+			m_countdown = m_numSteps;
+
+			if constexpr (std::is_same_v<T, LinearSmoothing>)
+			{
+				m_step = (m_target-m_current)/m_countdown;
+			}
+			else
+			{
+				SFM_ASSERT(0.f != m_current && 0.f != m_target);
+				m_step = expf((logf(fabsf(m_target)) - logf(fabsf(m_current))) / m_countdown);
+			}
+		}
+
+		SFM_INLINE float Next()
+		{
+			if (false == IsSmoothing())
+				return m_target;
+
+			--m_countdown;
+
+			if (true == IsSmoothing())
+			{
+				if constexpr (std::is_same_v<T, LinearSmoothing>)
+					m_current += m_step;
+				else
+					m_current *= m_step;
+			}
+			else
+				m_current = m_target;
+
+			return m_current;
+		}
+
+		float Skip(int numSamples)
+		{
+			if (numSamples >= m_countdown)
+			{
+				SetCurrentAndTarget(m_target);
+				return m_target;
+			}
+
+			if constexpr (std::is_same_v<T, LinearSmoothing>)
+				m_current += m_step*numSamples;
+			else
+				m_current *= powf(m_step, float(numSamples));
+
+			m_countdown -= numSamples;
+
+			return m_current;
+		}
+
+		SFM_INLINE float GetCurrent() const { return m_current; }
+		SFM_INLINE float GetTarget() const  { return m_target;  }
+
+		SFM_INLINE bool IsSmoothing() const
+		{
+			return m_countdown > 0;
+		}
+
+	private:
+		float m_current;
+		float m_target;
+		float m_step = 0.f;
+		int m_countdown = 0;
+		int m_numSteps = 0;
+	};
+}
@@ -0,0 +1,90 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Double-buffered snapshot (single writer, any number of readers, lock-free).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	For publishing a small struct from the audio thread (once per block, say) to whoever wants to read it
+
+	- Publish() writes the slot readers aren't pointed at, then flips the pointer; it never waits
+	- Read() copies the current slot and checks that slot's sequence number; if the writer got around to it in the
+	  meantime (which takes 2 Publish() calls during one Read()) it simply tries again
+	- T must be trivially copyable; reads copy it word by word through relaxed atomics so that a torn copy, which
+	  is always discarded, isn't a data race either
+*/
+
+#pragma once
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	template<typename T> class SnapshotBuffer
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		// Copied as words
+		static constexpr size_t kNumWords = (sizeof(T) + sizeof(uint64_t)-1)/sizeof(uint64_t);
+
+		struct Slot
+		{
+			std::atomic<uint64_t> sequence = 0; // Odd while being written
+			std::atomic<uint64_t> words[kNumWords] = {};
+		};
+
+	public:
+		SnapshotBuffer()
+		{
+			Publish(T());
+		}
+
+		// Writer (one thread only)
+		void Publish(const T &value)
+		{
+			const unsigned iNext = m_current.load(std::memory_order_relaxed) ^ 1;
+			Slot &slot = m_slots[iNext];
+
+			uint64_t words[kNumWords] = { 0 };
+			memcpy(words, &value, sizeof(T));
+
+			const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+			slot.sequence.store(sequence+1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for (size_t iWord = 0; iWord < kNumWords; ++iWord)
+				slot.words[iWord].store(words[iWord], std::memory_order_relaxed);
+
+			slot.sequence.store(sequence+2, std::memory_order_release);
+			m_current.store(iNext, std::memory_order_release);
+		}
+
+		// Readers (any thread)
+		void Read(T &value) const
+		{
+			uint64_t words[kNumWords];
+
+			for (;;)
+			{
+				const Slot &slot = m_slots[m_current.load(std::memory_order_acquire)];
+
+				const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+				if (sequence & 1)
+					continue;
+
+				for (size_t iWord = 0; iWord < kNumWords; ++iWord)
+					words[iWord] = slot.words[iWord].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (sequence == slot.sequence.load(std::memory_order_relaxed))
+					break;
+			}
+
+			memcpy(&value, words, sizeof(T));
+		}
+
+	private:
+		Slot m_slots[2];
+		std::atomic<unsigned> m_current = 0;
+	};
+}
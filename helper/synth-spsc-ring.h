@@ -0,0 +1,76 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Single producer, single consumer ring (lock-free, fixed size).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	- Never blocks nor allocates: if it's full the producer simply doesn't get a slot (and drops whatever it had)
+	- BeginPush()/EndPush() let the producer fill a slot in place, which saves a copy for larger items
+	- Capacity must be a power of 2; one thread pushes, one (other) thread pops
+*/
+
+#pragma once
+
+#include "../synth-global.h"
+
+namespace SFM
+{
+	template<typename T, unsigned kCapacity> class SPSCRing
+	{
+		static_assert(0 != kCapacity && 0 == (kCapacity & (kCapacity-1)));
+
+	public:
+		// Producer: returns nullptr if full, otherwise a slot to fill and hand over with EndPush()
+		T *BeginPush()
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head - m_tail.load(std::memory_order_acquire) == kCapacity)
+				return nullptr;
+
+			return &m_items[head & (kCapacity-1)];
+		}
+
+		void EndPush()
+		{
+			m_head.store(m_head.load(std::memory_order_relaxed)+1, std::memory_order_release);
+		}
+
+		bool TryPush(const T &item)
+		{
+			T *pSlot = BeginPush();
+			if (nullptr == pSlot)
+				return false;
+
+			*pSlot = item;
+			EndPush();
+
+			return true;
+		}
+
+		// Consumer: returns false if empty
+		bool TryPop(T &item)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail == m_head.load(std::memory_order_acquire))
+				return false;
+
+			item = m_items[tail & (kCapacity-1)];
+			m_tail.store(tail+1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Approx. if called while the other side is busy
+		size_t GetSize() const
+		{
+			return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		// Each on it's own cache line so producer & consumer don't fight over it
+		alignas(64) std::atomic<size_t> m_head = 0;
+		alignas(64) std::atomic<size_t> m_tail = 0;
+
+		alignas(64) T m_items[kCapacity];
+	};
+}
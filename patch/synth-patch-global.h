@@ -67,6 +67,9 @@ namespace SFM
 	{
 		// FM operators
 		PatchOperators operators;
+
+		// How operators render band-limited waveforms (PolyBLEP or mipmapped wavetable)
+		Oscillator::RenderMode oscRenderMode;
 		
 		// Voice mode
 		enum VoiceMode
@@ -182,6 +185,14 @@ namespace SFM
 		float postDrivedB;
 		float postWet;
 
+		// PostPass ladder filter model
+		enum PostFilterType
+		{
+			kMOOGPostFilter, // MusicDSP.org MOOG (4X oversampling)
+			kZDFPostFilter,  // Zero-delay feedback ladder (2X oversampling), opt-in
+			kNumPostFilterTypes
+		} postFilterType;
+
 		// Filter envelope
 		Envelope::Parameters filterEnvParams;
 		bool filterEnvInvert;
@@ -235,6 +246,9 @@ namespace SFM
 		{
 			// Reset patch
 			operators.ResetToEngineDefaults();
+
+			// PolyBLEP
+			oscRenderMode = Oscillator::RenderMode::kPolyBLEP;
 			
 			// Polyphonic
 			voiceMode = kPoly;
@@ -334,6 +348,7 @@ namespace SFM
 			postResonance = 0.f;
 			postDrivedB = kDefPostFilterDrivedB;
 			postWet = 0.f;
+			postFilterType = kMOOGPostFilter;
 
 			// Main filter envelope: infinite sustain
 			filterEnvParams.preAttack = 0.f;
@@ -355,6 +370,7 @@ namespace SFM
 			pitchEnvParams.P4 = 0.f;
 			pitchEnvParams.R1 = pitchEnvParams.R2 = pitchEnvParams.R3 = 1.f;
 			pitchEnvParams.L4 = 0.f;
+			pitchEnvParams.globalMul = 1.f; // 1 second
 
 			// Synthesizer sustain type
 			sustainType = kSynthPedal;
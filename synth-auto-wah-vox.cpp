@@ -127,14 +127,14 @@ namespace SFM
 
 			// Calc. vox. LFO A (sample) and B (amplitude)
 			const float voxPhase  = m_voxOscPhase.Sample();
-			const float oscInput  = mt_randfc()*0.995f; // Evade edges
+			const float oscInput  = m_random.NextFloatBipolar()*0.995f; // Evade edges
 			const float voxOsc    = m_voxSandH.Sample(voxPhase, oscInput);
 			const float toLFO     = steepstepf(voxMod);
 			const float voxLFO_A  = lerpf<float>(0.f, voxOsc, toLFO);
 			const float voxLFO_B  = lerpf<float>(1.f, fabsf(voxOsc), toLFO);
 			
 			// Calc. vox. "ghost" noise
-			const float ghostRand = mt_randfc();
+			const float ghostRand = m_random.NextFloatBipolar();
 			const float ghostSig  = ghostRand;
 			const float ghostEnv  = m_voxGhostEnv.Apply(sensEnvGain * voxLFO_B * voxGhost);
 			const float ghost     = ghostSig*ghostEnv;
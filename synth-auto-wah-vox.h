@@ -30,13 +30,14 @@ namespace SFM
 	private:
 
 	public:
-		AutoWah(unsigned sampleRate, unsigned Nyquist) :
+		AutoWah(unsigned sampleRate, unsigned Nyquist, uint64_t randomSeed) :
 			m_sampleRate(sampleRate), m_Nyquist(Nyquist)
 //,			m_RMS(sampleRate, 0.005f)
 ,			m_peak(sampleRate, kMinWahAttack)
 ,			m_gainEnvdB(sampleRate, kInfdB) // In this particular situation starting from (near) silence seems correct
 ,			m_voxSandH(sampleRate)
 ,			m_voxGhostEnv(sampleRate, 0.f)
+,			m_random(randomSeed, kAutoWahRandomStream)
 ,			m_curResonance(0.f, sampleRate, kDefParameterLatency)
 ,			m_curAttack(kDefWahAttack, sampleRate, kDefParameterLatency)
 ,			m_curHold(kDefWahHold, sampleRate, kDefParameterLatency)
@@ -106,6 +107,9 @@ namespace SFM
 
 		Oscillator m_LFO;
 
+		// Vox S&H & ghost noise
+		RandomStream m_random;
+
 		// Interpolated parameters
 		InterpolatedParameter<kLinInterpolate, true> m_curResonance;
 		InterpolatedParameter<kLinInterpolate, true, kMinWahAttack, kMaxWahAttack> m_curAttack;
@@ -28,13 +28,14 @@ namespace SFM
 	{
 	public:
 
-		Compressor(unsigned sampleRate) :
+		Compressor(Arena &arena, unsigned sampleRate) :
 			m_sampleRate(sampleRate)
-,			m_outDelayL(sampleRate, kCompLookaheadMS*0.001f)
-,			m_outDelayR(sampleRate, kCompLookaheadMS*0.001f)
-,			m_RMS(sampleRate, kCompRMSWindowSec)
+,			m_outDelayL(arena, sampleRate, kCompLookaheadMS*0.001f)
+,			m_outDelayR(arena, sampleRate, kCompLookaheadMS*0.001f)
+,			m_RMS(arena, sampleRate, kCompRMSWindowSec)
 ,			m_peak(sampleRate, kMinCompAttack)
 ,			m_gainEnvdB(sampleRate, 0.f /* Unit gain in dB */)
+,			m_autoGainCoeff(expf(-1.f / (sampleRate*kCompAutoGainSlewInSec)))
 ,			m_curThresholddB(kDefCompThresholddB, sampleRate, kDefParameterLatency)
 ,			m_curKneedB(kDefCompKneedB, sampleRate, kDefParameterLatency)
 ,			m_curRatio(kDefCompRatio, sampleRate, kDefParameterLatency)
@@ -42,12 +43,17 @@ namespace SFM
 ,			m_curAttack(kDefCompAttack, sampleRate, kDefParameterLatency)
 ,			m_curRelease(kDefCompRelease, sampleRate, kDefParameterLatency)
 ,			m_curLookahead(0.f, sampleRate, kDefParameterLatency)
-,			m_autoGainCoeff(expf(-1.f / (sampleRate*kCompAutoGainSlewInSec)))
 		{
 		}
 
 		~Compressor() {}
 
+		// Lookahead lines & RMS window
+		static size_t GetArenaSize(unsigned sampleRate)
+		{
+			return 2*DelayLine::GetArenaSize(sampleRate, kCompLookaheadMS*0.001f) + RMS::GetArenaSize(sampleRate, kCompRMSWindowSec);
+		}
+
 		SFM_INLINE void SetParameters(float thresholddB, float kneedB, float ratio, float gaindB, float attack, float release, float lookahead)
 		{
 			SFM_ASSERT(thresholddB >= kMinCompThresholdB && thresholddB <= kMaxCompThresholdB);
@@ -8,6 +8,7 @@
 	- Always write first, then read and write feedback
 	- Read() and ReadNearest() will wrap around
 	- ReadNormalized() reads up to the line's size (i.e. the very last written sample)
+	- DelayLine's buffer comes from an Arena (see helper/synth-arena.h), use GetArenaSize() to account for it
 
 	FIXME: add Catmull-Rom (cubic) interpolation? https://www.kvraudio.com/forum/viewtopic.php?p=7852862#p7852862
 */
@@ -15,28 +16,36 @@
 #pragma once
 
 #include "synth-global.h"
+#include "helper/synth-arena.h"
 
 namespace SFM
 {
 	class DelayLine
 	{
 	public:
-		DelayLine(size_t size) :
+		DelayLine(Arena &arena, size_t size) :
 			m_size(size)
-,			m_buffer((float *) mallocAligned(size * sizeof(float), 16))
+,			m_buffer(arena.AllocateFloats(size))
 ,			m_writeIdx(0)
 ,			m_curSize(size)
 		{
 			Reset();
 		}
 
-		DelayLine(unsigned sampleRate, float lenghtInSec) :
-			DelayLine(size_t(sampleRate*lenghtInSec)) 
+		DelayLine(Arena &arena, unsigned sampleRate, float lenghtInSec) :
+			DelayLine(arena, size_t(sampleRate*lenghtInSec)) 
 		{}
 
-		~DelayLine()
+		~DelayLine() {}
+
+		static size_t GetArenaSize(size_t size)
 		{
-			freeAligned(m_buffer);
+			return Arena::GetFloatsSize(size);
+		}
+
+		static size_t GetArenaSize(unsigned sampleRate, float lenghtInSec)
+		{
+			return GetArenaSize(size_t(sampleRate*lenghtInSec));
 		}
 
 		void Reset()
@@ -99,19 +108,40 @@ namespace SFM
 	};
 
 	// This class is primarily intended to alleviate small latencies (such as correction when using fourth order filters, to name one)
-	// Only accepts sizes that are a power of 2
+	// Latency equals size minus one; buffer (of 'maxSize') comes from an Arena, just like DelayLine's
 	class StereoLatencyDelayLine
 	{
 	public:
-		StereoLatencyDelayLine(size_t size) :
-			m_size(size)
+		StereoLatencyDelayLine(Arena &arena, size_t maxSize) :
+			m_maxSize(maxSize)
+,			m_size(maxSize)
+,			m_buffer(reinterpret_cast<std::array<float, 2> *>(arena.Allocate(maxSize*sizeof(std::array<float, 2>))))
 ,			m_writeIdx(0)
 		{
-			m_buffer.resize(size);
+			Reset();
 		}
 
 		~StereoLatencyDelayLine() {}
 
+		static size_t GetArenaSize(size_t maxSize)
+		{
+			return Arena::Align(maxSize*sizeof(std::array<float, 2>));
+		}
+
+		// Up to 'maxSize', does not allocate
+		void Resize(size_t size)
+		{
+			SFM_ASSERT(size > 0 && size <= m_maxSize);
+			m_size = size;
+			Reset();
+		}
+
+		void Reset()
+		{
+			memset(m_buffer, 0, m_maxSize*sizeof(std::array<float, 2>));
+			m_writeIdx = 0;
+		}
+
 		// Write samples
 		void Write(float left, float right)
 		{
@@ -130,8 +160,9 @@ namespace SFM
 		}
 
 	private:
-		const size_t m_size;
-		std::vector<std::array<float, 2>> m_buffer;
+		const size_t m_maxSize;
+		size_t m_size;
+		std::array<float, 2> *m_buffer;
 		
 		size_t m_writeIdx;
 	};
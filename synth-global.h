@@ -7,8 +7,36 @@
 
 #pragma once
 
-// Include JUCE
-#include <JuceHeader.h>
+// Set to 1 (or pass -DSFM_JUCE_INTEROP=1, see FMBISON_JUCE_INTEROP in CMakeLists.txt) to route assertions and log
+// output through JUCE (jassert() & DBG()); the engine itself does not depend on JUCE
+#ifndef SFM_JUCE_INTEROP
+	#define SFM_JUCE_INTEROP 0
+#endif
+
+#if SFM_JUCE_INTEROP
+	#include <JuceHeader.h>
+#endif
+
+// Standard library (what we used to get through JuceHeader.h)
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #ifndef _DEBUG
 	#ifdef _WIN32
@@ -28,7 +56,11 @@
 	#ifdef _WIN32
 		#define SFM_ASSERT(condition) if (!(condition)) __debugbreak();
 	#else
-		#define SFM_ASSERT(condition) jassert(condition); // FIXME: replace for platform equivalent (see jassert() impl.)
+		#if SFM_JUCE_INTEROP
+			#define SFM_ASSERT(condition) jassert(condition);
+		#else
+			#define SFM_ASSERT(condition) assert(condition);
+		#endif
 	#endif
 #else
 	#define SFM_ASSERT(condition)
@@ -42,7 +74,7 @@
 #define SFM_ASSERT_RANGE(variable, minimum, maximum) SFM_ASSERT(variable >= minimum && variable <= maximum)
 #define SFM_ASSERT_RANGE_BI(variable, range) SFM_ASSERT(variable >= -range && variable <= range)
 
-// Set to 1 to kill all SFM log output
+// Set to 1 to kill all SFM log output (SFM_LOG() compiles to nothing, see helper/synth-log.h)
 #if defined(_DEBUG) && !defined(PROFILE_BUILD)
 	#define SFM_NO_LOGGING 0
 #else
@@ -52,6 +84,15 @@
 // Set to 1 to let FM. BISON handle denormals
 #define SFM_KILL_DENORMALS 1
 
+// Set to 1 to lock (mlock() or VirtualLock()) the arena holding all rate-dependent buffers (see helper/synth-arena.h)
+#define SFM_LOCK_ARENA 0
+
+// Set to 1 (stages) or 2 (stages & per sample kernels) to time the render path, or pass -DSFM_PROFILE=<level> (see
+// FMBISON_PROFILE in CMakeLists.txt); at 0 all instrumentation compiles away (see helper/synth-profile.h)
+#ifndef SFM_PROFILE
+	#define SFM_PROFILE 0
+#endif
+
 // Define to disable all FX (including per-voice filter)
 // #define SFM_DISABLE_FX
 
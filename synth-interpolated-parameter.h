@@ -11,7 +11,8 @@
 	When using kMulInterpolate the target value may never be zero!
 
 	Do *always* call Set() and SetTarget() after calling SetRate() during interpolation to restore the current value
-	and set the new target. This is a small design flaw in juce::SmoothedValue if you ask me.
+	and set the new target. This is a small design flaw in juce::SmoothedValue if you ask me, and SmoothedValue
+	(helper/synth-smoothed-value.h) copies it faithfully so nothing changes sound-wise.
 
 	Like so:
 		const float curValue = interpolator.Get();
@@ -19,27 +20,24 @@
 		interpolator.Set(curValue);
 		interpolator.SetTarget(targetValue);
 
-	I'm not fixing this as long as we use juce::SmoothedValue.
+	Now that it's our own implementation this can be fixed, but that's for another day.
 
 	IMPORTANT: use the clamp feature for values that should *not* go out of range; if a small under- or overshoot is
 	           no problem, please set it to false and save yourself a few branches
 	
 	FIXME: 
-	- Replace JUCE implementation (also in other places where juce::SmoothedValue is used)
-	- Model own implementation after this one
+	- Fix SetRate() quirk (see above) in SmoothedValue
 */
 
 #pragma once
 
-// Include JUCE (for juce::SmoothedValue)
-#include <JuceHeader.h>
-
 #include "synth-global.h"
+#include "helper/synth-smoothed-value.h"
 
 namespace SFM
 {
-	typedef juce::ValueSmoothingTypes::Linear kLinInterpolate;
-	typedef juce::ValueSmoothingTypes::Multiplicative kMulInterpolate; // Target value may *never* be zero!
+	typedef LinearSmoothing kLinInterpolate;
+	typedef MultiplicativeSmoothing kMulInterpolate; // Target value may *never* be zero!
 
 	template <typename T, bool clamp, float minimum = 0.f, float maximum = 1.f> 
 	class InterpolatedParameter
@@ -73,58 +71,59 @@ namespace SFM
 
 		SFM_INLINE float Sample()
 		{
-			const float result = m_value.getNextValue();
-			return (clamp) ? jlimit<float>(minimum, maximum, result) : result;
+			const float result = m_value.Next();
+			return (clamp) ? std::clamp<float>(result, minimum, maximum) : result;
 		}
 
 		SFM_INLINE float Get() const
 		{
-			const float result = m_value.getCurrentValue();
-			return (clamp) ? jlimit<float>(minimum, maximum, result) : result;		}
+			const float result = m_value.GetCurrent();
+			return (clamp) ? std::clamp<float>(result, minimum, maximum) : result;
+		}
 
 		// Set current & target
 		SFM_INLINE void Set(float value)
 		{
-			m_value.setCurrentAndTargetValue(value);
+			m_value.SetCurrentAndTarget(value);
 		}
 
 		// Set target
 		SFM_INLINE void SetTarget(float value)
 		{
-			m_value.setTargetValue(value);
+			m_value.SetTarget(value);
 		}
 		
 		// Get target
 		SFM_INLINE float GetTarget() const
 		{
-			return (float) m_value.getTargetValue();
+			return m_value.GetTarget();
 		}
 
 		// Skip over N samples towards target value
 		SFM_INLINE void Skip(unsigned numSamples)
 		{
-			m_value.skip(numSamples);
+			m_value.Skip(int(numSamples));
 		}
 
 		// Set rate in seconds
 		SFM_INLINE void SetRate(unsigned sampleRate, float time)
 		{
-			m_value.reset(double(sampleRate), double(time));
+			m_value.SetRate(double(sampleRate), double(time));
 		}
 		
 		// Set rate in samples
 		SFM_INLINE void SetRate(unsigned numSamples)
 		{
-			m_value.reset(numSamples);
+			m_value.SetRate(int(numSamples));
 		}
 
 		// Is no longer interpolating
 		SFM_INLINE bool IsDone()
 		{
-			return false == m_value.isSmoothing();
+			return false == m_value.IsSmoothing();
 		}
 
 	private:
-		juce::SmoothedValue<float, T> m_value;
+		SmoothedValue<T> m_value;
 	};
 };
@@ -16,9 +16,9 @@ namespace SFM
 	class RMS
 	{
 	public:
-		RMS(unsigned sampleRate, float lengthInSec /* Window size */) :
+		RMS(Arena &arena, unsigned sampleRate, float lengthInSec /* Window size */) :
 			m_numSamples(unsigned(sampleRate*lengthInSec))
-,			m_line(m_numSamples)
+,			m_line(arena, m_numSamples)
 		{
 			SFM_ASSERT(m_numSamples > 0);
 
@@ -26,6 +26,11 @@ namespace SFM
 		}
 
 		~RMS() {}
+
+		static size_t GetArenaSize(unsigned sampleRate, float lengthInSec)
+		{
+			return DelayLine::GetArenaSize(unsigned(sampleRate*lengthInSec));
+		}
 	
 	private:
 		// Inserts new sample in circular buffer
@@ -0,0 +1,51 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Main (tape) delay.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include "synth-main-delay.h"
+
+namespace SFM
+{
+	size_t MainDelay::GetArenaSize(unsigned sampleRate)
+	{
+		return 3*DelayLine::GetArenaSize(unsigned(sampleRate*kMainDelayLineSize));
+	}
+
+	MainDelay::MainDelay(Arena &arena, unsigned sampleRate, unsigned Nyquist) :
+		m_sampleRate(sampleRate), m_Nyquist(Nyquist)
+,		m_tapeDelayLFO(sampleRate)
+,		m_tapeDelayLPF(kTapeDelayCutHz/sampleRate)
+,		m_delayLineL(arena, unsigned(sampleRate*kMainDelayLineSize))
+,		m_delayLineM(arena, unsigned(sampleRate*kMainDelayLineSize))
+,		m_delayLineR(arena, unsigned(sampleRate*kMainDelayLineSize))
+,		m_curDelayInSec(0.f, sampleRate, kDefParameterLatency * 4.f /* Longer */)
+,		m_curDelayWet(0.f, sampleRate, kDefParameterLatency)
+,		m_curDelayDrive(1.f /* 0dB */, sampleRate, kDefParameterLatency)
+,		m_curDelayFeedback(0.f, sampleRate, kDefParameterLatency)
+,		m_curDelayFeedbackCutoff(1.f, sampleRate, kDefParameterLatency)
+,		m_curDelayTapeWow(0.f, sampleRate, kDefParameterLatency)
+	{
+		// Set tape delay mod. frequency
+		m_tapeDelayLFO.Initialize(kTapeDelayHz, m_sampleRate);
+	}
+
+	void MainDelay::SetParameters(float delayInSec, float wet, float drivedB, float feedback, float feedbackCutoff, float tapeWow)
+	{
+		SFM_ASSERT(delayInSec >= 0.f && delayInSec <= kMainDelayInSec);
+		SFM_ASSERT_NORM(wet);
+		SFM_ASSERT(drivedB >= kMinDelayDrivedB && drivedB <= kMaxDelayDrivedB);
+		SFM_ASSERT_NORM(feedback);
+		SFM_ASSERT_NORM(feedbackCutoff);
+		SFM_ASSERT_NORM(tapeWow);
+
+		m_curDelayInSec.SetTarget(delayInSec);
+		m_curDelayWet.SetTarget(wet);
+		m_curDelayDrive.SetTarget(dB2Lin(drivedB));
+		m_curDelayFeedback.SetTarget(feedback);
+		m_curDelayFeedbackCutoff.SetTarget(feedbackCutoff);
+		m_curDelayTapeWow.SetTarget(tapeWow);
+	}
+}
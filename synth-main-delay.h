@@ -0,0 +1,155 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Main (tape) delay.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Lifted out of PostPass (which runs it per sample, in between chorus/phaser and the oversampled pass) so it
+	can also be used on it's own, as a shared send bus (see synth-rack.h)
+
+	- 3 lines (left, monaural, right) that bleed into each other, filtered feedback & 'tape wow'
+	- All parameters are interpolated per sample
+	- Delay lines come from an Arena, use GetArenaSize() to account for them
+*/
+
+#pragma once
+
+#include "synth-global.h"
+#include "synth-delay-line.h"
+#include "synth-phase.h"
+#include "synth-one-pole-filters.h"
+#include "synth-interpolated-parameter.h"
+#include "synth-stateless-oscillators.h"
+
+namespace SFM
+{
+	// Max. delay feedback (so as not to create an endless loop)
+	constexpr float kMaxDelayFeedback = 0.95f; // Like Ableton does, or so I've been told by Paul
+
+	// Delay line size & cross bleed amount
+	constexpr float kMainDelayLineSize = kMainDelayInSec;
+	constexpr float kDelayCrossbleeding = kGoldenRatio*0.1f; // Arbitrary
+
+	// "Tape delay" constants (for 'wow' effect)
+	constexpr float kTapeDelayHz = kGoldenRatio;
+	constexpr float kTapeDelaySpread = 0.02f;
+	constexpr float kTapeDelayCutHz = 50.f; // Borrowed from PostPass (sweep cutoff), FIXME
+
+	class MainDelay
+	{
+	public:
+		MainDelay(Arena &arena, unsigned sampleRate, unsigned Nyquist);
+
+		~MainDelay() {}
+
+		// Delay lines
+		static size_t GetArenaSize(unsigned sampleRate);
+
+		// Call before processing a block
+		void SetParameters(float delayInSec, float wet, float drivedB, float feedback, float feedbackCutoff, float tapeWow);
+
+		// Output just the delay (dry level is zero), for use as a send bus
+		void SetWetOnly(bool wetOnly)
+		{
+			m_wetOnly = wetOnly;
+		}
+
+		// Process (in place) a single sample
+		SFM_INLINE void Apply(float &left, float &right)
+		{
+			const float monaural = left*0.5f + right*0.5f;
+
+			const float curDelayInSec = m_curDelayInSec.Sample();
+			SFM_ASSERT(curDelayInSec >= 0.f && curDelayInSec <= kMainDelayInSec);
+
+			// Write driven samples to delay line
+			const float drive = m_curDelayDrive.Sample();
+			m_delayLineL.Write(left     * drive);
+			m_delayLineM.Write(monaural * drive);
+			m_delayLineR.Write(right    * drive);
+
+			// Sample delay line
+			const float curDelay   = curDelayInSec/kMainDelayInSec;
+			const float curTapeWow = m_curDelayTapeWow.Sample();
+			const float normDelay  = curDelay + curTapeWow*(curDelay*curDelay)*kTapeDelaySpread*m_tapeDelayLPF.Apply(fast_cosf(m_tapeDelayLFO.Sample()));
+			const float delayedL   = m_delayLineL.ReadNormalized(normDelay);
+			const float delayedM   = m_delayLineM.ReadNormalized(normDelay);
+			const float delayedR   = m_delayLineR.ReadNormalized(normDelay);
+
+			// Bleed delay samples a bit
+			constexpr float crossBleedAmt = kDelayCrossbleeding;
+			constexpr float invCrossBleedAmt = 1.f-crossBleedAmt;
+			const float crossBleed = delayedM;
+			const float delayL = delayedL*invCrossBleedAmt + crossBleed*crossBleedAmt;
+			const float delayR = delayedR*invCrossBleedAmt + crossBleed*crossBleedAmt;
+
+			// Filter delay
+			const float curFc = (m_curDelayFeedbackCutoff.Sample() * m_Nyquist/4)/m_sampleRate; // Limited range gives a more pronounced effect
+			m_delayFeedbackLPF_L.SetCutoff(curFc);
+			m_delayFeedbackLPF_R.SetCutoff(curFc);
+
+			const float filteredL = m_delayFeedbackLPF_L.Apply(delayL);
+			const float filteredR = m_delayFeedbackLPF_R.Apply(delayR);
+
+			const float filteredM = 0.5f*filteredL + 0.5f*filteredR;
+
+			// Feedback
+			const float curFeedback =  m_curDelayFeedback.Sample()*kMaxDelayFeedback;
+			m_delayLineL.WriteFeedback(filteredL, curFeedback);
+			m_delayLineM.WriteFeedback(filteredM, curFeedback);
+			m_delayLineR.WriteFeedback(filteredR, curFeedback);
+
+			// Add delay
+
+//			const float wet = m_curDelayWet.Sample();
+//			left  = left  + wet*delayL;
+//			right = right + wet*delayR;
+
+			// Stereo (width) effect (fixed)
+			// Nicked from synth-reverb.cpp
+			const float wet = m_curDelayWet.Sample();
+			const float dry = (false == m_wetOnly) ? 1.f-wet : 0.f;
+
+			const float width = kGoldenRatio; // FIXME: parameter?
+			const float wet1  = wet*(width*0.5f + 0.5f);
+			const float wet2  = wet*((1.f-width)*0.5f);
+
+//			left  = delayL*wet1 + delayR*wet2 + left*dry;
+//			right = delayR*wet1 + delayL*wet2 + right*dry;
+
+			// To be more like Ableton, we'll use the filtered samples rightaway
+			const float dryL = left, dryR = right;
+			left  = filteredL*wet1 + filteredR*wet2 + dryL*dry;
+			right = filteredR*wet1 + filteredL*wet2 + dryR*dry;
+		}
+
+		// Process (in place) a block
+		void Apply(float *pLeft, float *pRight, unsigned numSamples)
+		{
+			SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				Apply(pLeft[iSample], pRight[iSample]);
+		}
+
+	private:
+		const unsigned m_sampleRate;
+		const unsigned m_Nyquist;
+
+		bool m_wetOnly = false;
+
+		// Delay lines & interpolated parameters
+		Phase m_tapeDelayLFO;
+		SinglePoleLPF m_tapeDelayLPF;
+		DelayLine m_delayLineL;
+		DelayLine m_delayLineM;
+		DelayLine m_delayLineR;
+		CascadedSinglePoleLPF m_delayFeedbackLPF_L, m_delayFeedbackLPF_R;
+		InterpolatedParameter<kLinInterpolate, true, 0.f, kMainDelayInSec> m_curDelayInSec;
+		InterpolatedParameter<kLinInterpolate, true> m_curDelayWet;
+		InterpolatedParameter<kLinInterpolate, false> m_curDelayDrive;
+		InterpolatedParameter<kLinInterpolate, true> m_curDelayFeedback;
+		InterpolatedParameter<kLinInterpolate, true> m_curDelayFeedbackCutoff;
+		InterpolatedParameter<kLinInterpolate, true> m_curDelayTapeWow;
+	};
+}
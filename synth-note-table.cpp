@@ -0,0 +1,289 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Per-key note tables.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include "synth-note-table.h"
+
+namespace SFM
+{
+	/* ----------------------------------------------------------------------------------------------------
+
+		Table
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void NoteTable::Build(const PatchOperators &patchOps)
+	{
+		m_patchOps = patchOps;
+
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+		{
+			const PatchOperators::Operator &patchOp = m_patchOps.operators[iOp];
+			Operator &tableOp = m_operators[iOp];
+
+			tableOp.detuneMul = CalcDetuneMul(patchOp.detune);
+			tableOp.fineMul = powf(2.f, patchOp.fine/12.f);
+
+			for (unsigned key = 0; key < 128; ++key)
+			{
+				tableOp.keyTracking[key] = CalcKeyTracking(key, patchOp);
+				CalcLevelScaling(key, patchOp, tableOp.levelCut[key], tableOp.levelFactor[key], tableOp.levelAmount[key]);
+
+				// Modulator filter doesn't depend on key, so the last one goes
+				SetOperatorFilters(key, m_sampleRate, tableOp.filters[key], tableOp.modFilter, patchOp);
+			}
+		}
+	}
+
+	bool NoteTable::IsCurrent(const PatchOperators &patchOps) const
+	{
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+		{
+			const PatchOperators::Operator &patchOp = patchOps.operators[iOp];
+			const PatchOperators::Operator &tableOp = m_patchOps.operators[iOp];
+
+			// Frequency
+			if (patchOp.fixed != tableOp.fixed || patchOp.coarse != tableOp.coarse || patchOp.fine != tableOp.fine || patchOp.detune != tableOp.detune)
+				return false;
+
+			// Level scaling
+			if (patchOp.levelScaleBP != tableOp.levelScaleBP || patchOp.levelScaleRange != tableOp.levelScaleRange ||
+			    patchOp.levelScaleL != tableOp.levelScaleL || patchOp.levelScaleR != tableOp.levelScaleR ||
+			    patchOp.levelScaleExpL != tableOp.levelScaleExpL || patchOp.levelScaleExpR != tableOp.levelScaleExpR ||
+			    patchOp.cutLeftOfLSBP != tableOp.cutLeftOfLSBP || patchOp.cutRightOfLSBP != tableOp.cutRightOfLSBP)
+				return false;
+
+			// Envelope key tracking
+			if (patchOp.envKeyTrack != tableOp.envKeyTrack || patchOp.acousticEnvKeyTrack != tableOp.acousticEnvKeyTrack)
+				return false;
+
+			// Filters
+			if (patchOp.filterType != tableOp.filterType || patchOp.cutoff != tableOp.cutoff || patchOp.resonance != tableOp.resonance ||
+			    patchOp.cutoffKeyTrack != tableOp.cutoffKeyTrack || patchOp.peakdB != tableOp.peakdB || patchOp.waveform != tableOp.waveform)
+				return false;
+		}
+
+		return true;
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Calculation (moved here from FM_BISON.cpp)
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	// Calc. operator frequency
+	float NoteTable::CalcOpFreq(float fundamentalFreq, float detuneOffs, const PatchOperators::Operator &patchOp)
+	{
+		float frequency;
+		if (true == patchOp.fixed)
+		{
+			frequency = (float) patchOp.coarse;
+			SFM_ASSERT(frequency >= 0.f && frequency <= kMaxFixedHz);
+
+			// Fixed requency does not necessarily have to be below Nyquist
+			// Ratio, fine and detune controls are disabled in VST UI
+		}
+		else
+		{
+			const int   coarse = patchOp.coarse;              // Ratio
+			const int     fine = patchOp.fine;                // Semitones
+			const float detune = patchOp.detune + detuneOffs; // Cents
+
+			SFM_ASSERT(coarse >= kCoarseMin && coarse <= kCoarseMax);
+			SFM_ASSERT(abs(fine) <= kFineRange);
+			SFM_ASSERT(abs(detune) <= kDetuneRange);
+
+			frequency = ScaleOpFreq(fundamentalFreq, CalcDetuneMul(detune), coarse, powf(2.f, fine/12.f));
+		}
+
+		return frequency;
+	}
+
+	// Calc. multiplier for operator amplitude or modulation index
+	float NoteTable::CalcOpLevel(unsigned key, float velocity, const PatchOperators::Operator &patchOp)
+	{
+		bool cut;
+		float factor, amount;
+		CalcLevelScaling(key, patchOp, cut, factor, amount);
+
+		// Return level multiplier!
+		return ScaleOpLevel(velocity, patchOp.velSens, cut, factor, amount);
+	}
+
+	// Apply L/R breakpoint cut & level scaling (subtractive/additive & linear/exponential, like the DX7)
+	// ScaleOpLevel() applies the result to the (velocity) multiplier
+	void NoteTable::CalcLevelScaling(unsigned key, const PatchOperators::Operator &patchOp, bool &cut, float &factor, float &amount)
+	{
+		SFM_ASSERT(key <= 127);
+
+		cut = false;
+		factor = 0.f;
+		amount = 0.f;
+
+		const unsigned breakpoint = patchOp.levelScaleBP;
+
+		if (true == patchOp.cutLeftOfLSBP && true == patchOp.cutRightOfLSBP)
+		{
+			// Range cut
+			const unsigned sides = 127-breakpoint;
+
+			unsigned left = sides/2;
+			const unsigned remainder = left % 12;
+			left += 12-remainder; // Align right to high C note
+
+			const unsigned right = left+breakpoint;
+
+			if (key < left || key > right)
+				cut = true;
+		}
+		else if (true == patchOp.cutLeftOfLSBP && key < breakpoint)
+			// Cut left
+			cut = true;
+		else if (true == patchOp.cutRightOfLSBP && key > breakpoint)
+			// Cut right
+			cut = true;
+
+		// We didn't cut, so apply level scaling as usual
+		if (false == cut)
+		{
+			// Apply level scaling
+			const unsigned numSemis = patchOp.levelScaleRange;
+			if (0 != numSemis)
+			{
+				const bool keyIsLeftOfBP  = key < breakpoint;
+				const bool keyIsRightOfBP = key > breakpoint;
+
+				const float levelStep = 1.f/numSemis;
+
+				int distance = 0;
+				bool isExponential = false;
+
+				if (true == keyIsLeftOfBP)
+				{
+					distance = breakpoint-key;
+					amount = patchOp.levelScaleL;
+					isExponential = patchOp.levelScaleExpL;
+				}
+				else if (true == keyIsRightOfBP)
+				{
+					distance = key-breakpoint;
+					amount = patchOp.levelScaleR;
+					isExponential = patchOp.levelScaleExpR;
+				}
+
+				// Calculate normalized distance from BP
+				distance = std::min<int>(numSemis, abs(distance));
+				const float linear = smoothstepf(distance*levelStep); // This (smoothstep) takes the edges off, results in a smoother glide
+				factor = false == isExponential ? linear : powf(linear, 1.f-linear) /* -EXP/+EXP */;
+
+				// Subtractive as well as additive scaling leave the multiplier (output) on the other side
+				// of the breakpoint intact; this makes it intuitive to use this feature (I think)
+			}
+		}
+	}
+
+	// Returns [-1..1]
+	SFM_INLINE static float CalcOpCutoffKeyTracking(unsigned key, float cutoffKeyTrack)
+	{
+		SFM_ASSERT(key >= 0 && key <= 127);
+		const float normalizedKey = key/127.f;
+
+		/* const */ float tracking = cutoffKeyTrack;
+		SFM_ASSERT_BINORM(tracking);
+
+		return tracking*normalizedKey;
+	}
+
+	// Set up (static) operator filter
+	void NoteTable::SetOperatorFilters(unsigned key, unsigned sampleRate, Biquad &filter, SvfLinearTrapOptimised2 &modFilter, const PatchOperators::Operator &patchOp)
+	{
+		SFM_ASSERT(sampleRate > 0);
+
+		const unsigned Nyquist = sampleRate/2;
+
+//		filter.resetState();    //
+//		filter.reset();         // <- Shouldn't be necessary, as we always initialize it or set it to 'bq_type_none'
+		modFilter.resetState(); //
+
+		const float normQ = patchOp.resonance;
+
+		// Calculate keytracking (only for LPF & HPF)
+		float tracking = -1.f, cutoffNormFrom = -1.f, cutoffNormTo = -1.f;
+
+		if (PatchOperators::Operator::kLowpassFilter == patchOp.filterType || PatchOperators::Operator::kHighpassFilter == patchOp.filterType)
+		{
+			const float cutoffKeyTrack = patchOp.cutoffKeyTrack;
+			tracking = CalcOpCutoffKeyTracking(key, cutoffKeyTrack);
+
+			cutoffNormFrom = patchOp.cutoff;
+			cutoffNormTo = (tracking >= 0.f) ? 1.f : 0.f;
+
+			tracking = fabsf(tracking);
+		}
+
+		float cutoffNorm = -1.f; // Causes assertion if not set for kLowpassFilter/kHighpassFilter
+		const float biQ = 0.01f + 9.99f*normQ; // See Biquad.h
+		switch (patchOp.filterType)
+		{
+		default:
+			SFM_ASSERT(false);
+
+		case PatchOperators::Operator::kNoFilter:
+			filter.setBiquad(bq_type_none, 0.f, 0.f, 0.f);
+			break;
+
+		case PatchOperators::Operator::kLowpassFilter:
+			cutoffNorm = lerpf<float>(cutoffNormFrom, cutoffNormTo, tracking); // Keytrack
+			filter.setBiquad(bq_type_lowpass, BQ_CutoffToHz(cutoffNorm, Nyquist)/sampleRate, biQ, 0.f);
+			break;
+
+		case PatchOperators::Operator::kHighpassFilter:
+			cutoffNorm = lerpf<float>(cutoffNormFrom, 1.f-cutoffNormTo, tracking); // Keytrack
+			filter.setBiquad(bq_type_highpass, BQ_CutoffToHz(cutoffNorm, Nyquist)/sampleRate, biQ, 0.f);
+			break;
+
+		// FIXME: why not track the next ones too?
+		case PatchOperators::Operator::kBandpassFilter:
+			filter.setBiquad(bq_type_bandpass, BQ_CutoffToHz(patchOp.cutoff, Nyquist)/sampleRate, biQ, 0.f);
+			break;
+
+		case PatchOperators::Operator::kPeakFilter:
+			SFM_ASSERT(patchOp.peakdB >= kMinOpFilterPeakdB && patchOp.peakdB <= kMaxOpFilterPeakdB);
+			filter.setBiquad(bq_type_peak, BQ_CutoffToHz(patchOp.cutoff, Nyquist)/sampleRate, biQ, patchOp.peakdB);
+			break;
+		}
+
+		switch (patchOp.waveform)
+		{
+			// These waveforms shall remain unaltered
+			case Oscillator::kSine:
+			case Oscillator::kCosine:
+			case Oscillator::kPolyTriangle:
+			case Oscillator::kSupersaw: // Checked and it's not necessary (though at first I assumed it would be)
+				modFilter.updateNone();
+				break;
+
+			// Filter the remaining waveforms a little to "take the top off"
+			default:
+				modFilter.updateLowpassCoeff(SVF_CutoffToHz(kModulatorLP, Nyquist), kSVFLowestFilterQ, sampleRate);
+				break;
+		}
+	}
+
+	// Calc. tracking (linear or 'acoustically curved')
+	float NoteTable::CalcKeyTracking(unsigned key, const PatchOperators::Operator &patchOp)
+	{
+		SFM_ASSERT(key >= 0 && key <= 127);
+		const float normalizedKey = key/127.f;
+
+		SFM_ASSERT(patchOp.envKeyTrack >= 0.f && patchOp.envKeyTrack <= 1.f);
+
+		return (false == patchOp.acousticEnvKeyTrack)
+			? 1.f - 0.9f*patchOp.envKeyTrack*normalizedKey
+			: AcousticTrackingCurve(normalizedKey, patchOp.envKeyTrack); // See impl. for details
+	}
+}
@@ -0,0 +1,164 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Per-key note tables.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	What voice initialization (and the per-block voice update) calculates for each operator & key that only depends
+	on the patch: frequency ratio, level scaling, envelope key tracking and the operator filters; a 32-note chord
+	landing in one block used to mean hundreds of powf() & tanf() calls, now it's mostly table reads
+
+	- Build() does all operators & keys (not real-time safe, but quick), Bison has it's worker thread do that
+	  whenever IsCurrent() says the patch has moved on (see Bison::UpdateNoteTable())
+	- The static Calc*() functions calculate the same thing on the spot, for when there's no current table; both
+	  paths use the exact same arithmetic, so output is bit-identical either way
+	- Velocity & detune jitter are applied on lookup, as they're not known up front
+
+	FIXME:
+		- Continuously automating a key related parameter (say an operator's cutoff) keeps the table stale, which
+		  is no worse than before but buys nothing either
+*/
+
+#pragma once
+
+#include "3rdparty/filters/SvfLinearTrapOptimised2.hpp"
+#include "3rdparty/filters/Biquad.h"
+
+#include "synth-global.h"
+#include "patch/synth-patch-global.h"
+
+namespace SFM
+{
+	class NoteTable
+	{
+	public:
+		NoteTable(unsigned sampleRate) :
+			m_sampleRate(sampleRate) {}
+
+		// Calculates everything for all operators & keys
+		void Build(const PatchOperators &patchOps);
+
+		// Built from the same key related parameters?
+		bool IsCurrent(const PatchOperators &patchOps) const;
+
+		// Lookups (table must be current)
+		SFM_INLINE float GetOpFreq(unsigned iOp, float fundamentalFreq, float detuneOffs) const
+		{
+			SFM_ASSERT(iOp < kNumOperators);
+
+			const PatchOperators::Operator &patchOp = m_patchOps.operators[iOp];
+			if (true == patchOp.fixed)
+				return float(patchOp.coarse);
+
+			// Detune jitter (see Bison::InitializeVoice()) is the exception
+			const Operator &tableOp = m_operators[iOp];
+			const float detuneMul = (0.f == detuneOffs) ? tableOp.detuneMul : CalcDetuneMul(patchOp.detune + detuneOffs);
+
+			return ScaleOpFreq(fundamentalFreq, detuneMul, patchOp.coarse, tableOp.fineMul);
+		}
+
+		SFM_INLINE float GetOpLevel(unsigned iOp, unsigned key, float velocity, float velSens) const
+		{
+			SFM_ASSERT(iOp < kNumOperators && key <= 127);
+
+			const Operator &tableOp = m_operators[iOp];
+			return ScaleOpLevel(velocity, velSens, tableOp.levelCut[key], tableOp.levelFactor[key], tableOp.levelAmount[key]);
+		}
+
+		SFM_INLINE void SetOperatorFilters(unsigned iOp, unsigned key, Biquad &filter, SvfLinearTrapOptimised2 &modFilter) const
+		{
+			SFM_ASSERT(iOp < kNumOperators && key <= 127);
+
+			const Operator &tableOp = m_operators[iOp];
+			filter = tableOp.filters[key];
+			modFilter = tableOp.modFilter;
+		}
+
+		SFM_INLINE float GetKeyTracking(unsigned iOp, unsigned key) const
+		{
+			SFM_ASSERT(iOp < kNumOperators && key <= 127);
+			return m_operators[iOp].keyTracking[key];
+		}
+
+		// Same, calculated on the spot
+		static float CalcOpFreq(float fundamentalFreq, float detuneOffs, const PatchOperators::Operator &patchOp);
+		static float CalcOpLevel(unsigned key, float velocity, const PatchOperators::Operator &patchOp);
+		static void SetOperatorFilters(unsigned key, unsigned sampleRate, Biquad &filter, SvfLinearTrapOptimised2 &modFilter, const PatchOperators::Operator &patchOp);
+		static float CalcKeyTracking(unsigned key, const PatchOperators::Operator &patchOp);
+
+	private:
+		// Level scaling for a single key (see CalcOpLevel())
+		static void CalcLevelScaling(unsigned key, const PatchOperators::Operator &patchOp, bool &cut, float &factor, float &amount);
+
+		SFM_INLINE static float CalcDetuneMul(float detune /* Cents */)
+		{
+			return powf(2.f, (detune*0.01f)/12.f);
+		}
+
+		// Ratio mode
+		SFM_INLINE static float ScaleOpFreq(float frequency, float detuneMul, int coarse, float fineMul)
+		{
+			frequency *= detuneMul;
+
+			if (coarse < 0)
+				frequency /= abs(coarse-1);
+			else if (coarse > 1)
+				frequency *= coarse;
+
+			frequency *= fineMul;
+
+			return frequency;
+		}
+
+		SFM_INLINE static float ScaleOpLevel(float velocity, float velSens, bool cut, float factor, float amount)
+		{
+			float multiplier = 1.f;
+
+			// Factor in velocity
+			const float velPow = velocity*velocity;
+			multiplier = lerpf<float>(multiplier, multiplier*velPow, velSens);
+
+			// Cut by breakpoint?
+			if (true == cut)
+				multiplier = 0.f;
+
+			if (0.f != multiplier)
+			{
+				if (amount < 0.f)
+					// Fade out by gradually interpolating towards lower level
+					multiplier = lerpf<float>(multiplier, multiplier*(1.f-fabsf(amount)), factor);
+				else if (amount > 0.f)
+					// Fade in by adding to set level
+					multiplier = lerpf<float>(multiplier, std::min<float>(1.f, multiplier+fabsf(amount)), factor);
+			}
+
+			SFM_ASSERT(multiplier >= 0.f && multiplier <= 1.f);
+
+			return multiplier;
+		}
+
+		// Per operator
+		struct Operator
+		{
+			// Frequency ratio (see CalcOpFreq())
+			float detuneMul;
+			float fineMul;
+
+			SvfLinearTrapOptimised2 modFilter;
+
+			// Per key
+			float keyTracking[128];
+			float levelFactor[128];
+			float levelAmount[128];
+			bool levelCut[128];
+			Biquad filters[128];
+		};
+
+		const unsigned m_sampleRate;
+
+		// Copy of what it was built from
+		PatchOperators m_patchOps;
+
+		Operator m_operators[kNumOperators];
+	};
+}
@@ -10,39 +10,86 @@
 
 namespace SFM
 {
-	void Oscillator::Initialize(Waveform form, float frequency, unsigned sampleRate, float phaseShift, float supersawDetune /* = 0.f */, float supersawMix /* = 0.f */)
+	constexpr float kDefaultDuty = 0.25f; // FIXME: parameter?
+
+	/*
+		Wavetables for band-limited waveforms, kPolyTriangle up to and including kBump
+	*/
+
+	constexpr unsigned kNumWavetables = Oscillator::kBump-Oscillator::kPolyTriangle+1;
+	static Wavetable s_wavetables[kNumWavetables];
+
+	/* static */ void Oscillator::CalculateWavetables()
+	{
+		// The PolyBLEP functions at a negligible pitch give us the naive waveforms, with discontinuities
+		// sampled halfway, and a guarantee that both render modes line up (phase & amplitude)
+		constexpr float pitch = 1e-7f;
+
+		s_wavetables[kPolyTriangle-kPolyTriangle].Calculate([](float phase) { return oscPolyTriangle(phase, pitch); });
+		s_wavetables[kPolySquare-kPolyTriangle].Calculate([](float phase) { return oscPolySquare(phase, pitch); });
+		s_wavetables[kPolySaw-kPolyTriangle].Calculate([](float phase) { return oscPolySaw(phase, pitch); });
+		s_wavetables[kPolyRamp-kPolyTriangle].Calculate([](float phase) { return oscPolyRamp(phase, pitch); });
+		s_wavetables[kPolyRectifiedSine-kPolyTriangle].Calculate([](float phase) { return oscPolyRectifiedSine(phase, pitch); });
+		s_wavetables[kPolyRectangle-kPolyTriangle].Calculate([](float phase) { return oscPolyRectangle(phase, pitch, kDefaultDuty); });
+		s_wavetables[kBump-kPolyTriangle].Calculate([](float phase) { return Squarepusher(oscSine(phase), 0.3f); });
+	}
+
+	/* static */ const Wavetable *Oscillator::GetWavetable(Waveform form, RenderMode mode)
+	{
+		if (kWavetable == mode && form >= kPolyTriangle && form <= kBump)
+			return &s_wavetables[form-kPolyTriangle];
+
+		return nullptr;
+	}
+
+	void Oscillator::Initialize(Waveform form, float frequency, unsigned sampleRate, float phaseShift, float supersawDetune /* = 0.f */, float supersawMix /* = 0.f */, uint64_t clock /* = 0 */)
 	{
 		switch (form)
 		{
 		case kWhiteNoise:
+			m_state.emplace<std::monostate>();
 			m_phase.Initialize(1.f, sampleRate);
 			break;
 
 		case kPinkNoise:
-			m_pinkNoise = PinkNoise();
+			m_state.emplace<PinkNoise>();
 			m_phase.Initialize(1.f, sampleRate);
 			break;
 
 		case kSupersaw:
-			m_supersaw.Initialize(frequency, sampleRate, supersawDetune, supersawMix);
+			SFM_ASSERT(nullptr != m_pSupersaw);
+
+			// Keep (free running) phases if it already was one, but bring them up to date first
+			if (kSupersaw != m_form)
+			{
+				SFM_ASSERT(nullptr != m_pRandom);
+				*m_pSupersaw = Supersaw(clock, *m_pRandom);
+			}
+			else
+				m_pSupersaw->CatchUp(clock);
+
+			m_pSupersaw->Initialize(frequency, sampleRate, supersawDetune, supersawMix);
+			m_state.emplace<std::monostate>();
 			break;
 
 		case kSampleAndHold:
-			m_sampleAndHold = SampleAndHold(sampleRate);
+			m_state.emplace<SampleAndHold>(sampleRate);
+			m_phase.Initialize(frequency, sampleRate, phaseShift);
+			break;
 
 		default:
+			m_state.emplace<std::monostate>();
 			m_phase.Initialize(frequency, sampleRate, phaseShift);
 		}		
 
 		m_form = form;
+		m_pWavetable = GetWavetable(form, m_renderMode);
 	}
 
 	float Oscillator::Sample(float phaseShift)
 	{
 		SFM_ASSERT(phaseShift >= 0.f);
 
-		constexpr float defaultDuty = 0.25f; // FIXME: parameter?
-		
 		// These calls are unnecessary for a few waveforms, but as far as they don't show up in a profiler I'll let them be
 		const float phase = m_phase.Sample();
 		const float pitch = m_phase.GetPitch(); // For PolyBLEP
@@ -50,6 +97,13 @@ namespace SFM
 		const float modulated = (0.f == phaseShift) // Not calling fmodf() certainly warrants a comparison and branch
 			? phase // Gauranteed to be [0..1]
 			: fmodf(phase+phaseShift, 1.f);
+
+		if (nullptr != m_pWavetable)
+		{
+			// Band-limited waveform from wavetable (see SetRenderMode())
+			m_signal = m_pWavetable->Sample(modulated, pitch);
+			return m_signal;
+		}
 		
 		// Calculate signal (switch statement has never shown up during profiling)
 		float signal = 0.f;
@@ -62,7 +116,7 @@ namespace SFM
 			/* Supersaw */
 
 			case kSupersaw:
-				signal = m_supersaw.Sample();
+				signal = GetSupersawState().Sample();
 				break;
 
 			/* Band-limited (DCO/LFO) */
@@ -96,7 +150,7 @@ namespace SFM
 				break;
 
 			case kPolyRectangle:
-				signal = oscPolyRectangle(modulated, pitch, defaultDuty);
+				signal = oscPolyRectangle(modulated, pitch, kDefaultDuty);
 				break;
 
 			case kBump:
@@ -128,11 +182,13 @@ namespace SFM
 			/* Noise */
 			
 			case kWhiteNoise:
-				signal = oscWhiteNoise();
+				SFM_ASSERT(nullptr != m_pRandom);
+				signal = oscWhiteNoise(*m_pRandom);
 				break;
 			
 			case kPinkNoise:
-				signal = m_pinkNoise.Sample();
+				SFM_ASSERT(nullptr != m_pRandom);
+				signal = std::get_if<PinkNoise>(&m_state)->Sample(oscWhiteNoise(*m_pRandom));
 				break;
 
 			/* See synth-oscillator.h */
@@ -168,22 +224,23 @@ namespace SFM
 				break;
 
 			case kPulse:
-				signal = oscPulse(modulated, defaultDuty);
+				signal = oscPulse(modulated, kDefaultDuty);
 				break;
 
 			/* S&H */
 
 			case kSampleAndHold:
 				{
-					const float random = oscWhiteNoise();
-					signal = m_sampleAndHold.Sample(modulated, random);
+					SFM_ASSERT(nullptr != m_pRandom);
+					const float random = oscWhiteNoise(*m_pRandom);
+					signal = std::get_if<SampleAndHold>(&m_state)->Sample(modulated, random);
 				}
 
 				break;
 			
 			// Not implemented
 			default:
-				signal = oscWhiteNoise();
+				signal = 0.f;
 				SFM_ASSERT(false);
 				break;
 		}
@@ -194,4 +251,73 @@ namespace SFM
 		m_signal = signal;
 		return signal;
 	}
+
+	void Oscillator::Sample(float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pDest);
+
+		// Band-limited waveforms are rendered from a phase ramp (in place), the rest is cheap or stateful so one by one will do
+		const bool isBandLimited = nullptr != m_pWavetable || (m_form >= kSine && m_form <= kPolyRectangle);
+		if (false == isBandLimited)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pDest[iSample] = Sample(0.f);
+
+			return;
+		}
+
+		if (0 == numSamples)
+			return;
+
+		const float pitch = m_phase.GetPitch(); // For PolyBLEP & wavetable
+		m_phase.Sample(pDest, numSamples);
+
+		if (nullptr != m_pWavetable)
+		{
+			m_pWavetable->Sample(pDest, pitch, pDest, numSamples);
+		}
+		else
+		{
+			switch (m_form)
+			{
+			case kSine:
+				fast_sinf(pDest, pDest, numSamples);
+				break;
+
+			case kCosine:
+				fast_cosf(pDest, pDest, numSamples);
+				break;
+
+			case kPolyTriangle:
+				oscPolyTriangle(pDest, pitch, pDest, numSamples);
+				break;
+
+			case kPolySquare:
+				oscPolySquare(pDest, pitch, pDest, numSamples);
+				break;
+
+			case kPolySaw:
+				oscPolySaw(pDest, pitch, pDest, numSamples);
+				break;
+
+			case kPolyRamp:
+				oscPolyRamp(pDest, pitch, pDest, numSamples);
+				break;
+
+			case kPolyRectifiedSine:
+				oscPolyRectifiedSine(pDest, pitch, pDest, numSamples);
+				break;
+
+			case kPolyRectangle:
+				oscPolyRectangle(pDest, pitch, kDefaultDuty, pDest, numSamples);
+				break;
+
+			default:
+				SFM_ASSERT(false);
+				break;
+			}
+		}
+
+		m_signal = pDest[numSamples-1];
+	}
 }
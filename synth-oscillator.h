@@ -4,9 +4,15 @@
 	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 
+	- State specific to a waveform (pink noise, S&H) lives in a variant so that only the waveform in use
+	  takes up space; there are a lot of these (3 LFOs & 6 operators per voice) so this matters for the cache
+	- The supersaw's state (8 SIMD lanes) is too large for that, so it lives in a slot handed to the oscillator by
+	  it's owner, only operators get one (see SetSupersawState() & Bison::GrowVoicePool())
+	- Band-limited waveforms (except sine & cosine) can be rendered from mipmapped wavetables instead (see SetRenderMode())
+	- Without phase shift a block can be rendered at once, which is 4 samples at a time (SSE) for the band-limited
+	  waveforms (see Sample(float *, unsigned))
+
 	FIXME:
-		- I'm not happy about Oscillator containing specific state and multiple phase objects just to
-		  support a handful of special cases
 		- https://github.com/bipolaraudio/FM-BISON/issues/84
 */
 
@@ -15,12 +21,15 @@
 #pragma warning(push)
 #pragma warning(disable: 4324) // Tell MSVC to shut it about padding I'm aware of
 
+#include <variant>
+
 #include "synth-global.h"
 #include "synth-phase.h"
 #include "synth-stateless-oscillators.h"
 #include "synth-pink-noise.h"
 #include "synth-sample-and-hold.h"
 #include "synth-supersaw.h"
+#include "synth-wavetable.h"
 
 namespace SFM
 {
@@ -68,33 +77,89 @@ namespace SFM
 			kSampleAndHold
 		};
 
+		// How to render band-limited waveforms
+		enum RenderMode
+		{
+			kPolyBLEP, // Per sample (see synth-stateless-oscillators.h)
+			kWavetable // Mipmapped wavetable (see synth-wavetable.h), if available for waveform
+		};
+
 	private:
 		/* const */ Waveform m_form;
 		Phase m_phase;
 
-		// Autonomous oscillators
-		PinkNoise     m_pinkNoise;
-		SampleAndHold m_sampleAndHold;
-		Supersaw      m_supersaw;
+		// Autonomous oscillators (only the one matching m_form is alive)
+		std::variant<std::monostate, PinkNoise, SampleAndHold> m_state;
+
+		// Supersaw slot (see SetSupersawState())
+		Supersaw *m_pSupersaw = nullptr;
+
+		// For noise, S&H & supersaw phases (see SetRandomStream())
+		RandomStream *m_pRandom = nullptr;
+
+		// Wavetable (if rendered from one, see SetRenderMode())
+		RenderMode m_renderMode = kPolyBLEP;
+		const Wavetable *m_pWavetable = nullptr;
 
 		// Signal
 		float m_signal = 0.f;
 
+		static const Wavetable *GetWavetable(Waveform form, RenderMode mode);
+
+		SFM_INLINE Supersaw &GetSupersawState()
+		{
+			SFM_ASSERT(kSupersaw == m_form && nullptr != m_pSupersaw);
+			return *m_pSupersaw;
+		}
+
+		SFM_INLINE const Supersaw &GetSupersawState() const
+		{
+			SFM_ASSERT(kSupersaw == m_form && nullptr != m_pSupersaw);
+			return *m_pSupersaw;
+		}
+
 	public:
-		Oscillator(unsigned sampleRate = 1) :
-			m_sampleAndHold(sampleRate)
+		Oscillator(unsigned sampleRate = 1)
 		{
 			Initialize(kNone, 0.f, sampleRate, 0.0);
 		}
 
-		void Initialize(Waveform form, float frequency, unsigned sampleRate, float phaseShift, float supersawDetune = 0.f, float supersawMix = 0.f);
+		// Call once before using kWavetable (see Bison::Bison())
+		static void CalculateWavetables();
+
+		// For kSupersaw pass the current sample clock (see synth-supersaw.h)
+		void Initialize(Waveform form, float frequency, unsigned sampleRate, float phaseShift, float supersawDetune = 0.f, float supersawMix = 0.f, uint64_t clock = 0);
+
+		// Required for kWhiteNoise, kPinkNoise, kSampleAndHold & kSupersaw; set it before Initialize() (typically the voice's stream)
+		SFM_INLINE void SetRandomStream(RandomStream *pRandom)
+		{
+			m_pRandom = pRandom;
+		}
+
+		// Required for kSupersaw; set it before Initialize() (typically the operator's slot in the voice pool)
+		SFM_INLINE void SetSupersawState(Supersaw *pState)
+		{
+			m_pSupersaw = pState;
+		}
+
+		// Sticks until changed, so set it before Initialize() to be sure
+		SFM_INLINE void SetRenderMode(RenderMode mode)
+		{
+			m_renderMode = mode;
+			m_pWavetable = GetWavetable(m_form, mode);
+		}
+
+		SFM_INLINE RenderMode GetRenderMode() const
+		{
+			return m_renderMode;
+		}
 
 		SFM_INLINE void PitchBend(float bend)
 		{
 			if (kSupersaw != m_form)
 				m_phase.PitchBend(bend);
 			else
-				m_supersaw.PitchBend(bend);
+				GetSupersawState().PitchBend(bend);
 		}
 
 		SFM_INLINE void SetFrequency(float frequency)
@@ -120,7 +185,7 @@ namespace SFM
 		{ 
 			return (m_form != kSupersaw)
 				? m_phase.GetFrequency()
-				: m_supersaw.GetFrequency();
+				: GetSupersawState().GetFrequency();
 		}
 
 		// Useless for kPinkNoise & kWhiteNoise (but allowed)
@@ -128,22 +193,33 @@ namespace SFM
 		{
 			return (m_form != kSupersaw)
 				? m_phase.Get()
-				: m_supersaw.GetPhase();
+				: GetSupersawState().GetPhase();
 		} 
 		
-		// S&H
+		// S&H (ignored if not kSampleAndHold)
 		SFM_INLINE void SetSampleAndHoldSlewRate(float rate)
 		{
-			m_sampleAndHold.SetSlewRate(rate);
+			SampleAndHold *pSampleAndHold = std::get_if<SampleAndHold>(&m_state);
+			if (nullptr != pSampleAndHold)
+				pSampleAndHold->SetSlewRate(rate);
 		}
 
-		// Supersaw
-		SFM_INLINE Supersaw &GetSupersaw()
+		// Supersaw (nullptr if not kSupersaw)
+		SFM_INLINE Supersaw *GetSupersaw()
 		{
-			return m_supersaw;
+			return (kSupersaw == m_form) ? m_pSupersaw : nullptr;
+		}
+
+		// Draws from the random stream (see SetRandomStream()), so rendering ahead would change the order of draws
+		SFM_INLINE bool UsesRandomStream() const
+		{
+			return kWhiteNoise == m_form || kPinkNoise == m_form || kSampleAndHold == m_form || kSupersaw == m_form;
 		}
 
 		float Sample(float phaseShift);
+
+		// Renders 'numSamples' without phase shift (for LFOs), identical to calling Sample(0.f) that many times
+		void Sample(float *pDest, unsigned numSamples);
 	};
 }
 
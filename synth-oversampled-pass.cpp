@@ -0,0 +1,215 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Oversampled pass: tube distortion & 24dB post filter.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include "synth-oversampled-pass.h"
+#include "synth-distort.h"
+
+namespace SFM
+{
+	// Tube tone LPF Qs
+	constexpr float kTubeToneFlatQ = 0.f;
+	constexpr float kTubeToneColorQ = kGoldenRatio*0.0628f;
+
+	// Tube tone LPF cutoff is limited to a fraction of the (oversampled) rate, at 1X Nyquist would blow it up
+	constexpr float kTubeToneMaxCutoffRatio = 0.45f;
+
+	OversampledPass::OversampledPass(Arena &arena, unsigned sampleRate, unsigned Nyquist, unsigned maxSamplesPerBlock, unsigned factor) :
+		m_sampleRate(sampleRate), m_Nyquist(Nyquist), m_factor(factor), m_overSampleRate(sampleRate*factor)
+
+		// Oversampling (1X means none)
+,		m_oversampler(arena, factor, maxSamplesPerBlock)
+,		m_compensation(arena, kOversamplerMaxLatency+1)
+
+		// Post filter
+,		m_postFilterMOOG(m_overSampleRate)
+,		m_postFilterZDF(m_overSampleRate)
+,		m_curPostModel(0.f, m_overSampleRate, kDefParameterLatency)
+,		m_curPostCutoff(0.f, m_overSampleRate, kDefParameterLatency * 2.f /* Longer */)
+,		m_curPostReso(0.f, m_overSampleRate, kDefParameterLatency)
+,		m_curPostDrive(0.f, m_overSampleRate, kDefParameterLatency)
+,		m_curPostWet(0.f, m_overSampleRate, kDefParameterLatency)
+
+		// Tube distort
+,		m_curTubeDist(0.f, m_overSampleRate, kDefParameterLatency)
+,		m_curTubeDrive(kDefTubeDrive, m_overSampleRate, kDefParameterLatency)
+,		m_curTubeOffset(0.f, m_overSampleRate, kDefParameterLatency)
+,		m_curTubeTone(kDefTubeTone, m_overSampleRate, kDefParameterLatency)
+,		m_tubeToneQ(SVF_ResoToQ(kTubeToneFlatQ))
+	{
+	}
+
+	void OversampledPass::SetLatencyCompensation(unsigned numSamples)
+	{
+		SFM_ASSERT(numSamples <= kOversamplerMaxLatency);
+
+		m_compensationSize = numSamples;
+		m_compensation.Resize(numSamples+1);
+	}
+
+	void OversampledPass::SetParameters(float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
+	                                    float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso)
+	{
+		SFM_ASSERT_NORM(postCutoff);
+		SFM_ASSERT_NORM(postReso);
+		SFM_ASSERT(postDrivedB >= kMinPostFilterDrivedB && postDrivedB <= kMaxPostFilterDrivedB);
+		SFM_ASSERT_NORM(postWet);
+		SFM_ASSERT_NORM(tubeDistort);
+		SFM_ASSERT(tubeDrive >= kMinTubeDrive && tubeDrive <= kMaxTubeDrive);
+		SFM_ASSERT(tubeOffset >= kMinTubeOffset && tubeOffset <= kMaxTubeOffset);
+		SFM_ASSERT_NORM(tubeTone);
+
+		// Switch filter model: the one that's faded in starts off clean
+		if (postZDF != m_postZDF)
+		{
+			m_postZDF = postZDF;
+
+			if (true == postZDF && 0.f == m_curPostModel.Get())
+				m_postFilterZDF.Reset();
+			else if (false == postZDF && 1.f == m_curPostModel.Get())
+				m_postFilterMOOG.Reset();
+
+			m_curPostModel.SetTarget(true == postZDF ? 1.f : 0.f);
+		}
+
+		// Set post filter parameters
+		m_curPostCutoff.SetTarget(postCutoff);
+		m_curPostReso.SetTarget(postReso);
+		m_curPostDrive.SetTarget(dBToGain(postDrivedB));
+		m_curPostWet.SetTarget(postWet);
+
+		// Set tube distortion parameters
+		m_curTubeDist.SetTarget(tubeDistort);
+		m_curTubeDrive.SetTarget(tubeDrive);
+		m_curTubeOffset.SetTarget(tubeOffset);
+		m_curTubeTone.SetTarget(tubeTone);
+
+		m_tubeToneQ = SVF_ResoToQ(tubeToneReso ? kTubeToneColorQ : kTubeToneFlatQ);
+	}
+
+	void OversampledPass::Reset()
+	{
+		m_oversampler.Reset();
+		m_compensation.Reset();
+
+		m_postFilterMOOG.Reset();
+		m_postFilterZDF.Reset();
+
+		m_tubeToneFilter.resetState();
+		m_tubeDCBlocker = StereoDCBlocker();
+
+		m_curPostModel.Set(m_curPostModel.GetTarget());
+		m_curPostCutoff.Set(m_curPostCutoff.GetTarget());
+		m_curPostReso.Set(m_curPostReso.GetTarget());
+		m_curPostDrive.Set(m_curPostDrive.GetTarget());
+		m_curPostWet.Set(m_curPostWet.GetTarget());
+		m_curTubeDist.Set(m_curTubeDist.GetTarget());
+		m_curTubeDrive.Set(m_curTubeDrive.GetTarget());
+		m_curTubeOffset.Set(m_curTubeOffset.GetTarget());
+		m_curTubeTone.Set(m_curTubeTone.GetTarget());
+	}
+
+	void OversampledPass::Apply(float *pLeft, float *pRight, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+		SFM_ASSERT(numSamples > 0);
+
+		// Oversample (at 1X we simply work in place)
+		float *pOverL = pLeft, *pOverR = pRight;
+		if (m_factor > 1)
+		{
+			m_oversampler.Upsample(pLeft, pRight, numSamples);
+			pOverL = m_oversampler.GetBufferL();
+			pOverR = m_oversampler.GetBufferR();
+		}
+
+		const unsigned numOversamples = numSamples*m_factor;
+
+		const float maxToneHz = m_overSampleRate*kTubeToneMaxCutoffRatio;
+
+		for (unsigned iSample = 0; iSample < numOversamples; ++iSample)
+		{
+			float sampleL = pOverL[iSample];
+			float sampleR = pOverR[iSample];
+
+			// Apply (non-linear) distortion
+			const float amount = m_curTubeDist.Sample();
+			const float drive  = m_curTubeDrive.Sample();
+			const float offset = m_curTubeOffset.Sample();
+			const float tone   = m_curTubeTone.Sample();
+
+			// Apply (soft) clipping
+			const float driveAdj = drive/kMaxTubeDrive; // Normalized
+			float distortedL = Squarepusher(offset+sampleL, driveAdj);
+			float distortedR = Squarepusher(offset+sampleR, driveAdj);
+
+			// Apply tone filter (resonant LPF)
+			m_tubeToneFilter.updateLowpassCoeff(std::min<float>(maxToneHz, SVF_CutoffToHz(tone, m_Nyquist)), m_tubeToneQ, m_overSampleRate);
+			m_tubeToneFilter.tick(distortedL, distortedR);
+
+			// Remove possible DC offset
+			m_tubeDCBlocker.Apply(distortedL, distortedR);
+
+			// Add to signal
+			float postDistortedL = sampleL + distortedL*amount; // lerpf<float>(sampleL, distortedL, smoothstepped);
+			float postDistortedR = sampleR + distortedR*amount; // lerpf<float>(sampleR, distortedR, smoothstepped);
+
+			// Apply 24dB post filter
+			const float curPostModel  = m_curPostModel.Sample();
+			const float curPostCutoff = m_curPostCutoff.Sample();
+			const float curPostReso   = m_curPostReso.Sample();
+			const float curPostDrive  = m_curPostDrive.Sample();
+			const float curPostWet    = m_curPostWet.Sample();
+
+			const float cutoffHz = kMinPostFilterCutoffHz + curPostCutoff*kPostFilterCutoffRange;
+
+			// Apply filter(s), only both when crossfading between models
+			float filteredL = postDistortedL, filteredR = postDistortedR;
+
+			if (curPostModel < 1.f)
+			{
+				m_postFilterMOOG.SetParameters(cutoffHz, curPostReso /* [0..1] */, curPostDrive);
+				m_postFilterMOOG.Apply(filteredL, filteredR);
+			}
+
+			if (curPostModel > 0.f)
+			{
+				float ladderL = postDistortedL, ladderR = postDistortedR;
+
+				// Only recalculates coefficients if necessary
+				m_postFilterZDF.SetParameters(cutoffHz, curPostReso /* [0..1] */, curPostDrive);
+				m_postFilterZDF.Apply(ladderL, ladderR);
+
+				filteredL = lerpf<float>(filteredL, ladderL, curPostModel);
+				filteredR = lerpf<float>(filteredR, ladderR, curPostModel);
+			}
+
+			// Blend
+			sampleL = lerpf<float>(postDistortedL, filteredL, curPostWet);
+			sampleR = lerpf<float>(postDistortedR, filteredR, curPostWet);
+
+			// Write
+			pOverL[iSample] = sampleL;
+			pOverR[iSample] = sampleR;
+		}
+
+		// Downsample result
+		m_oversampler.Downsample(pLeft, pRight, numSamples);
+
+		// Line up with slowest factor
+		if (0 != m_compensationSize)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				m_compensation.Write(pLeft[iSample], pRight[iSample]);
+
+				const auto &delayed = m_compensation.Read();
+				pLeft[iSample]  = delayed[0];
+				pRight[iSample] = delayed[1];
+			}
+		}
+	}
+}
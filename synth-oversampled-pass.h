@@ -0,0 +1,116 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Oversampled pass: tube distortion & 24dB post filter.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Chopped out of PostPass::Apply() so that PostPass can keep one of these per oversampling factor (1X, 2X or 4X)
+	and crossfade between them; to make that possible each instance can be padded with a latency compensation delay
+	so that all of them line up with the slowest one
+
+	Switching between the MOOG and ZDF filter model is crossfaded as well (internally)
+
+	Up- and downsampling is done by Oversampler (synth-oversampler.h), which like the compensation delay gets it's
+	buffers from the arena
+*/
+
+#pragma once
+
+#include "3rdparty/filters/SvfLinearTrapOptimised2.hpp"
+#include "3rdparty/filters/MusicDSPModel.h"
+
+#include "synth-global.h"
+#include "synth-oversampler.h"
+#include "synth-delay-line.h"
+#include "synth-one-pole-filters.h"
+#include "synth-interpolated-parameter.h"
+#include "synth-ladder-filter.h"
+
+namespace SFM
+{
+	// Minimum (oversampled) sample rates required to keep aliasing at bay
+	constexpr unsigned kLightOversampledRate = 88200;  // ZDF ladder and/or mild tube distortion
+	constexpr unsigned kHeavyOversampledRate = 176400; // MOOG ladder and/or heavy tube distortion
+
+	// Tube distortion (amount times normalized drive) from which on it's considered heavy
+	constexpr float kHeavyTubeDistortion = 0.2f;
+
+	// Supported factors: 1X, 2X & 4X
+	constexpr unsigned kNumOversamplingFactors = 3;
+
+	class OversampledPass
+	{
+	public:
+		OversampledPass(Arena &arena, unsigned sampleRate, unsigned Nyquist, unsigned maxSamplesPerBlock, unsigned factor /* 1, 2 or 4 */);
+		~OversampledPass() {}
+
+		// Oversampler & compensation delay (not the object itself)
+		static size_t GetArenaSize(unsigned factor, unsigned maxSamplesPerBlock)
+		{
+			return Oversampler::GetArenaSize(factor, maxSamplesPerBlock) + StereoLatencyDelayLine::GetArenaSize(kOversamplerMaxLatency+1);
+		}
+
+		// Up to kOversamplerMaxLatency
+		void SetLatencyCompensation(unsigned numSamples);
+
+		void SetParameters(float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
+		                   float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso);
+
+		// Clears all state and snaps interpolated parameters to their targets (call SetParameters() first)
+		void Reset();
+
+		// Processes in place
+		void Apply(float *pLeft, float *pRight, unsigned numSamples);
+
+		unsigned GetFactor() const
+		{
+			return m_factor;
+		}
+
+		// Latency of the oversampling filters in samples (excl. compensation)
+		float GetLatency() const
+		{
+			return float(m_oversampler.GetLatency());
+		}
+
+		// Smallest factor (1, 2 or 4) that yields at least 'requiredRate'
+		static unsigned GetFactorFor(unsigned sampleRate, unsigned requiredRate)
+		{
+			unsigned factor = 1;
+			while (sampleRate*factor < requiredRate && factor < 4)
+				factor *= 2;
+
+			return factor;
+		}
+
+	private:
+		const unsigned m_sampleRate;
+		const unsigned m_Nyquist;
+		const unsigned m_factor;
+		const unsigned m_overSampleRate;
+
+		// Oversampling & latency compensation
+		Oversampler m_oversampler;
+		StereoLatencyDelayLine m_compensation;
+		unsigned m_compensationSize = 0;
+
+		// Post filters & interpolated parameters
+		MusicDSPMoog m_postFilterMOOG;
+		LadderFilter m_postFilterZDF;
+		bool m_postZDF = false;
+		InterpolatedParameter<kLinInterpolate, true> m_curPostModel; // 0 = MOOG, 1 = ZDF
+		InterpolatedParameter<kLinInterpolate, true> m_curPostCutoff;
+		InterpolatedParameter<kLinInterpolate, true> m_curPostReso;
+		InterpolatedParameter<kLinInterpolate, false> m_curPostDrive;
+		InterpolatedParameter<kLinInterpolate, true> m_curPostWet;
+
+		// Tube distortion filter (AA), DC blocker & interpolated parameters
+		InterpolatedParameter<kLinInterpolate, true> m_curTubeDist;
+		InterpolatedParameter<kLinInterpolate, false> m_curTubeDrive;
+		InterpolatedParameter<kLinInterpolate, false> m_curTubeOffset;
+		InterpolatedParameter<kLinInterpolate, true> m_curTubeTone; // Normalized cutoff
+		float m_tubeToneQ;
+		SvfLinearTrapOptimised2 m_tubeToneFilter;
+		StereoDCBlocker m_tubeDCBlocker;
+	};
+}
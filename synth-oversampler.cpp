@@ -0,0 +1,240 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Half-band oversampler (stereo, SSE).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include <xmmintrin.h>
+
+#include "synth-oversampler.h"
+
+namespace SFM
+{
+	// Kaiser window beta (approx. 80dB stopband)
+	constexpr double kHalfbandKaiserBeta = 8.0;
+
+	// Dot product of 'numTaps' (multiple of 4) taps and samples
+	SFM_INLINE static float DotProduct(const float *pTaps, const float *pSamples, unsigned numTaps)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (unsigned iTap = 0; iTap < numTaps; iTap += 4)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pTaps + iTap), _mm_loadu_ps(pSamples + iTap)));
+
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		return _mm_cvtss_f32(sum);
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		HalfbandStage
+
+		Prototype has 2*numTaps+1 taps with the center one at index numTaps; all taps at an even distance
+		from the center, except for the center one itself (0.5), are zero, which leaves the odd branch
+
+		Upsampling (gain 2 to make up for zero stuffing), for input x and output y:
+			y[2m]   = x[m - numTaps/2]
+			y[2m+1] = 2 * sum(branch[i] * x[m-i])
+
+		Downsampling, for input v (even samples e, odd samples o) and output y:
+			y[m] = 0.5*e[m - numTaps/2] + sum(branch[i] * o[m-1-i])
+
+		The branch is symmetrical, so reversing it to line up with history (oldest first) is a no-op
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	HalfbandStage::HalfbandStage(Arena &arena, unsigned numTaps, unsigned maxSamplesPerBlock) :
+		m_numTaps(numTaps)
+,		m_maxSamples(maxSamplesPerBlock)
+,		m_pTaps(arena.AllocateFloats(numTaps))
+,		m_pUpBuf(arena.AllocateFloats(numTaps + maxSamplesPerBlock))
+,		m_pDownOdd(arena.AllocateFloats(numTaps + maxSamplesPerBlock))
+,		m_pDownEven(arena.AllocateFloats(numTaps/2 + maxSamplesPerBlock))
+	{
+		SFM_ASSERT(0 == (numTaps & 3));
+
+		const double center = numTaps;
+		const double windowNorm = 1.0/BesselI0(kHalfbandKaiserBeta);
+
+		double sum = 0.0;
+		for (unsigned iTap = 0; iTap < numTaps; ++iTap)
+		{
+			// Odd taps of prototype: lowpass at a quarter of the (higher) rate
+			const double offset = (2*iTap+1) - center;
+			const double x = 0.5*offset;
+			const double sinc = sin(kPI*x)/(kPI*x);
+			const double ratio = offset/(center+1.0);
+			const double window = BesselI0(kHalfbandKaiserBeta*sqrt(1.0-ratio*ratio))*windowNorm;
+
+			const double tap = 0.5*sinc*window;
+			m_pTaps[iTap] = float(tap);
+			sum += tap;
+		}
+
+		// Normalize so that DC gain is exactly 1 (0.5 from the center tap, 0.5 from the branch)
+		for (unsigned iTap = 0; iTap < numTaps; ++iTap)
+			m_pTaps[iTap] = float(m_pTaps[iTap]*0.5/sum);
+
+		Reset();
+	}
+
+	void HalfbandStage::Reset()
+	{
+		memset(m_pUpBuf, 0, (m_numTaps + m_maxSamples)*sizeof(float));
+		memset(m_pDownOdd, 0, (m_numTaps + m_maxSamples)*sizeof(float));
+		memset(m_pDownEven, 0, (m_numTaps/2 + m_maxSamples)*sizeof(float));
+	}
+
+	void HalfbandStage::Upsample(const float *pSrc, float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pSrc && nullptr != pDest);
+		SFM_ASSERT(numSamples <= m_maxSamples);
+
+		float *pBuf = m_pUpBuf;
+		memcpy(pBuf + m_numTaps, pSrc, numSamples*sizeof(float));
+
+		const unsigned halfTaps = m_numTaps/2;
+		const float *pTaps = m_pTaps;
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			pDest[iSample*2 + 0] = pBuf[iSample + halfTaps];
+			pDest[iSample*2 + 1] = 2.f*DotProduct(pTaps, pBuf + iSample+1, m_numTaps);
+		}
+
+		// Keep last 'numTaps' samples as history
+		memmove(pBuf, pBuf + numSamples, m_numTaps*sizeof(float));
+	}
+
+	void HalfbandStage::Downsample(const float *pSrc, float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pSrc && nullptr != pDest);
+		SFM_ASSERT(numSamples <= m_maxSamples);
+
+		const unsigned halfTaps = m_numTaps/2;
+
+		float *pOdd  = m_pDownOdd;
+		float *pEven = m_pDownEven;
+
+		// Split into even & odd samples
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			pEven[halfTaps + iSample] = pSrc[iSample*2 + 0];
+			pOdd[m_numTaps + iSample] = pSrc[iSample*2 + 1];
+		}
+
+		const float *pTaps = m_pTaps;
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			pDest[iSample] = 0.5f*pEven[iSample] + DotProduct(pTaps, pOdd + iSample, m_numTaps);
+
+		memmove(pOdd, pOdd + numSamples, m_numTaps*sizeof(float));
+		memmove(pEven, pEven + numSamples, halfTaps*sizeof(float));
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Oversampler
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	static unsigned GetNumStages(unsigned factor)
+	{
+		SFM_ASSERT(1 == factor || 2 == factor || 4 == factor);
+		return (4 == factor) ? 2 : factor-1;
+	}
+
+	static unsigned GetNumTaps(unsigned iStage)
+	{
+		return (0 == iStage) ? kOversamplerStage1Taps : kOversamplerStage2Taps;
+	}
+
+	/* static */ size_t Oversampler::GetArenaSize(unsigned factor, unsigned maxSamplesPerBlock)
+	{
+		// Must match the order in which the constructor allocates
+		size_t size = 0;
+
+		for (unsigned iStage = 0; iStage < GetNumStages(factor); ++iStage)
+		{
+			const unsigned maxSamples = maxSamplesPerBlock << iStage;
+
+			size += 2*(Arena::Align(sizeof(HalfbandStage)) + HalfbandStage::GetArenaSize(GetNumTaps(iStage), maxSamples));
+			size += 2*Arena::GetFloatsSize(maxSamples*2);
+		}
+
+		return size;
+	}
+
+	Oversampler::Oversampler(Arena &arena, unsigned factor, unsigned maxSamplesPerBlock)
+	{
+		m_numStages = GetNumStages(factor);
+
+		for (unsigned iStage = 0; iStage < m_numStages; ++iStage)
+		{
+			const unsigned numTaps = GetNumTaps(iStage);
+			const unsigned maxSamples = maxSamplesPerBlock << iStage;
+
+			m_pStagesL[iStage] = new (arena.Allocate(sizeof(HalfbandStage))) HalfbandStage(arena, numTaps, maxSamples);
+			m_pStagesR[iStage] = new (arena.Allocate(sizeof(HalfbandStage))) HalfbandStage(arena, numTaps, maxSamples);
+
+			m_pBufL[iStage+1] = arena.AllocateFloats(maxSamples*2);
+			m_pBufR[iStage+1] = arena.AllocateFloats(maxSamples*2);
+		}
+	}
+
+	void Oversampler::Reset()
+	{
+		for (unsigned iStage = 0; iStage < m_numStages; ++iStage)
+		{
+			m_pStagesL[iStage]->Reset();
+			m_pStagesR[iStage]->Reset();
+		}
+	}
+
+	void Oversampler::Upsample(const float *pLeft, const float *pRight, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+
+		if (0 == m_numStages)
+			return;
+
+		m_pStagesL[0]->Upsample(pLeft, m_pBufL[1], numSamples);
+		m_pStagesR[0]->Upsample(pRight, m_pBufR[1], numSamples);
+
+		for (unsigned iStage = 1; iStage < m_numStages; ++iStage)
+		{
+			const unsigned stageSamples = numSamples << iStage;
+			m_pStagesL[iStage]->Upsample(m_pBufL[iStage], m_pBufL[iStage+1], stageSamples);
+			m_pStagesR[iStage]->Upsample(m_pBufR[iStage], m_pBufR[iStage+1], stageSamples);
+		}
+	}
+
+	void Oversampler::Downsample(float *pLeft, float *pRight, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+
+		if (0 == m_numStages)
+			return;
+
+		for (unsigned iStage = m_numStages-1; iStage > 0; --iStage)
+		{
+			const unsigned stageSamples = numSamples << iStage;
+			m_pStagesL[iStage]->Downsample(m_pBufL[iStage+1], m_pBufL[iStage], stageSamples);
+			m_pStagesR[iStage]->Downsample(m_pBufR[iStage+1], m_pBufR[iStage], stageSamples);
+		}
+
+		m_pStagesL[0]->Downsample(m_pBufL[1], pLeft, numSamples);
+		m_pStagesR[0]->Downsample(m_pBufR[1], pRight, numSamples);
+	}
+
+	unsigned Oversampler::GetLatency() const
+	{
+		// Each stage's latency is in samples at it's lower rate
+		unsigned latency = 0;
+		for (unsigned iStage = 0; iStage < m_numStages; ++iStage)
+			latency += m_pStagesL[iStage]->GetLatency() >> iStage;
+
+		return latency;
+	}
+}
@@ -0,0 +1,108 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Half-band oversampler (stereo, SSE).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Replaces juce::dsp::Oversampling in OversampledPass: up to 2 cascaded 2X stages (so 1X, 2X or 4X), each
+	a linear phase half-band FIR (Kaiser windowed sinc), split into it's 2 polyphase branches:
+
+	- Half-band means every other tap is zero and the center tap is 0.5, so one branch is a plain delay
+	  and the other a short dot product (kOversamplerStage1Taps or kOversamplerStage2Taps, 4 at a time using SSE)
+	- The first stage (closest to the host rate) is the steepest, the second one only has to keep what the first
+	  one lets through, which is the same trick JUCE uses
+	- Latency is an integer number of samples at the host rate (see GetLatency())
+	- Stages, taps & buffers come from an Arena (see helper/synth-arena.h), use GetArenaSize() to account for them
+*/
+
+#pragma once
+
+#include "synth-global.h"
+#include "helper/synth-arena.h"
+
+namespace SFM
+{
+	// Taps of the non-trivial branch of each stage (must be a multiple of 4, and even)
+	constexpr unsigned kOversamplerStage1Taps = 32;
+	constexpr unsigned kOversamplerStage2Taps = 16;
+
+	// Latency at 4X, which is the worst case (see Oversampler::GetLatency())
+	constexpr unsigned kOversamplerMaxLatency = kOversamplerStage1Taps + kOversamplerStage2Taps/2;
+
+	// One channel, one 2X stage
+	class HalfbandStage
+	{
+	public:
+		HalfbandStage(Arena &arena, unsigned numTaps, unsigned maxSamplesPerBlock /* At the lower rate */);
+
+		// Taps & buffers (not the object itself)
+		static size_t GetArenaSize(unsigned numTaps, unsigned maxSamplesPerBlock)
+		{
+			return Arena::GetFloatsSize(numTaps) + 2*Arena::GetFloatsSize(numTaps + maxSamplesPerBlock) + Arena::GetFloatsSize(numTaps/2 + maxSamplesPerBlock);
+		}
+
+		void Reset();
+
+		// Writes 2*numSamples
+		void Upsample(const float *pSrc, float *pDest, unsigned numSamples);
+
+		// Reads 2*numSamples
+		void Downsample(const float *pSrc, float *pDest, unsigned numSamples);
+
+		// Upsampling plus downsampling, in samples at the lower rate
+		unsigned GetLatency() const
+		{
+			return m_numTaps;
+		}
+
+	private:
+		const unsigned m_numTaps;
+		const unsigned m_maxSamples;
+
+		// Odd (non-trivial) branch, reversed so it lines up with history (oldest first)
+		float *m_pTaps;
+
+		// History followed by current block (see Upsample() & Downsample())
+		float *m_pUpBuf;
+		float *m_pDownOdd;
+		float *m_pDownEven;
+	};
+
+	class Oversampler
+	{
+	public:
+		Oversampler(Arena &arena, unsigned factor /* 1, 2 or 4 */, unsigned maxSamplesPerBlock);
+
+		static size_t GetArenaSize(unsigned factor, unsigned maxSamplesPerBlock);
+
+		void Reset();
+
+		// Fills internal buffers with numSamples*factor samples (see GetBufferL() & GetBufferR())
+		void Upsample(const float *pLeft, const float *pRight, unsigned numSamples);
+
+		// Reads internal buffers, writes numSamples to destination
+		void Downsample(float *pLeft, float *pRight, unsigned numSamples);
+
+		float *GetBufferL() { return m_pBufL[m_numStages]; }
+		float *GetBufferR() { return m_pBufR[m_numStages]; }
+
+		unsigned GetFactor() const
+		{
+			return 1 << m_numStages;
+		}
+
+		// In samples at host rate
+		unsigned GetLatency() const;
+
+	private:
+		unsigned m_numStages;
+
+		// Stages per channel
+		HalfbandStage *m_pStagesL[2] = { nullptr };
+		HalfbandStage *m_pStagesR[2] = { nullptr };
+
+		// Buffers at each rate (index 0 is unused; input & output are the caller's)
+		float *m_pBufL[3] = { nullptr };
+		float *m_pBufR[3] = { nullptr };
+	};
+}
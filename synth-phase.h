@@ -5,6 +5,9 @@
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 
 	Phase period is [0..1]
+
+	FreeRunningPhase keeps a sample clock stamp and is only brought up to date (analytically) when it's read
+	or it's pitch changes, so keeping it running costs nothing (see Bison::m_sampleClock)
 */
 
 #pragma once
@@ -79,10 +82,65 @@ namespace SFM
 			return curPhase;
 		}
 
-		// Can be used for free running phases
-		SFM_INLINE void Skip(unsigned count)
+		// Writes ramp (for block oscillators, see synth-stateless-oscillators.h)
+		SFM_INLINE void Sample(float *pDest, unsigned numSamples)
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				pDest[iSample] = Sample();
+		}
+
+		// Can be used for free running phases (in double precision since 'count' can be huge)
+		SFM_INLINE void Skip(uint64_t count)
+		{
+			m_phase = float(fmod(double(m_phase) + double(m_pitch)*double(count), 1.0));
+		}
+	};
+
+	class FreeRunningPhase
+	{
+	private:
+		Phase    m_phase;
+		uint64_t m_clock = 0;
+
+		SFM_INLINE void CatchUp(uint64_t clock)
+		{
+			SFM_ASSERT(clock >= m_clock);
+
+			if (clock != m_clock)
+			{
+				m_phase.Skip(clock-m_clock);
+				m_clock = clock;
+			}
+		}
+
+	public:
+		FreeRunningPhase(unsigned sampleRate) :
+			m_phase(sampleRate) {}
+
+		SFM_INLINE void Initialize(float frequency, unsigned sampleRate, uint64_t clock)
+		{
+			m_phase.Initialize(frequency, sampleRate);
+			m_clock = clock;
+		}
+
+		SFM_INLINE void SetFrequency(float frequency, uint64_t clock)
+		{
+			if (frequency != m_phase.GetFrequency())
+			{
+				CatchUp(clock);
+				m_phase.SetFrequency(frequency);
+			}
+		}
+
+		SFM_INLINE float GetFrequency() const
+		{
+			return m_phase.GetFrequency();
+		}
+
+		SFM_INLINE float Get(uint64_t clock)
 		{
-			m_phase = fmodf(m_phase + m_pitch*count, 1.f);
+			CatchUp(clock);
+			return m_phase.Get();
 		}
 	};
 }
@@ -5,10 +5,15 @@
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 
 	Source: http://www.firstpr.com.au/dsp/pink-noise/ (using Paul Kellet's refined method)
+
+	- Filters white noise, so the caller decides which RandomStream it comes from
+	- Block version runs the 7 filter stages side by side (SSE), results match Sample() within float precision
 */
 
 #pragma once
 
+#include <emmintrin.h>
+
 #include "synth-global.h"
 #include "synth-stateless-oscillators.h"
 
@@ -20,12 +25,12 @@ namespace SFM
 		PinkNoise()
 		{
 			for (auto &value : m_pinkCoeffs)
-				value = 0.0;
+				value = 0.f;
 		}
 
-		SFM_INLINE float Sample()
+		SFM_INLINE float Sample(float whiteNoise)
 		{
-			const float whiteNoise = mt_randfc();
+			SFM_ASSERT(fabsf(whiteNoise) <= 1.f);
 
 			// Added an extra zero to each last constant like Kellet suggested
 			m_pinkCoeffs[0] = 0.99886f * m_pinkCoeffs[0] + whiteNoise*0.00555179f;
@@ -41,6 +46,49 @@ namespace SFM
 			
 			return pink;
 		}
+
+		// Fills 'pDest' with white noise from 'random' and filters it in place
+		SFM_INLINE void Sample(RandomStream &random, float *pDest, unsigned numSamples)
+		{
+			SFM_ASSERT(nullptr != pDest);
+
+			random.FillBipolar(pDest, numSamples);
+
+			// Stages 0-3 in A, 4-6 in B (stage 6 is just the previous white noise sample, scaled)
+			__m128 A = _mm_loadu_ps(m_pinkCoeffs);
+			__m128 B = _mm_setr_ps(m_pinkCoeffs[4], m_pinkCoeffs[5], m_pinkCoeffs[6], 0.f);
+
+			const __m128 feedbackA = _mm_setr_ps(0.99886f, 0.99332f, 0.96900f, 0.86650f);
+			const __m128 inputA    = _mm_setr_ps(0.00555179f, 0.00750759f, 0.01538520f, 0.03104856f);
+			const __m128 feedbackB = _mm_setr_ps(0.55000f, -0.7616f, 0.f, 0.f);
+			const __m128 inputB    = _mm_setr_ps(0.05329522f, -0.00168980f, 0.115926f, 0.f);
+			const __m128 inputDirect = _mm_setr_ps(0.5362f, 0.f, 0.f, 0.f);
+			const __m128 previousMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, -1, 0)); // Stage 6 is summed before it's updated
+
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				const __m128 whiteNoise = _mm_set1_ps(pDest[iSample]);
+
+				A = _mm_add_ps(_mm_mul_ps(feedbackA, A), _mm_mul_ps(inputA, whiteNoise));
+				const __m128 nextB = _mm_add_ps(_mm_mul_ps(feedbackB, B), _mm_mul_ps(inputB, whiteNoise));
+
+				const __m128 summedB = _mm_or_ps(_mm_and_ps(previousMask, B), _mm_andnot_ps(previousMask, nextB));
+				__m128 pink = _mm_add_ps(_mm_add_ps(A, summedB), _mm_mul_ps(inputDirect, whiteNoise));
+				B = nextB;
+
+				// Horizontal sum
+				pink = _mm_add_ps(pink, _mm_movehl_ps(pink, pink));
+				pink = _mm_add_ss(pink, _mm_shuffle_ps(pink, pink, 1));
+				pDest[iSample] = _mm_cvtss_f32(pink);
+			}
+
+			alignas(16) float stagesB[4];
+			_mm_storeu_ps(m_pinkCoeffs, A);
+			_mm_store_ps(stagesB, B);
+			m_pinkCoeffs[4] = stagesB[0];
+			m_pinkCoeffs[5] = stagesB[1];
+			m_pinkCoeffs[6] = stagesB[2];
+		}
 		
 	private:
 		float m_pinkCoeffs[7];
@@ -8,8 +8,8 @@
 	- Auto-wah/Vox
 	- Yamaha Reface CP-style chorus & phaser
 	- Delay
-	- Tube distortion (4X oversampling)
-	- Post filter (24dB) (4X oversampling)
+	- Tube distortion (1X, 2X or 4X oversampling, see synth-oversampled-pass.cpp)
+	- Post filter (24dB) (1X, 2X or 4X oversampling)
 	- Reverb
 	- Compressor
 	- Low cut, 3-band tuning, master volume & final clamp
@@ -20,78 +20,70 @@
 
 #include "synth-post-pass.h"
 #include "synth-stateless-oscillators.h"
-#include "synth-distort.h"
 #include "patch/synth-patch-global.h"
+#include "helper/synth-profile.h"
 
 namespace SFM
 {
 	// Remedies sampling artifacts whilst sweeping a delay line
 	constexpr float kSweepCutoffHz = 50.f;
 
-	// Max. delay feedback (so as not to create an endless loop)
-	constexpr float kMaxDelayFeedback = 0.95f; // Like Ableton does, or so I've been told by Paul
-
-	// Delay line size (main delay) & cross bleed amount
-	constexpr float kMainDelayLineSize = kMainDelayInSec;
-	constexpr float kDelayCrossbleeding = kGoldenRatio*0.1f; // Arbitrary
-	
 	// The compressor's 'bite' is filtered so it can be used as a GUI indicator; higher value means brighter and quicker
 	constexpr float kCompressorBiteCutHz = 480.f;
 
-	// "Tape delay" constants (for 'wow' effect)
-	constexpr float kTapeDelayHz = kGoldenRatio;
-	constexpr float kTapeDelaySpread = 0.02f;
+	// Crossfade time when switching oversampling factor
+	constexpr float kOversamplingFadeTime = 0.01f; // 10MS
+
+	static unsigned FactorToIndex(unsigned factor)
+	{
+		SFM_ASSERT(1 == factor || 2 == factor || 4 == factor);
+		return (4 == factor) ? 2 : factor-1;
+	}
 
-	// Tube tone LPF Qs
-	constexpr float kTubeToneFlatQ = 0.f;
-	constexpr float kTubeToneColorQ = kGoldenRatio*0.0628f;
+	// Max. chorus delay
+	static unsigned GetChorusLineSize(unsigned sampleRate)
+	{
+		return sampleRate/10; // 100MS
+	}
 
-	PostPass::PostPass(unsigned sampleRate, unsigned maxSamplesPerBlock, unsigned Nyquist) :
-		m_sampleRate(sampleRate), m_Nyquist(Nyquist), m_sampleRate4X(sampleRate*4)
+	size_t PostPass::GetArenaSize(unsigned sampleRate, unsigned maxSamplesPerBlock)
+	{
+		// Must match the order in which the constructor allocates
+		size_t size = 0;
+
+		size += MainDelay::GetArenaSize(sampleRate);
+		size += DelayLine::GetArenaSize(GetChorusLineSize(sampleRate));
+		size += Reverb::GetArenaSize(sampleRate);
+		size += Compressor::GetArenaSize(sampleRate);
+		size += 4*Arena::GetFloatsSize(maxSamplesPerBlock);
+
+		// Worst case: all factors
+		for (unsigned factor : { 1u, 2u, 4u })
+			size += Arena::Align(sizeof(OversampledPass)) + OversampledPass::GetArenaSize(factor, maxSamplesPerBlock);
+
+		return size;
+	}
+
+	PostPass::PostPass(Arena &arena, unsigned sampleRate, unsigned maxSamplesPerBlock, unsigned Nyquist, uint64_t randomSeed) :
+		m_sampleRate(sampleRate), m_Nyquist(Nyquist)
 
 		// Delay
-,		m_tapeDelayLFO(sampleRate)
-,		m_tapeDelayLPF(kSweepCutoffHz /* Borrowed, FIXME */ / sampleRate)
-,		m_delayLineL(unsigned(sampleRate*kMainDelayLineSize))
-,		m_delayLineM(unsigned(sampleRate*kMainDelayLineSize))
-,		m_delayLineR(unsigned(sampleRate*kMainDelayLineSize))
-,		m_curDelayInSec(0.f, sampleRate, kDefParameterLatency * 4.f /* Longer */)
-,		m_curDelayWet(0.f, sampleRate, kDefParameterLatency)
-,		m_curDelayDrive(1.f /* 0dB */, sampleRate, kDefParameterLatency)
-,		m_curDelayFeedback(0.f, sampleRate, kDefParameterLatency)
-,		m_curDelayFeedbackCutoff(1.f, sampleRate, kDefParameterLatency)
-,		m_curDelayTapeWow(0.f, sampleRate, kDefParameterLatency)
+,		m_delay(arena, sampleRate, Nyquist)
 		
 		// Chorus/Phaser
-,		m_chorusDL(sampleRate/10  /* 100MS max. chorus delay */)
+,		m_chorusDL(arena, GetChorusLineSize(sampleRate))
 ,		m_chorusSweep(sampleRate), m_chorusSweepMod(sampleRate)
 ,		m_chorusSweepLPF1(kSweepCutoffHz/sampleRate), m_chorusSweepLPF2(kSweepCutoffHz/sampleRate)
 ,		m_phaserSweep(sampleRate)
 ,		m_phaserSweepLPF((kSweepCutoffHz*2.f)/sampleRate) // Tweaked a little for effect
 
-		// Oversampling (stereo)
-,		m_oversampling4X(2, 2, juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true)
-
-		// Post filter
-,		m_postFilter(m_sampleRate4X)
-,		m_curPostCutoff(0.f, m_sampleRate4X, kDefParameterLatency * 2.f /* Longer */)
-,		m_curPostReso(0.f, m_sampleRate4X, kDefParameterLatency)
-,		m_curPostDrive(0.f, m_sampleRate4X, kDefParameterLatency)
-,		m_curPostWet(0.f, m_sampleRate4X, kDefParameterLatency)
-		
-		// Tube distort
-,		m_curTubeDist(0.f, m_sampleRate4X, kDefParameterLatency)
-,		m_curTubeDrive(kDefTubeDrive, m_sampleRate4X, kDefParameterLatency)
-,		m_curTubeOffset(0.f, m_sampleRate4X, kDefParameterLatency)
-,		m_curTubeTone(kDefTubeTone, m_sampleRate4X, kDefParameterLatency)
-
 		// Post (EQ)
 ,		m_postEQ(sampleRate, true)
 
 		// External effects
-,		m_wah(sampleRate, Nyquist)
-,		m_reverb(sampleRate, Nyquist)
-,		m_compressor(sampleRate)
+,		m_wah(sampleRate, Nyquist, randomSeed)
+,		m_reverb(arena, sampleRate, Nyquist)
+,		m_compressor(arena, sampleRate)
 ,		m_compressorBiteLPF(kCompressorBiteCutHz/sampleRate)
 		
 		// Misc.
@@ -100,14 +92,37 @@ namespace SFM
 ,		m_curMasterVol(1.f, sampleRate, kDefParameterLatency)
 	{
 		// Allocate intermediate buffers
-		m_pBufL  = reinterpret_cast<float *>(mallocAligned(maxSamplesPerBlock*sizeof(float), 16));
-		m_pBufR  = reinterpret_cast<float *>(mallocAligned(maxSamplesPerBlock*sizeof(float), 16));
+		m_pBufL  = arena.AllocateFloats(maxSamplesPerBlock);
+		m_pBufR  = arena.AllocateFloats(maxSamplesPerBlock);
+		m_pFadeBufL = arena.AllocateFloats(maxSamplesPerBlock);
+		m_pFadeBufR = arena.AllocateFloats(maxSamplesPerBlock);
+
+		// Create oversampled passes for each factor that can occur at this rate
+		for (unsigned requiredRate : { 0u, kLightOversampledRate, kHeavyOversampledRate })
+		{
+			const unsigned factor = OversampledPass::GetFactorFor(sampleRate, requiredRate);
+			auto &pPass = m_oversampled[FactorToIndex(factor)];
+
+			if (nullptr == pPass)
+			{
+				pPass = new (arena.Allocate(sizeof(OversampledPass))) OversampledPass(arena, sampleRate, Nyquist, maxSamplesPerBlock, factor);
+				m_oversampledLatency = std::max<float>(m_oversampledLatency, pPass->GetLatency());
+			}
+		}
+
+		// Line them up
+		for (auto *pPass : m_oversampled)
+		{
+			if (nullptr != pPass)
+				pPass->SetLatencyCompensation(unsigned(m_oversampledLatency - pPass->GetLatency()));
+		}
 
-		// Initialize JUCE oversampling object (FIXME)
-		m_oversampling4X.initProcessing(maxSamplesPerBlock);
+		// Start at 1X (nothing to do)
+		m_curOversampled = m_nextOversampled = FactorToIndex(1);
 
-		// Set tape delay mod. frequency
-		m_tapeDelayLFO.Initialize(kTapeDelayHz, m_sampleRate);
+		// Flush filters before fading in (generous)
+		m_oversampledWarmUp   = 0;
+		m_oversampledFadeSize = unsigned(sampleRate*kOversamplingFadeTime);
 
 		// Set low kill (cut) filter
 		m_killLow.reset();
@@ -116,14 +131,19 @@ namespace SFM
 
 	PostPass::~PostPass()
 	{
-		freeAligned(m_pBufL);
-		freeAligned(m_pBufR);
+		// Buffers belong to arena, but the oversampled passes must be destroyed
+		for (auto *pPass : m_oversampled)
+		{
+			if (nullptr != pPass)
+				pPass->~OversampledPass();
+		}
 	}
 
 	float PostPass::GetLatency() const
 	{
 		// FIXME: approx. complete sum best possible
-		const float oversamplingLatency = m_oversampling4X.getLatencyInSamples();
+		// Constant, regardless of the current oversampling factor
+		const float oversamplingLatency = m_oversampledLatency;
 		const float compressorLatency   = m_compressor.GetLatency();
 
 		return oversamplingLatency + compressorLatency;
@@ -134,7 +154,7 @@ namespace SFM
 	                     float wahResonance, float wahAttack, float wahHold, float wahRate, float wahDrivedB, float wahSpeak, float wahSpeakVowel, float wahSpeakVowelMod, float wahSpeakGhost, float wahSpeakCut, float wahSpeakReso, float wahCut, float wahWet,
 	                     float cpRate, float cpWet, bool isChorus,
 	                     float delayInSec, float delayWet, float delayDrivedB, float delayFeedback, float delayFeedbackCutoff, float delayTapeWow,
-	                     float postCutoff, float postReso, float postDrivedB, float postWet,
+	                     float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
 	                     float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso,
 	                     float reverbWet, float reverbRoomSize, float reverbDampening, float reverbWidth, float reverbLP, float reverbHP, float reverbPreDelay,
 	                     float compThresholddB, float compKneedB, float compRatio, float compGaindB, float compAttack, float compRelease, float compLookahead, bool compAutoGain, float compRMSToPeak,
@@ -161,6 +181,8 @@ namespace SFM
 		SFM_ASSERT(tubeDrive >= kMinTubeDrive && tubeDrive <= kMaxTubeDrive);
 		SFM_ASSERT(tubeOffset >= kMinTubeOffset && tubeOffset <= kMaxTubeOffset);
 		SFM_ASSERT_NORM(tubeTone);
+
+		SFM_PROFILE_SCOPE(kProfilePostPass);
 		
 		// Delay is automatically overridden to it's manual setting if it doesn't fit in it's delay line
 		const bool useBPM = 0.f != rateBPM;
@@ -181,6 +203,9 @@ namespace SFM
 		memcpy(m_pBufL, pLeftIn,  bufSize);
 		memcpy(m_pBufR, pRightIn, bufSize);
 
+		// Times each stage below, up until the end of the final pass
+		SFM_PROFILE_SECTION(stageTimer, kProfileWah);
+
 #if !defined(SFM_DISABLE_FX)
 
 		/* ----------------------------------------------------------------------------------------------------
@@ -195,6 +220,11 @@ namespace SFM
 		m_wah.SetParameters(wahResonance, wahAttack, wahHold, wahRate, wahDrivedB, wahSpeak, wahSpeakVowel, wahSpeakVowelMod, wahSpeakGhost, wahSpeakCut, wahSpeakReso, wahCut, wahWet);
 		m_wah.Apply(m_pBufL, m_pBufR, numSamples, false == useBPM);
 
+		if (nullptr != m_pVisualization)
+			m_pVisualization->Meter(kVisWah, m_pBufL, m_pBufR, numSamples);
+
+		SFM_PROFILE_NEXT(stageTimer, kProfileChorusDelay);
+
 		/* ----------------------------------------------------------------------------------------------------
 
 			Chorus/Phaser + Delay
@@ -219,12 +249,10 @@ namespace SFM
 		SFM_ASSERT(delay >= 0.f && delay <= kMainDelayInSec);
 
 		// Set delay param. targets
-		m_curDelayInSec.SetTarget(delay);
-		m_curDelayWet.SetTarget(delayWet);
-		m_curDelayDrive.SetTarget(dB2Lin(delayDrivedB));
-		m_curDelayFeedback.SetTarget(delayFeedback);
-		m_curDelayFeedbackCutoff.SetTarget(delayFeedbackCutoff);
-		m_curDelayTapeWow.SetTarget(delayTapeWow);
+		m_delay.SetParameters(delay, delayWet, delayDrivedB, delayFeedback, delayFeedbackCutoff, delayTapeWow);
+
+		// Left to a shared bus?
+		const bool applyDelay = 0 == (m_sends & kSendDelay);
 		
 		// Set rate for both chorus & phaser
 		if (false == useBPM || true == overrideSyncCP) // Sync. to BPM?
@@ -267,163 +295,38 @@ namespace SFM
 				ApplyPhaser(left, right, left, right, phaserWet);
 
 			//
-			// Apply delay (always executed, for now, FIXME?)
+			// Apply delay (always executed unless it's left to a send bus, FIXME?)
 			//
 
-			const float monaural = left*0.5f + right*0.5f;
-
-			const float curDelayInSec = m_curDelayInSec.Sample();
-			SFM_ASSERT(curDelayInSec >= 0.f && curDelayInSec <= kMainDelayInSec);
+			if (true == applyDelay)
+				m_delay.Apply(left, right);
 
-			// Write driven samples to delay line
-			const float drive = m_curDelayDrive.Sample();
-			m_delayLineL.Write(left     * drive);
-			m_delayLineM.Write(monaural * drive);
-			m_delayLineR.Write(right    * drive);
-			
-			// Sample delay line
-			const float curDelay   = curDelayInSec/kMainDelayInSec;
-			const float curTapeWow = m_curDelayTapeWow.Sample();
-			const float normDelay  = curDelay + curTapeWow*(curDelay*curDelay)*kTapeDelaySpread*m_tapeDelayLPF.Apply(fast_cosf(m_tapeDelayLFO.Sample()));
-			const float delayedL   = m_delayLineL.ReadNormalized(normDelay);
-			const float delayedM   = m_delayLineM.ReadNormalized(normDelay);
-			const float delayedR   = m_delayLineR.ReadNormalized(normDelay);
-			
-			// Bleed delay samples a bit
-			constexpr float crossBleedAmt = kDelayCrossbleeding;
-			constexpr float invCrossBleedAmt = 1.f-crossBleedAmt;
-			const float crossBleed = delayedM;
-			const float delayL = delayedL*invCrossBleedAmt + crossBleed*crossBleedAmt;
-			const float delayR = delayedR*invCrossBleedAmt + crossBleed*crossBleedAmt;
-
-			// Filter delay
-			const float curFc = (m_curDelayFeedbackCutoff.Sample() * m_Nyquist/4)/m_sampleRate; // Limited range gives a more pronounced effect
-			m_delayFeedbackLPF_L.SetCutoff(curFc);
-			m_delayFeedbackLPF_R.SetCutoff(curFc);
-
-			const float filteredL = m_delayFeedbackLPF_L.Apply(delayL);
-			const float filteredR = m_delayFeedbackLPF_R.Apply(delayR);
-
-			const float filteredM = 0.5f*filteredL + 0.5f*filteredR;
-
-			// Feedback
-			const float curFeedback =  m_curDelayFeedback.Sample()*kMaxDelayFeedback;
-			m_delayLineL.WriteFeedback(filteredL, curFeedback);
-			m_delayLineM.WriteFeedback(filteredM, curFeedback);
-			m_delayLineR.WriteFeedback(filteredR, curFeedback);
-
-			// Add delay
-
-//			const float wet = m_curDelayWet.Sample();
-//			m_pBufL[iSample] = left  + wet*delayL;
-//			m_pBufR[iSample] = right + wet*delayR;
-
-			// Stereo (width) effect (fixed)
-			// Nicked from synth-reverb.cpp
-			const float wet = m_curDelayWet.Sample();
-			const float dry = 1.f-wet;
-
-			const float width = kGoldenRatio; // FIXME: parameter?
-			const float wet1  = wet*(width*0.5f + 0.5f);
-			const float wet2  = wet*((1.f-width)*0.5f);
-			
-//			m_pBufL[iSample] = delayL*wet1 + delayR*wet2 + left*dry;
-//			m_pBufR[iSample] = delayR*wet1 + delayL*wet2 + right*dry;
-			
-			// To be more like Ableton, we'll use the filtered samples rightaway
-			m_pBufL[iSample] = filteredL*wet1 + filteredR*wet2 + left*dry;
-			m_pBufR[iSample] = filteredR*wet1 + filteredL*wet2 + right*dry;
+			m_pBufL[iSample] = left;
+			m_pBufR[iSample] = right;
 		}
 
+		if (nullptr != m_pVisualization)
+			m_pVisualization->Meter(kVisChorusDelay, m_pBufL, m_pBufR, numSamples);
+
 		/* ----------------------------------------------------------------------------------------------------
 
-			Oversampled: 24dB ladder filter & tube distortion (4X)
+			Oversampled: 24dB ladder filter & tube distortion (1X, 2X or 4X)
 
-			JUCE says:
-			" Choose between FIR or IIR filtering depending on your needs in term of latency and phase 
-			  distortion. With FIR filters, the phase is linear but the latency is maximised. With IIR 
-			  filtering, the phase is compromised around the Nyquist frequency but the latency is minimised. "
+			Oversampling uses linear phase (FIR) half-band filters, which costs some latency (see synth-oversampler.h)
 
-			I've tried to skip oversampling entirely but this resulted in clicking artifacts, so tough luck :)
-			FIXME: research why!
+			I've tried to skip oversampling entirely but this resulted in clicking artifacts; turns out the
+			tone filter blew up at Nyquist (1X) and switching changed the latency. So now the factor is chosen 
+			per block from the sample rate and the amount of nonlinearity, all factors are padded to the same 
+			latency and switching between them is crossfaded.
 
 		 ------------------------------------------------------------------------------------------------------ */
 
-		// Set post filter parameters
-		m_curPostCutoff.SetTarget(postCutoff);
-		m_curPostReso.SetTarget(postReso);
-		m_curPostDrive.SetTarget(dBToGain(postDrivedB));
-		m_curPostWet.SetTarget(postWet);
-
-		// Set tube distortion parameters
-		m_curTubeDist.SetTarget(tubeDistort);
-		m_curTubeDrive.SetTarget(tubeDrive);
-		m_curTubeOffset.SetTarget(tubeOffset);
-		m_curTubeTone.SetTarget(tubeTone);
-
-		const float toneQ = SVF_ResoToQ(tubeToneReso ? kTubeToneColorQ : kTubeToneFlatQ);
-		
-		// Main buffers
-		float *inputBuffers[2] = { m_pBufL, m_pBufR };
-		juce::dsp::AudioBlock<float> inputBlock(inputBuffers, 2, numSamples);
-
-		// Oversample 4X
-		auto outBlock = m_oversampling4X.processSamplesUp(inputBlock);
-		const size_t numOversamples = outBlock.getNumSamples();
-		SFM_ASSERT(numOversamples == numSamples*4);
-
-		float *pOverL = outBlock.getChannelPointer(0);
-		float *pOverR = outBlock.getChannelPointer(1);
+		SFM_PROFILE_NEXT(stageTimer, kProfileOversampled);
 
-		for (unsigned iSample = 0; iSample < numOversamples; ++iSample)
-		{
-			float sampleL = pOverL[iSample]; 
-			float sampleR = pOverR[iSample];
-
-			// Apply (non-linear) distortion
-			const float amount = m_curTubeDist.Sample();
-			const float drive  = m_curTubeDrive.Sample();
-			const float offset = m_curTubeOffset.Sample();
-			const float tone   = m_curTubeTone.Sample();
-
-			// Apply (soft) clipping
-			const float driveAdj = drive/kMaxTubeDrive; // Normalized
-			float distortedL = Squarepusher(offset+sampleL, driveAdj);
-			float distortedR = Squarepusher(offset+sampleR, driveAdj);
-
-			// Apply tone filter (resonant LPF)
-			m_tubeToneFilter.updateLowpassCoeff(SVF_CutoffToHz(tone, m_Nyquist), toneQ, m_sampleRate4X);
-			m_tubeToneFilter.tick(distortedL, distortedR);
-
-			// Remove possible DC offset
-			m_tubeDCBlocker.Apply(distortedL, distortedR);
-
-			// Add to signal
-			float postDistortedL = sampleL + distortedL*amount; // lerpf<float>(sampleL, distortedL, smoothstepped);
-			float postDistortedR = sampleR + distortedR*amount; // lerpf<float>(sampleR, distortedR, smoothstepped);
-
-			// Apply 24dB post filter
-			const float curPostCutoff = m_curPostCutoff.Sample();
-			const float curPostReso   = m_curPostReso.Sample();
-			const float curPostDrive  = m_curPostDrive.Sample();
-			const float curPostWet    = m_curPostWet.Sample();
-
-			// Apply filter
-			float filteredL = postDistortedL, filteredR = postDistortedR;
-			m_postFilter.SetParameters(kMinPostFilterCutoffHz + curPostCutoff*kPostFilterCutoffRange, curPostReso /* [0..1] */, curPostDrive);
-			m_postFilter.Apply(filteredL, filteredR);
-
-			// Blend
-			sampleL = lerpf<float>(postDistortedL, filteredL, curPostWet);
-			sampleR = lerpf<float>(postDistortedR, filteredR, curPostWet);
-
-			// Write
-			pOverL[iSample] = sampleL;
-			pOverR[iSample] = sampleR;
-		}
+		ApplyOversampled(numSamples, postCutoff, postReso, postDrivedB, postWet, postZDF, tubeDistort, tubeDrive, tubeOffset, tubeTone, tubeToneReso);
 
-		// Downsample result
-		m_oversampling4X.processSamplesDown(inputBlock);
+		if (nullptr != m_pVisualization)
+			m_pVisualization->Meter(kVisFilterTube, m_pBufL, m_pBufR, numSamples);
 
 		/* ----------------------------------------------------------------------------------------------------
 
@@ -433,12 +336,20 @@ namespace SFM
 
 		 ------------------------------------------------------------------------------------------------------ */
 
-		// Apply reverb (after post filter to avoid muddy sound)
-		m_reverb.SetRoomSize(reverbRoomSize);
-		m_reverb.SetDampening(reverbDampening);
-		m_reverb.SetWidth(reverbWidth);
-		m_reverb.SetPreDelay(reverbPreDelay);
-		m_reverb.Apply(m_pBufL, m_pBufR, numSamples, reverbWet, reverbLP, reverbHP);
+		SFM_PROFILE_NEXT(stageTimer, kProfileReverb);
+
+		// Apply reverb (after post filter to avoid muddy sound), unless it's left to a send bus
+		if (0 == (m_sends & kSendReverb))
+		{
+			m_reverb.SetRoomSize(reverbRoomSize);
+			m_reverb.SetDampening(reverbDampening);
+			m_reverb.SetWidth(reverbWidth);
+			m_reverb.SetPreDelay(reverbPreDelay);
+			m_reverb.Apply(m_pBufL, m_pBufR, numSamples, reverbWet, reverbLP, reverbHP);
+		}
+
+		if (nullptr != m_pVisualization)
+			m_pVisualization->Meter(kVisReverb, m_pBufL, m_pBufR, numSamples);
 
 		/* ----------------------------------------------------------------------------------------------------
 
@@ -449,8 +360,13 @@ namespace SFM
 
 		 ------------------------------------------------------------------------------------------------------ */
 
+		 SFM_PROFILE_NEXT(stageTimer, kProfileCompressor);
+
 		 m_compressor.SetParameters(compThresholddB, compKneedB, compRatio, compGaindB, compAttack, compRelease, compLookahead);
 		 m_compressorBiteLPF.Apply(m_compressor.Apply(m_pBufL, m_pBufR, numSamples, compAutoGain, compRMSToPeak));
+
+		if (nullptr != m_pVisualization)
+			m_pVisualization->Meter(kVisCompressor, m_pBufL, m_pBufR, numSamples);
 		 
 #endif
 
@@ -459,6 +375,8 @@ namespace SFM
 			Final pass
 
 		 ------------------------------------------------------------------------------------------------------ */
+
+		SFM_PROFILE_NEXT(stageTimer, kProfileFinal);
 		
 		// Set master volume target
 		m_curMasterVol.SetTarget(dBToGain(masterVoldB));
@@ -488,6 +406,87 @@ namespace SFM
 		}
 	}
 
+	/* ----------------------------------------------------------------------------------------------------
+
+		Oversampled pass w/dynamic factor
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void PostPass::ApplyOversampled(unsigned numSamples,
+	                                float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
+	                                float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso)
+	{
+		// Required (oversampled) rate; none if neither the tube nor the filter is audible
+		unsigned requiredRate = 0;
+
+		if (postWet > 0.f)
+			requiredRate = (true == postZDF) ? kLightOversampledRate : kHeavyOversampledRate;
+
+		if (tubeDistort > 0.f)
+		{
+			const float tubeAmount = tubeDistort*(tubeDrive/kMaxTubeDrive);
+			requiredRate = std::max<unsigned>(requiredRate, (tubeAmount >= kHeavyTubeDistortion) ? kHeavyOversampledRate : kLightOversampledRate);
+		}
+
+		const unsigned targetIdx = FactorToIndex(OversampledPass::GetFactorFor(m_sampleRate, requiredRate));
+		SFM_ASSERT(nullptr != m_oversampled[targetIdx]);
+
+		// Start crossfade? (one at a time)
+		if (false == m_oversampledFade && targetIdx != m_curOversampled)
+		{
+			m_nextOversampled = targetIdx;
+			m_oversampledFade = true;
+			m_oversampledWarmUp = 2*unsigned(m_oversampledLatency) + 64;
+			m_oversampledFadePos = 0;
+
+			auto *pNext = m_oversampled[m_nextOversampled];
+			pNext->SetParameters(postCutoff, postReso, postDrivedB, postWet, postZDF, tubeDistort, tubeDrive, tubeOffset, tubeTone, tubeToneReso);
+			pNext->Reset();
+		}
+
+		auto *pCur = m_oversampled[m_curOversampled];
+		pCur->SetParameters(postCutoff, postReso, postDrivedB, postWet, postZDF, tubeDistort, tubeDrive, tubeOffset, tubeTone, tubeToneReso);
+
+		if (false == m_oversampledFade)
+		{
+			pCur->Apply(m_pBufL, m_pBufR, numSamples);
+			return;
+		}
+
+		// Both run during crossfade (and warm-up)
+		auto *pNext = m_oversampled[m_nextOversampled];
+		pNext->SetParameters(postCutoff, postReso, postDrivedB, postWet, postZDF, tubeDistort, tubeDrive, tubeOffset, tubeTone, tubeToneReso);
+
+		const size_t bufSize = numSamples * sizeof(float);
+		memcpy(m_pFadeBufL, m_pBufL, bufSize);
+		memcpy(m_pFadeBufR, m_pBufR, bufSize);
+
+		pCur->Apply(m_pBufL, m_pBufR, numSamples);
+		pNext->Apply(m_pFadeBufL, m_pFadeBufR, numSamples);
+
+		const float fadeStep = 1.f/m_oversampledFadeSize;
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			if (m_oversampledWarmUp > 0)
+			{
+				--m_oversampledWarmUp;
+				continue;
+			}
+
+			// Latencies are equal so a linear fade will do
+			const float fade = (m_oversampledFadePos < m_oversampledFadeSize) ? m_oversampledFadePos++ * fadeStep : 1.f;
+			m_pBufL[iSample] = lerpf<float>(m_pBufL[iSample], m_pFadeBufL[iSample], fade);
+			m_pBufR[iSample] = lerpf<float>(m_pBufR[iSample], m_pFadeBufR[iSample], fade);
+		}
+
+		if (m_oversampledFadePos == m_oversampledFadeSize)
+		{
+			m_curOversampled = m_nextOversampled;
+			m_oversampledFade = false;
+		}
+	}
+
 	/* ----------------------------------------------------------------------------------------------------
 
 		Chorus/Phaser impl.
@@ -498,6 +497,8 @@ namespace SFM
 
 	void PostPass::ApplyChorus(float sampleL, float sampleR, float &outL, float &outR, float wetness)
 	{
+		SFM_PROFILE_DETAIL_SCOPE(kProfileChorusPhaser);
+
 		// Sweep modulation LFO
 		const float sweepMod = fast_cosf(m_chorusSweepMod.Sample());
 		
@@ -527,6 +528,8 @@ namespace SFM
 
 	void PostPass::ApplyPhaser(float sampleL, float sampleR, float &outL, float &outR, float wetness)
 	{
+		SFM_PROFILE_DETAIL_SCOPE(kProfileChorusPhaser);
+
 		// Sweep LFO (filtered for pleasing effect)
 		const float sweepMod = m_phaserSweepLPF.Apply(oscTriangle(m_phaserSweep.Sample()));
 		
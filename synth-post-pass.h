@@ -6,21 +6,17 @@
 
 	FIXME:
 		- Almost the entire path is implemented in Apply(), chop this up into smaller pieces?
-		- Write own (or adapt public domain) up- and downsampling routines (currently using JUCE's)
 		- The list of parameters is rather huge, pass through a structure?
 */
 
 #pragma once
 
 #include "3rdparty/filters/SvfLinearTrapOptimised2.hpp"
-#include "3rdparty/filters/MusicDSPModel.h"
 #include "3rdparty/filters/Biquad.h"
 
-// Include JUCE (for juce::dsp::Oversampling)
-#include <JuceHeader.h>
-
 #include "synth-global.h"
 #include "synth-delay-line.h"
+#include "synth-main-delay.h"
 #include "synth-phase.h"
 #include "synth-one-pole-filters.h"
 #include "synth-interpolated-parameter.h"
@@ -28,30 +24,55 @@
 #include "synth-compressor.h"
 #include "synth-auto-wah-vox.h"
 #include "synth-mini-EQ.h"
+#include "synth-oversampled-pass.h"
+#include "synth-visualization.h"
 
 namespace SFM
 {
 	const unsigned kNumPhaserStages = 8;
 
+	// Stages that can be left to a shared send bus (see PostPass::SetSends())
+	enum PostPassSends
+	{
+		kSendDelay  = 1,
+		kSendReverb = 2
+	};
+
 	class PostPass
 	{
 	public:
-		PostPass(unsigned sampleRate, unsigned maxSamplesPerBlock, unsigned Nyquist);
+		PostPass(Arena &arena, unsigned sampleRate, unsigned maxSamplesPerBlock, unsigned Nyquist, uint64_t randomSeed);
 		~PostPass();
 
+		// Arena space needed by constructor (excl. PostPass itself)
+		static size_t GetArenaSize(unsigned sampleRate, unsigned maxSamplesPerBlock);
+
 		// FIXME: this parameter list is just too ridiculously long!
 		void Apply(unsigned numSamples,
 		           float rateBPM, unsigned overideFlagsRateBPM, /* See impl. for details! */
 				   float wahResonance, float wahAttack, float wahHold, float wahRate, float wahDrivedB, float wahSpeak, float wahSpeakVowel, float wahSpeakVowelMod, float wahSpeakGhost, float wahSpeakCut, float wahSpeakReso, float wahCut, float wahWet,
 		           float cpRate, float cpWet, bool isChorus,
 		           float delayInSec, float delayWet, float delayDrivedB, float delayFeedback, float delayFeedbackCutoff, float delayTapeWow,
-		           float postCutoff, float postReso, float postDrivedB, float postWet,
+		           float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
 		           float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso,
 		           float reverbWet, float reverbRoomSize, float reverbDampening, float reverbWidth, float reverbLP, float reverbHP, float reverbPreDelay,
 		           float compThresholddB, float compKneedB, float compRatio, float compGaindB, float compAttack, float compRelease, float compLookahead, bool compAutoGain, float compRMSToPeak,
 				   float bassTuning, float trebleTuning, float midTuning, float masterVol,
 		           const float *pLeftIn, const float *pRightIn, float *pLeftOut, float *pRightOut);
 
+		// Meter each stage's output during Apply() (nullptr to stop)
+		void SetVisualization(Visualization *pVisualization)
+		{
+			m_pVisualization = pVisualization;
+		}
+
+		// Skip delay and/or reverb ('sends' are PostPassSends), which are then run once, on a bus shared by multiple
+		// instances (see synth-rack.h); their wet parameters are the send levels
+		void SetSends(unsigned sends)
+		{
+			m_sends = sends;
+		}
+
 		// Intended for a graphical indicator
 		float GetCompressorBite() const
 		{
@@ -83,30 +104,26 @@ namespace SFM
 			m_phaserSweep.SetFrequency(rate);
 		}
 		
+		void ApplyOversampled(unsigned numSamples,
+		                      float postCutoff, float postReso, float postDrivedB, float postWet, bool postZDF,
+		                      float tubeDistort, float tubeDrive, float tubeOffset, float tubeTone, bool tubeToneReso);
+
 		void ApplyChorus(float sampleL, float sampleR, float &outL, float &outR, float wetness);
 		void ApplyPhaser(float sampleL, float sampleR, float &outL, float &outR, float wetness);
 		
 		const unsigned m_sampleRate;
 		const unsigned m_Nyquist;
-		const unsigned m_sampleRate4X; // Convenience
 
 		// Intermediate buffers
 		float *m_pBufL = nullptr;
 		float *m_pBufR = nullptr;
 
-		// Delay lines & delay's interpolated parameters
-		Phase m_tapeDelayLFO;
-		SinglePoleLPF m_tapeDelayLPF;
-		DelayLine m_delayLineL;
-		DelayLine m_delayLineM;
-		DelayLine m_delayLineR;
-		CascadedSinglePoleLPF m_delayFeedbackLPF_L, m_delayFeedbackLPF_R;
-		InterpolatedParameter<kLinInterpolate, true, 0.f, kMainDelayInSec> m_curDelayInSec;
-		InterpolatedParameter<kLinInterpolate, true> m_curDelayWet;
-		InterpolatedParameter<kLinInterpolate, false> m_curDelayDrive;
-		InterpolatedParameter<kLinInterpolate, true> m_curDelayFeedback;
-		InterpolatedParameter<kLinInterpolate, true> m_curDelayFeedbackCutoff;
-		InterpolatedParameter<kLinInterpolate, true> m_curDelayTapeWow;
+		// Buffers for oversampled pass that's fading in
+		float *m_pFadeBufL = nullptr;
+		float *m_pFadeBufR = nullptr;
+
+		// Delay
+		MainDelay m_delay;
 
 		// Chorus
 		DelayLine m_chorusDL;
@@ -118,23 +135,17 @@ namespace SFM
 		Phase m_phaserSweep;
 		SinglePoleLPF m_phaserSweepLPF;
 
-		// Oversampling (JUCE, FIXME)
-		juce::dsp::Oversampling<float> m_oversampling4X;
-
-		// Post filter & interpolated parameters
-		MusicDSPMoog m_postFilter;
-		InterpolatedParameter<kLinInterpolate, true> m_curPostCutoff;
-		InterpolatedParameter<kLinInterpolate, true> m_curPostReso;
-		InterpolatedParameter<kLinInterpolate, false> m_curPostDrive;
-		InterpolatedParameter<kLinInterpolate, true> m_curPostWet;
-
-		// Tube distortion filter (AA), DC blocker & interpolated parameters
-		InterpolatedParameter<kLinInterpolate, true> m_curTubeDist;
-		InterpolatedParameter<kLinInterpolate, false> m_curTubeDrive;
-		InterpolatedParameter<kLinInterpolate, false> m_curTubeOffset;
-		InterpolatedParameter<kLinInterpolate, true> m_curTubeTone; // Normalized cutoff
-		SvfLinearTrapOptimised2 m_tubeToneFilter;
-		StereoDCBlocker m_tubeDCBlocker;	
+		// Oversampled tube distortion & post filter, one per factor (1X, 2X, 4X) if it can occur at this sample rate (constructed in arena)
+		OversampledPass *m_oversampled[kNumOversamplingFactors] = { nullptr };
+		float m_oversampledLatency = 0.f; // Of slowest factor, the others are compensated
+
+		// Current & next (crossfading) oversampled pass
+		unsigned m_curOversampled  = 0;
+		unsigned m_nextOversampled = 0;
+		bool m_oversampledFade = false;
+		unsigned m_oversampledWarmUp   = 0; // Samples to wait before fading in (flushes filters)
+		unsigned m_oversampledFadePos  = 0;
+		unsigned m_oversampledFadeSize = 0;
 		
 		// Post
 		MiniEQ m_postEQ;
@@ -148,6 +159,12 @@ namespace SFM
 		// Exposed to be used, chiefly, as indicator
 		CascadedSinglePoleLPF m_compressorBiteLPF;
 
+		// See SetSends()
+		unsigned m_sends = 0;
+
+		// Not owned, nullptr if no one's watching
+		Visualization *m_pVisualization = nullptr;
+
 		// Misc.
 		InterpolatedParameter<kLinInterpolate, true> m_curChorusWet;
 		InterpolatedParameter<kLinInterpolate, true> m_curPhaserWet;
@@ -0,0 +1,402 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Multi-timbral rack.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include "synth-rack.h"
+
+namespace SFM
+{
+	constexpr unsigned kRackChannels = 16;
+
+	BisonRack::BisonRack(unsigned numParts, int numThreads /* = -1 */) :
+		m_pool((numThreads < 0) ? JobPool::GetDefaultNumThreads() : unsigned(numThreads))
+,		m_numParts(numParts)
+	{
+		SFM_ASSERT(numParts > 0 && numParts <= kMaxRackParts);
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part *pPart = new Part();
+			pPart->bison.SetJobPool(&m_pool);
+			pPart->bison.SetWorker(&m_worker);
+
+			pPart->job.function = RenderPartJob;
+			pPart->job.pInstance = this;
+			pPart->job.pData = pPart;
+
+			m_parts[iPart] = pPart;
+		}
+
+		memset(m_heldParts, 0, sizeof(m_heldParts));
+
+		// Bus patch: only delay & reverb are used
+		m_busPatch.ResetToEngineDefaults();
+
+		SFM_LOG("Rack: {} parts, {} pool thread(s)", m_numParts, GetNumThreads());
+	}
+
+	BisonRack::~BisonRack()
+	{
+		DeleteRateDependentObjects();
+
+		for (Part *pPart : m_parts)
+			delete pPart;
+	}
+
+	void BisonRack::SetPartChannel(unsigned iPart, int channel)
+	{
+		SFM_ASSERT(iPart < m_numParts);
+		SFM_ASSERT(kRackOmni == channel || (channel >= 0 && channel < int(kRackChannels)));
+
+		m_parts[iPart]->channel = channel;
+	}
+
+	void BisonRack::SetPartKeyRange(unsigned iPart, unsigned lowKey, unsigned highKey)
+	{
+		SFM_ASSERT(iPart < m_numParts);
+		SFM_ASSERT(lowKey <= highKey && highKey <= 127);
+
+		m_parts[iPart]->lowKey  = lowKey;
+		m_parts[iPart]->highKey = highKey;
+	}
+
+	void BisonRack::SetSendBuses(unsigned sends)
+	{
+		SFM_ASSERT(0 == (sends & ~unsigned(kSendDelay|kSendReverb)));
+
+		m_sends = sends;
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+			m_parts[iPart]->bison.SetSends(sends);
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Sampling properties
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void BisonRack::OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock, unsigned internalRate /* = 0 */)
+	{
+		SFM_LOG("BisonRack::OnSetSamplingProperties({}, {}, {})", sampleRate, samplesPerBlock, internalRate);
+
+		DeleteRateDependentObjects();
+
+		m_sampleRate = sampleRate;
+		m_samplesPerBlock = samplesPerBlock;
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+			m_parts[iPart]->bison.OnSetSamplingProperties(sampleRate, samplesPerBlock, internalRate);
+
+		// Size arena; order of allocation below must match
+		size_t arenaSize = m_numParts*2*Arena::GetFloatsSize(samplesPerBlock);
+
+		if (0 != (m_sends & kSendDelay))
+			arenaSize += Arena::Align(sizeof(MainDelay)) + MainDelay::GetArenaSize(sampleRate) + 2*Arena::GetFloatsSize(samplesPerBlock);
+
+		if (0 != (m_sends & kSendReverb))
+			arenaSize += Arena::Align(sizeof(Reverb)) + Reverb::GetArenaSize(sampleRate) + 2*Arena::GetFloatsSize(samplesPerBlock);
+
+		m_arena.Reserve(arenaSize, 0 != SFM_LOCK_ARENA);
+
+		// Part output & send levels
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part &part = *m_parts[iPart];
+			part.pBufL = m_arena.AllocateFloats(samplesPerBlock);
+			part.pBufR = m_arena.AllocateFloats(samplesPerBlock);
+
+			const Patch &patch = part.bison.GetPatch();
+			part.delaySend  = { patch.delayWet,  sampleRate, kDefParameterLatency };
+			part.reverbSend = { patch.reverbWet, sampleRate, kDefParameterLatency };
+		}
+
+		// Send buses
+		if (0 != (m_sends & kSendDelay))
+		{
+			m_delay = new (m_arena.Allocate(sizeof(MainDelay))) MainDelay(m_arena, sampleRate, sampleRate>>1);
+			m_delay->SetWetOnly(true);
+
+			m_pDelaySendL = m_arena.AllocateFloats(samplesPerBlock);
+			m_pDelaySendR = m_arena.AllocateFloats(samplesPerBlock);
+		}
+
+		if (0 != (m_sends & kSendReverb))
+		{
+			m_reverb = new (m_arena.Allocate(sizeof(Reverb))) Reverb(m_arena, sampleRate, sampleRate>>1);
+			m_reverb->SetWetOnly(true);
+
+			m_pReverbSendL = m_arena.AllocateFloats(samplesPerBlock);
+			m_pReverbSendR = m_arena.AllocateFloats(samplesPerBlock);
+		}
+
+		// Held notes were cut by the parts
+		memset(m_heldParts, 0, sizeof(m_heldParts));
+	}
+
+	void BisonRack::DeleteRateDependentObjects()
+	{
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part &part = *m_parts[iPart];
+			part.bison.DeleteRateDependentObjects();
+			part.pBufL = part.pBufR = nullptr;
+		}
+
+		if (nullptr != m_delay)
+		{
+			m_delay->~MainDelay();
+			m_delay = nullptr;
+		}
+
+		if (nullptr != m_reverb)
+		{
+			m_reverb->~Reverb();
+			m_reverb = nullptr;
+		}
+
+		m_pDelaySendL = m_pDelaySendR = nullptr;
+		m_pReverbSendL = m_pReverbSendR = nullptr;
+
+		m_sampleRate = 0;
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Events
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void BisonRack::NoteOn(unsigned channel, unsigned key, float velocity, unsigned timeStamp)
+	{
+		SFM_ASSERT(channel < kRackChannels);
+		SFM_ASSERT(key <= 127);
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part &part = *m_parts[iPart];
+
+			if (true == part.IsListening(channel) && key >= part.lowKey && key <= part.highKey)
+			{
+				part.bison.NoteOn(key, -1.f, velocity, timeStamp);
+				m_heldParts[channel][key] |= 1 << iPart;
+			}
+		}
+	}
+
+	void BisonRack::NoteOff(unsigned channel, unsigned key, unsigned timeStamp)
+	{
+		SFM_ASSERT(channel < kRackChannels);
+		SFM_ASSERT(key <= 127);
+
+		const unsigned heldParts = m_heldParts[channel][key];
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			if (0 != (heldParts & (1 << iPart)))
+				m_parts[iPart]->bison.NoteOff(key, timeStamp);
+		}
+
+		m_heldParts[channel][key] = 0;
+	}
+
+	void BisonRack::Sustain(unsigned channel, bool state)
+	{
+		SFM_ASSERT(channel < kRackChannels);
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			if (true == m_parts[iPart]->IsListening(channel))
+				m_parts[iPart]->bison.Sustain(state);
+		}
+	}
+
+	void BisonRack::SetControllers(unsigned channel, float bendWheel, float modulation, float aftertouch)
+	{
+		SFM_ASSERT(channel < kRackChannels);
+		SFM_ASSERT_BINORM(bendWheel);
+		SFM_ASSERT_NORM(modulation);
+		SFM_ASSERT_NORM(aftertouch);
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part &part = *m_parts[iPart];
+
+			if (true == part.IsListening(channel))
+			{
+				part.bendWheel  = bendWheel;
+				part.modulation = modulation;
+				part.aftertouch = aftertouch;
+			}
+		}
+	}
+
+	void BisonRack::SetBPM(float BPM, bool resetPhase)
+	{
+		m_BPM = BPM;
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+			m_parts[iPart]->bison.SetBPM(BPM, resetPhase);
+	}
+
+	int BisonRack::GetLatency() const
+	{
+		int latency = 0;
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+			latency = std::max(latency, m_parts[iPart]->bison.GetLatency());
+
+		return latency;
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Render
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	/* static */ void BisonRack::RenderPartJob(void *pInst, void *pPart)
+	{
+		const BisonRack &rack = *reinterpret_cast<const BisonRack *>(pInst);
+		Part &part = *reinterpret_cast<Part *>(pPart);
+
+		part.bison.Render(rack.m_renderSamples, part.bendWheel, part.modulation, part.aftertouch, part.pBufL, part.pBufR);
+	}
+
+	void BisonRack::Render(unsigned numSamples, float *pLeft, float *pRight)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+		SFM_ASSERT(0 != m_sampleRate);
+
+		if (numSamples > m_samplesPerBlock)
+		{
+			// See Bison::Render()
+			SFM_ASSERT(false);
+			return;
+		}
+
+#if SFM_KILL_DENORMALS
+		// Disable denormals (parts do so themselves, this is for the send buses)
+		DisableDenormals disableDEN;
+#endif
+
+		// Render all parts, helping out until they're done (each pushes jobs of it's own for voices)
+		m_renderSamples = numSamples;
+
+		JobGroup group;
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+			m_pool.Push(m_parts[iPart]->job, group);
+
+		m_pool.Wait(group);
+
+		// Mix parts (in order) & feed send buses
+		memset(pLeft,  0, numSamples*sizeof(float));
+		memset(pRight, 0, numSamples*sizeof(float));
+
+		if (nullptr != m_delay)
+		{
+			memset(m_pDelaySendL, 0, numSamples*sizeof(float));
+			memset(m_pDelaySendR, 0, numSamples*sizeof(float));
+		}
+
+		if (nullptr != m_reverb)
+		{
+			memset(m_pReverbSendL, 0, numSamples*sizeof(float));
+			memset(m_pReverbSendR, 0, numSamples*sizeof(float));
+		}
+
+		for (unsigned iPart = 0; iPart < m_numParts; ++iPart)
+		{
+			Part &part = *m_parts[iPart];
+			const float *pPartL = part.pBufL;
+			const float *pPartR = part.pBufR;
+
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				pLeft[iSample]  += pPartL[iSample];
+				pRight[iSample] += pPartR[iSample];
+			}
+
+			const Patch &patch = part.bison.GetPatch();
+
+			if (nullptr != m_delay)
+			{
+				part.delaySend.SetTarget(patch.delayWet);
+
+				for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				{
+					const float send = part.delaySend.Sample();
+					m_pDelaySendL[iSample] += pPartL[iSample]*send;
+					m_pDelaySendR[iSample] += pPartR[iSample]*send;
+				}
+			}
+
+			if (nullptr != m_reverb)
+			{
+				part.reverbSend.SetTarget(patch.reverbWet);
+
+				for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+				{
+					const float send = part.reverbSend.Sample();
+					m_pReverbSendL[iSample] += pPartL[iSample]*send;
+					m_pReverbSendR[iSample] += pPartR[iSample]*send;
+				}
+			}
+		}
+
+		ApplySendBuses(numSamples);
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			// Returns
+			if (nullptr != m_delay)
+			{
+				pLeft[iSample]  += m_pDelaySendL[iSample];
+				pRight[iSample] += m_pDelaySendR[iSample];
+			}
+
+			if (nullptr != m_reverb)
+			{
+				pLeft[iSample]  += m_pReverbSendL[iSample];
+				pRight[iSample] += m_pReverbSendR[iSample];
+			}
+
+			// Clamp because DAWs like it like that (see PostPass)
+			pLeft[iSample]  = Clamp(pLeft[iSample]);
+			pRight[iSample] = Clamp(pRight[iSample]);
+		}
+	}
+
+	// Processes (in place) what's been sent to the buses, wet only, scaled by the return levels
+	void BisonRack::ApplySendBuses(unsigned numSamples)
+	{
+		if (nullptr != m_delay)
+		{
+			// Synchronize to BPM like Bison does, unless it's overridden or doesn't fit the delay line
+			float delayInSec = m_busPatch.delayInSec;
+
+			if (true == m_busPatch.beatSync && 0.f != m_BPM && 0 == (m_busPatch.syncOverride & kFlagOverrideDelay))
+			{
+				SFM_ASSERT(m_busPatch.beatSyncRatio > 0.f);
+
+				const float syncInSec = m_busPatch.beatSyncRatio/(m_BPM/60.f);
+				if (syncInSec < kMainDelayInSec)
+					delayInSec = syncInSec;
+			}
+
+			m_delay->SetParameters(delayInSec, m_busPatch.delayWet, m_busPatch.delayDrivedB, m_busPatch.delayFeedback, m_busPatch.delayFeedbackCutoff, m_busPatch.delayTapeWow);
+			m_delay->Apply(m_pDelaySendL, m_pDelaySendR, numSamples);
+		}
+
+		if (nullptr != m_reverb)
+		{
+			m_reverb->SetRoomSize(m_busPatch.reverbRoomSize);
+			m_reverb->SetDampening(m_busPatch.reverbDampening);
+			m_reverb->SetWidth(m_busPatch.reverbWidth);
+			m_reverb->SetPreDelay(m_busPatch.reverbPreDelay);
+			m_reverb->Apply(m_pReverbSendL, m_pReverbSendR, numSamples, m_busPatch.reverbWet, m_busPatch.reverbBassTuningdB, m_busPatch.reverbTrebleTuningdB);
+		}
+	}
+}
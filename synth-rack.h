@@ -0,0 +1,151 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Multi-timbral rack.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	A number of Bison instances ('parts'), each with it's own patch, MIDI channel & key range, that share one
+	work-stealing job pool (see helper/synth-job-pool.h) and, optionally, a delay and/or reverb send bus
+
+	- Render() pushes a job for each part, which in turn pushes jobs for it's voices (see Bison::SetJobPool()), and
+	  helps out until they're all done; parts are then mixed in order, so output doesn't depend on the thread count
+	- Parts share one background worker (see helper/synth-background-worker.h) for slow, non real-time work
+	  (standby PostPass & note tables) instead of each starting a thread of it's own
+	- Send buses: parts skip the stage (see Bison::SetSends()) and send their output to the bus instead, their patch's
+	  'delayWet' & 'reverbWet' are then send levels; the buses themselves are set up with GetBusPatch()
+	- Note events are routed by channel & key range; a NoteOff() goes to the parts that got the NoteOn(), so changing
+	  ranges whilst notes are held doesn't leave them hanging
+	- Same rules as Bison: not thread-safe, call OnSetSamplingProperties() before Render() and only touch patches in
+	  between Render() calls
+
+	FIXME:
+		- Latency differences between parts (internal rate, compressor lookahead) aren't compensated
+*/
+
+#pragma once
+
+#include "FM_BISON.h"
+#include "synth-main-delay.h"
+#include "synth-reverb.h"
+
+namespace SFM
+{
+	constexpr unsigned kMaxRackParts = 16;
+
+	// Part listens to all channels
+	constexpr int kRackOmni = -1;
+
+	class BisonRack
+	{
+	public:
+		// 'numThreads' - pool threads besides the one calling Render(); -1 is one less than there are hardware threads
+		BisonRack(unsigned numParts, int numThreads = -1);
+		~BisonRack();
+
+		unsigned GetNumParts() const { return m_numParts; }
+
+		// For it's patch, voices, telemetry & visualization; leave rendering, sampling properties & note events to the rack
+		Bison &GetPart(unsigned iPart)
+		{
+			SFM_ASSERT(iPart < m_numParts);
+			return m_parts[iPart]->bison;
+		}
+
+		// MIDI channel [0..15] or kRackOmni (default)
+		void SetPartChannel(unsigned iPart, int channel);
+
+		// Inclusive, [0..127] (default)
+		void SetPartKeyRange(unsigned iPart, unsigned lowKey, unsigned highKey);
+
+		// Stages to run on a shared bus instead of in each part ('sends' are PostPassSends, see synth-post-pass.h)
+		// Call before OnSetSamplingProperties()
+		void SetSendBuses(unsigned sends);
+
+		// Send buses are set up by the delay* & reverb* parameters (plus BPM sync.) of this patch, with 'delayWet' &
+		// 'reverbWet' as return levels
+		Patch &GetBusPatch()
+		{
+			return m_busPatch;
+		}
+
+		// See Bison::OnSetSamplingProperties(), send buses always run at host rate
+		void OnSetSamplingProperties(unsigned sampleRate, unsigned samplesPerBlock, unsigned internalRate = 0);
+		void DeleteRateDependentObjects();
+
+		// Note events
+		void NoteOn(unsigned channel, unsigned key, float velocity, unsigned timeStamp);
+		void NoteOff(unsigned channel, unsigned key, unsigned timeStamp);
+		void Sustain(unsigned channel, bool state);
+
+		// Wheels & aftertouch (see Bison::Render()), per channel; used from the next Render() on
+		void SetControllers(unsigned channel, float bendWheel, float modulation, float aftertouch);
+
+		void SetBPM(float BPM, bool resetPhase);
+
+		// Render number of samples to 2 channels (stereo)
+		void Render(unsigned numSamples, float *pLeft, float *pRight);
+
+		// Largest of all parts
+		int GetLatency() const;
+
+		unsigned GetNumThreads() const { return m_pool.GetNumWorkers()-1; }
+
+	private:
+		struct Part
+		{
+			Bison bison;
+
+			int channel = kRackOmni;
+			unsigned lowKey = 0, highKey = 127;
+
+			float bendWheel = 0.f;
+			float modulation = 0.f;
+			float aftertouch = 0.f;
+
+			// Output (carved from m_arena)
+			float *pBufL = nullptr;
+			float *pBufR = nullptr;
+
+			// Send levels
+			InterpolatedParameter<kLinInterpolate, true> delaySend;
+			InterpolatedParameter<kLinInterpolate, true> reverbSend;
+
+			Job job;
+
+			bool IsListening(unsigned channel) const
+			{
+				return kRackOmni == this->channel || int(channel) == this->channel;
+			}
+		};
+
+		static void RenderPartJob(void *pInst, void *pPart);
+
+		void ApplySendBuses(unsigned numSamples);
+
+		JobPool m_pool;
+		BackgroundWorker m_worker; // Shared by all parts, see Bison::SetWorker()
+
+		const unsigned m_numParts;
+		Part *m_parts[kMaxRackParts] = { nullptr };
+
+		// For each channel & key, parts (bits) that got the NoteOn()
+		uint16_t m_heldParts[16][128];
+		static_assert(kMaxRackParts <= 16);
+
+		unsigned m_sampleRate = 0;
+		unsigned m_samplesPerBlock = 0;
+		unsigned m_renderSamples = 0;
+
+		float m_BPM = 0.f;
+
+		// Send buses (carved from m_arena)
+		unsigned m_sends = 0;
+		Patch m_busPatch;
+
+		Arena m_arena;
+		MainDelay *m_delay = nullptr;
+		Reverb *m_reverb = nullptr;
+		float *m_pDelaySendL = nullptr, *m_pDelaySendR = nullptr;
+		float *m_pReverbSendL = nullptr, *m_pReverbSendR = nullptr;
+	};
+}
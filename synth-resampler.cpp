@@ -0,0 +1,109 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Polyphase upsampler (stereo, SSE).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include <xmmintrin.h>
+
+#include "synth-resampler.h"
+
+namespace SFM
+{
+	// Kaiser window beta (approx. 80dB stopband)
+	constexpr double kUpsamplerKaiserBeta = 7.857;
+
+	PolyphaseUpsampler::PolyphaseUpsampler(Arena &arena, unsigned factor) :
+		m_factor(factor)
+	{
+		SFM_ASSERT(2 == factor || 4 == factor);
+
+		m_pPhases   = arena.AllocateFloats(factor*kUpsamplerTapsPerPhase);
+		m_pHistoryL = arena.AllocateFloats(2*kUpsamplerTapsPerPhase);
+		m_pHistoryR = arena.AllocateFloats(2*kUpsamplerTapsPerPhase);
+
+		// Design lowpass at output rate with cutoff at input Nyquist; odd length, so last tap of last phase is zero
+		const unsigned numTaps = factor*kUpsamplerTapsPerPhase - 1;
+		const double center = (numTaps-1)*0.5;
+		const double cutoff = 0.5/factor; // Normalized (cycles per sample)
+		const double windowNorm = 1.0/BesselI0(kUpsamplerKaiserBeta);
+
+		auto prototype = [=](unsigned iTap) -> double
+		{
+			if (iTap >= numTaps)
+				return 0.0;
+
+			const double offset = iTap-center;
+			const double x = 2.0*cutoff*offset;
+			const double sinc = (0.0 == x) ? 1.0 : sin(kPI*x)/(kPI*x);
+			const double ratio = offset/center;
+			const double window = BesselI0(kUpsamplerKaiserBeta*sqrt(std::max(0.0, 1.0-ratio*ratio)))*windowNorm;
+
+			// Gain compensates for zero stuffing
+			return factor*2.0*cutoff*sinc*window;
+		};
+
+		// Split into phases, reversed to match history order (oldest first)
+		for (unsigned iPhase = 0; iPhase < factor; ++iPhase)
+		{
+			float *pPhase = m_pPhases + iPhase*kUpsamplerTapsPerPhase;
+
+			for (unsigned iTap = 0; iTap < kUpsamplerTapsPerPhase; ++iTap)
+				pPhase[iTap] = float(prototype(iPhase + (kUpsamplerTapsPerPhase-1-iTap)*factor));
+		}
+
+		Reset();
+	}
+
+	void PolyphaseUpsampler::Reset()
+	{
+		memset(m_pHistoryL, 0, 2*kUpsamplerTapsPerPhase*sizeof(float));
+		memset(m_pHistoryR, 0, 2*kUpsamplerTapsPerPhase*sizeof(float));
+		m_writeIdx = 0;
+	}
+
+	// Horizontal sum
+	SFM_INLINE static float HorizontalSum(__m128 sum)
+	{
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		return _mm_cvtss_f32(sum);
+	}
+
+	void PolyphaseUpsampler::Apply(const float *pLeft, const float *pRight, unsigned numSamples, float *pDestL, float *pDestR)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+		SFM_ASSERT(nullptr != pDestL && nullptr != pDestR);
+
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+		{
+			// Write to history (twice)
+			m_writeIdx = (m_writeIdx+1) % kUpsamplerTapsPerPhase;
+			m_pHistoryL[m_writeIdx] = m_pHistoryL[m_writeIdx+kUpsamplerTapsPerPhase] = pLeft[iSample];
+			m_pHistoryR[m_writeIdx] = m_pHistoryR[m_writeIdx+kUpsamplerTapsPerPhase] = pRight[iSample];
+
+			// Last kUpsamplerTapsPerPhase samples, oldest first
+			const float *pHistL = m_pHistoryL + m_writeIdx + 1;
+			const float *pHistR = m_pHistoryR + m_writeIdx + 1;
+
+			for (unsigned iPhase = 0; iPhase < m_factor; ++iPhase)
+			{
+				const float *pPhase = m_pPhases + iPhase*kUpsamplerTapsPerPhase;
+
+				__m128 sumL = _mm_setzero_ps();
+				__m128 sumR = _mm_setzero_ps();
+
+				for (unsigned iTap = 0; iTap < kUpsamplerTapsPerPhase; iTap += 4)
+				{
+					const __m128 taps = _mm_load_ps(pPhase + iTap);
+					sumL = _mm_add_ps(sumL, _mm_mul_ps(taps, _mm_loadu_ps(pHistL + iTap)));
+					sumR = _mm_add_ps(sumR, _mm_mul_ps(taps, _mm_loadu_ps(pHistR + iTap)));
+				}
+
+				*pDestL++ = HorizontalSum(sumL);
+				*pDestR++ = HorizontalSum(sumR);
+			}
+		}
+	}
+}
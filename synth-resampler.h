@@ -0,0 +1,65 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Polyphase upsampler (stereo, SSE).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Used to render the engine at an internal rate (say 48KHz) and bring it up to the host rate (say 192KHz);
+	this only supports integer factors (2 or 4), which covers all common host rates (88.2/96/176.4/192KHz)
+
+	- Windowed sinc (Kaiser) lowpass, split into 'factor' phases of kUpsamplerTapsPerPhase taps each
+	- History is kept twice (mirrored) so each phase is a straight dot product (4 taps at a time using SSE)
+	- Odd number of taps so latency is an integer number of (host) samples
+
+	FIXME:
+		- Support rational factors (like 44.1KHz -> 48KHz)?
+*/
+
+#pragma once
+
+#include "synth-global.h"
+#include "helper/synth-arena.h"
+
+namespace SFM
+{
+	constexpr unsigned kUpsamplerTapsPerPhase = 32; // Must be a multiple of 4
+
+	class PolyphaseUpsampler
+	{
+	public:
+		PolyphaseUpsampler(Arena &arena, unsigned factor /* 2 or 4 */);
+		~PolyphaseUpsampler() {}
+
+		static size_t GetArenaSize(unsigned factor)
+		{
+			return Arena::GetFloatsSize(factor*kUpsamplerTapsPerPhase) + 2*Arena::GetFloatsSize(2*kUpsamplerTapsPerPhase);
+		}
+
+		void Reset();
+
+		// Writes numSamples*factor samples to destination
+		void Apply(const float *pLeft, const float *pRight, unsigned numSamples, float *pDestL, float *pDestR);
+
+		unsigned GetFactor() const
+		{
+			return m_factor;
+		}
+
+		// In output (host) samples
+		unsigned GetLatency() const
+		{
+			return (kUpsamplerTapsPerPhase*m_factor - 2)/2;
+		}
+
+	private:
+		const unsigned m_factor;
+
+		// Per phase, reversed so they line up with history (factor*kUpsamplerTapsPerPhase)
+		float *m_pPhases = nullptr;
+
+		// Mirrored history (2*kUpsamplerTapsPerPhase per channel)
+		float *m_pHistoryL = nullptr;
+		float *m_pHistoryR = nullptr;
+		unsigned m_writeIdx = 0;
+	};
+}
@@ -52,10 +52,37 @@ namespace SFM
 	// Pre-delay line length (in seconds)
 	constexpr float kReverbPreDelayLen = 0.5f; // 500MS
 
-	Reverb::Reverb(unsigned sampleRate, unsigned Nyquist) :
+	// Total number of floats needed for all combs & all-passes (L+R)
+	static size_t GetTotalBufSize(unsigned sampleRate)
+	{
+		const size_t stereoSpread = ScaleNumSamples(sampleRate, kStereoSpread);
+
+		size_t totalBufSize = 0;
+		
+		for (auto size : kCombSizes)
+		{
+			size = ScaleNumSamples(sampleRate, size);
+			totalBufSize += size + (size+stereoSpread);
+		}
+		
+		for (auto size : kAllPassSizes)
+		{
+			size = ScaleNumSamples(sampleRate, size);
+			totalBufSize += size + (size+stereoSpread);
+		}
+
+		return totalBufSize;
+	}
+
+	size_t Reverb::GetArenaSize(unsigned sampleRate)
+	{
+		return DelayLine::GetArenaSize(sampleRate, kReverbPreDelayLen) + Arena::GetFloatsSize(GetTotalBufSize(sampleRate));
+	}
+
+	Reverb::Reverb(Arena &arena, unsigned sampleRate, unsigned Nyquist) :
 		m_sampleRate(sampleRate), m_Nyquist(Nyquist)
 ,		m_preEQ(sampleRate, false)
-,		m_preDelayLine(sampleRate, kReverbPreDelayLen)
+,		m_preDelayLine(arena, sampleRate, kReverbPreDelayLen)
 ,		m_width(kDefaultWidth)
 ,		m_roomSize(kDefaultRoomSize)
 ,		m_preDelay(0.f)
@@ -75,22 +102,8 @@ namespace SFM
 		const size_t stereoSpread = ScaleNumSamples(sampleRate, kStereoSpread);
 		
 		// Allocate single sequential buffer
-		size_t totalBufSize = 0;
-		
-		for (auto size : kCombSizes)
-		{
-			size = ScaleNumSamples(sampleRate, size);
-			totalBufSize += size + (size+stereoSpread);
-		}
-		
-		for (auto size : kAllPassSizes)
-		{
-			size = ScaleNumSamples(sampleRate, size);
-			totalBufSize += size + (size+stereoSpread);
-		}
-		
-		m_totalBufSize = totalBufSize*sizeof(float);
-		m_buffer = reinterpret_cast<float*>(mallocAligned(m_totalBufSize, 16));
+		m_totalBufSize = GetTotalBufSize(sampleRate)*sizeof(float);
+		m_buffer = reinterpret_cast<float*>(arena.Allocate(m_totalBufSize));
 		
 		// Set sizes and pointers
 		size_t offset = 0;
@@ -138,7 +151,7 @@ namespace SFM
 		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
 		{
 			const float curWet = m_curWet.Sample() * kMaxReverbWet; // Doesn't sound like much if fully open, consider different mix below? (FIXME)
-			const float dry = 1.f-curWet;
+			const float dry = (false == m_wetOnly) ? 1.f-curWet : 0.f;
 
 			// Stereo (width) effect
 			const float width = m_curWidth.Sample();
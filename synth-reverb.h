@@ -137,12 +137,12 @@ namespace SFM
 	class Reverb
 	{
 	public:
-		Reverb(unsigned sampleRate, unsigned Nyquist);
+		Reverb(Arena &arena, unsigned sampleRate, unsigned Nyquist);
 		
-		~Reverb()
-		{
-			freeAligned(m_buffer);
-		}
+		~Reverb() {}
+
+		// Pre-delay line & comb/all-pass buffer
+		static size_t GetArenaSize(unsigned sampleRate);
 	
 	public:
 		SFM_INLINE void SetWidth(float width)
@@ -176,6 +176,12 @@ namespace SFM
 			m_preDelay = preDelay;
 		}
 
+		// Output just the reverb (dry level is zero), for use as a send bus
+		SFM_INLINE void SetWetOnly(bool wetOnly)
+		{
+			m_wetOnly = wetOnly;
+		}
+
 		// Samples are read & written sequentially so one buffer per channel suffices
 		void Apply(float *pLeft, float *pRight, unsigned numSamples, float wet, float bassTuning, float trebleTuning);
 
@@ -195,6 +201,7 @@ namespace SFM
 		float m_roomSize;
 		float m_dampening;
 		float m_preDelay;
+		bool m_wetOnly = false;
 
 		// Interpolated parameters
 		InterpolatedParameter<kLinInterpolate, true> m_curWet;
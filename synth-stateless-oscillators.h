@@ -6,10 +6,13 @@
 
 	- Phase is [0..1], this range must be adhered to except for oscSine() and oscCos()
 	- Band-limited (PolyBLEP) oscillators are called 'oscPoly...'
+	- These have a block version (same name) that renders a phase ramp (see Phase::Sample()) 4 samples at a time (SSE)
 */
 
 #pragma once
 
+#include <xmmintrin.h>
+
 #include "synth-global.h"
 
 namespace SFM
@@ -146,6 +149,75 @@ namespace SFM
 			else 
 				return 0.f;
 		}
+
+		/* SSE versions (for block oscillators) */
+
+		// Wraps [0..2] to [0..1] (like subtracting bitwiseOrZero())
+		SFM_INLINE static __m128 Wrap4(__m128 point)
+		{
+			const __m128 one = _mm_set1_ps(1.f);
+			return _mm_sub_ps(point, _mm_and_ps(_mm_cmpge_ps(point, one), one));
+		}
+
+		// Returns masked (BLEP/BLAMP) polynomial variables; divides like BLEP() & BLAMP() so the results are identical
+		SFM_INLINE static void Points4(__m128 point, __m128 dT, __m128 &low, __m128 &high, __m128 &isLow, __m128 &isHigh)
+		{
+			const __m128 one = _mm_set1_ps(1.f);
+			isLow  = _mm_cmplt_ps(point, dT);
+			isHigh = _mm_andnot_ps(isLow, _mm_cmpgt_ps(point, _mm_sub_ps(one, dT)));
+			low    = _mm_sub_ps(_mm_div_ps(point, dT), one);
+			high   = _mm_add_ps(_mm_div_ps(_mm_sub_ps(point, one), dT), one);
+		}
+
+		SFM_INLINE static __m128 Negate4(__m128 value)
+		{
+			return _mm_xor_ps(value, _mm_set1_ps(-0.f));
+		}
+
+		SFM_INLINE static __m128 BLEP4(__m128 point, __m128 dT)
+		{
+			__m128 low, high, isLow, isHigh;
+			Points4(point, dT, low, high, isLow, isHigh);
+
+			return _mm_or_ps(
+				_mm_and_ps(isHigh, _mm_mul_ps(high, high)),
+				_mm_and_ps(isLow,  Negate4(_mm_mul_ps(low, low))));
+		}
+
+		SFM_INLINE static __m128 BLAMP4(__m128 point, __m128 dT)
+		{
+			__m128 low, high, isLow, isHigh;
+			Points4(point, dT, low, high, isLow, isHigh);
+
+			const __m128 third = _mm_set1_ps(1.f/3.f);
+
+			return _mm_or_ps(
+				_mm_and_ps(isHigh, _mm_mul_ps(_mm_mul_ps(third, _mm_mul_ps(high, high)), high)),
+				_mm_and_ps(isLow,  _mm_mul_ps(_mm_mul_ps(Negate4(third), _mm_mul_ps(low, low)), low)));
+		}
+
+		// Selects 'a' where mask is set, 'b' otherwise
+		SFM_INLINE static __m128 Select4(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		// Renders block: 4 at a time, remainder with scalar version
+		template<typename Kernel4, typename Kernel1>
+		SFM_INLINE static void RenderBlock(const float *pPhase, float pitch, float *pDest, unsigned numSamples, Kernel4 kernel4, Kernel1 kernel1)
+		{
+			SFM_ASSERT(nullptr != pPhase && nullptr != pDest);
+			SFM_ASSERT(pitch > 0.f);
+
+			const __m128 dT = _mm_set1_ps(pitch);
+
+			unsigned iSample = 0;
+			for (; iSample+4 <= numSamples; iSample += 4)
+				_mm_storeu_ps(pDest+iSample, kernel4(_mm_loadu_ps(pPhase+iSample), dT));
+
+			for (; iSample < numSamples; ++iSample)
+				pDest[iSample] = kernel1(pPhase[iSample], pitch);
+		}
 	}
 
 	SFM_INLINE static float oscPolySquare(float phase, float pitch)
@@ -247,12 +319,115 @@ namespace SFM
 		return rectangle;
 	}
 
+	/*
+		Band-limited (PolyBLEP) block oscillators
+
+		- Render 'numSamples' from a phase ramp (see Phase::Sample(float *, unsigned)) at a constant pitch
+		- Branchless, so no penalty at high pitches where BLEP regions are hit often
+		- Results are identical to the scalar versions (same operations in the same order, unless the compiler contracts to FMA),
+		  which is what Oscillator::Sample(float *, unsigned) relies on (checked by 'bench_components --check')
+	*/
+
+	SFM_INLINE static void oscPolySaw(const float *pPhase, float pitch, float *pDest, unsigned numSamples)
+	{
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(_mm_add_ps(phase, _mm_set1_ps(0.5f)));
+				const __m128 saw = _mm_sub_ps(_mm_add_ps(P1, P1), _mm_set1_ps(1.f));
+				return _mm_sub_ps(saw, Poly::BLEP4(P1, dT));
+			},
+			[](float phase, float pitch) { return oscPolySaw(phase, pitch); });
+	}
+
+	SFM_INLINE static void oscPolySquare(const float *pPhase, float pitch, float *pDest, unsigned numSamples)
+	{
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(_mm_add_ps(phase, _mm_set1_ps(0.5f)));
+				const __m128 square = Poly::Select4(_mm_cmplt_ps(phase, _mm_set1_ps(0.5f)), _mm_set1_ps(1.f), _mm_set1_ps(-1.f));
+				return _mm_add_ps(square, _mm_sub_ps(Poly::BLEP4(phase, dT), Poly::BLEP4(P1, dT)));
+			},
+			[](float phase, float pitch) { return oscPolySquare(phase, pitch); });
+	}
+
+	SFM_INLINE static void oscPolyRamp(const float *pPhase, float pitch, float *pDest, unsigned numSamples)
+	{
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(phase);
+				const __m128 ramp = _mm_sub_ps(_mm_set1_ps(1.f), _mm_add_ps(P1, P1));
+				return _mm_add_ps(ramp, Poly::BLEP4(P1, dT));
+			},
+			[](float phase, float pitch) { return oscPolyRamp(phase, pitch); });
+	}
+
+	SFM_INLINE static void oscPolyTriangle(const float *pPhase, float pitch, float *pDest, unsigned numSamples)
+	{
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(_mm_add_ps(phase, _mm_set1_ps(0.25f)));
+				const __m128 P2 = Poly::Wrap4(_mm_add_ps(phase, _mm_set1_ps(0.75f)));
+
+				// [0..1] rises, [1..3] falls, [3..4] rises again
+				const __m128 four = _mm_set1_ps(4.f);
+				const __m128 scaled = _mm_mul_ps(phase, four);
+				__m128 triangle = Poly::Select4(_mm_cmpgt_ps(scaled, _mm_set1_ps(1.f)), _mm_sub_ps(_mm_set1_ps(2.f), scaled), scaled);
+				triangle = Poly::Select4(_mm_cmpge_ps(scaled, _mm_set1_ps(3.f)), _mm_sub_ps(scaled, four), triangle);
+
+				const __m128 blamp = _mm_sub_ps(Poly::BLAMP4(P1, dT), Poly::BLAMP4(P2, dT));
+				return _mm_add_ps(triangle, _mm_mul_ps(_mm_mul_ps(four, dT), blamp));
+			},
+			[](float phase, float pitch) { return oscPolyTriangle(phase, pitch); });
+	}
+
+	SFM_INLINE static void oscPolyRectifiedSine(const float *pPhase, float pitch, float *pDest, unsigned numSamples)
+	{
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(_mm_add_ps(phase, _mm_set1_ps(0.25f)));
+				const __m128 sine = fast_sinf4(_mm_mul_ps(_mm_set1_ps(0.5f), P1));
+				const __m128 rectified = _mm_sub_ps(_mm_add_ps(sine, sine), _mm_set1_ps(2.f));
+
+				return _mm_add_ps(rectified, _mm_mul_ps(_mm_add_ps(dT, dT), Poly::BLAMP4(P1, dT)));
+			},
+			[](float phase, float pitch) { return oscPolyRectifiedSine(phase, pitch); });
+	}
+
+	SFM_INLINE static void oscPolyRectangle(const float *pPhase, float pitch, float width, float *pDest, unsigned numSamples)
+	{
+		SFM_ASSERT(width > 0.f && width <= 1.f);
+
+		const __m128 widthV = _mm_set1_ps(width);
+
+		Poly::RenderBlock(pPhase, pitch, pDest, numSamples, 
+			[widthV](__m128 phase, __m128 dT) -> __m128
+			{
+				const __m128 P1 = Poly::Wrap4(_mm_sub_ps(_mm_add_ps(phase, _mm_set1_ps(1.f)), widthV));
+
+				__m128 rectangle = _mm_mul_ps(_mm_set1_ps(-2.f), widthV);
+				rectangle = _mm_add_ps(rectangle, _mm_and_ps(_mm_cmplt_ps(phase, widthV), _mm_set1_ps(2.f)));
+
+				return _mm_add_ps(rectangle, _mm_sub_ps(Poly::BLEP4(phase, dT), Poly::BLEP4(P1, dT)));
+			},
+			[width](float phase, float pitch) { return oscPolyRectangle(phase, pitch, width); });
+	}
+
 	/*
 		White noise
 	*/
 
-	SFM_INLINE static float oscWhiteNoise()
+	SFM_INLINE static float oscWhiteNoise(RandomStream &random)
+	{
+		return random.NextFloatBipolar();
+	}
+
+	SFM_INLINE static void oscWhiteNoise(RandomStream &random, float *pDest, unsigned numSamples)
 	{
-		return mt_randfc();
+		random.FillBipolar(pDest, numSamples);
 	}
 }
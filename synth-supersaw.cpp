@@ -64,8 +64,9 @@ namespace SFM
 		// Reset DC blocker
 		m_blocker.Reset();
 
-		// Set frequency (JP-8000 controls, pitch, filter)
-		m_frequency = 0.f; 
+		// Set frequency (JP-8000 controls, pitch, filter); pitch is calculated right away since CatchUp() needs it
+		m_pitchFrequency = -1.f;
 		SetFrequency(frequency, detune, mix);
+		UpdatePitch();
 	}
 }
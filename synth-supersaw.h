@@ -5,13 +5,14 @@
 	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
 
 	- Ref.: https://pdfs.semanticscholar.org/1852/250068e864215dd7f12755cf00636868a251.pdf (copy in repository)
-	- Free running: all phases are updated by Bison::Render() if the oscillator is not being used
+	- Free running: Sample() advances a sample clock stamp along with the phases, when the oscillator is picked up
+	  again CatchUp() advances them analytically to the current (global) clock, so an idle one costs nothing
+	- The 7 oscillators run side by side in 8 lanes (2 SSE registers, the last lane is silent) using a branchless PolyBLEP
 	
 	FIXME:
 		- Not in [-1..1] - is this a problem?
 		- Minimize beating (especially at lower frequencies)
 		- Review filter
-		- SSE implementation
 		- Too much implementation lives in this header file
 
 	For now I'm picking the single precision version since I can't hear the f*cking difference ;)
@@ -19,16 +20,24 @@
 
 #pragma once
 
+#include <xmmintrin.h>
+
 #include "3rdparty/filters/Biquad.h"
 
 #include "synth-global.h"
 #include "synth-stateless-oscillators.h"
 #include "synth-one-pole-filters.h"
+#include "helper/synth-profile.h"
 
 namespace SFM
 {
-	// Number of oscillators
+	// Number of oscillators & SIMD lanes they're padded to
 	constexpr unsigned kNumSupersawOscillators = 7;
+	constexpr unsigned kNumSupersawLanes = 8;
+
+	// Oscillator pitch & HPF cutoff are limited to this fraction of the sample rate: bent or modulated beyond Nyquist
+	// the filter becomes unstable and the phases would need more than one wrap per sample
+	constexpr float kSupersawMaxPitch = 0.49f;
 
 	// Relation between frequencies (slightly asymmetric)
 	// Centre oscillator moved from position 4 to 1
@@ -82,17 +91,32 @@ namespace SFM
 	public:
 		static void CalculateDetuneTable();
 
-		Supersaw() : 
-			m_sampleRate(1) 
+		// Empty slot (see Oscillator::SetSupersawState())
+		Supersaw() :
+			m_sampleRate(1)
+,			m_clock(0)
+		{
+			for (unsigned iLane = 0; iLane < kNumSupersawLanes; ++iLane)
+				m_relative[iLane] = 0.f;
+		}
+
+		Supersaw(uint64_t clock, RandomStream &random) : 
+			m_sampleRate(1)
+,			m_clock(clock)
 		{
 			// Initialize phases with random values between [0..1] and let's hope that at least a few of them are irrational
 			for (auto &phase : m_phase)
-				phase = mt_randf();
+				phase = random.NextFloat();
+
+			// Padding lane: runs at fundamental but is silent
+			for (unsigned iLane = 0; iLane < kNumSupersawLanes; ++iLane)
+				m_relative[iLane] = (iLane < kNumSupersawOscillators) ? kSupersawRelative[iLane] : 0.f;
 		}
 
 		void Initialize(float frequency, unsigned sampleRate, float detune, float mix);
 
 		// Allows on the fly adjustment of the 2 key JP-8000 parameters (read: whilst note held)
+		// Cheap to call every sample: pitches & filter are only recalculated (by Sample()) if something changed
 		SFM_INLINE void SetFrequency(float frequency, float detune, float mix)
 		{
 			// Set JP-8000 controls
@@ -100,43 +124,83 @@ namespace SFM
 			SetMix(mix);
 
 			m_frequency = frequency;
-			OnFrequencyChange(m_frequency);
+			m_bend = 1.f;
 		}
 
 		SFM_INLINE void PitchBend(float bend)
 		{
-			// An unnecessary OnFrequencyChange() isn't cheap enough to just disregard
-			if (1.f == bend)
-				return;
-
-			const float frequency = m_frequency*bend;
-			OnFrequencyChange(frequency);
+			m_bend = bend;
 		}
 
 		SFM_INLINE float Sample()
 		{
-			// Centre oscillator
-			const float main = Oscillate(0);
+			UpdatePitch();
+
+			// All oscillators at once, 2x4 lanes (last lane is padding)
+			const __m128 one  = _mm_set1_ps(1.f);
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 two  = _mm_set1_ps(2.f);
+
+			__m128 mixed = _mm_setzero_ps();
+
+			for (unsigned iLane = 0; iLane < kNumSupersawLanes; iLane += 4)
+			{
+				const __m128 phase    = _mm_load_ps(m_phase+iLane);
+				const __m128 pitch    = _mm_load_ps(m_pitch+iLane);
+				const __m128 invPitch = _mm_load_ps(m_invPitch+iLane);
+
+				// Advance & wrap phase
+				__m128 next = _mm_add_ps(phase, pitch);
+				next = _mm_sub_ps(next, _mm_and_ps(_mm_cmpgt_ps(next, one), one));
+				_mm_store_ps(m_phase+iLane, next);
+
+				// Saw (shifted by half a period, like oscPolySaw())
+				__m128 P1 = _mm_add_ps(phase, half);
+				P1 = _mm_sub_ps(P1, _mm_and_ps(_mm_cmpge_ps(P1, one), one));
+				__m128 saw = _mm_sub_ps(_mm_mul_ps(two, P1), one);
+
+				// Branchless PolyBLEP (see Poly::BLEP())
+				const __m128 low     = _mm_sub_ps(_mm_mul_ps(P1, invPitch), one);
+				const __m128 high    = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(P1, one), invPitch), one);
+				const __m128 isLow   = _mm_cmplt_ps(P1, pitch);
+				const __m128 isHigh  = _mm_cmpgt_ps(P1, _mm_sub_ps(one, pitch));
+				const __m128 blepLow = _mm_and_ps(isLow, _mm_mul_ps(low, low));
+				const __m128 blepHigh = _mm_and_ps(isHigh, _mm_mul_ps(high, high));
+				saw = _mm_sub_ps(saw, _mm_sub_ps(blepHigh, blepLow));
+
+				mixed = _mm_add_ps(mixed, _mm_mul_ps(saw, _mm_load_ps(m_mix+iLane)));
+			}
 
-			// Side oscillators
-			float sides = 0.f;
-			for (unsigned iOsc = 1; iOsc < kNumSupersawOscillators; ++iOsc)
-				sides += Oscillate(iOsc);
+			// Horizontal sum
+			mixed = _mm_add_ps(mixed, _mm_movehl_ps(mixed, mixed));
+			mixed = _mm_add_ss(mixed, _mm_shuffle_ps(mixed, mixed, 1));
 
-			float signal = m_HPF.processMono(main*m_mainMix + sides*m_sideMix); // As far as I remember (FIXME: check paper) this filter is to remove (possible aliasing related) rumble below the centre freq.
+			float signal = m_HPF.processMono(_mm_cvtss_f32(mixed)); // As far as I remember (FIXME: check paper) this filter is to remove (possible aliasing related) rumble below the centre freq.
 			signal = m_blocker.Apply(signal); // Why exactly do I think I should do something about a DC offset in this situation?
 
+			++m_clock;
+
 			return signal;
 		}
 		
-		// Advance phase by a number of samples (used by Bison::Render() for true 'free running') <-- FIXME!
-		SFM_INLINE void Skip(unsigned numSamples)
+		// Advance phases to sample clock (for true 'free running'), call before changing the frequency
+		SFM_INLINE void CatchUp(uint64_t clock)
 		{
+			SFM_ASSERT(clock >= m_clock);
+
+			if (clock == m_clock)
+				return;
+
+			SFM_PROFILE_SCOPE(kProfileSupersawCatchUp);
+
+			const double numSamples = double(clock-m_clock);
 			for (unsigned iOsc = 0; iOsc < kNumSupersawOscillators; ++iOsc)
 			{
 				float &phase = m_phase[iOsc];
-				phase = fmodf(phase + numSamples*m_pitch[iOsc], 1.f);
+				phase = float(fmod(phase + numSamples*m_pitch[iOsc], 1.0));
 			}
+
+			m_clock = clock;
 		}
 
 		SFM_INLINE float GetFrequency() const
@@ -152,72 +216,92 @@ namespace SFM
 		}
 
 	private:
+		// Per lane (padded to 2 SSE registers)
+		alignas(16) float m_phase[kNumSupersawLanes]    = { 0.f };
+		alignas(16) float m_pitch[kNumSupersawLanes]    = { 0.f };
+		alignas(16) float m_invPitch[kNumSupersawLanes] = { 0.f };
+		alignas(16) float m_mix[kNumSupersawLanes]      = { 0.f };
+		alignas(16) float m_relative[kNumSupersawLanes];
+
 		unsigned m_sampleRate;
+		uint64_t m_clock; // Sample clock the phases are at
+
 		float m_frequency = 0.f;
+		float m_bend = 1.f;
 
-		float m_curDetune = 0.f;
-		float m_mainMix   = 0.f; 
-		float m_sideMix   = 0.f;
+		// Set values (to detect change)
+		float m_setDetune = -1.f;
+		float m_setMix = -1.f;
+
+		// Values m_pitch & m_HPF were calculated for (negative means 'dirty')
+		float m_pitchFrequency = -1.f;
+		float m_pitchDetune = -1.f;
 
-		float m_phase[kNumSupersawOscillators] = { 0.f };
-		float m_pitch[kNumSupersawOscillators] = { 0.f };
+		float m_curDetune = 0.f;
 
 		Biquad m_HPF;
 		DCBlocker m_blocker;
 
-		SFM_INLINE float Tick(unsigned iOsc)
+		SFM_INLINE void UpdatePitch()
 		{
-			SFM_ASSERT(iOsc < kNumSupersawOscillators);
+			const float frequency = m_frequency*m_bend;
 
-			float &phase = m_phase[iOsc];
-			float  pitch = m_pitch[iOsc];
-
-			const float oscPhase = phase;
-			SFM_ASSERT(oscPhase >= 0.f && oscPhase <= 1.f);
-
-			phase += pitch;
-
-			if (phase > 1.f)
-				phase -= 1.f;
-
-			return oscPhase;
-		}
-
-		SFM_INLINE float Oscillate(unsigned iOsc)
-		{
-			return oscPolySaw(Tick(iOsc), m_pitch[iOsc]);
-		}
+			if (frequency == m_pitchFrequency && m_curDetune == m_pitchDetune)
+				return;
 
-		SFM_INLINE void OnFrequencyChange(float frequency)
-		{
 			// Calc. pitch for each oscillator
-			for (unsigned iOsc = 0; iOsc < kNumSupersawOscillators; ++iOsc)
+			const __m128 fundamental = _mm_set1_ps(CalculatePitch<float>(frequency, m_sampleRate));
+			const __m128 detune = _mm_set1_ps(m_curDetune);
+			const __m128 one = _mm_set1_ps(1.f);
+			const __m128 maxPitch = _mm_set1_ps(kSupersawMaxPitch);
+
+			for (unsigned iLane = 0; iLane < kNumSupersawLanes; iLane += 4)
 			{
-				const float offset   = m_curDetune*kSupersawRelative[iOsc];
-				const float freqOffs = frequency * offset;
-				const float detuned  = frequency + freqOffs;
-				const float pitch    = CalculatePitch<float>(detuned, m_sampleRate);
-				m_pitch[iOsc] = pitch;
+				const __m128 offset = _mm_mul_ps(detune, _mm_load_ps(m_relative+iLane));
+				const __m128 pitch  = _mm_min_ps(maxPitch, _mm_mul_ps(fundamental, _mm_add_ps(one, offset)));
+				_mm_store_ps(m_pitch+iLane, pitch);
+				_mm_store_ps(m_invPitch+iLane, _mm_div_ps(one, pitch));
 			}
 
 			// Cut lower end
-			constexpr float Q = kNormalGainAtCutoff*kPI*0.5f; // Totally arbitrary.. (FIXME?)
-			m_HPF.setBiquad(bq_type_highpass, frequency/m_sampleRate, Q, 0.f);
+			if (frequency != m_pitchFrequency)
+			{
+				constexpr float Q = kNormalGainAtCutoff*kPI*0.5f; // Totally arbitrary.. (FIXME?)
+				m_HPF.setBiquad(bq_type_highpass, std::min(frequency, kSupersawMaxPitch*m_sampleRate)/m_sampleRate, Q, 0.f);
+			}
+
+			m_pitchFrequency = frequency;
+			m_pitchDetune = m_curDetune;
 		}
 		
 		// Key parameters (detune & mix)
 		SFM_INLINE void SetDetune(float detune /* [0..1] */)
 		{
+			if (detune == m_setDetune)
+				return;
+
 //			m_curDetune = (float) SampleDetuneCurve(detune);
 			m_curDetune = SampleDetuneTable(detune);
 			SFM_ASSERT(m_curDetune >= 0.f && m_curDetune <= 1.f);
+
+			m_setDetune = detune;
 		}
 	
 		SFM_INLINE void SetMix(float mix /* [0..1] */)
 		{
 			SFM_ASSERT_NORM(mix);
-			m_mainMix = -0.55366f*mix + 0.99785f;
-			m_sideMix = -0.73764f*powf(mix, 2.f) + 1.2841f*mix + 0.044372f;
+
+			if (mix == m_setMix)
+				return;
+
+			const float mainMix = -0.55366f*mix + 0.99785f;
+			const float sideMix = -0.73764f*powf(mix, 2.f) + 1.2841f*mix + 0.044372f;
+
+			m_mix[0] = mainMix;
+			for (unsigned iLane = 1; iLane < kNumSupersawLanes; ++iLane)
+				m_mix[iLane] = (iLane < kNumSupersawOscillators) ? sideMix : 0.f;
+
+			m_setMix = mix;
 		}
 		
 		// See impl.
@@ -0,0 +1,64 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Engine telemetry.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Filled in by Bison once per Render() call and published through a SnapshotBuffer (helper/synth-snapshot-buffer.h),
+	so any thread can call Bison::GetTelemetry() at any time without bothering the audio thread
+
+	- Per block counts include what happened in NoteOn() & NoteOff() calls since the previous Render()
+	- A request is 'deferred' if it could not get a voice this block (it's first in line next block) and 'dropped'
+	  if it was thrown away (request queue full, or voices were reset/voice mode switched)
+	- Render time is measured around all of Render(), against the block's duration (the budget); a block using more
+	  than kTelemetryNearMissLoad of it's budget is a near miss, one using more than all of it an overrun (in which
+	  case the host may or may not have dropped out, depending on it's buffering)
+	- Note table fallbacks count voices (not operators) that were set up or updated the slow way, which happens for
+	  a block or so each time the patch's operators change (see synth-note-table.h) or if note tables are off
+*/
+
+#pragma once
+
+#include "synth-global.h"
+
+namespace SFM
+{
+	// Fraction of block budget that counts as a near miss
+	constexpr float kTelemetryNearMissLoad = 0.8f;
+
+	struct Telemetry
+	{
+		// Render() calls so far
+		uint64_t block = 0;
+
+		// Voices, as of the end of the block
+		unsigned activeVoices = 0;    // Playing (including sustained)
+		unsigned releasingVoices = 0;
+		unsigned stolenVoices = 0;    // Fading out
+		unsigned polyphony = 0;       // Current limit
+		unsigned reqPolyphony = 0;    // What the patch asks for; if larger than 'polyphony' it's clamped to the voice pool (see Bison::ReserveVoices())
+
+		// This block
+		unsigned steals = 0;
+		unsigned deferredRequests = 0;
+		unsigned droppedRequests = 0;
+		unsigned duplicateNoteOns = 0;
+		unsigned noteTableFallbacks = 0; // Voices initialized or updated without a current note table (see Bison::UpdateNoteTable())
+		bool voiceReset = false;      // All voices stolen (voice mode switch, polyphony change, ResetVoices())
+
+		// Load
+		float renderTimeUs = 0.f;
+		float budgetUs = 0.f;
+		float load = 0.f;             // Render time/budget
+
+		// Totals
+		uint64_t totalSteals = 0;
+		uint64_t totalDeferred = 0;
+		uint64_t totalDropped = 0;
+		uint64_t totalDuplicateNoteOns = 0;
+		uint64_t totalNoteTableFallbacks = 0;
+		uint64_t nearMisses = 0;
+		uint64_t overruns = 0;
+		float peakLoad = 0.f;
+	};
+}
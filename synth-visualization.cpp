@@ -0,0 +1,202 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Visualization feed.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include "synth-visualization.h"
+#include "helper/synth-fft.h"
+
+namespace SFM
+{
+	Visualization::Visualization() :
+		m_hann(kVisSpectrumSize), m_bins(kVisSpectrumSize)
+	{
+		for (unsigned iSample = 0; iSample < kVisSpectrumSize; ++iSample)
+			m_hann[iSample] = 0.5f - 0.5f*cosf(k2PI*iSample/kVisSpectrumSize);
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Consumer
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void Visualization::Attach(unsigned flags /* = 0 */)
+	{
+		SFM_ASSERT(0 == (flags & ~(kVisScope|kVisSpectrum)));
+
+		// Anything left is from an earlier attachment
+		if (false == IsAttached())
+		{
+			while (true == m_queue.TryPop(m_popped))
+				;
+		}
+
+		m_flags.store(flags | kAttached, std::memory_order_release);
+	}
+
+	void Visualization::Detach()
+	{
+		m_flags.store(0, std::memory_order_release);
+	}
+
+	bool Visualization::Pop(VisualizationFrame &frame)
+	{
+		if (false == m_queue.TryPop(m_popped))
+			return false;
+
+		frame = m_popped.frame;
+
+		if (true == frame.hasSpectrum)
+		{
+			for (unsigned iSample = 0; iSample < kVisSpectrumSize; ++iSample)
+				m_bins[iSample] = m_popped.window[iSample]*m_hann[iSample];
+
+			FFT(m_bins.data(), kVisSpectrumSize, false);
+
+			// Hann window halves a sine's amplitude, the other half is in the negative frequencies
+			constexpr double scale = 4.0/kVisSpectrumSize;
+			for (unsigned iBin = 0; iBin < kVisSpectrumBins; ++iBin)
+				frame.spectrum[iBin] = float(std::abs(m_bins[iBin])*scale);
+		}
+
+		return true;
+	}
+
+	/* ----------------------------------------------------------------------------------------------------
+
+		Producer
+
+	 ------------------------------------------------------------------------------------------------------ */
+
+	void Visualization::Reset(unsigned sampleRate)
+	{
+		m_sampleRate = sampleRate;
+		m_active = false; // Restarts windows
+	}
+
+	bool Visualization::BeginBlock()
+	{
+		++m_block;
+
+		const unsigned flags = m_flags.load(std::memory_order_acquire);
+		const bool active = 0 != (flags & kAttached);
+
+		if (true == active && (false == m_active || flags != m_curFlags))
+		{
+			// (Re)start windows
+			m_scopePos = m_scopeCount = 0;
+			m_scopeSum = 0.f;
+			m_windowPos = 0;
+		}
+
+		m_active = active;
+		m_curFlags = flags;
+
+		if (false == active)
+			return false;
+
+		VisualizationFrame &frame = m_entry.frame;
+		frame.block = m_block;
+		frame.sampleRate = m_sampleRate;
+		frame.compressorBite = 0.f;
+		frame.hasScope = frame.hasSpectrum = false;
+
+		for (float &peak : frame.opPeaks)
+			peak = 0.f;
+
+		for (float &level : frame.levels)
+			level = 0.f;
+
+		return true;
+	}
+
+	void Visualization::Meter(VisualizationStage stage, const float *pLeft, const float *pRight, unsigned numSamples)
+	{
+		SFM_ASSERT(stage < kNumVisStages);
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+
+		float peak = m_entry.frame.levels[stage];
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			peak = std::max(peak, std::max(fabsf(pLeft[iSample]), fabsf(pRight[iSample])));
+
+		m_entry.frame.levels[stage] = peak;
+	}
+
+	void Visualization::Capture(const float *pLeft, const float *pRight, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pLeft && nullptr != pRight);
+
+		VisualizationFrame &frame = m_entry.frame;
+
+		if (0 != (m_curFlags & kVisScope))
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				m_scopeSum += 0.5f*(pLeft[iSample] + pRight[iSample]);
+
+				if (++m_scopeCount == kVisScopeDecimation)
+				{
+					m_scope[m_scopePos] = m_scopeSum/kVisScopeDecimation;
+					m_scopeSum = 0.f;
+					m_scopeCount = 0;
+
+					if (++m_scopePos == kVisScopeSize)
+					{
+						// Only the last one completed this block is kept
+						memcpy(frame.scope, m_scope, sizeof(m_scope));
+						frame.hasScope = true;
+						m_scopePos = 0;
+					}
+				}
+			}
+		}
+
+		if (0 != (m_curFlags & kVisSpectrum))
+		{
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				m_window[m_windowPos] = 0.5f*(pLeft[iSample] + pRight[iSample]);
+
+				if (++m_windowPos == kVisSpectrumSize)
+				{
+					memcpy(m_entry.window, m_window, sizeof(m_window));
+					frame.hasSpectrum = true;
+					m_windowPos = 0;
+				}
+			}
+		}
+	}
+
+	void Visualization::EndBlock()
+	{
+		SFM_ASSERT(true == m_active);
+
+		Entry *pSlot = m_queue.BeginPush();
+		if (nullptr == pSlot)
+		{
+			m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		// Skip windows if there's nothing new in them
+		const VisualizationFrame &frame = m_entry.frame;
+		pSlot->frame.block = frame.block;
+		pSlot->frame.sampleRate = frame.sampleRate;
+		pSlot->frame.compressorBite = frame.compressorBite;
+		pSlot->frame.hasScope = frame.hasScope;
+		pSlot->frame.hasSpectrum = frame.hasSpectrum;
+		memcpy(pSlot->frame.opPeaks, frame.opPeaks, sizeof(frame.opPeaks));
+		memcpy(pSlot->frame.levels, frame.levels, sizeof(frame.levels));
+
+		if (true == frame.hasScope)
+			memcpy(pSlot->frame.scope, frame.scope, sizeof(frame.scope));
+
+		if (true == frame.hasSpectrum)
+			memcpy(pSlot->window, m_entry.window, sizeof(m_entry.window));
+
+		m_queue.EndPush();
+	}
+}
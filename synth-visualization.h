@@ -0,0 +1,171 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Visualization feed.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Bison fills in a frame each Render() call (operator peaks, compressor bite, output level of each stage and,
+	if asked for, scope & spectrum windows) and pushes it onto an SPSC ring; a single consumer (the UI) pops them
+
+	- Nothing is done unless a consumer is attached (Attach()), and then only what it asked for
+	- Producer cost per block is bounded: a peak scan per stage, copying the output into the scope/spectrum windows
+	  and copying one frame; the spectrum's FFT is done by Pop(), on the consumer's thread
+	- If the consumer doesn't keep up frames are dropped (see GetDroppedFrames()), the audio thread never waits
+	- Frames are about 4KB, so don't make kVisQueueSize much larger than it needs to be
+*/
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "synth-global.h"
+#include "helper/synth-spsc-ring.h"
+
+namespace SFM
+{
+	enum VisualizationStage
+	{
+		kVisVoices,       // All voices, before PostPass
+		kVisWah,
+		kVisChorusDelay,
+		kVisFilterTube,   // Oversampled pass
+		kVisReverb,
+		kVisCompressor,
+		kVisOutput,       // What Render() returns
+		kNumVisStages
+	};
+
+	// Optional parts of a frame (see Visualization::Attach())
+	enum VisualizationFlags
+	{
+		kVisScope    = 1,
+		kVisSpectrum = 2
+	};
+
+	constexpr unsigned kVisScopeSize       = 256; // Points
+	constexpr unsigned kVisScopeDecimation = 4;   // Output samples (averaged) per point
+	constexpr unsigned kVisSpectrumSize    = 512; // FFT size (output samples)
+	constexpr unsigned kVisSpectrumBins    = kVisSpectrumSize/2;
+	constexpr unsigned kVisQueueSize       = 16;  // Frames (power of 2)
+
+	struct VisualizationFrame
+	{
+		uint64_t block = 0;      // Render() call
+		unsigned sampleRate = 0; // Host rate, to map spectrum bins to frequencies
+
+		// Follows approx. peak (modulator-only will be normalized, which makes for a nicer view as 'index' values tend to be low!)
+		float opPeaks[kNumOperators] = { 0.f };
+
+		// [0..1], when RMS falls below threshold dB
+		float compressorBite = 0.f;
+
+		// Absolute peak (linear) of each stage's output during this block, stereo
+		float levels[kNumVisStages] = { 0.f };
+
+		// Set if a window was completed during this block (and only if asked for)
+		bool hasScope = false;
+		bool hasSpectrum = false;
+
+		// Mono, decimated (see kVisScopeDecimation), oldest first
+		float scope[kVisScopeSize] = { 0.f };
+
+		// Magnitude of each bin (Hann window), a full scale sine reads approx. 1
+		float spectrum[kVisSpectrumBins] = { 0.f };
+	};
+
+	class Visualization
+	{
+	public:
+		Visualization();
+
+		/*
+			Consumer (one thread)
+		*/
+
+		// Start receiving frames, 'flags' are VisualizationFlags; can also be called to change them
+		void Attach(unsigned flags = 0);
+		void Detach();
+
+		bool IsAttached() const
+		{
+			return 0 != (m_flags.load(std::memory_order_relaxed) & kAttached);
+		}
+
+		// Oldest frame first, returns false if there's none
+		bool Pop(VisualizationFrame &frame);
+
+		// Frames lost because the queue was full
+		uint64_t GetDroppedFrames() const
+		{
+			return m_droppedFrames.load(std::memory_order_relaxed);
+		}
+
+		/*
+			Producer (Bison, audio thread)
+		*/
+
+		// Call when Render() doesn't run
+		void Reset(unsigned sampleRate);
+
+		// Call at the start of each block; if it returns false (no consumer) skip everything below
+		bool BeginBlock();
+
+		bool IsActive() const
+		{
+			return m_active;
+		}
+
+		// Stages can be metered more than once per block (partial blocks, PostPass crossfade), the peak is kept
+		void Meter(VisualizationStage stage, const float *pLeft, const float *pRight, unsigned numSamples);
+
+		// Feeds scope & spectrum windows with output, if they're asked for
+		void Capture(const float *pLeft, const float *pRight, unsigned numSamples);
+
+		// To fill in the rest (operator peaks, compressor bite)
+		VisualizationFrame &GetFrame()
+		{
+			SFM_ASSERT(true == m_active);
+			return m_entry.frame;
+		}
+
+		// Pushes frame (or drops it)
+		void EndBlock();
+
+	private:
+		constexpr static unsigned kAttached = 0x80000000;
+
+		// What's on the queue: the spectrum is calculated by the consumer
+		struct Entry
+		{
+			VisualizationFrame frame;
+			float window[kVisSpectrumSize] = { 0.f };
+		};
+
+		SPSCRing<Entry, kVisQueueSize> m_queue;
+
+		std::atomic<unsigned> m_flags = 0;
+		std::atomic<uint64_t> m_droppedFrames = 0;
+
+		// Producer
+		unsigned m_sampleRate = 0;
+		uint64_t m_block = 0;
+		bool m_active = false;
+		unsigned m_curFlags = 0;
+
+		Entry m_entry;
+
+		float m_scope[kVisScopeSize];
+		unsigned m_scopePos = 0;
+		float m_scopeSum = 0.f;
+		unsigned m_scopeCount = 0;
+
+		float m_window[kVisSpectrumSize];
+		unsigned m_windowPos = 0;
+
+		// Consumer
+		Entry m_popped;
+		std::vector<float> m_hann;
+		std::vector<std::complex<double>> m_bins;
+	};
+}
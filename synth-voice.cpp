@@ -7,24 +7,20 @@
 
 #include "synth-voice.h"
 #include "synth-distort.h"
+#include "helper/synth-profile.h"
 
 namespace SFM
 {
 	// This function is called by Voice::Reset()
 	void Voice::Operator::Reset(unsigned sampleRate)
 	{
-		// Disabled
+		// Disabled, not a carrier
 		enabled = false;
+		isCarrier = false;
 
 		// Near-zero frequency
 		curFreq = { kEpsilon, sampleRate, kDefParameterLatency };
 
-		// No detune jitter
-		detuneOffs = 0.f;
-
-		// No key tracking
-		keyTracking = 0.f;
-
 		// Silent
 		amplitude = { 0.f, sampleRate, kDefParameterLatency };
 		index     = { 0.f, sampleRate, kDefParameterLatency };
@@ -59,9 +55,6 @@ namespace SFM
 		// No (manual) panning
 		panning = { 0.f, sampleRate, kDefParameterLatency };
 
-		// Not a carrier
-		isCarrier = false;
-
 		// Reset operator filter
 		filter.reset();
 
@@ -87,6 +80,10 @@ namespace SFM
 		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
 		{
 			m_operators[iOp].Reset(sampleRate);
+
+			// No frequency set, no detune jitter
+			m_operatorSetup[iOp].setFrequency = 0.f;
+			m_operatorSetup[iOp].detuneOffs = 0.f;
 		}
 	}
 
@@ -109,11 +106,15 @@ namespace SFM
 		m_LFO2   = Oscillator(sampleRate);
 		m_modLFO = Oscillator(sampleRate);
 
+		m_pLFO1Block = m_pLFO2Block = m_pModLFOBlock = nullptr;
+		m_LFOBlockSize = m_iLFOBlock = 0;
+
 		// Filter envelope
 		m_filterEnvelope.Reset();
 
 		// Pitch (envelope)
 		m_pitchBendRange = kDefPitchBendRange;
+		m_maxOpFreq = 0.f;
 		m_pitchEnvelope.Reset(sampleRate);
 
 		// Reset main filter
@@ -125,6 +126,36 @@ namespace SFM
 		PostInitialize();
 	}
 
+	void Voice::BindOscillatorState()
+	{
+		SFM_ASSERT(nullptr != m_pSupersaws);
+
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+		{
+			auto &oscillator = m_operators[iOp].oscillator;
+			oscillator.SetRandomStream(&m_random);
+			oscillator.SetSupersawState(m_pSupersaws+iOp);
+		}
+
+		m_LFO1.SetRandomStream(&m_random);
+		m_LFO2.SetRandomStream(&m_random);
+		m_modLFO.SetRandomStream(&m_random);
+	}
+
+	void Voice::CopyFrom(const Voice &voice)
+	{
+		Supersaw *pSupersaws = m_pSupersaws;
+
+		*this = voice;
+
+		m_pSupersaws = pSupersaws;
+		for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+			m_pSupersaws[iOp] = voice.m_pSupersaws[iOp];
+
+		// Keep drawing from the copied stream, voice is likely to be reseeded
+		BindOscillatorState();
+	}
+
 	void Voice::PostInitialize()
 	{
 		// Clear modulation buffer
@@ -220,6 +251,62 @@ namespace SFM
 	// Bright
 	constexpr float kFeedbackScale = 1.f;
 
+#if SFM_PROFILE >= 2
+
+	// Operator kernel, by oscillator type
+	static ProfileStage GetKernelProfileStage(const Oscillator &oscillator)
+	{
+		const Oscillator::Waveform form = oscillator.GetWaveform();
+
+		switch (form)
+		{
+		case Oscillator::kSine:
+		case Oscillator::kCosine:
+			return kProfileKernelSine;
+
+		case Oscillator::kSupersaw:
+			return kProfileKernelSupersaw;
+
+		case Oscillator::kWhiteNoise:
+		case Oscillator::kPinkNoise:
+		case Oscillator::kSampleAndHold:
+			return kProfileKernelNoise;
+
+		default:
+			if (form >= Oscillator::kPolyTriangle && form <= Oscillator::kBump)
+				return (Oscillator::kWavetable == oscillator.GetRenderMode()) ? kProfileKernelWavetable : kProfileKernelPolyBLEP;
+
+			return kProfileKernelRaw;
+		}
+	}
+
+#endif
+
+	void Voice::RenderLFOs(float *pLFOs, unsigned numSamples)
+	{
+		SFM_ASSERT(nullptr != pLFOs);
+
+		// Sample() leaves the LFOs alone until the voice is triggered
+		const unsigned numLFOSamples = numSamples - std::min(m_sampleOffs, numSamples);
+
+		auto renderLFO = [numLFOSamples](Oscillator &LFO, float *pDest) -> const float *
+		{
+			if (true == LFO.UsesRandomStream())
+				return nullptr;
+
+			LFO.Sample(pDest, numLFOSamples);
+			return pDest;
+		};
+
+		// Any order will do, since none of these draw from the random stream
+		m_pModLFOBlock = renderLFO(m_modLFO, pLFOs);
+		m_pLFO1Block   = renderLFO(m_LFO1, pLFOs + numSamples);
+		m_pLFO2Block   = renderLFO(m_LFO2, pLFOs + 2*numSamples);
+
+		m_LFOBlockSize = numLFOSamples;
+		m_iLFOBlock = 0;
+	}
+
 	void Voice::Sample(float &left, float &right, float pitchBend, float ampBend, float modulation, float LFOBlend, float LFOModDepth)
 	{
 		// Render?
@@ -244,7 +331,16 @@ namespace SFM
 		SFM_ASSERT(LFOModDepth >= 0.f);
 		
 		// Calculate LFO value
-		const float modLFO = m_modLFO.Sample(0.f);
+		auto sampleLFO = [this](Oscillator &LFO, const float *pBlock)
+		{
+			if (nullptr == pBlock)
+				return LFO.Sample(0.f);
+
+			SFM_ASSERT(m_iLFOBlock < m_LFOBlockSize);
+			return pBlock[m_iLFOBlock];
+		};
+
+		const float modLFO = sampleLFO(m_modLFO, m_pModLFOBlock);
 
 		auto modulate = [](float input, float modulation, float depth)
 		{
@@ -252,8 +348,9 @@ namespace SFM
 			return lerpf<float>(input, sample, depth);
 		};
 
-		const float LFO1 = modulate(m_LFO1.Sample(0.f /* Do something funky here? */), modLFO, LFOModDepth);
-		const float LFO2 = modulate(m_LFO2.Sample(0.f), modLFO, LFOModDepth);
+		const float LFO1 = modulate(sampleLFO(m_LFO1, m_pLFO1Block), modLFO, LFOModDepth);
+		const float LFO2 = modulate(sampleLFO(m_LFO2, m_pLFO2Block), modLFO, LFOModDepth);
+		++m_iLFOBlock;
 		const float blend = lerpf<float>(LFO1, LFO2, LFOBlend);
 
 		const float LFO = blend;
@@ -298,7 +395,7 @@ namespace SFM
 					const float curDetune = voiceOp.supersawDetune.Sample();
 					const float curMix    = voiceOp.supersawMix.Sample();
 					
-					oscillator.GetSupersaw().SetFrequency(curFreq, curDetune, curMix);
+					oscillator.GetSupersaw()->SetFrequency(curFreq, curDetune, curMix);
 				}
 
 				// Get modulation from 3 sources
@@ -333,11 +430,19 @@ namespace SFM
 
 				// Vibrato: pitch bend, pitch envelope & pitch LFO
 				const float pitchLFO = powf(2.f, LFO*voiceOp.pitchMod*modulation * pitchRangeOct);
-				const float vibrato = pitchBend*pitchEnv*pitchLFO;
+				float vibrato = pitchBend*pitchEnv*pitchLFO;
+
+				if (0.f != m_maxOpFreq && curFreq*vibrato > m_maxOpFreq)
+					vibrato = m_maxOpFreq/curFreq;
+
 				oscillator.PitchBend(vibrato);
 
 				// Calculate sample
-				float sample = oscillator.Sample(phaseShift+feedback);
+				float sample;
+				{
+					SFM_PROFILE_DETAIL_SCOPE(GetKernelProfileStage(oscillator));
+					sample = oscillator.Sample(phaseShift+feedback);
+				}
 
 				// LFO tremolo
 				const float tremolo = 1.f - fabsf(LFO*voiceOp.ampMod);
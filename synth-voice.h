@@ -53,22 +53,32 @@ namespace SFM
 		// Modulation buffer (1 sample delay, FIXME)
 		float m_modSamples[kNumOperators+1]; // First slot for index -1
 
+		// Per-sample (hot) operator state; the small fields Sample() checks for every operator come first
 		struct Operator
 		{
 			// This function is called by Voice::Reset()
 			void Reset(unsigned sampleRate);
 
 			bool enabled;
-			
-			// Frequency
-			float setFrequency; // As calculated by CalcOpFreq()
-			InterpolatedParameter<kMulInterpolate, false> curFreq;
 
-			// Detune offset (used in jitter)
-			float detuneOffs;
+			// Is carrier (output)
+			bool isCarrier;
 
-			// Key tracking (higher note, shorter envelope)
-			float keyTracking;
+			// Indices: -1 means none, modulator indices must be larger than operator index
+			// Yes, this means there is 1 frame of delay, but @ 44.1kHz that amounts to: 2,2675736961451247165532879818594e-5 and that value only gets smaller;
+			int8_t modulators[3], iFeedback;
+			bool noModulation; // Small optimization (see Voice::Render()), initialized by PostInitialize()
+
+			// LFO influence
+			float ampMod;
+			float pitchMod;
+			float panMod;
+
+			// Operator feedback
+			float feedback;
+
+			// Frequency
+			InterpolatedParameter<kMulInterpolate, false> curFreq;
 
 			// Oscillator, amplitude & envelope
 			InterpolatedParameter<kLinInterpolate, true> amplitude; // (R)
@@ -76,20 +86,9 @@ namespace SFM
 			Oscillator oscillator;
 			Envelope envelope;
 
-			// Indices: -1 means none, modulator indices must be larger than operator index
-			// Yes, this means there is 1 frame of delay, but @ 44.1kHz that amounts to: 2,2675736961451247165532879818594e-5 and that value only gets smaller;
-			int modulators[3], iFeedback;
-			bool noModulation; // Small optimization (see Voice::Render()), initialized by PostInitialize()
-
 			// Feedback (R)
 			// See: https://www.reddit.com/r/FMsynthesis/comments/85jfrb/dx7_feedback_implementation/
 			InterpolatedParameter<kLinInterpolate, true> feedbackAmt;
-			float feedback; // Operator feedback
-
-			// LFO influence
-			float ampMod;
-			float pitchMod;
-			float panMod;
 
 			// Drive (square) distortion (R)
 			InterpolatedParameter<kLinInterpolate, false> drive;
@@ -97,9 +96,6 @@ namespace SFM
 			// Panning ([0..1], 0.5 is center) (R)
 			InterpolatedParameter<kLinInterpolate, true> panning;
 
-			// Is carrier (output)
-			bool isCarrier;
-			
 			// Filters
 			Biquad filter;                     // Operator filter
 			SvfLinearTrapOptimised2 modFilter; // Filter can be used to take the edge off an operator to be used as modulator (Set to default by Reset(), could be a Biquad, sure, but this is tweaked to work)
@@ -112,10 +108,28 @@ namespace SFM
 			InterpolatedParameter<kLinInterpolate, true> supersawMix;
 		} m_operators[kNumOperators];
 
+		// Operator setup (cold), written on initialization and read when (patch) parameters are updated
+		struct OperatorSetup
+		{
+			float setFrequency; // As calculated by CalcOpFreq()
+			float detuneOffs;   // Detune offset (used in jitter)
+		} m_operatorSetup[kNumOperators];
+
 		// LFO oscillators
 		Oscillator m_LFO1, m_LFO2;
 		Oscillator m_modLFO;
 
+		// LFOs rendered ahead (see RenderLFOs()), nullptr if Sample() has to sample it
+		const float *m_pLFO1Block = nullptr, *m_pLFO2Block = nullptr;
+		const float *m_pModLFOBlock = nullptr;
+		unsigned m_LFOBlockSize = 0, m_iLFOBlock = 0;
+
+		// Random stream (noise, S&H, jitter), seeded for each note (see Bison::SeedVoice())
+		RandomStream m_random;
+
+		// Supersaw slots, one per operator (owned by Bison, see GrowVoicePool())
+		Supersaw *m_pSupersaws = nullptr;
+
 		// Main filter (used in FM_BISON.cpp)
 		SvfLinearTrapOptimised2 m_filterSVF;
 		
@@ -124,6 +138,7 @@ namespace SFM
 
 		// Pitch (range & envelope)
 		int m_pitchBendRange; // Applied to LFO, envelope & modulation
+		float m_maxOpFreq;    // Operator frequency (after pitch bend, envelope & LFO) is limited to this, zero means no limit
 		PitchEnvelope m_pitchEnvelope;
 
 		// Freq. glide
@@ -141,6 +156,12 @@ namespace SFM
 		// Call after every initialization
 		void PostInitialize();
 
+		// Points oscillators & LFOs to m_random and operators to their supersaw slot (after seeding or copying a voice)
+		void BindOscillatorState();
+
+		// Copy of another voice, with it's own random stream & supersaw slots (used for monophonic voice stealing)
+		void CopyFrom(const Voice &voice);
+
 		bool IsIdle()      const { return kIdle      == m_state; }
 		bool IsPlaying()   const { return kPlaying   == m_state; }
 		bool IsReleasing() const { return kReleasing == m_state; }
@@ -156,6 +177,10 @@ namespace SFM
 		// Used for voice stealing & monophonic mode
 		float GetSummedOutput(); /* const */
 
+		// Renders LFOs ahead for the next 'numSamples' (right before sampling them), except for those that draw from the
+		// random stream as that would change the order of draws (see Oscillator::UsesRandomStream()); 'pLFOs' holds 3*numSamples
+		void RenderLFOs(float *pLFOs, unsigned numSamples);
+
 		// Render "dry" FM voice (see impl. for param. ranges)
 		void Sample(float &left, float &right, float pitchBend, float ampBend /* Linear gain */, float modulation, float LFOBias, float LFOModDepth);
 	};
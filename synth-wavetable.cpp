@@ -0,0 +1,96 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Mipmapped band-limited wavetable.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+*/
+
+#include <emmintrin.h>
+#include <vector>
+
+#include "synth-wavetable.h"
+#include "helper/synth-fft.h"
+
+namespace SFM
+{
+	// Resolution the naive cycle is sampled at before band-limiting; way above level 0 so that what aliases
+	// when sampling it (a naive saw has infinite harmonics) lands well below audible level
+	constexpr unsigned kWavetableSourceSize = 1 << 16;
+
+	void Wavetable::Calculate(const std::function<float(float)> &naive)
+	{
+		// Spectrum of one cycle
+		std::vector<std::complex<double>> spectrum(kWavetableSourceSize);
+
+		for (unsigned iSample = 0; iSample < kWavetableSourceSize; ++iSample)
+			spectrum[iSample] = naive(float(iSample)/kWavetableSourceSize);
+
+		FFT(spectrum.data(), kWavetableSourceSize, false);
+
+		std::vector<std::complex<double>> bins(kWavetableLevels[0].size);
+
+		for (unsigned iLevel = 0; iLevel < kWavetableNumLevels; ++iLevel)
+		{
+			const WavetableLevel &level = kWavetableLevels[iLevel];
+			const unsigned numHarmonics = kWavetableMaxHarmonics >> iLevel;
+
+			SFM_ASSERT(numHarmonics < level.size/2);
+
+			// Keep DC & harmonics (positive & negative frequencies), scaled for the inverse FFT
+			constexpr double scale = 1.0/kWavetableSourceSize;
+
+			std::fill(bins.begin(), bins.end(), std::complex<double>(0.0));
+
+			bins[0] = spectrum[0]*scale;
+
+			for (unsigned iHarmonic = 1; iHarmonic <= numHarmonics; ++iHarmonic)
+			{
+				bins[iHarmonic]            = spectrum[iHarmonic]*scale;
+				bins[level.size-iHarmonic] = spectrum[kWavetableSourceSize-iHarmonic]*scale;
+			}
+
+			FFT(bins.data(), level.size, true);
+
+			float *pSamples = m_samples + level.offset;
+
+			for (unsigned iSample = 0; iSample < level.size; ++iSample)
+				pSamples[iSample] = float(bins[iSample].real());
+
+			// Guard sample (for interpolation)
+			pSamples[level.size] = pSamples[0];
+		}
+	}
+
+	void Wavetable::Sample(const float *pPhase, float pitch, float *pDest, unsigned numSamples) const
+	{
+		SFM_ASSERT(nullptr != pPhase && nullptr != pDest);
+
+		const WavetableLevel &level = kWavetableLevels[GetLevel(pitch)];
+		const float *pSamples = m_samples + level.offset;
+
+		const __m128 size = _mm_set1_ps(float(level.size));
+		const __m128i mask = _mm_set1_epi32(int(level.size-1));
+
+		unsigned iSample = 0;
+		for (; iSample+4 <= numSamples; iSample += 4)
+		{
+			const __m128 position = _mm_mul_ps(_mm_loadu_ps(pPhase+iSample), size);
+			const __m128i truncated = _mm_cvttps_epi32(position);
+			const __m128 fraction = _mm_sub_ps(position, _mm_cvtepi32_ps(truncated));
+
+			alignas(16) int indices[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(indices), _mm_and_si128(truncated, mask));
+
+			// No gather in SSE, so fetch pairs one by one
+			const __m128 A = _mm_setr_ps(pSamples[indices[0]],   pSamples[indices[1]],   pSamples[indices[2]],   pSamples[indices[3]]);
+			const __m128 B = _mm_setr_ps(pSamples[indices[0]+1], pSamples[indices[1]+1], pSamples[indices[2]+1], pSamples[indices[3]+1]);
+
+			// Like lerpf(), so the result is identical to the scalar version
+			const __m128 invFraction = _mm_sub_ps(_mm_set1_ps(1.f), fraction);
+			_mm_storeu_ps(pDest+iSample, _mm_add_ps(_mm_mul_ps(A, invFraction), _mm_mul_ps(B, fraction)));
+		}
+
+		for (; iSample < numSamples; ++iSample)
+			pDest[iSample] = Sample(pPhase[iSample], pitch);
+	}
+}
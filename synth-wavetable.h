@@ -0,0 +1,102 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Mipmapped band-limited wavetable.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	An alternative to PolyBLEP (see synth-stateless-oscillators.h) for the non-sine operator waveforms: one cycle
+	is band-limited (using an FFT) once per octave, so whatever the pitch, the level used has no harmonics above Nyquist
+
+	- Level 0 holds kWavetableMaxHarmonics harmonics, each next level half as many (octave spacing)
+	- Each level holds kWavetableOversampling samples per cycle of it's highest harmonic, but at least kWavetableMinSize
+	- Tables are calculated once, up front (see Oscillator::CalculateWavetables()) and shared by all instances
+	- Lookup is linearly interpolated; the block version does 4 samples at a time (SSE), like the 'oscPoly...' ones, with identical results
+
+	FIXME:
+		- Switching levels (gliding or bending across an octave boundary) is not crossfaded
+*/
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "synth-global.h"
+
+namespace SFM
+{
+	constexpr unsigned kWavetableNumLevels    = 11;
+	constexpr unsigned kWavetableMaxHarmonics = 1 << (kWavetableNumLevels-1); // So that the last level is a pure sine
+	constexpr unsigned kWavetableOversampling = 8;
+	constexpr unsigned kWavetableMinSize      = 256;
+
+	struct WavetableLevel
+	{
+		unsigned offset; // In samples
+		unsigned size;   // Power of 2, followed by 1 guard sample
+	};
+
+	constexpr std::array<WavetableLevel, kWavetableNumLevels> CalculateWavetableLevels()
+	{
+		std::array<WavetableLevel, kWavetableNumLevels> levels = {};
+
+		unsigned offset = 0;
+		for (unsigned iLevel = 0; iLevel < kWavetableNumLevels; ++iLevel)
+		{
+			const unsigned size = std::max(kWavetableMinSize, kWavetableOversampling*(kWavetableMaxHarmonics >> iLevel));
+			levels[iLevel] = { offset, size };
+			offset += size+1;
+		}
+
+		return levels;
+	}
+
+	constexpr std::array<WavetableLevel, kWavetableNumLevels> kWavetableLevels = CalculateWavetableLevels();
+	constexpr unsigned kWavetableNumSamples = kWavetableLevels[kWavetableNumLevels-1].offset + kWavetableLevels[kWavetableNumLevels-1].size+1;
+
+	class Wavetable
+	{
+	public:
+		// Band-limits one cycle of 'naive' (phase [0..1]) for each level (not real-time!)
+		void Calculate(const std::function<float(float)> &naive);
+
+		// Lowest level without harmonics above Nyquist at pitch (see Phase::GetPitch())
+		SFM_INLINE static unsigned GetLevel(float pitch)
+		{
+			// Smallest L for which pitch*(kWavetableMaxHarmonics>>L) <= 0.5, so ceil(log2(pitch*kWavetableMaxHarmonics*2)),
+			// taken straight from the floating point representation
+			const float scaled = pitch*(2.f*kWavetableMaxHarmonics);
+
+			uint32_t bits;
+			memcpy(&bits, &scaled, sizeof(float));
+
+			const int exponent = int(bits >> 23) - 127;
+			const int level = exponent + (0 != (bits & 0x7fffff)); // Round up unless it's an exact power of 2
+
+			return unsigned(std::clamp(level, 0, int(kWavetableNumLevels-1)));
+		}
+
+		SFM_INLINE float Sample(float phase, float pitch) const
+		{
+			SFM_ASSERT(phase >= 0.f && phase <= 1.f);
+
+			const WavetableLevel &level = kWavetableLevels[GetLevel(pitch)];
+
+			const float position = phase*level.size;
+			const unsigned index = unsigned(position);
+			const float fraction = position - float(index);
+
+			// Wraps phase 1.0 back to 0.0
+			const float *pSamples = m_samples + level.offset + (index & (level.size-1));
+			return lerpf<float>(pSamples[0], pSamples[1], fraction);
+		}
+
+		// Renders 'numSamples' from a phase ramp at a constant pitch (see Phase::Sample(float *, unsigned))
+		void Sample(const float *pPhase, float pitch, float *pDest, unsigned numSamples) const;
+
+	private:
+		alignas(16) float m_samples[kWavetableNumSamples];
+	};
+}
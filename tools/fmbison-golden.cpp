@@ -0,0 +1,580 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Golden output regression harness.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Renders a fixed set of scenarios (patch + note events) in deterministic mode (see Bison::SetSeed()) and either
+	writes them as golden files or compares against golden files written earlier (say before an optimization)
+
+	Usage:
+		fmbison-golden --write <dir>
+		fmbison-golden --check <dir> [--exact] [--max-error <abs>] [--max-lsd <dB>]
+		fmbison-golden --check-note-tables
+
+	- Golden files are 32-bit float stereo WAV, so they can be listened to
+	- The reference set lives in tools/golden (CTest runs '--check' against it), rewrite it only if output is meant
+	  to change and say so in the commit
+	- Reports max. abs. error and log-spectral distance (LSD, Hann windowed frames, only bins within 90dB of the
+	  frame's peak and above -120dB count, so tiny differences in near silent bins don't dominate)
+	- Same build: output is bit-identical, use --exact to demand just that (say when checking a refactor)
+	- Different build/compiler/instruction set: FMA contraction and the like introduce rounding differences that
+	  feedback FM & resonant filters amplify; an AVX2/FMA build against an SSE2 one measured a max. error of 6e-3
+	  and a mean LSD of 0.08dB (worst frame 1dB), the default tolerances (kDefMaxError, kDefMaxLSD) cover that
+	- '--max-lsd' applies to the mean LSD over all frames
+	- '--check-note-tables' needs no golden files: it renders each scenario with note tables on and off (see
+	  Bison::SetNoteTables()) and demands bit-identical output, as the table lookups must match Calc*() exactly
+	- Exit code is non-zero if any scenario is missing or out of tolerance
+
+	FIXME:
+		- Scenarios live in code, might want to read them from file at some point
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../FM_BISON.h"
+#include "../helper/synth-fft.h"
+
+using namespace SFM;
+
+constexpr uint64_t kGoldenSeed = 0xB150Bull;
+
+constexpr unsigned kGoldenSampleRate = 48000;
+constexpr unsigned kGoldenBlockSize  = 256;
+
+constexpr unsigned kSpectrumSize = 2048;
+constexpr float kSpectrumFloordB = -120.f; // Absolute
+constexpr float kSpectrumRangedB = 90.f;   // Below frame peak
+
+// Default tolerances (see above)
+constexpr float kDefMaxError = 1e-2f; // -40dB
+constexpr float kDefMaxLSD   = 0.25f; // dB
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Scenarios
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct NoteEvent
+{
+	unsigned sample; // Absolute
+	unsigned key;
+	float velocity;  // Zero means note off
+};
+
+struct Scenario
+{
+	const char *name;
+	float seconds;
+	std::function<void(Patch &)> setup;
+	std::vector<NoteEvent> events;
+	unsigned internalRate;                     // See Bison::OnSetSamplingProperties(), zero means host rate
+	std::function<float(unsigned)> bendWheel;  // Per block (absolute sample), none means zero
+};
+
+static void AddChord(std::vector<NoteEvent> &events, unsigned onSample, unsigned offSample, std::initializer_list<unsigned> keys, float velocity)
+{
+	for (unsigned key : keys)
+	{
+		events.push_back({ onSample, key, velocity });
+		events.push_back({ offSample, key, 0.f });
+	}
+}
+
+static void AddArpeggio(std::vector<NoteEvent> &events, unsigned startSample, unsigned step, unsigned count, unsigned baseKey)
+{
+	const unsigned intervals[] = { 0, 4, 7, 12, 16, 12, 7, 4 };
+	for (unsigned iNote = 0; iNote < count; ++iNote)
+	{
+		const unsigned key = baseKey + intervals[iNote % 8];
+		const unsigned onSample = startSample + iNote*step;
+		events.push_back({ onSample, key, 0.5f + 0.05f*(iNote % 8) });
+		events.push_back({ onSample + step*3/4, key, 0.f });
+	}
+}
+
+static std::vector<Scenario> GetScenarios()
+{
+	std::vector<Scenario> scenarios;
+
+	// Classic 2-stack FM e-piano-ish with feedback, poly chords and an arpeggio
+	{
+		Scenario scenario = { "fm-keys", 4.f, {}, {}, 0, {} };
+
+		scenario.setup = [](Patch &patch)
+		{
+			auto &ops = patch.operators.operators;
+			for (unsigned iOp = 0; iOp < 6; ++iOp)
+			{
+				ops[iOp].enabled = true;
+				ops[iOp].isCarrier = 0 == (iOp & 1);
+				ops[iOp].coarse = 1 + iOp/2;
+				ops[iOp].index = 0.3f;
+				if (0 == (iOp & 1)) ops[iOp].modulators[0] = iOp+1;
+			}
+
+			ops[5].feedback = 5;
+			ops[5].feedbackAmt = 0.4f;
+		};
+
+		AddChord(scenario.events, 0, 48000, { 48, 52, 55, 60 }, 0.8f);
+		AddChord(scenario.events, 60000, 110000, { 50, 53, 57, 62 }, 0.6f);
+		AddArpeggio(scenario.events, 110000, 4800, 16, 60);
+
+		scenarios.push_back(scenario);
+	}
+
+	// Everything that draws random values: noise, S&H, supersaw phases & full jitter
+	{
+		Scenario scenario = { "random-sources", 3.f, {}, {}, 0, {} };
+
+		scenario.setup = [](Patch &patch)
+		{
+			// Carriers & their modulator (supersaws can't be modulated)
+			const Oscillator::Waveform waveforms[6] =
+			{
+				Oscillator::Waveform::kPolySaw,
+				Oscillator::Waveform::kWhiteNoise,
+				Oscillator::Waveform::kSupersaw,
+				Oscillator::Waveform::kPinkNoise,
+				Oscillator::Waveform::kSine,
+				Oscillator::Waveform::kSampleAndHold
+			};
+
+			auto &ops = patch.operators.operators;
+			for (unsigned iOp = 0; iOp < 6; ++iOp)
+			{
+				ops[iOp].enabled = true;
+				ops[iOp].isCarrier = 0 == (iOp & 1) || Oscillator::Waveform::kPinkNoise == waveforms[iOp];
+				ops[iOp].waveform = waveforms[iOp];
+				ops[iOp].keySync = false;
+				ops[iOp].index = 0.1f;
+				ops[iOp].supersawDetune = 0.6f;
+				if (0 == (iOp & 1) && Oscillator::Waveform::kSupersaw != waveforms[iOp]) ops[iOp].modulators[0] = iOp+1;
+			}
+
+			patch.jitter = 1.f;
+			patch.LFOWaveform1 = Oscillator::Waveform::kSampleAndHold;
+		};
+
+		AddChord(scenario.events, 0, 72000, { 36, 43, 48, 55, 60, 64 }, 0.9f);
+		AddArpeggio(scenario.events, 72000, 3000, 24, 48);
+
+		scenarios.push_back(scenario);
+	}
+
+	// Monophonic glide through the full PostPass (wah/Vox, chorus, delay, ZDF ladder, reverb, compressor)
+	{
+		Scenario scenario = { "mono-all-fx", 4.f, {}, {}, 0, {} };
+
+		scenario.setup = [](Patch &patch)
+		{
+			auto &ops = patch.operators.operators;
+			ops[0].enabled = true;
+			ops[0].isCarrier = true;
+			ops[0].waveform = Oscillator::Waveform::kPolySaw;
+			ops[1].enabled = true;
+			ops[1].isCarrier = false;
+			ops[1].coarse = 2;
+			ops[1].index = 0.2f;
+			ops[0].modulators[0] = 1;
+
+			patch.voiceMode = Patch::VoiceMode::kMono;
+			patch.monoGlide = 0.05f;
+
+			patch.wahWet = 0.6f;
+			patch.wahSpeak = 0.5f;
+			patch.wahSpeakGhost = 0.5f;
+			patch.cpWet = 0.5f;
+			patch.delayWet = 0.3f;
+			patch.delayFeedback = 0.4f;
+			patch.postWet = 0.5f;
+			patch.postCutoff = 0.6f;
+			patch.postFilterType = Patch::kZDFPostFilter;
+			patch.reverbWet = 0.4f;
+			patch.compThresholddB = -18.f;
+		};
+
+		AddArpeggio(scenario.events, 0, 6000, 28, 45);
+
+		scenarios.push_back(scenario);
+	}
+
+	// Voice engine at half rate (24KHz), high FM partials pushed past it's Nyquist by pitch bend & vibrato
+	{
+		Scenario scenario = { "internal-rate", 3.f, {}, {}, 24000, {} };
+
+		scenario.setup = [](Patch &patch)
+		{
+			auto &ops = patch.operators.operators;
+			for (unsigned iOp = 0; iOp < 4; ++iOp)
+			{
+				ops[iOp].enabled = true;
+				ops[iOp].isCarrier = 0 == (iOp & 1);
+				ops[iOp].coarse = 2 + 2*iOp;
+				ops[iOp].index = 0.4f;
+				ops[iOp].pitchMod = 1.f;
+				if (0 == (iOp & 1)) ops[iOp].modulators[0] = iOp+1;
+			}
+
+			patch.pitchBendRange = 24;
+			patch.LFORate = 60.f;
+			patch.modulationOverride = 1.f;
+		};
+
+		// Up 2 octaves and back, then down
+		scenario.bendWheel = [](unsigned sample)
+		{
+			return sinf(2.f*3.1415926535897932384626433832795f*sample/96000.f);
+		};
+
+		AddChord(scenario.events, 0, 60000, { 72, 79, 84 }, 0.8f);
+		AddArpeggio(scenario.events, 60000, 4800, 16, 84);
+
+		scenarios.push_back(scenario);
+	}
+
+	return scenarios;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Rendering
+
+ ------------------------------------------------------------------------------------------------------ */
+
+// Returns interleaved stereo
+static std::vector<float> RenderScenario(const Scenario &scenario, bool noteTables = true, Telemetry *pTelemetry = nullptr)
+{
+	Bison bison;
+	scenario.setup(bison.GetPatch());
+
+	bison.SetSeed(kGoldenSeed);
+	bison.SetNoteTables(noteTables);
+	bison.OnSetSamplingProperties(kGoldenSampleRate, kGoldenBlockSize, scenario.internalRate);
+
+	const unsigned numSamples = unsigned(scenario.seconds*kGoldenSampleRate);
+
+	std::vector<float> output(numSamples*2);
+	std::vector<float> left(kGoldenBlockSize), right(kGoldenBlockSize);
+
+	for (unsigned iOffset = 0; iOffset < numSamples; iOffset += kGoldenBlockSize)
+	{
+		const unsigned blockSize = std::min(kGoldenBlockSize, numSamples-iOffset);
+
+		for (const NoteEvent &event : scenario.events)
+		{
+			if (event.sample >= iOffset && event.sample < iOffset+blockSize)
+			{
+				const unsigned timeStamp = event.sample-iOffset;
+				if (0.f != event.velocity)
+					bison.NoteOn(event.key, -1.f, event.velocity, timeStamp);
+				else
+					bison.NoteOff(event.key, timeStamp);
+			}
+		}
+
+		const float bendWheel = (nullptr != scenario.bendWheel) ? scenario.bendWheel(iOffset) : 0.f;
+		bison.Render(blockSize, bendWheel, 0.f, 0.f, left.data(), right.data());
+
+		for (unsigned iSample = 0; iSample < blockSize; ++iSample)
+		{
+			output[(iOffset+iSample)*2 + 0] = left[iSample];
+			output[(iOffset+iSample)*2 + 1] = right[iSample];
+		}
+	}
+
+	if (nullptr != pTelemetry)
+		bison.GetTelemetry(*pTelemetry);
+
+	return output;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	WAV (32-bit float stereo, little endian hosts only)
+
+ ------------------------------------------------------------------------------------------------------ */
+
+#pragma pack(push, 1)
+
+struct WavHeader
+{
+	char riff[4];
+	uint32_t riffSize;
+	char wave[4];
+	char fmt[4];
+	uint32_t fmtSize;
+	uint16_t format; // 3 = IEEE float
+	uint16_t numChannels;
+	uint32_t sampleRate;
+	uint32_t byteRate;
+	uint16_t blockAlign;
+	uint16_t bitsPerSample;
+	char data[4];
+	uint32_t dataSize;
+};
+
+#pragma pack(pop)
+
+static bool WriteWav(const std::string &path, const std::vector<float> &samples)
+{
+	FILE *pFile = fopen(path.c_str(), "wb");
+	if (nullptr == pFile)
+		return false;
+
+	const uint32_t dataSize = uint32_t(samples.size()*sizeof(float));
+
+	WavHeader header;
+	memcpy(header.riff, "RIFF", 4);
+	header.riffSize = uint32_t(sizeof(WavHeader)-8) + dataSize;
+	memcpy(header.wave, "WAVE", 4);
+	memcpy(header.fmt, "fmt ", 4);
+	header.fmtSize = 16;
+	header.format = 3;
+	header.numChannels = 2;
+	header.sampleRate = kGoldenSampleRate;
+	header.byteRate = kGoldenSampleRate*2*sizeof(float);
+	header.blockAlign = 2*sizeof(float);
+	header.bitsPerSample = 32;
+	memcpy(header.data, "data", 4);
+	header.dataSize = dataSize;
+
+	const bool success = 1 == fwrite(&header, sizeof(WavHeader), 1, pFile) && samples.size() == fwrite(samples.data(), sizeof(float), samples.size(), pFile);
+	fclose(pFile);
+
+	return success;
+}
+
+// Only reads what WriteWav() writes
+static bool ReadWav(const std::string &path, std::vector<float> &samples)
+{
+	FILE *pFile = fopen(path.c_str(), "rb");
+	if (nullptr == pFile)
+		return false;
+
+	WavHeader header;
+	bool success = 1 == fread(&header, sizeof(WavHeader), 1, pFile) &&
+		0 == memcmp(header.data, "data", 4) && 3 == header.format && 2 == header.numChannels && kGoldenSampleRate == header.sampleRate;
+
+	if (true == success)
+	{
+		samples.resize(header.dataSize/sizeof(float));
+		success = samples.size() == fread(samples.data(), sizeof(float), samples.size(), pFile);
+	}
+
+	fclose(pFile);
+
+	return success;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Comparison
+
+ ------------------------------------------------------------------------------------------------------ */
+
+// Power spectrum (dB) of one channel, frame starts at 'offset' (interleaved)
+static void GetSpectrum(const std::vector<float> &samples, unsigned offset, unsigned channel, std::vector<float> &spectrum)
+{
+	std::vector<std::complex<double>> bins(kSpectrumSize);
+	for (unsigned iSample = 0; iSample < kSpectrumSize; ++iSample)
+	{
+		const double hann = 0.5 - 0.5*cos(2.0*3.1415926535897932384626433832795*iSample/kSpectrumSize);
+		bins[iSample] = samples[(offset+iSample)*2 + channel]*hann;
+	}
+
+	FFT(bins.data(), kSpectrumSize, false);
+
+	spectrum.resize(kSpectrumSize/2);
+	for (unsigned iBin = 0; iBin < kSpectrumSize/2; ++iBin)
+		spectrum[iBin] = float(10.0*log10(std::norm(bins[iBin]) + 1e-30));
+}
+
+struct Difference
+{
+	float maxError;
+	unsigned maxErrorSample;
+	float meanLSD;  // Over all frames (dB)
+	float worstLSD; // Worst frame (dB)
+};
+
+static Difference Compare(const std::vector<float> &reference, const std::vector<float> &test)
+{
+	Difference difference = { 0.f, 0, 0.f, 0.f };
+
+	const unsigned numSamples = unsigned(reference.size()/2);
+
+	for (unsigned iSample = 0; iSample < numSamples*2; ++iSample)
+	{
+		const float error = fabsf(reference[iSample]-test[iSample]);
+		if (error > difference.maxError || std::isnan(error))
+		{
+			difference.maxError = std::isnan(error) ? INFINITY : error;
+			difference.maxErrorSample = iSample/2;
+		}
+	}
+
+	// Log-spectral distance, 50% overlap, only over bins where either is above the floor (silence doesn't count)
+	std::vector<float> specRef, specTest;
+	double sumLSD = 0.0;
+	unsigned numFrames = 0;
+
+	for (unsigned iOffset = 0; iOffset+kSpectrumSize <= numSamples; iOffset += kSpectrumSize/2)
+	{
+		for (unsigned iChan = 0; iChan < 2; ++iChan)
+		{
+			GetSpectrum(reference, iOffset, iChan, specRef);
+			GetSpectrum(test, iOffset, iChan, specTest);
+
+			const float peak = *std::max_element(specRef.begin(), specRef.end());
+			const float floor = std::max(kSpectrumFloordB, peak-kSpectrumRangedB);
+
+			double sumSquared = 0.0;
+			unsigned numBins = 0;
+
+			for (unsigned iBin = 0; iBin < kSpectrumSize/2; ++iBin)
+			{
+				const float ref = std::max(specRef[iBin], floor);
+				const float tst = std::max(specTest[iBin], floor);
+				if (ref > floor || tst > floor)
+				{
+					sumSquared += (ref-tst)*(ref-tst);
+					++numBins;
+				}
+			}
+
+			const float LSD = (0 != numBins) ? float(sqrt(sumSquared/numBins)) : 0.f;
+			difference.worstLSD = std::max(difference.worstLSD, LSD);
+			sumLSD += LSD;
+			++numFrames;
+		}
+	}
+
+	difference.meanLSD = (0 != numFrames) ? float(sumLSD/numFrames) : 0.f;
+
+	return difference;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Entry point
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static int PrintUsage()
+{
+	printf("Usage: fmbison-golden --write <dir>\n");
+	printf("       fmbison-golden --check <dir> [--exact] [--max-error <abs>] [--max-lsd <dB>]\n");
+	printf("       fmbison-golden --check-note-tables\n");
+	return 2;
+}
+
+// Note tables on vs. off, must be bit-identical (see above)
+static int CheckNoteTables()
+{
+	int result = 0;
+
+	for (const Scenario &scenario : GetScenarios())
+	{
+		Telemetry telemetryOn, telemetryOff;
+		const std::vector<float> outputOn  = RenderScenario(scenario, true, &telemetryOn);
+		const std::vector<float> outputOff = RenderScenario(scenario, false, &telemetryOff);
+
+		const Difference difference = Compare(outputOn, outputOff);
+		const bool identical = 0 == memcmp(outputOn.data(), outputOff.data(), outputOn.size()*sizeof(float));
+
+		printf("%-16s %s max. error %.3g (at sample %u), note table fallbacks %llu (on) vs. %llu (off)\n",
+			scenario.name, (true == identical) ? "OK    " : "FAILED",
+			difference.maxError, difference.maxErrorSample,
+			(unsigned long long) telemetryOn.totalNoteTableFallbacks, (unsigned long long) telemetryOff.totalNoteTableFallbacks);
+
+		if (false == identical)
+			result = 1;
+	}
+
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	if (2 == argc && 0 == strcmp(argv[1], "--check-note-tables"))
+		return CheckNoteTables();
+
+	if (argc < 3)
+		return PrintUsage();
+
+	const std::string mode = argv[1];
+	const std::string directory = argv[2];
+
+	if ("--write" != mode && "--check" != mode)
+		return PrintUsage();
+
+	bool exact = false;
+	float maxError = kDefMaxError;
+	float maxLSD = kDefMaxLSD;
+
+	for (int iArg = 3; iArg < argc; ++iArg)
+	{
+		if (0 == strcmp(argv[iArg], "--exact"))
+			exact = true;
+		else if (0 == strcmp(argv[iArg], "--max-error") && iArg+1 < argc)
+			maxError = float(atof(argv[++iArg]));
+		else if (0 == strcmp(argv[iArg], "--max-lsd") && iArg+1 < argc)
+			maxLSD = float(atof(argv[++iArg]));
+		else
+			return PrintUsage();
+	}
+
+	int result = 0;
+
+	for (const Scenario &scenario : GetScenarios())
+	{
+		const std::string path = directory + "/" + scenario.name + ".wav";
+		const std::vector<float> output = RenderScenario(scenario);
+
+		if ("--write" == mode)
+		{
+			if (false == WriteWav(path, output))
+			{
+				printf("%-16s FAILED to write %s\n", scenario.name, path.c_str());
+				result = 1;
+			}
+			else
+				printf("%-16s written (%zu samples)\n", scenario.name, output.size()/2);
+
+			continue;
+		}
+
+		std::vector<float> golden;
+		if (false == ReadWav(path, golden) || golden.size() != output.size())
+		{
+			printf("%-16s FAILED: %s missing or of different length\n", scenario.name, path.c_str());
+			result = 1;
+			continue;
+		}
+
+		const Difference difference = Compare(golden, output);
+		const bool identical = 0 == memcmp(golden.data(), output.data(), output.size()*sizeof(float));
+		const bool pass = (true == exact) ? identical : difference.maxError <= maxError && difference.meanLSD <= maxLSD;
+
+		printf("%-16s %s max. error %.3g (at sample %u), LSD mean %.4f dB, worst %.4f dB%s\n",
+			scenario.name, (true == pass) ? "OK    " : "FAILED",
+			difference.maxError, difference.maxErrorSample, difference.meanLSD, difference.worstLSD,
+			(true == identical) ? " (bit-identical)" : "");
+
+		if (false == pass)
+			result = 1;
+	}
+
+	return result;
+}
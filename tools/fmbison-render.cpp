@@ -0,0 +1,1372 @@
+/*
+	FM. BISON hybrid FM synthesis -- Offline MIDI file renderer.
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Plays Standard MIDI Files (format 0 & 1) through Bison and writes the result as WAV
+
+	Usage:
+		fmbison-render [options] <file.mid> [<file.mid> ...]
+
+		--patch <file>        Patch file (see below), if omitted: engine defaults with operator 0 on as sine carrier
+		--output <file>       Output file (single input only), default: input with '.wav' instead of '.mid'
+		--output-dir <dir>    Where output goes (multiple inputs), default: next to each input
+		--format <f32|s24|s16> Sample format, default: f32 (s16 is TPDF dithered)
+		--rate <Hz>           Sample rate, default: 48000
+		--block <samples>     Render() block size, default: 256
+		--channel <1-16>      Only play this MIDI channel, default: all of them
+		--jobs <N>            Worker threads (multiple inputs), default: number of hardware threads
+		--tail-db <dB>        Tail is done once output stays below this level (and all voices are idle), default: -90
+		--max-tail <sec>      Stop rendering this long after the last event regardless, default: 60
+		--seed <N>            Seed (see Bison::SetSeed()), default: fixed, so output is the same on every run
+		--pipelined           Run PostPass on a thread of it's own (see Bison::SetPipelined()), same output
+
+	Patch file:
+		# Comment
+		cutoff = 0.5
+		filterEnvParams.attack = 0.1
+		op0.enabled = true
+		op1.modulators[0] = 2
+
+	- Keys are the names of Patch (patch/synth-patch-global.h) & PatchOperators::Operator (synth-patch-operators.h)
+	  members, operator members are prefixed with 'op<index>.' (0-based, like 'modulators[]' & 'feedback');
+	  enumerations (waveform, filterType, ...) are given as their integer value, booleans as true/false (or 1/0)
+	- Values are not range checked, mind the ranges noted in those headers
+	- Note on/off are passed with sample-accurate timestamps; Render() blocks are split on sustain pedal (CC64) and
+	  tempo changes so those take effect on the exact sample too; pitch bend, mod. wheel (CC1) & channel pressure
+	  (aftertouch) are Render() parameters and are picked up per block
+	- Output is handed to a writer thread through a fixed number of chunks (the renderer waits if it runs ahead),
+	  so memory use does not depend on the length of a file
+	- With multiple inputs each worker thread has it's own Bison instance (constructed up front, the static
+	  initialization in Bison's constructor isn't thread-safe) that is set up anew for each file
+	- Rendering stops once all events have been played, all voices are idle and the output (reverb & delay tails
+	  included) has stayed below '--tail-db' for kTailHoldSec, or after '--max-tail' seconds
+	- Reports the realtime factor (seconds of audio rendered per second of Render(), writing excluded) per file and
+	  overall (wall clock, so it includes writing & parallelism)
+	- Exit code is non-zero if any input could not be read or written
+
+	FIXME:
+		- No FLAC (there's no encoder in the tree), WAV only, and plain RIFF, so 4GB tops (approx. 3 hours at 48KHz/f32)
+		- Sysex, program & bank changes are ignored
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../FM_BISON.h"
+#include "../helper/synth-MIDI.h"
+
+using namespace SFM;
+
+constexpr uint64_t kDefSeed = 0xB150Bull;
+
+constexpr unsigned kDefSampleRate = 48000;
+constexpr unsigned kDefBlockSize  = 256;
+constexpr float kDefTaildB        = -90.f;
+constexpr float kDefMaxTailSec    = 60.f;
+constexpr float kTailHoldSec      = 0.5f;
+constexpr float kDefBPM           = 120.f; // SMF default (500000 microseconds per quarter note)
+
+// Controllers not in synth-MIDI.h
+constexpr unsigned kModWheelCC    = 1;
+constexpr unsigned kAllSoundOffCC = 120;
+constexpr unsigned kAllNotesOffCC = 123;
+
+// Writer: kWriterChunks*kWriterChunkFrames stereo frames in flight at most
+constexpr unsigned kWriterChunks      = 16;
+constexpr unsigned kWriterChunkFrames = 8192;
+
+enum SampleFormat
+{
+	kFloat32,
+	kPCM24,
+	kPCM16
+};
+
+struct Options
+{
+	std::string patchPath;
+	std::string outputPath;
+	std::string outputDir;
+	SampleFormat format = kFloat32;
+	unsigned sampleRate = kDefSampleRate;
+	unsigned blockSize = kDefBlockSize;
+	int channel = -1; // All
+	unsigned numJobs = 0;
+	float taildB = kDefTaildB;
+	float maxTailSec = kDefMaxTailSec;
+	uint64_t seed = kDefSeed;
+	bool pipelined = false;
+};
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Patch file
+
+ ------------------------------------------------------------------------------------------------------ */
+
+enum FieldType
+{
+	kFloatField,
+	kIntField,
+	kUnsignedField,
+	kBoolField,
+	kEnumField
+};
+
+struct PatchField
+{
+	const char *name;
+	FieldType type;
+	size_t offset;
+};
+
+template<typename T> constexpr FieldType GetFieldType()
+{
+	if constexpr (std::is_same_v<T, float>)
+		return kFloatField;
+	else if constexpr (std::is_same_v<T, int>)
+		return kIntField;
+	else if constexpr (std::is_same_v<T, unsigned>)
+		return kUnsignedField;
+	else if constexpr (std::is_same_v<T, bool>)
+		return kBoolField;
+	else
+	{
+		static_assert(std::is_enum_v<T> && sizeof(T) == sizeof(int), "Unsupported patch field type");
+		return kEnumField;
+	}
+}
+
+#define GLOBAL_FIELD(member)   { #member, GetFieldType<std::remove_cvref_t<decltype(Patch::member)>>(), offsetof(Patch, member) }
+#define OPERATOR_FIELD(member) { #member, GetFieldType<std::remove_cvref_t<decltype(PatchOperators::Operator::member)>>(), offsetof(PatchOperators::Operator, member) }
+
+#define ENVELOPE_FIELDS(FIELD, envelope) \
+	FIELD(envelope.preAttack), FIELD(envelope.attack), FIELD(envelope.decay), FIELD(envelope.sustain), FIELD(envelope.release), \
+	FIELD(envelope.globalMul), FIELD(envelope.attackCurve), FIELD(envelope.decayCurve), FIELD(envelope.releaseCurve)
+
+static const PatchField kGlobalFields[] =
+{
+	GLOBAL_FIELD(oscRenderMode),
+	GLOBAL_FIELD(voiceMode),
+	GLOBAL_FIELD(monoGlide),
+	GLOBAL_FIELD(monoAtt),
+	GLOBAL_FIELD(masterVoldB),
+	GLOBAL_FIELD(pitchBendRange),
+	GLOBAL_FIELD(LFOWaveform1),
+	GLOBAL_FIELD(LFOWaveform2),
+	GLOBAL_FIELD(LFOWaveform3),
+	GLOBAL_FIELD(LFOBlend),
+	GLOBAL_FIELD(LFOModSpeed),
+	GLOBAL_FIELD(LFOModDepth),
+	GLOBAL_FIELD(LFORate),
+	GLOBAL_FIELD(LFOKeySync),
+	GLOBAL_FIELD(modulationOverride),
+	GLOBAL_FIELD(SandHSlewRate),
+	GLOBAL_FIELD(beatSync),
+	GLOBAL_FIELD(beatSyncRatio),
+	GLOBAL_FIELD(jitter),
+	GLOBAL_FIELD(cpIsPhaser),
+	GLOBAL_FIELD(cpWet),
+	GLOBAL_FIELD(cpRate),
+	GLOBAL_FIELD(delayInSec),
+	GLOBAL_FIELD(delayWet),
+	GLOBAL_FIELD(delayDrivedB),
+	GLOBAL_FIELD(delayFeedback),
+	GLOBAL_FIELD(delayFeedbackCutoff),
+	GLOBAL_FIELD(delayTapeWow),
+	GLOBAL_FIELD(pitchIsAmpMod),
+	GLOBAL_FIELD(maxPolyVoices),
+	GLOBAL_FIELD(wahResonance),
+	GLOBAL_FIELD(wahAttack),
+	GLOBAL_FIELD(wahHold),
+	GLOBAL_FIELD(wahRate),
+	GLOBAL_FIELD(wahDrivedB),
+	GLOBAL_FIELD(wahSpeak),
+	GLOBAL_FIELD(wahSpeakVowel),
+	GLOBAL_FIELD(wahSpeakVowelMod),
+	GLOBAL_FIELD(wahSpeakGhost),
+	GLOBAL_FIELD(wahSpeakCut),
+	GLOBAL_FIELD(wahSpeakResonance),
+	GLOBAL_FIELD(wahCut),
+	GLOBAL_FIELD(wahWet),
+	GLOBAL_FIELD(reverbWet),
+	GLOBAL_FIELD(reverbRoomSize),
+	GLOBAL_FIELD(reverbDampening),
+	GLOBAL_FIELD(reverbWidth),
+	GLOBAL_FIELD(reverbPreDelay),
+	GLOBAL_FIELD(reverbBassTuningdB),
+	GLOBAL_FIELD(reverbTrebleTuningdB),
+	GLOBAL_FIELD(compThresholddB),
+	GLOBAL_FIELD(compKneedB),
+	GLOBAL_FIELD(compRatio),
+	GLOBAL_FIELD(compGaindB),
+	GLOBAL_FIELD(compAttack),
+	GLOBAL_FIELD(compRelease),
+	GLOBAL_FIELD(compLookahead),
+	GLOBAL_FIELD(compAutoGain),
+	GLOBAL_FIELD(compRMSToPeak),
+	GLOBAL_FIELD(filterType),
+	GLOBAL_FIELD(cutoff),
+	GLOBAL_FIELD(resonance),
+	GLOBAL_FIELD(resonanceLimit),
+	GLOBAL_FIELD(postCutoff),
+	GLOBAL_FIELD(postResonance),
+	GLOBAL_FIELD(postDrivedB),
+	GLOBAL_FIELD(postWet),
+	GLOBAL_FIELD(postFilterType),
+	ENVELOPE_FIELDS(GLOBAL_FIELD, filterEnvParams),
+	GLOBAL_FIELD(filterEnvInvert),
+	GLOBAL_FIELD(pitchEnvParams.P1),
+	GLOBAL_FIELD(pitchEnvParams.P2),
+	GLOBAL_FIELD(pitchEnvParams.P3),
+	GLOBAL_FIELD(pitchEnvParams.P4),
+	GLOBAL_FIELD(pitchEnvParams.R1),
+	GLOBAL_FIELD(pitchEnvParams.R2),
+	GLOBAL_FIELD(pitchEnvParams.R3),
+	GLOBAL_FIELD(pitchEnvParams.L4),
+	GLOBAL_FIELD(pitchEnvParams.globalMul),
+	GLOBAL_FIELD(sustainType),
+	GLOBAL_FIELD(aftertouchMod),
+	GLOBAL_FIELD(tubeDistort),
+	GLOBAL_FIELD(tubeDrive),
+	GLOBAL_FIELD(tubeOffset),
+	GLOBAL_FIELD(tubeTone),
+	GLOBAL_FIELD(tubeToneReso),
+	GLOBAL_FIELD(pianoPedalFalloff),
+	GLOBAL_FIELD(pianoPedalReleaseMul),
+	GLOBAL_FIELD(acousticScaling),
+	GLOBAL_FIELD(syncOverride),
+	GLOBAL_FIELD(bassTuningdB),
+	GLOBAL_FIELD(trebleTuningdB),
+	GLOBAL_FIELD(midTuningdB)
+};
+
+static const PatchField kOperatorFields[] =
+{
+	OPERATOR_FIELD(enabled),
+	OPERATOR_FIELD(isCarrier),
+	OPERATOR_FIELD(waveform),
+	OPERATOR_FIELD(filterType),
+	OPERATOR_FIELD(peakdB),
+	OPERATOR_FIELD(cutoff),
+	OPERATOR_FIELD(resonance),
+	OPERATOR_FIELD(cutoffKeyTrack),
+	OPERATOR_FIELD(keySync),
+	OPERATOR_FIELD(modulators[0]),
+	OPERATOR_FIELD(modulators[1]),
+	OPERATOR_FIELD(modulators[2]),
+	OPERATOR_FIELD(feedback),
+	OPERATOR_FIELD(coarse),
+	OPERATOR_FIELD(fine),
+	OPERATOR_FIELD(detune),
+	OPERATOR_FIELD(fixed),
+	OPERATOR_FIELD(output),
+	OPERATOR_FIELD(index),
+	ENVELOPE_FIELDS(OPERATOR_FIELD, envParams),
+	OPERATOR_FIELD(envKeyTrack),
+	OPERATOR_FIELD(acousticEnvKeyTrack),
+	OPERATOR_FIELD(velocityInvert),
+	OPERATOR_FIELD(velSens),
+	OPERATOR_FIELD(feedbackAmt),
+	OPERATOR_FIELD(ampMod),
+	OPERATOR_FIELD(pitchMod),
+	OPERATOR_FIELD(panMod),
+	OPERATOR_FIELD(drive),
+	OPERATOR_FIELD(panning),
+	OPERATOR_FIELD(levelScaleBP),
+	OPERATOR_FIELD(levelScaleRange),
+	OPERATOR_FIELD(levelScaleL),
+	OPERATOR_FIELD(levelScaleR),
+	OPERATOR_FIELD(levelScaleExpL),
+	OPERATOR_FIELD(levelScaleExpR),
+	OPERATOR_FIELD(cutLeftOfLSBP),
+	OPERATOR_FIELD(cutRightOfLSBP),
+	OPERATOR_FIELD(supersawDetune),
+	OPERATOR_FIELD(supersawMix)
+};
+
+#undef GLOBAL_FIELD
+#undef OPERATOR_FIELD
+#undef ENVELOPE_FIELDS
+
+static std::string Trim(const std::string &string)
+{
+	const size_t first = string.find_first_not_of(" \t\r\n");
+	if (std::string::npos == first)
+		return "";
+
+	const size_t last = string.find_last_not_of(" \t\r\n");
+	return string.substr(first, last-first+1);
+}
+
+static bool SetField(const PatchField &field, void *pStruct, const std::string &value)
+{
+	char *pEnd = nullptr;
+	uint8_t *pField = reinterpret_cast<uint8_t *>(pStruct) + field.offset;
+
+	switch (field.type)
+	{
+	case kFloatField:
+		{
+			const float floatValue = strtof(value.c_str(), &pEnd);
+			memcpy(pField, &floatValue, sizeof(float));
+			break;
+		}
+
+	case kIntField:
+	case kEnumField:
+		{
+			const int intValue = int(strtol(value.c_str(), &pEnd, 10));
+			memcpy(pField, &intValue, sizeof(int));
+			break;
+		}
+
+	case kUnsignedField:
+		{
+			// Accepts -1 (as used for 'no operator')
+			const unsigned unsignedValue = unsigned(strtoll(value.c_str(), &pEnd, 10));
+			memcpy(pField, &unsignedValue, sizeof(unsigned));
+			break;
+		}
+
+	case kBoolField:
+		{
+			bool boolValue;
+			if ("true" == value || "1" == value || "on" == value)
+				boolValue = true;
+			else if ("false" == value || "0" == value || "off" == value)
+				boolValue = false;
+			else
+				return false;
+
+			memcpy(pField, &boolValue, sizeof(bool));
+			return true;
+		}
+	}
+
+	return pEnd != value.c_str() && 0 == *pEnd;
+}
+
+template<size_t kNumFields> static const PatchField *FindField(const PatchField (&fields)[kNumFields], const std::string &name)
+{
+	for (const PatchField &field : fields)
+		if (name == field.name)
+			return &field;
+
+	return nullptr;
+}
+
+static bool LoadPatch(const std::string &path, Patch &patch)
+{
+	FILE *pFile = fopen(path.c_str(), "r");
+	if (nullptr == pFile)
+	{
+		printf("Can't open patch: %s\n", path.c_str());
+		return false;
+	}
+
+	bool success = true;
+
+	char line[512];
+	unsigned iLine = 0;
+	while (nullptr != fgets(line, sizeof(line), pFile))
+	{
+		++iLine;
+
+		std::string text = line;
+		text = Trim(text.substr(0, text.find('#')));
+		if (true == text.empty())
+			continue;
+
+		const size_t equals = text.find('=');
+		if (std::string::npos == equals)
+		{
+			printf("%s(%u): expected <key> = <value>\n", path.c_str(), iLine);
+			success = false;
+			continue;
+		}
+
+		const std::string key = Trim(text.substr(0, equals));
+		const std::string value = Trim(text.substr(equals+1));
+
+		const PatchField *pField = nullptr;
+		void *pStruct = &patch;
+
+		// Operator?
+		unsigned iOp;
+		int prefixLength = 0;
+		if (1 == sscanf(key.c_str(), "op%u.%n", &iOp, &prefixLength) && prefixLength > 0)
+		{
+			if (iOp < kNumOperators)
+			{
+				pField = FindField(kOperatorFields, key.substr(prefixLength));
+				pStruct = &patch.operators.operators[iOp];
+			}
+		}
+		else
+			pField = FindField(kGlobalFields, key);
+
+		if (nullptr == pField)
+		{
+			printf("%s(%u): unknown key '%s'\n", path.c_str(), iLine, key.c_str());
+			success = false;
+		}
+		else if (false == SetField(*pField, pStruct, value))
+		{
+			printf("%s(%u): invalid value '%s' for '%s'\n", path.c_str(), iLine, value.c_str(), key.c_str());
+			success = false;
+		}
+	}
+
+	fclose(pFile);
+
+	return success;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Standard MIDI File
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Event
+{
+	enum Type
+	{
+		kNoteOn,
+		kNoteOff,
+		kAllNotesOff,
+		kSustain,
+		kTempo,
+		kBend,
+		kModulation,
+		kAftertouch
+	} type;
+
+	uint64_t tick;
+	uint64_t sample;
+	unsigned key;
+	float value; // Velocity, pedal, BPM, bend, modulation, aftertouch
+
+	// Sustain & tempo take effect at a specific sample, the rest is either timestamped or per block
+	bool SplitsBlock() const
+	{
+		return kSustain == type || kTempo == type;
+	}
+};
+
+class MIDIReader
+{
+public:
+	MIDIReader(const std::vector<uint8_t> &data, size_t offset, size_t end) :
+		m_data(data), m_offset(offset), m_end(end) {}
+
+	bool IsDone() const { return m_offset >= m_end; }
+
+	bool Read(unsigned numBytes, uint32_t &value)
+	{
+		if (m_offset+numBytes > m_end)
+			return false;
+
+		value = 0;
+		for (unsigned iByte = 0; iByte < numBytes; ++iByte)
+			value = (value << 8) | m_data[m_offset++];
+
+		return true;
+	}
+
+	// Variable length quantity
+	bool ReadVLQ(uint32_t &value)
+	{
+		value = 0;
+		for (unsigned iByte = 0; iByte < 4; ++iByte)
+		{
+			if (m_offset >= m_end)
+				return false;
+
+			const uint8_t byte = m_data[m_offset++];
+			value = (value << 7) | (byte & 0x7f);
+
+			if (0 == (byte & 0x80))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool Skip(size_t numBytes)
+	{
+		if (m_offset+numBytes > m_end)
+			return false;
+
+		m_offset += numBytes;
+		return true;
+	}
+
+	size_t GetOffset() const { return m_offset; }
+
+private:
+	const std::vector<uint8_t> &m_data;
+	size_t m_offset, m_end;
+};
+
+static bool ReadTrack(MIDIReader &reader, int channel, std::vector<Event> &events)
+{
+	uint64_t tick = 0;
+	uint32_t runningStatus = 0;
+
+	while (false == reader.IsDone())
+	{
+		uint32_t delta, status;
+		if (false == reader.ReadVLQ(delta) || false == reader.Read(1, status))
+			return false;
+
+		tick += delta;
+
+		if (MIDI_META_EVENT == status)
+		{
+			uint32_t type, length;
+			if (false == reader.Read(1, type) || false == reader.ReadVLQ(length))
+				return false;
+
+			if (0x51 == type && 3 == length) // Tempo
+			{
+				uint32_t microseconds;
+				if (false == reader.Read(3, microseconds))
+					return false;
+
+				if (0 != microseconds)
+					events.push_back({ Event::kTempo, tick, 0, 0, float(60000000.0/microseconds) });
+			}
+			else if (0x2f == type) // End of track
+				return reader.Skip(length);
+			else if (false == reader.Skip(length))
+				return false;
+
+			continue;
+		}
+
+		if (MIDI_SYSEX == status || MIDI_EOX == status)
+		{
+			uint32_t length;
+			if (false == reader.ReadVLQ(length) || false == reader.Skip(length))
+				return false;
+
+			continue;
+		}
+
+		uint32_t data1;
+		if (status < 0x80)
+		{
+			// Running status
+			if (0 == runningStatus)
+				return false;
+
+			data1 = status;
+			status = runningStatus;
+		}
+		else
+		{
+			runningStatus = status;
+			if (false == reader.Read(1, data1))
+				return false;
+		}
+
+		const uint32_t type = status & 0xf0;
+
+		uint32_t data2 = 0;
+		if (PROGRAM_CHANGE != type && CHANNEL_PRESSURE != type && false == reader.Read(1, data2))
+			return false;
+
+		if (-1 != channel && int(status & 0xf) != channel)
+			continue;
+
+		switch (type)
+		{
+		case NOTE_ON:
+			if (0 != data2)
+			{
+				events.push_back({ Event::kNoteOn, tick, 0, data1, data2/127.f });
+				break;
+			}
+
+			// Velocity zero is NOTE_OFF
+			[[fallthrough]];
+
+		case NOTE_OFF:
+			events.push_back({ Event::kNoteOff, tick, 0, data1, 0.f });
+			break;
+
+		case CONTROL_CHANGE:
+			if (SUSTAIN == data1)
+				events.push_back({ Event::kSustain, tick, 0, 0, (data2 >= 64) ? 1.f : 0.f });
+			else if (kModWheelCC == data1)
+				events.push_back({ Event::kModulation, tick, 0, 0, data2/127.f });
+			else if (kAllNotesOffCC == data1 || kAllSoundOffCC == data1)
+				events.push_back({ Event::kAllNotesOff, tick, 0, 0, 0.f });
+			break;
+
+		case PITCH_BEND:
+			{
+				const int bend = int(data1 | (data2 << 7)) - 8192;
+				events.push_back({ Event::kBend, tick, 0, 0, std::clamp(bend/8191.f, -1.f, 1.f) });
+				break;
+			}
+
+		case CHANNEL_PRESSURE:
+			events.push_back({ Event::kAftertouch, tick, 0, 0, data1/127.f });
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+// Reads all tracks into one list, sorted by sample
+static bool LoadMIDIFile(const std::string &path, int channel, unsigned sampleRate, std::vector<Event> &events)
+{
+	FILE *pFile = fopen(path.c_str(), "rb");
+	if (nullptr == pFile)
+	{
+		printf("Can't open MIDI file: %s\n", path.c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[65536];
+	size_t numRead;
+	while (0 != (numRead = fread(buffer, 1, sizeof(buffer), pFile)))
+		data.insert(data.end(), buffer, buffer+numRead);
+
+	fclose(pFile);
+
+	MIDIReader file(data, 0, data.size());
+
+	uint32_t magic, headerSize, format, numTracks, division;
+	if (false == file.Read(4, magic) || 0x4d546864 /* MThd */ != magic ||
+		false == file.Read(4, headerSize) || headerSize < 6 ||
+		false == file.Read(2, format) || false == file.Read(2, numTracks) || false == file.Read(2, division) ||
+		false == file.Skip(headerSize-6))
+	{
+		printf("%s: not a Standard MIDI File\n", path.c_str());
+		return false;
+	}
+
+	if (format > 1)
+	{
+		printf("%s: format %u not supported (only 0 & 1)\n", path.c_str(), format);
+		return false;
+	}
+
+	events.clear();
+
+	for (unsigned iTrack = 0; iTrack < numTracks && false == file.IsDone(); )
+	{
+		uint32_t chunkType, chunkSize;
+		if (false == file.Read(4, chunkType) || false == file.Read(4, chunkSize) || file.GetOffset()+chunkSize > data.size())
+		{
+			printf("%s: truncated\n", path.c_str());
+			return false;
+		}
+
+		// Skip unknown chunks
+		if (0x4d54726b /* MTrk */ == chunkType)
+		{
+			MIDIReader track(data, file.GetOffset(), file.GetOffset()+chunkSize);
+			if (false == ReadTrack(track, channel, events))
+			{
+				printf("%s: track %u is corrupt\n", path.c_str(), iTrack);
+				return false;
+			}
+
+			++iTrack;
+		}
+
+		file.Skip(chunkSize);
+	}
+
+	// Merge tracks (stable, so events on the same tick stay in order of their track)
+	std::stable_sort(events.begin(), events.end(), [](const Event &left, const Event &right) { return left.tick < right.tick; });
+
+	// Ticks to samples
+	if (0 != (division & 0x8000))
+	{
+		// SMPTE: frames per second (negative) & ticks per frame
+		const int framesPerSec = -int8_t(division >> 8);
+		const double ticksPerSec = framesPerSec*double(division & 0xff);
+
+		if (0.0 == ticksPerSec)
+			return false;
+
+		for (Event &event : events)
+			event.sample = uint64_t(llround(event.tick*sampleRate/ticksPerSec));
+	}
+	else
+	{
+		if (0 == division)
+			return false;
+
+		// Tempo map (applies to all tracks)
+		double seconds = 0.0;
+		double secondsPerTick = 60.0/(kDefBPM*division);
+		uint64_t lastTick = 0;
+
+		for (Event &event : events)
+		{
+			seconds += (event.tick-lastTick)*secondsPerTick;
+			lastTick = event.tick;
+
+			event.sample = uint64_t(llround(seconds*sampleRate));
+
+			if (Event::kTempo == event.type)
+				secondsPerTick = 60.0/(event.value*division);
+		}
+	}
+
+	return true;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	WAV writer (little endian hosts only)
+
+ ------------------------------------------------------------------------------------------------------ */
+
+#pragma pack(push, 1)
+
+struct WavHeader
+{
+	char riff[4];
+	uint32_t riffSize;
+	char wave[4];
+	char fmt[4];
+	uint32_t fmtSize;
+	uint16_t format; // 1 = PCM, 3 = IEEE float
+	uint16_t numChannels;
+	uint32_t sampleRate;
+	uint32_t byteRate;
+	uint16_t blockAlign;
+	uint16_t bitsPerSample;
+	char data[4];
+	uint32_t dataSize;
+};
+
+#pragma pack(pop)
+
+// Write() hands interleaved chunks to a thread that converts & writes them; blocks only if all chunks are in flight
+class WavWriter
+{
+public:
+	WavWriter() :
+		m_chunks(kWriterChunks)
+	{
+		for (Chunk &chunk : m_chunks)
+			chunk.samples.resize(kWriterChunkFrames*2);
+
+		m_bytes.resize(kWriterChunkFrames*2*sizeof(float));
+	}
+
+	~WavWriter()
+	{
+		Close();
+	}
+
+	bool Open(const std::string &path, unsigned sampleRate, SampleFormat format)
+	{
+		SFM_ASSERT(nullptr == m_pFile);
+
+		m_pFile = fopen(path.c_str(), "wb");
+		if (nullptr == m_pFile)
+			return false;
+
+		m_sampleRate = sampleRate;
+		m_format = format;
+		m_numFrames = 0;
+		m_failed = false;
+		m_closing = false;
+		m_head = m_tail = m_count = 0;
+		m_ditherState = 0x9e3779b9;
+
+		// Placeholder, sizes are filled in by Close()
+		WriteHeader();
+
+		m_thread = std::thread(&WavWriter::Thread, this);
+
+		return true;
+	}
+
+	void Write(const float *pLeft, const float *pRight, unsigned numFrames)
+	{
+		while (numFrames > 0)
+		{
+			Chunk &chunk = m_chunks[m_tail];
+
+			const unsigned numToCopy = std::min(numFrames, kWriterChunkFrames-chunk.numFrames);
+			float *pDest = chunk.samples.data() + chunk.numFrames*2;
+			for (unsigned iFrame = 0; iFrame < numToCopy; ++iFrame)
+			{
+				*pDest++ = pLeft[iFrame];
+				*pDest++ = pRight[iFrame];
+			}
+
+			chunk.numFrames += numToCopy;
+			pLeft  += numToCopy;
+			pRight += numToCopy;
+			numFrames -= numToCopy;
+
+			if (kWriterChunkFrames == chunk.numFrames)
+				Submit();
+		}
+	}
+
+	// Returns false if anything went wrong since Open()
+	bool Close()
+	{
+		if (nullptr == m_pFile)
+			return false;
+
+		if (0 != m_chunks[m_tail].numFrames)
+			Submit();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closing = true;
+		}
+
+		m_condition.notify_all();
+		m_thread.join();
+
+		// Now that the sizes are known
+		if (0 != fseek(m_pFile, 0, SEEK_SET))
+			m_failed = true;
+		else
+			WriteHeader();
+
+		if (0 != fclose(m_pFile))
+			m_failed = true;
+
+		m_pFile = nullptr;
+
+		return false == m_failed;
+	}
+
+private:
+	struct Chunk
+	{
+		std::vector<float> samples;
+		unsigned numFrames = 0;
+	};
+
+	unsigned GetBytesPerSample() const
+	{
+		return (kFloat32 == m_format) ? 4 : (kPCM24 == m_format) ? 3 : 2;
+	}
+
+	void Submit()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_tail = (m_tail+1) % kWriterChunks;
+		++m_count;
+		m_condition.notify_all();
+
+		// Wait until the next one is free (the thread clears it's 'numFrames')
+		m_condition.wait(lock, [this] { return m_count < kWriterChunks; });
+	}
+
+	void WriteHeader()
+	{
+		const unsigned bytesPerSample = GetBytesPerSample();
+		const uint64_t dataSize = m_numFrames*2*bytesPerSample;
+
+		if (dataSize > 0xffffffffull - sizeof(WavHeader))
+			m_failed = true; // Too large for plain RIFF
+
+		WavHeader header;
+		memcpy(header.riff, "RIFF", 4);
+		header.riffSize = uint32_t(sizeof(WavHeader)-8 + dataSize);
+		memcpy(header.wave, "WAVE", 4);
+		memcpy(header.fmt, "fmt ", 4);
+		header.fmtSize = 16;
+		header.format = (kFloat32 == m_format) ? 3 : 1;
+		header.numChannels = 2;
+		header.sampleRate = m_sampleRate;
+		header.byteRate = m_sampleRate*2*bytesPerSample;
+		header.blockAlign = uint16_t(2*bytesPerSample);
+		header.bitsPerSample = uint16_t(8*bytesPerSample);
+		memcpy(header.data, "data", 4);
+		header.dataSize = uint32_t(dataSize);
+
+		if (1 != fwrite(&header, sizeof(WavHeader), 1, m_pFile))
+			m_failed = true;
+	}
+
+	// TPDF, [-1..1] LSB
+	float Dither()
+	{
+		// Xorshift32
+		auto next = [this]() -> float
+		{
+			m_ditherState ^= m_ditherState << 13;
+			m_ditherState ^= m_ditherState >> 17;
+			m_ditherState ^= m_ditherState << 5;
+			return m_ditherState*(1.f/4294967296.f);
+		};
+
+		return next() - next();
+	}
+
+	void Convert(const Chunk &chunk)
+	{
+		const unsigned numSamples = chunk.numFrames*2;
+		const float *pSamples = chunk.samples.data();
+		uint8_t *pDest = m_bytes.data();
+
+		switch (m_format)
+		{
+		case kFloat32:
+			memcpy(pDest, pSamples, numSamples*sizeof(float));
+			break;
+
+		case kPCM24:
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				const int32_t value = int32_t(lrintf(std::clamp(pSamples[iSample], -1.f, 1.f)*8388607.f));
+				*pDest++ = uint8_t(value);
+				*pDest++ = uint8_t(value >> 8);
+				*pDest++ = uint8_t(value >> 16);
+			}
+
+			break;
+
+		case kPCM16:
+			for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			{
+				const float dithered = pSamples[iSample]*32767.f + Dither();
+				const int16_t value = int16_t(lrintf(std::clamp(dithered, -32768.f, 32767.f)));
+				memcpy(pDest, &value, sizeof(int16_t));
+				pDest += sizeof(int16_t);
+			}
+
+			break;
+		}
+	}
+
+	void Thread()
+	{
+		for (;;)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return 0 != m_count || true == m_closing; });
+
+			if (0 == m_count)
+				return; // Closing & nothing left
+
+			Chunk &chunk = m_chunks[m_head];
+			lock.unlock();
+
+			Convert(chunk);
+
+			const size_t numBytes = size_t(chunk.numFrames)*2*GetBytesPerSample();
+			if (numBytes != fwrite(m_bytes.data(), 1, numBytes, m_pFile))
+				m_failed = true;
+
+			m_numFrames += chunk.numFrames;
+			chunk.numFrames = 0;
+
+			lock.lock();
+			m_head = (m_head+1) % kWriterChunks;
+			--m_count;
+			lock.unlock();
+
+			m_condition.notify_all();
+		}
+	}
+
+	FILE *m_pFile = nullptr;
+	unsigned m_sampleRate = 0;
+	SampleFormat m_format = kFloat32;
+	uint64_t m_numFrames = 0;
+	std::atomic<bool> m_failed = false;
+	uint32_t m_ditherState = 0;
+
+	std::vector<Chunk> m_chunks;
+	std::vector<uint8_t> m_bytes;
+
+	// Guarded by 'm_mutex': producer fills 'm_tail', thread writes 'm_head' onwards
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	unsigned m_head = 0, m_tail = 0, m_count = 0;
+	bool m_closing = false;
+
+	std::thread m_thread;
+};
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Render
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Result
+{
+	bool success = false;
+	double audioSec = 0.0;
+	double renderSec = 0.0;
+	float peak = 0.f;
+	size_t numEvents = 0;
+};
+
+static void Dispatch(Bison &bison, const Event &event, unsigned timeStamp, bool (&keys)[kMIDINumKeys], float &bend, float &modulation, float &aftertouch)
+{
+	switch (event.type)
+	{
+	case Event::kNoteOn:
+		bison.NoteOn(event.key, -1.f, event.value, timeStamp);
+		keys[event.key] = true;
+		break;
+
+	case Event::kNoteOff:
+		bison.NoteOff(event.key, timeStamp);
+		keys[event.key] = false;
+		break;
+
+	case Event::kAllNotesOff:
+		for (unsigned iKey = 0; iKey < kMIDINumKeys; ++iKey)
+		{
+			if (true == keys[iKey])
+			{
+				bison.NoteOff(iKey, timeStamp);
+				keys[iKey] = false;
+			}
+		}
+
+		break;
+
+	case Event::kSustain:
+		bison.Sustain(0.f != event.value);
+		break;
+
+	case Event::kTempo:
+		bison.SetBPM(event.value, false);
+		break;
+
+	case Event::kBend:
+		bend = event.value;
+		break;
+
+	case Event::kModulation:
+		modulation = event.value;
+		break;
+
+	case Event::kAftertouch:
+		aftertouch = event.value;
+		break;
+	}
+}
+
+static Result RenderFile(Bison &bison, const Patch &patch, const Options &options, const std::string &inputPath, const std::string &outputPath, WavWriter &writer)
+{
+	Result result;
+
+	std::vector<Event> events;
+	if (false == LoadMIDIFile(inputPath, options.channel, options.sampleRate, events))
+		return result;
+
+	result.numEvents = events.size();
+
+	if (false == writer.Open(outputPath, options.sampleRate, options.format))
+	{
+		printf("Can't open output: %s\n", outputPath.c_str());
+		return result;
+	}
+
+	// Set up anew, so it doesn't matter what this instance rendered before
+	bison.GetPatch() = patch;
+	bison.SetSeed(options.seed);
+	bison.SetPipelined(options.pipelined);
+	bison.OnSetSamplingProperties(options.sampleRate, options.blockSize);
+	bison.Sustain(false);
+	bison.SetBPM(kDefBPM, true);
+
+	const unsigned blockSize = options.blockSize;
+	std::vector<float> left(blockSize), right(blockSize);
+
+	bool keys[kMIDINumKeys] = { false };
+	float bend = 0.f, modulation = 0.f, aftertouch = 0.f;
+
+	const float tailThreshold = powf(10.f, options.taildB/20.f);
+	const uint64_t tailHold = uint64_t(kTailHoldSec*options.sampleRate);
+	const uint64_t lastEvent = (true == events.empty()) ? 0 : events.back().sample;
+	const uint64_t maxEnd = lastEvent + uint64_t(options.maxTailSec*options.sampleRate);
+
+	uint64_t position = 0, silent = 0;
+	size_t iEvent = 0;
+
+	// Pipelined mode delays output by a block, drop that so output lines up with the MIDI file either way
+	unsigned numToSkip = (true == bison.IsPipelined()) ? blockSize : 0;
+	uint64_t numWritten = 0;
+
+	std::chrono::steady_clock::duration renderTime(0);
+
+	for (;;)
+	{
+		// Split at sustain & tempo changes
+		uint64_t end = position + blockSize;
+		for (size_t iSplit = iEvent; iSplit < events.size() && events[iSplit].sample < end; ++iSplit)
+		{
+			if (true == events[iSplit].SplitsBlock() && events[iSplit].sample > position)
+			{
+				end = events[iSplit].sample;
+				break;
+			}
+		}
+
+		for (; iEvent < events.size() && events[iEvent].sample < end; ++iEvent)
+		{
+			const uint64_t sample = std::max(events[iEvent].sample, position);
+			Dispatch(bison, events[iEvent], unsigned(sample-position), keys, bend, modulation, aftertouch);
+		}
+
+		const unsigned numSamples = unsigned(end-position);
+
+		const auto start = std::chrono::steady_clock::now();
+		bison.Render(numSamples, bend, modulation, aftertouch, left.data(), right.data());
+		renderTime += std::chrono::steady_clock::now()-start;
+
+		const unsigned numSkipped = std::min(numSamples, numToSkip);
+		numToSkip -= numSkipped;
+
+		writer.Write(left.data()+numSkipped, right.data()+numSkipped, numSamples-numSkipped);
+		numWritten += numSamples-numSkipped;
+
+		float peak = 0.f;
+		for (unsigned iSample = 0; iSample < numSamples; ++iSample)
+			peak = std::max(peak, std::max(fabsf(left[iSample]), fabsf(right[iSample])));
+
+		result.peak = std::max(result.peak, peak);
+		position = end;
+
+		// Tail
+		if (iEvent == events.size())
+		{
+			if (0 == bison.GetVoiceCount() && peak < tailThreshold)
+				silent += numSamples;
+			else
+				silent = 0;
+
+			if (silent >= tailHold || position >= maxEnd)
+				break;
+		}
+	}
+
+	bison.DeleteRateDependentObjects();
+
+	if (false == writer.Close())
+	{
+		printf("Can't write output: %s\n", outputPath.c_str());
+		return result;
+	}
+
+	result.success = true;
+	result.audioSec = double(numWritten)/options.sampleRate;
+	result.renderSec = std::chrono::duration<double>(renderTime).count();
+
+	return result;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Main
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static std::string GetOutputPath(const Options &options, const std::string &inputPath)
+{
+	if (false == options.outputPath.empty())
+		return options.outputPath;
+
+	std::string name = inputPath;
+
+	if (false == options.outputDir.empty())
+	{
+		const size_t slash = name.find_last_of("/\\");
+		if (std::string::npos != slash)
+			name = name.substr(slash+1);
+
+		name = options.outputDir + "/" + name;
+	}
+
+	const size_t dot = name.find_last_of('.');
+	const size_t slash = name.find_last_of("/\\");
+	if (std::string::npos != dot && (std::string::npos == slash || dot > slash))
+		name = name.substr(0, dot);
+
+	return name + ".wav";
+}
+
+static int PrintUsage()
+{
+	printf("Usage: fmbison-render [--patch <file>] [--output <file> | --output-dir <dir>] [--format f32|s24|s16]\n");
+	printf("                      [--rate <Hz>] [--block <samples>] [--channel <1-16>] [--jobs <N>]\n");
+	printf("                      [--tail-db <dB>] [--max-tail <sec>] [--seed <N>] [--pipelined] <file.mid> [<file.mid> ...]\n");
+	return 2;
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	std::vector<std::string> inputs;
+
+	for (int iArg = 1; iArg < argc; ++iArg)
+	{
+		const std::string arg = argv[iArg];
+		const bool hasValue = iArg+1 < argc;
+
+		if ("--patch" == arg && true == hasValue)
+			options.patchPath = argv[++iArg];
+		else if ("--output" == arg && true == hasValue)
+			options.outputPath = argv[++iArg];
+		else if ("--output-dir" == arg && true == hasValue)
+			options.outputDir = argv[++iArg];
+		else if ("--format" == arg && true == hasValue)
+		{
+			const std::string format = argv[++iArg];
+			if ("f32" == format)
+				options.format = kFloat32;
+			else if ("s24" == format)
+				options.format = kPCM24;
+			else if ("s16" == format)
+				options.format = kPCM16;
+			else
+				return PrintUsage();
+		}
+		else if ("--rate" == arg && true == hasValue)
+			options.sampleRate = unsigned(atoi(argv[++iArg]));
+		else if ("--block" == arg && true == hasValue)
+			options.blockSize = unsigned(atoi(argv[++iArg]));
+		else if ("--channel" == arg && true == hasValue)
+			options.channel = atoi(argv[++iArg])-1;
+		else if ("--jobs" == arg && true == hasValue)
+			options.numJobs = unsigned(atoi(argv[++iArg]));
+		else if ("--tail-db" == arg && true == hasValue)
+			options.taildB = float(atof(argv[++iArg]));
+		else if ("--max-tail" == arg && true == hasValue)
+			options.maxTailSec = float(atof(argv[++iArg]));
+		else if ("--seed" == arg && true == hasValue)
+			options.seed = strtoull(argv[++iArg], nullptr, 0);
+		else if ("--pipelined" == arg)
+			options.pipelined = true;
+		else if (0 == arg.compare(0, 2, "--"))
+			return PrintUsage();
+		else
+			inputs.push_back(arg);
+	}
+
+	if (true == inputs.empty() || 0 == options.sampleRate || 0 == options.blockSize || options.channel < -1 || options.channel > 15)
+		return PrintUsage();
+
+	if (false == options.outputPath.empty() && inputs.size() > 1)
+	{
+		printf("--output takes a single input, use --output-dir\n");
+		return 2;
+	}
+
+	// Patch
+	Patch patch;
+	patch.ResetToEngineDefaults();
+
+	if (false == options.patchPath.empty())
+	{
+		if (false == LoadPatch(options.patchPath, patch))
+			return 1;
+	}
+	else
+	{
+		// Like a DX7's 'INIT VOICE'
+		patch.operators.operators[0].enabled = true;
+		patch.operators.operators[0].isCarrier = true;
+		patch.operators.operators[0].waveform = Oscillator::kSine;
+	}
+
+	unsigned numJobs = (0 != options.numJobs) ? options.numJobs : std::max(1u, std::thread::hardware_concurrency());
+	numJobs = std::min(numJobs, unsigned(inputs.size()));
+
+	// Instances & writers are created here, on this thread (see above)
+	std::vector<std::unique_ptr<Bison>> instances;
+	std::vector<std::unique_ptr<WavWriter>> writers;
+	for (unsigned iJob = 0; iJob < numJobs; ++iJob)
+	{
+		instances.emplace_back(std::make_unique<Bison>());
+		writers.emplace_back(std::make_unique<WavWriter>());
+	}
+
+	std::vector<Result> results(inputs.size());
+	std::atomic<size_t> nextInput = 0;
+	std::mutex printMutex;
+
+	auto worker = [&](unsigned iJob)
+	{
+		for (size_t iInput = nextInput++; iInput < inputs.size(); iInput = nextInput++)
+		{
+			const std::string outputPath = GetOutputPath(options, inputs[iInput]);
+			const Result result = RenderFile(*instances[iJob], patch, options, inputs[iInput], outputPath, *writers[iJob]);
+			results[iInput] = result;
+
+			if (true == result.success)
+			{
+				std::lock_guard<std::mutex> lock(printMutex);
+
+				const double realtime = (result.renderSec > 0.0) ? result.audioSec/result.renderSec : 0.0;
+				printf("%s -> %s: %zu events, %.2f sec. in %.2f sec. (%.1fx realtime), peak %.1f dBFS\n",
+					inputs[iInput].c_str(), outputPath.c_str(), result.numEvents, result.audioSec, result.renderSec, realtime,
+					(result.peak > 0.f) ? 20.f*log10f(result.peak) : -INFINITY);
+			}
+		}
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for (unsigned iJob = 1; iJob < numJobs; ++iJob)
+		threads.emplace_back(worker, iJob);
+
+	worker(0);
+
+	for (std::thread &thread : threads)
+		thread.join();
+
+	const double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+	int exitCode = 0;
+	double audioSec = 0.0;
+	for (const Result &result : results)
+	{
+		audioSec += result.audioSec;
+		if (false == result.success)
+			exitCode = 1;
+	}
+
+	if (inputs.size() > 1)
+		printf("Total: %zu file(s), %.2f sec. in %.2f sec. on %u thread(s) (%.1fx realtime)\n",
+			inputs.size(), audioSec, wallSec, numJobs, (wallSec > 0.0) ? audioSec/wallSec : 0.0);
+
+	return exitCode;
+}
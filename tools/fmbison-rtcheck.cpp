@@ -0,0 +1,629 @@
+
+/*
+	FM. BISON hybrid FM synthesis -- Real-time safety check (allocations & locks on the audio thread).
+	(C) njdewit technologies (visualizers.nl) & bipolaraudio.nl
+	MIT license applies, please see https://en.wikipedia.org/wiki/MIT_License or LICENSE in the project root!
+
+	Interposes malloc() & friends, operator new/delete and pthread mutex/thread calls, and records a stack trace
+	each time one of them happens on a thread that's flagged as the audio thread, which is the case only while it
+	is inside Bison::Render() (or BisonRack::Render()); then runs a set of scenarios meant to shake the render path up
+
+	Usage:
+		fmbison-rtcheck [--scenario <name>] [--traces <count>]
+
+	- Exit code is non-zero if any violation was found, so this can run as part of a build/CI
+	- Only Render() is checked: NoteOn(), NoteOff() & the like are called in between, unflagged (FIXME?)
+	- Linux/glibc only (forwards to __libc_malloc() & co., uses dlsym(RTLD_NEXT) & backtrace()), and can't be built
+	  along with a sanitizer as those interpose the same functions (see CMakeLists.txt)
+	- Traces are more readable if the executable exports it's symbols (it's linked that way, see CMakeLists.txt)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../FM_BISON.h"
+#include "../synth-rack.h"
+
+using namespace SFM;
+
+constexpr unsigned kRTSampleRate = 48000;
+constexpr unsigned kRTBlockSize  = 256;
+constexpr unsigned kRTBlocks     = 400; // Per scenario, approx. 2 sec.
+
+constexpr unsigned kMaxTraceDepth = 32;
+constexpr unsigned kMaxTraces     = 256; // Unique
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Interposer
+
+	Must not allocate nor lock itself, hence the fixed size trace table & the re-entrancy guard
+
+ ------------------------------------------------------------------------------------------------------ */
+
+enum Violation
+{
+	kMalloc,
+	kFree,
+	kNew,
+	kDelete,
+	kMutexLock,
+	kThreadCreate,
+	kThreadJoin,
+	kNumViolations
+};
+
+static const char *s_violationNames[kNumViolations] =
+{
+	"malloc",
+	"free",
+	"operator new",
+	"operator delete",
+	"pthread_mutex_lock",
+	"pthread_create",
+	"pthread_join"
+};
+
+struct Trace
+{
+	Violation violation;
+	unsigned count;
+	int depth;
+	void *frames[kMaxTraceDepth];
+};
+
+static thread_local bool t_isAudioThread = false;
+static thread_local bool t_inHook = false;
+
+static std::atomic<uint64_t> s_violations[kNumViolations];
+
+static Trace s_traces[kMaxTraces];
+static std::atomic<unsigned> s_numTraces = 0;
+static std::atomic<uint64_t> s_lostTraces = 0;
+
+static void Record(Violation violation)
+{
+	if (false == t_isAudioThread || true == t_inHook)
+		return;
+
+	t_inHook = true;
+
+	s_violations[violation].fetch_add(1, std::memory_order_relaxed);
+
+	void *frames[kMaxTraceDepth];
+	const int depth = backtrace(frames, kMaxTraceDepth);
+
+	// Same trace seen before? (only the audio thread writes, so no need to be clever here)
+	const unsigned numTraces = s_numTraces.load(std::memory_order_relaxed);
+	for (unsigned iTrace = 0; iTrace < numTraces; ++iTrace)
+	{
+		Trace &trace = s_traces[iTrace];
+		if (violation == trace.violation && depth == trace.depth && 0 == memcmp(frames, trace.frames, depth*sizeof(void *)))
+		{
+			++trace.count;
+			t_inHook = false;
+			return;
+		}
+	}
+
+	if (numTraces < kMaxTraces)
+	{
+		Trace &trace = s_traces[numTraces];
+		trace.violation = violation;
+		trace.count = 1;
+		trace.depth = depth;
+		memcpy(trace.frames, frames, depth*sizeof(void *));
+		s_numTraces.store(numTraces+1, std::memory_order_relaxed);
+	}
+	else
+		s_lostTraces.fetch_add(1, std::memory_order_relaxed);
+
+	t_inHook = false;
+}
+
+// glibc's own allocator
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pAddress, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+extern "C" void  __libc_free(void *pAddress);
+
+extern "C"
+{
+	void *malloc(size_t size)
+	{
+		Record(kMalloc);
+		return __libc_malloc(size);
+	}
+
+	void *calloc(size_t count, size_t size)
+	{
+		Record(kMalloc);
+		return __libc_calloc(count, size);
+	}
+
+	void *realloc(void *pAddress, size_t size)
+	{
+		Record(kMalloc);
+		return __libc_realloc(pAddress, size);
+	}
+
+	void *aligned_alloc(size_t alignment, size_t size)
+	{
+		Record(kMalloc);
+		return __libc_memalign(alignment, size);
+	}
+
+	void *memalign(size_t alignment, size_t size)
+	{
+		Record(kMalloc);
+		return __libc_memalign(alignment, size);
+	}
+
+	int posix_memalign(void **ppAddress, size_t alignment, size_t size)
+	{
+		Record(kMalloc);
+
+		void *pAddress = __libc_memalign(alignment, size);
+		if (nullptr == pAddress)
+			return ENOMEM;
+
+		*ppAddress = pAddress;
+		return 0;
+	}
+
+	void free(void *pAddress)
+	{
+		if (nullptr != pAddress)
+			Record(kFree);
+
+		__libc_free(pAddress);
+	}
+}
+
+// Operator new & delete skip malloc() so they're reported as what they are
+static void *AllocateNew(size_t size, size_t alignment = 0)
+{
+	Record(kNew);
+
+	void *pAddress = (0 == alignment) ? __libc_malloc(size ? size : 1) : __libc_memalign(alignment, size ? size : 1);
+	if (nullptr == pAddress)
+		throw std::bad_alloc();
+
+	return pAddress;
+}
+
+static void FreeNew(void *pAddress)
+{
+	if (nullptr != pAddress)
+		Record(kDelete);
+
+	__libc_free(pAddress);
+}
+
+void *operator new(size_t size)                                          { return AllocateNew(size); }
+void *operator new[](size_t size)                                        { return AllocateNew(size); }
+void *operator new(size_t size, std::align_val_t alignment)              { return AllocateNew(size, size_t(alignment)); }
+void *operator new[](size_t size, std::align_val_t alignment)            { return AllocateNew(size, size_t(alignment)); }
+void operator delete(void *pAddress) noexcept                            { FreeNew(pAddress); }
+void operator delete[](void *pAddress) noexcept                          { FreeNew(pAddress); }
+void operator delete(void *pAddress, size_t) noexcept                    { FreeNew(pAddress); }
+void operator delete[](void *pAddress, size_t) noexcept                  { FreeNew(pAddress); }
+void operator delete(void *pAddress, std::align_val_t) noexcept          { FreeNew(pAddress); }
+void operator delete[](void *pAddress, std::align_val_t) noexcept        { FreeNew(pAddress); }
+void operator delete(void *pAddress, size_t, std::align_val_t) noexcept  { FreeNew(pAddress); }
+void operator delete[](void *pAddress, size_t, std::align_val_t) noexcept { FreeNew(pAddress); }
+
+// Threads & locks: forwarded to the next definition (libc), looked up on first use (benign race)
+template<typename T> static T GetNext(T &pFunction, const char *name)
+{
+	if (nullptr == pFunction)
+		pFunction = reinterpret_cast<T>(dlsym(RTLD_NEXT, name));
+
+	return pFunction;
+}
+
+static int (*s_pMutexLock)(pthread_mutex_t *) = nullptr;
+static int (*s_pMutexTryLock)(pthread_mutex_t *) = nullptr;
+static int (*s_pThreadCreate)(pthread_t *, const pthread_attr_t *, void *(*)(void *), void *) = nullptr;
+static int (*s_pThreadJoin)(pthread_t, void **) = nullptr;
+
+extern "C"
+{
+	int pthread_mutex_lock(pthread_mutex_t *pMutex)
+	{
+		Record(kMutexLock);
+		return GetNext(s_pMutexLock, "pthread_mutex_lock")(pMutex);
+	}
+
+	int pthread_mutex_trylock(pthread_mutex_t *pMutex)
+	{
+		Record(kMutexLock);
+		return GetNext(s_pMutexTryLock, "pthread_mutex_trylock")(pMutex);
+	}
+
+	int pthread_create(pthread_t *pThread, const pthread_attr_t *pAttr, void *(*pRoutine)(void *), void *pArg)
+	{
+		Record(kThreadCreate);
+		return GetNext(s_pThreadCreate, "pthread_create")(pThread, pAttr, pRoutine, pArg);
+	}
+
+	int pthread_join(pthread_t thread, void **ppResult)
+	{
+		Record(kThreadJoin);
+		return GetNext(s_pThreadJoin, "pthread_join")(thread, ppResult);
+	}
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Scenarios
+
+	Each gets a fresh instance; 'block' is called before each Render() to play the host (unflagged)
+
+ ------------------------------------------------------------------------------------------------------ */
+
+struct Scenario
+{
+	const char *name;
+	std::function<void(Patch &)> setup;
+	std::function<void(Bison &, unsigned iBlock)> block;
+	unsigned internalRate = 0;
+	bool pipelined = false;
+	unsigned rackParts = 0; // Runs a BisonRack instead, 'block' is called for each part
+};
+
+static void SetupFMStack(Patch &patch)
+{
+	auto &ops = patch.operators.operators;
+	for (unsigned iOp = 0; iOp < kNumOperators; ++iOp)
+	{
+		ops[iOp].enabled = true;
+		ops[iOp].isCarrier = 0 == (iOp & 1);
+		ops[iOp].coarse = 1 + iOp/2;
+		ops[iOp].index = 0.3f;
+		if (0 == (iOp & 1)) ops[iOp].modulators[0] = iOp+1;
+	}
+
+	ops[5].feedback = 5;
+	ops[5].feedbackAmt = 0.4f;
+}
+
+static void SetupAllFX(Patch &patch)
+{
+	SetupFMStack(patch);
+
+	auto &ops = patch.operators.operators;
+	ops[2].waveform = Oscillator::Waveform::kSupersaw;
+	ops[2].modulators[0] = -1;
+	ops[4].waveform = Oscillator::Waveform::kPolySaw;
+
+	patch.wahWet = 0.6f;
+	patch.wahSpeak = 0.5f;
+	patch.cpWet = 0.5f;
+	patch.delayWet = 0.3f;
+	patch.delayFeedback = 0.4f;
+	patch.postWet = 0.5f;
+	patch.tubeDistort = 0.5f;
+	patch.reverbWet = 0.4f;
+	patch.compThresholddB = -18.f;
+}
+
+static std::vector<Scenario> GetScenarios()
+{
+	std::vector<Scenario> scenarios;
+
+	// Far more notes than voices, all at once, then all released
+	scenarios.push_back({ "note-flood", SetupFMStack, [](Bison &bison, unsigned iBlock)
+	{
+		if (0 == iBlock % 20)
+		{
+			for (unsigned key = 24; key < 120; ++key)
+				bison.NoteOn(key, -1.f, 0.8f, key % kRTBlockSize);
+		}
+		else if (10 == iBlock % 20)
+		{
+			for (unsigned key = 24; key < 120; ++key)
+				bison.NoteOff(key, key % kRTBlockSize);
+		}
+	} });
+
+	// Sustain pedal held while notes come and go (and polyphony changes)
+	scenarios.push_back({ "sustain", SetupFMStack, [](Bison &bison, unsigned iBlock)
+	{
+		const unsigned key = 48 + (iBlock*7) % 36;
+
+		if (0 == iBlock % 50)
+			bison.Sustain(true);
+		else if (35 == iBlock % 50)
+			bison.Sustain(false);
+
+		if (0 == iBlock % 3)
+			bison.NoteOn(key, -1.f, 0.7f, 0);
+		else if (1 == iBlock % 3)
+			bison.NoteOff(key, 128);
+
+		if (0 == iBlock % 120)
+			bison.GetPatch().maxPolyVoices = (0 == iBlock % 240) ? 8 : 32;
+	} });
+
+	// Switching between poly & mono with notes playing, and explicit voice resets
+	scenarios.push_back({ "mode-switch", SetupFMStack, [](Bison &bison, unsigned iBlock)
+	{
+		Patch &patch = bison.GetPatch();
+
+		if (0 == iBlock % 25)
+			patch.voiceMode = (Patch::VoiceMode::kMono == patch.voiceMode) ? Patch::VoiceMode::kPoly : Patch::VoiceMode::kMono;
+
+		if (0 == iBlock % 60)
+			bison.ResetVoices();
+
+		const unsigned key = 40 + (iBlock*5) % 24;
+		if (0 == iBlock % 2)
+			bison.NoteOn(key, -1.f, 0.6f, 64);
+		else if (0 == iBlock % 5)
+			bison.NoteOff(40 + ((iBlock-3)*5) % 24, 0);
+	} });
+
+	// PostPass rebuilt (by it's worker) and crossfaded in, repeatedly
+	scenarios.push_back({ "reset-postpass", SetupAllFX, [](Bison &bison, unsigned iBlock)
+	{
+		if (0 == iBlock)
+		{
+			for (unsigned key : { 48, 55, 60, 64 })
+				bison.NoteOn(key, -1.f, 0.8f, 0);
+		}
+
+		if (0 == iBlock % 15)
+			bison.ResetPostPass();
+	} });
+
+	// Parameters all over the place, every block
+	scenarios.push_back({ "patch-edits", SetupAllFX, [](Bison &bison, unsigned iBlock)
+	{
+		Patch &patch = bison.GetPatch();
+		auto &ops = patch.operators.operators;
+
+		const float phase = (iBlock % 64)/63.f;
+
+		patch.cutoff = phase;
+		patch.resonance = 1.f-phase;
+		patch.filterType = (0 == (iBlock/32) % 2) ? Patch::kLowpassFilter : Patch::kBandpassFilter;
+		patch.postCutoff = phase;
+		patch.tubeDistort = phase;
+		patch.delayInSec = phase*kMainDelayInSec;
+		patch.delayWet = 1.f-phase;
+		patch.reverbRoomSize = phase;
+		patch.reverbWet = phase*0.5f;
+		patch.compLookahead = phase;
+		patch.cpIsPhaser = 0 == (iBlock/16) % 2;
+		patch.LFOWaveform1 = (0 == (iBlock/8) % 2) ? Oscillator::Waveform::kSampleAndHold : Oscillator::Waveform::kSine;
+
+		ops[1].index = phase;
+		ops[3].coarse = 1 + (iBlock/16) % 8;
+		ops[5].feedbackAmt = phase;
+
+		if (0 == iBlock % 8)
+			bison.NoteOn(36 + (iBlock/8) % 48, -1.f, 0.5f + 0.5f*phase, 32);
+		else if (4 == iBlock % 8)
+			bison.NoteOff(36 + (iBlock/8) % 48, 32);
+	} });
+
+	// BPM (LFO, delay & wah sync.) changing and resetting phase
+	scenarios.push_back({ "bpm-reset", [](Patch &patch) { SetupAllFX(patch); patch.beatSync = true; }, [](Bison &bison, unsigned iBlock)
+	{
+		if (0 == iBlock % 10)
+			bison.SetBPM(80.f + (iBlock % 90), 0 == iBlock % 20);
+
+		if (0 == iBlock % 40)
+			bison.NoteOn(45 + (iBlock/40) % 12, -1.f, 0.9f, 0);
+		else if (30 == iBlock % 40)
+			bison.NoteOff(45 + (iBlock/40) % 12, 0);
+	} });
+
+	// Voice engine at a lower internal rate (resampled)
+	{
+		Scenario scenario = scenarios[0];
+		scenario.name = "internal-rate";
+		scenario.internalRate = 22050;
+		scenarios.push_back(scenario);
+	}
+
+	// Pipelined mode (handing blocks to & waiting on the pipeline thread), with parameters all over the place
+	{
+		Scenario scenario = scenarios[4];
+		scenario.name = "pipelined";
+		scenario.pipelined = true;
+		scenarios.push_back(scenario);
+	}
+
+	// Rack with send buses; it's pool has no threads of it's own, so all jobs (parts & voices) run, and are checked, here
+	{
+		Scenario scenario = scenarios[0];
+		scenario.name = "rack";
+		scenario.setup = SetupAllFX;
+		scenario.rackParts = 4;
+		scenarios.push_back(scenario);
+	}
+
+	return scenarios;
+}
+
+/* ----------------------------------------------------------------------------------------------------
+
+	Main
+
+ ------------------------------------------------------------------------------------------------------ */
+
+static uint64_t GetTotalViolations()
+{
+	uint64_t total = 0;
+	for (auto &count : s_violations)
+		total += count.load();
+
+	return total;
+}
+
+static void RunRackScenario(const Scenario &scenario)
+{
+	BisonRack rack(scenario.rackParts, 0);
+
+	for (unsigned iPart = 0; iPart < rack.GetNumParts(); ++iPart)
+	{
+		scenario.setup(rack.GetPart(iPart).GetPatch());
+		rack.GetPart(iPart).SetSeed(0xB150Bull+iPart);
+	}
+
+	rack.SetSendBuses(kSendDelay|kSendReverb);
+	rack.GetBusPatch().delayWet = 0.3f;
+	rack.GetBusPatch().reverbWet = 0.4f;
+	rack.OnSetSamplingProperties(kRTSampleRate, kRTBlockSize);
+
+	std::vector<float> left(kRTBlockSize), right(kRTBlockSize);
+
+	for (unsigned iBlock = 0; iBlock < kRTBlocks; ++iBlock)
+	{
+		for (unsigned iPart = 0; iPart < rack.GetNumParts(); ++iPart)
+			scenario.block(rack.GetPart(iPart), iBlock);
+
+		const unsigned numSamples = kRTBlockSize - (iBlock % 3)*17;
+
+		t_isAudioThread = true;
+		rack.Render(numSamples, left.data(), right.data());
+		t_isAudioThread = false;
+	}
+}
+
+static void RunScenario(const Scenario &scenario)
+{
+	if (0 != scenario.rackParts)
+	{
+		RunRackScenario(scenario);
+		return;
+	}
+
+	Bison bison;
+	scenario.setup(bison.GetPatch());
+
+	bison.SetSeed(0xB150Bull);
+	bison.SetPipelined(scenario.pipelined);
+	bison.OnSetSamplingProperties(kRTSampleRate, kRTBlockSize, scenario.internalRate);
+
+	std::vector<float> left(kRTBlockSize), right(kRTBlockSize);
+
+	for (unsigned iBlock = 0; iBlock < kRTBlocks; ++iBlock)
+	{
+		scenario.block(bison, iBlock);
+
+		// Block size varies a little (hosts do that)
+		const unsigned numSamples = kRTBlockSize - (iBlock % 3)*17;
+
+		t_isAudioThread = true;
+		bison.Render(numSamples, 0.f, 0.f, 0.f, left.data(), right.data());
+		t_isAudioThread = false;
+	}
+}
+
+static void PrintUsage()
+{
+	fprintf(stderr, "Usage: fmbison-rtcheck [--scenario <name>] [--traces <count>]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *filter = nullptr;
+	unsigned maxTraces = 16;
+
+	for (int iArg = 1; iArg < argc; ++iArg)
+	{
+		if (0 == strcmp(argv[iArg], "--scenario") && iArg+1 < argc)
+			filter = argv[++iArg];
+		else if (0 == strcmp(argv[iArg], "--traces") && iArg+1 < argc)
+			maxTraces = unsigned(atoi(argv[++iArg]));
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// First call may load libgcc_s (and allocate), get that out of the way
+	void *warmUp[1];
+	backtrace(warmUp, 1);
+
+	bool found = false;
+	uint64_t total = 0;
+
+	for (const Scenario &scenario : GetScenarios())
+	{
+		if (nullptr != filter && 0 != strcmp(filter, scenario.name))
+			continue;
+
+		found = true;
+
+		RunScenario(scenario);
+
+		const uint64_t newTotal = GetTotalViolations();
+		printf("%-16s %s (%llu violations)\n", scenario.name, (newTotal == total) ? "OK  " : "FAIL", (unsigned long long) (newTotal-total));
+		total = newTotal;
+	}
+
+	if (false == found)
+	{
+		fprintf(stderr, "No scenario by that name\n");
+		return 1;
+	}
+
+	if (0 == total)
+	{
+		printf("Render() is real-time safe in all scenarios\n");
+		return 0;
+	}
+
+	// Summary & (most frequent) traces
+	printf("\nViolations on the audio thread:\n");
+	for (unsigned iViolation = 0; iViolation < kNumViolations; ++iViolation)
+	{
+		const uint64_t count = s_violations[iViolation].load();
+		if (0 != count)
+			printf("  %-20s %llu\n", s_violationNames[iViolation], (unsigned long long) count);
+	}
+
+	const unsigned numTraces = s_numTraces.load();
+
+	std::vector<unsigned> order(numTraces);
+	for (unsigned iTrace = 0; iTrace < numTraces; ++iTrace)
+		order[iTrace] = iTrace;
+
+	std::sort(order.begin(), order.end(), [](unsigned a, unsigned b) { return s_traces[a].count > s_traces[b].count; });
+
+	for (unsigned iOrder = 0; iOrder < std::min(numTraces, maxTraces); ++iOrder)
+	{
+		const Trace &trace = s_traces[order[iOrder]];
+
+		printf("\n%s, %u time(s):\n", s_violationNames[trace.violation], trace.count);
+		fflush(stdout);
+
+		// Skip Record() & the hook itself
+		const int skip = std::min(trace.depth, 2);
+		backtrace_symbols_fd(trace.frames+skip, trace.depth-skip, STDOUT_FILENO);
+	}
+
+	if (numTraces > maxTraces)
+		printf("\n(%u more unique trace(s), use --traces)\n", numTraces-maxTraces);
+
+	if (0 != s_lostTraces.load())
+		printf("(%llu violation(s) not traced, table full)\n", (unsigned long long) s_lostTraces.load());
+
+	return 1;
+}